@@ -0,0 +1,208 @@
+#include "BulkDataAllocator.h"
+
+namespace
+{
+    constexpr uint32_t s_headerSize = sizeof(BulkDataHeader);
+
+    // The previous allocator, which reclaimed blocks in allocation order only.
+    class FifoBulkDataAllocator
+    {
+    protected:
+        uint8_t* m_memory;
+        uint32_t m_size;
+        uint32_t m_head = 0;
+        uint32_t m_tail = 0;
+
+        void reclaim()
+        {
+            while (m_tail != m_head)
+            {
+                const auto header = reinterpret_cast<BulkDataHeader*>(m_memory + m_tail);
+
+                if (header->byteSize == 0)
+                    m_tail = 0;
+
+                else if (header->released)
+                    m_tail += header->byteSize;
+
+                else
+                    break;
+            }
+
+            if (m_tail == m_head)
+            {
+                m_head = 0;
+                m_tail = 0;
+            }
+        }
+
+        bool tryMake(uint32_t blockSize, uint32_t& offset)
+        {
+            reclaim();
+
+            if (m_tail <= m_head)
+            {
+                if (m_head + blockSize + s_headerSize <= m_size)
+                {
+                    offset = m_head;
+                    m_head += blockSize;
+                    return true;
+                }
+
+                if (blockSize >= m_tail)
+                    return false;
+
+                reinterpret_cast<BulkDataHeader*>(m_memory + m_head)->byteSize = 0;
+                m_head = 0;
+            }
+
+            if (m_head + blockSize < m_tail)
+            {
+                offset = m_head;
+                m_head += blockSize;
+                return true;
+            }
+
+            return false;
+        }
+
+    public:
+        FifoBulkDataAllocator(uint8_t* memory, uint32_t size) : m_memory(memory), m_size(size)
+        {
+        }
+
+        bool tryAllocate(uint32_t byteSize, uint32_t& offset)
+        {
+            const uint32_t blockSize = BulkDataAllocator::getBlockSize(byteSize);
+            if (!tryMake(blockSize, offset))
+                return false;
+
+            const auto header = reinterpret_cast<BulkDataHeader*>(m_memory + offset);
+            header->byteSize = blockSize;
+            header->released = false;
+
+            offset += s_headerSize;
+            return true;
+        }
+    };
+
+    // x86 sends blocks to a consumer thread that releases them in order. Every so often one block is held
+    // back for 200 microseconds, like a locked buffer whose message isn't sent until the game unlocks it.
+    template<typename TAllocator>
+    void runBulkData(benchmark::State& state)
+    {
+        constexpr uint32_t s_size = 4 * 1024 * 1024;
+        constexpr uint32_t s_count = 20000;
+
+        const uint32_t holdInterval = static_cast<uint32_t>(state.range(0));
+
+        std::vector<uint8_t> memory(s_size);
+        int64_t byteCount = 0;
+        int64_t stallCount = 0;
+
+        for (auto _ : state)
+        {
+            TAllocator allocator(memory.data(), s_size);
+
+            std::mutex mutex;
+            std::vector<uint32_t> queue;
+            std::atomic<bool> done = false;
+
+            std::thread consumer([&]
+            {
+                std::vector<uint32_t> offsets;
+
+                while (true)
+                {
+                    {
+                        std::lock_guard lock(mutex);
+                        offsets.swap(queue);
+                    }
+
+                    if (offsets.empty())
+                    {
+                        if (done)
+                            break;
+
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    for (const uint32_t offset : offsets)
+                        reinterpret_cast<BulkDataHeader*>(memory.data() + offset - s_headerSize)->released = true;
+
+                    offsets.clear();
+                }
+            });
+
+            std::mt19937 random(1);
+            uint32_t heldOffset = 0;
+            auto heldTime = std::chrono::steady_clock::now();
+
+            const auto sendHeld = [&]
+            {
+                if (heldOffset != 0 && std::chrono::steady_clock::now() - heldTime >= std::chrono::microseconds(200))
+                {
+                    std::lock_guard lock(mutex);
+                    queue.push_back(heldOffset);
+                    heldOffset = 0;
+                }
+            };
+
+            for (uint32_t i = 0; i < s_count; i++)
+            {
+                const uint32_t byteSize = 1 + random() % (random() % 16 == 0 ? 256 * 1024 : 4096);
+                uint32_t offset;
+
+                while (!allocator.tryAllocate(byteSize, offset))
+                {
+                    ++stallCount;
+                    sendHeld();
+                    std::this_thread::yield();
+                }
+
+                memset(memory.data() + offset, 0xCD, byteSize);
+                byteCount += byteSize;
+
+                if (holdInterval != 0 && heldOffset == 0 && i % holdInterval == 0)
+                {
+                    heldOffset = offset;
+                    heldTime = std::chrono::steady_clock::now();
+                }
+                else
+                {
+                    std::lock_guard lock(mutex);
+                    queue.push_back(offset);
+                }
+
+                sendHeld();
+            }
+
+            if (heldOffset != 0)
+            {
+                std::lock_guard lock(mutex);
+                queue.push_back(heldOffset);
+            }
+
+            done = true;
+            consumer.join();
+        }
+
+        state.SetBytesProcessed(byteCount);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_count);
+        state.counters["Stalls"] = benchmark::Counter(static_cast<double>(stallCount), benchmark::Counter::kAvgIterations);
+    }
+}
+
+static void BM_BulkDataFifo(benchmark::State& state)
+{
+    runBulkData<FifoBulkDataAllocator>(state);
+}
+
+static void BM_BulkDataAllocator(benchmark::State& state)
+{
+    runBulkData<BulkDataAllocator>(state);
+}
+
+BENCHMARK(BM_BulkDataFifo)->Arg(0)->Arg(1000)->Arg(100)->ArgName("HoldInterval")->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BulkDataAllocator)->Arg(0)->Arg(1000)->Arg(100)->ArgName("HoldInterval")->UseRealTime()->Unit(benchmark::kMillisecond);
\ No newline at end of file
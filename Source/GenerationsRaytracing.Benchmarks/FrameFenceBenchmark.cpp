@@ -0,0 +1,101 @@
+#include "FrameFence.h"
+#include "MemoryMappedFile.h"
+#include "MessageQueue.h"
+
+// Producer/consumer stress harness for the frame fence over the POSIX backend. Both sides simulate 
+// a fixed amount of work per frame, so the frame rate shows how much of it the fence lets overlap.
+// Sleeping work overlaps even on a single core, busy work needs a core for each side.
+namespace
+{
+    constexpr TCHAR s_memoryMappedFileName[] = TEXT("GenerationsRaytracingFrameFenceBenchmark");
+    constexpr TCHAR s_eventName[] = TEXT("GenerationsRaytracingFrameFenceBenchmarkEvent");
+
+    struct SharedState
+    {
+        MessageQueue queue;
+        std::atomic<uint32_t> sentFrame;
+        std::atomic<bool> stop;
+    };
+
+    void simulateWork(int64_t microseconds, bool busy)
+    {
+        if (busy)
+        {
+            const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(microseconds);
+            while (std::chrono::steady_clock::now() < end)
+                ;
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
+        }
+    }
+
+    void consume(int64_t workMicroseconds, bool busy)
+    {
+        MemoryMappedFile memoryMappedFile(s_memoryMappedFileName, sizeof(SharedState));
+        auto state = static_cast<SharedState*>(memoryMappedFile.map());
+
+        Event event(s_eventName);
+        FrameFence frameFence(state->queue.completedFrame, event);
+
+        while (true)
+        {
+            while (state->sentFrame == frameFence.getCompletedFrame() && !state->stop)
+                std::this_thread::yield();
+
+            if (state->sentFrame == frameFence.getCompletedFrame())
+                break;
+
+            simulateWork(workMicroseconds, busy);
+            frameFence.signal();
+        }
+
+        memoryMappedFile.unmap(state);
+    }
+}
+
+// Arguments are max frames ahead, x86 work, x64 work and whether the work is busy.
+static void BM_FrameFence(benchmark::State& benchmarkState)
+{
+    const auto maxFramesAhead = static_cast<uint32_t>(benchmarkState.range(0));
+    const int64_t producerWork = benchmarkState.range(1);
+    const int64_t consumerWork = benchmarkState.range(2);
+    const bool busy = benchmarkState.range(3) != 0;
+
+    MemoryMappedFile memoryMappedFile(s_memoryMappedFileName, sizeof(SharedState));
+    auto state = static_cast<SharedState*>(memoryMappedFile.map());
+    state->queue.completedFrame = 0;
+    state->sentFrame = 0;
+    state->stop = false;
+
+    Event event(s_eventName, FALSE, FALSE);
+    FrameFence frameFence(state->queue.completedFrame, event);
+
+    std::thread consumer(consume, consumerWork, busy);
+
+    const size_t shouldExit = 0;
+    uint32_t frame = 0;
+
+    for (auto _ : benchmarkState)
+    {
+        simulateWork(producerWork, busy);
+
+        ++frame;
+        state->sentFrame = frame;
+        frameFence.wait(frame, maxFramesAhead, &shouldExit);
+    }
+
+    state->stop = true;
+    consumer.join();
+
+    benchmarkState.counters["Frames"] = benchmark::Counter(static_cast<double>(frame), benchmark::Counter::kIsRate);
+
+    memoryMappedFile.unmap(state);
+}
+
+BENCHMARK(BM_FrameFence)
+    ->ArgsProduct({ { 0, 1, 2 }, { 1000 }, { 1000, 2000 }, { 0, 1 } })
+    ->ArgNames({ "MaxFramesAhead", "X86Work", "X64Work", "Busy" })
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "FreeListAllocator.h"
+#include "LegacyFreeListAllocator.h"
+
+namespace
+{
+    // Loads a stage worth of ids, then unloads it in random order, like the resource ids on x86 do.
+    template<typename TAllocator>
+    void runStageReload(benchmark::State& state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0));
+
+        std::vector<uint32_t> indices(count);
+        std::mt19937 random(1);
+
+        for (auto _ : state)
+        {
+            TAllocator allocator;
+
+            for (auto& index : indices)
+                index = allocator.allocate();
+
+            std::shuffle(indices.begin(), indices.end(), random);
+
+            for (const auto index : indices)
+                allocator.free(index);
+
+            for (auto& index : indices)
+                index = allocator.allocate();
+
+            benchmark::DoNotOptimize(indices.data());
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count * 3);
+    }
+}
+
+static void BM_FreeListLegacy(benchmark::State& state)
+{
+    runStageReload<LegacyFreeListAllocator>(state);
+}
+
+static void BM_FreeListAllocator(benchmark::State& state)
+{
+    runStageReload<FreeListAllocator>(state);
+}
+
+BENCHMARK(BM_FreeListLegacy)->Arg(1000)->Arg(10000)->Arg(100000)->ArgName("Count")->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FreeListAllocator)->Arg(1000)->Arg(10000)->Arg(100000)->ArgName("Count")->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "Message.h"
+#include "MessageReservationQueue.h"
+#include "MessageRing.h"
+#include "Mutex.h"
+#include "LockGuard.h"
+
+// Bytes per second of copying a payload into a thread local message that gets copied into the 
+// queue once it's done (makeMessage/endMessage), against writing it in place between reserving 
+// and committing (reserveMessage/commitMessage). Both go through the real ring and reservation 
+// queue like MessageSender, allocating under the lock and committing without it, with a consumer 
+// thread draining the queue.
+namespace
+{
+    constexpr uint32_t s_ringSize = sizeof(MessageQueue) + 32 * 1024 * 1024;
+    constexpr uint32_t s_headerSize = 5; // ID and byte size
+
+    class Sender
+    {
+    protected:
+        std::vector<uint8_t> m_memory;
+        MessageQueue* m_queue;
+        MessageRingWriter m_ring;
+        Mutex m_mutex;
+
+        struct ReservationData
+        {
+        };
+
+        using Reservation = MessageReservationQueue<ReservationData>::Reservation;
+
+        MessageReservationQueue<ReservationData> m_reservations;
+        std::atomic<bool> m_stop{ false };
+        std::thread m_consumer;
+
+        // Returns the reservation index to commit.
+        uint32_t allocate(uint32_t byteSize, uint32_t& offset)
+        {
+            while (true)
+            {
+                while (!m_reservations.canReserve())
+                {
+                    m_mutex.unlock();
+                    std::this_thread::yield();
+                    m_mutex.lock();
+                }
+
+                const uint32_t tail = m_queue->tail;
+                if (m_ring.tryAllocate(byteSize, 4, tail, offset))
+                    break;
+
+                commit(m_reservations.reserve(m_ring.getOffset(), 0, m_ring.getOffset()));
+
+                ++m_queue->tailWaiterCount;
+
+                while (m_queue->tail == tail)
+                {
+                    m_mutex.unlock();
+                    std::this_thread::yield();
+                    m_mutex.lock();
+                }
+
+                --m_queue->tailWaiterCount;
+            }
+
+            m_memory[offset] = MsgCreateSwapChain::s_id;
+            memcpy(&m_memory[offset + 1], &byteSize, sizeof(byteSize));
+
+            return m_reservations.reserve(offset, byteSize, m_ring.getOffset());
+        }
+
+        void commit(uint32_t index)
+        {
+            m_reservations.commit(index, [](Reservation&) {});
+        }
+
+        void consume()
+        {
+            MessageRingReader reader(m_memory.data());
+            uint32_t offset = sizeof(MessageQueue);
+
+            while (true)
+            {
+                if (m_queue->tailWaiterCount > 0)
+                    m_queue->tail = offset;
+
+                if (!reader.hasNext(m_queue->head, offset))
+                {
+                    m_queue->tail = offset;
+
+                    if (m_stop)
+                        break;
+
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                if (m_memory[offset] == MsgPadding::s_id)
+                {
+                    offset += offsetof(MsgPadding, data) + m_memory[offset + 1];
+                }
+                else
+                {
+                    uint32_t byteSize;
+                    memcpy(&byteSize, &m_memory[offset + 1], sizeof(byteSize));
+                    offset += byteSize;
+                }
+            }
+        }
+
+    public:
+        Sender() : m_memory(s_ringSize), m_queue(new (m_memory.data()) MessageQueue()), m_ring(m_memory.data(), s_ringSize),
+            m_reservations(m_queue->head, 1024)
+        {
+            m_queue->head = sizeof(MessageQueue);
+            m_queue->tail = sizeof(MessageQueue);
+            m_consumer = std::thread(&Sender::consume, this);
+        }
+
+        ~Sender()
+        {
+            m_stop = true;
+            m_consumer.join();
+        }
+
+        void sendCopied(const uint8_t* data, uint32_t dataSize)
+        {
+            thread_local std::vector<uint8_t> message;
+            message.resize(s_headerSize + dataSize);
+            memcpy(&message[s_headerSize], data, dataSize);
+
+            uint32_t index;
+            uint32_t offset;
+            {
+                LockGuard lock(m_mutex);
+                index = allocate(static_cast<uint32_t>(message.size()), offset);
+            }
+
+            memcpy(&m_memory[offset + s_headerSize], &message[s_headerSize], dataSize);
+            commit(index);
+        }
+
+        void sendReserved(const uint8_t* data, uint32_t dataSize)
+        {
+            uint32_t index;
+            uint32_t offset;
+            {
+                LockGuard lock(m_mutex);
+                index = allocate(s_headerSize + dataSize, offset);
+            }
+
+            memcpy(&m_memory[offset + s_headerSize], data, dataSize);
+            commit(index);
+        }
+    };
+
+    template<bool Reserved>
+    void BM_SendMessage(benchmark::State& state)
+    {
+        static std::unique_ptr<Sender> s_sender;
+
+        if (state.thread_index() == 0)
+            s_sender = std::make_unique<Sender>();
+
+        const auto dataSize = static_cast<uint32_t>(state.range(0));
+        std::vector<uint8_t> data(dataSize, static_cast<uint8_t>(state.thread_index()));
+
+        for (auto _ : state)
+        {
+            if constexpr (Reserved)
+                s_sender->sendReserved(data.data(), dataSize);
+            else
+                s_sender->sendCopied(data.data(), dataSize);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * dataSize);
+
+        if (state.thread_index() == 0)
+            s_sender.reset();
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_SendMessage, false)
+    ->Name("BM_SendMessage/Copied")
+    ->RangeMultiplier(16)->Range(64, 1024 * 1024)
+    ->Threads(1)->Threads(2)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_SendMessage, true)
+    ->Name("BM_SendMessage/Reserved")
+    ->RangeMultiplier(16)->Range(64, 1024 * 1024)
+    ->Threads(1)->Threads(2)
+    ->UseRealTime();
\ No newline at end of file
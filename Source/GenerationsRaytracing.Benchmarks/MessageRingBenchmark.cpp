@@ -0,0 +1,34 @@
+#include "MessageRingStress.h"
+
+// Producer stall time under synthetic message mixes. Arguments are the 
+// ring size in kilobytes and the percentage of large messages.
+static void BM_MessageRing(benchmark::State& state)
+{
+    const uint32_t ringSize = sizeof(MessageQueue) + static_cast<uint32_t>(state.range(0)) * 1024;
+    const MessageMix mix{ 9, 64, 4 * 1024, 64 * 1024, static_cast<uint32_t>(state.range(1)) };
+
+    MessageRingStressResult total;
+    uint32_t seed = 0;
+
+    for (auto _ : state)
+    {
+        const auto result = MessageRingStress::run(ringSize, mix, 10000, ++seed);
+
+        total.messageCount += result.messageCount;
+        total.byteCount += result.byteCount;
+        total.stallCount += result.stallCount;
+        total.stallTime += result.stallTime;
+        total.totalTime += result.totalTime;
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(total.byteCount));
+    state.SetItemsProcessed(static_cast<int64_t>(total.messageCount));
+    state.counters["Stalls"] = benchmark::Counter(static_cast<double>(total.stallCount), benchmark::Counter::kAvgIterations);
+    state.counters["StallRatio"] = static_cast<double>(total.stallTime.count()) / static_cast<double>(total.totalTime.count());
+}
+
+BENCHMARK(BM_MessageRing)
+    ->ArgsProduct({ { 256, 4096 }, { 0, 1, 10 } })
+    ->ArgNames({ "RingKB", "LargePercentage" })
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
\ No newline at end of file
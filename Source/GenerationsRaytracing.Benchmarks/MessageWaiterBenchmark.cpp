@@ -0,0 +1,110 @@
+#include "MessageWaiter.h"
+
+#include <ctime>
+
+// Latency and CPU usage of the consumer under a bursty producer, comparing the adaptive waiter
+// against busy spinning on head like the old run loop did. Arguments are the amount of messages 
+// per burst and the idle time between bursts in microseconds.
+namespace
+{
+    constexpr TCHAR s_eventName[] = TEXT("GenerationsRaytracingMessageWaiterBenchmarkEvent");
+    constexpr uint32_t s_burstCount = 50;
+
+    int64_t getThreadCpuTime()
+    {
+        timespec time;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+    }
+
+    struct Channel
+    {
+        Event event{ s_eventName, FALSE, FALSE };
+        std::atomic<uint32_t> head{ 0 };
+        std::atomic<bool> sleeping{ false };
+        std::vector<std::chrono::steady_clock::time_point> publishTimes;
+    };
+
+    struct ConsumerResult
+    {
+        std::chrono::nanoseconds latency{};
+        int64_t cpuTime = 0;
+    };
+
+    template<bool Adaptive>
+    void consume(Channel& channel, uint32_t messageCount, ConsumerResult& result)
+    {
+        const int64_t cpuTimeBegin = getThreadCpuTime();
+
+        for (uint32_t offset = 0; offset < messageCount; offset++)
+        {
+            if constexpr (Adaptive)
+                MessageWaiter::wait(channel.sleeping, channel.event, [&] { return offset != channel.head; });
+            else
+                while (offset == channel.head) ;
+
+            result.latency += std::chrono::steady_clock::now() - channel.publishTimes[offset];
+        }
+
+        result.cpuTime = getThreadCpuTime() - cpuTimeBegin;
+    }
+
+    template<bool Adaptive>
+    void BM_MessageWaiter(benchmark::State& state)
+    {
+        const auto burstSize = static_cast<uint32_t>(state.range(0));
+        const auto idleTime = std::chrono::microseconds(state.range(1));
+        const uint32_t messageCount = burstSize * s_burstCount;
+
+        std::chrono::nanoseconds latency{};
+        int64_t cpuTime = 0;
+        std::chrono::nanoseconds wallTime{};
+
+        for (auto _ : state)
+        {
+            Channel channel;
+            channel.publishTimes.resize(messageCount);
+
+            ConsumerResult result;
+            const auto begin = std::chrono::steady_clock::now();
+            std::thread consumer(consume<Adaptive>, std::ref(channel), messageCount, std::ref(result));
+
+            for (uint32_t i = 0; i < messageCount; i++)
+            {
+                if (i != 0 && (i % burstSize) == 0)
+                    std::this_thread::sleep_for(idleTime);
+
+                channel.publishTimes[i] = std::chrono::steady_clock::now();
+                channel.head = i + 1;
+                MessageWaiter::notify(channel.sleeping, channel.event);
+            }
+
+            consumer.join();
+
+            wallTime += std::chrono::steady_clock::now() - begin;
+            latency += result.latency;
+            cpuTime += result.cpuTime;
+        }
+
+        const double totalMessages = static_cast<double>(state.iterations()) * messageCount;
+
+        state.counters["LatencyUs"] = static_cast<double>(latency.count()) / totalMessages / 1000.0;
+        state.counters["ConsumerCpu"] = static_cast<double>(cpuTime) / static_cast<double>(wallTime.count());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_MessageWaiter, false)
+    ->Name("BM_MessageWaiter/BusySpin")
+    ->ArgsProduct({ { 1, 64 }, { 100, 2000 } })
+    ->ArgNames({ "Burst", "IdleUs" })
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_MessageWaiter, true)
+    ->Name("BM_MessageWaiter/Adaptive")
+    ->ArgsProduct({ { 1, 64 }, { 100, 2000 } })
+    ->ArgNames({ "Burst", "IdleUs" })
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "LegacyRangeAllocator.h"
+#include "RangeAllocator.h"
+
+namespace
+{
+    // Keeps the number of live ranges given in the argument around while replacing random ones,
+    // with geometry counts like bottom level acceleration structures have.
+    template<typename TAllocator>
+    void runChurn(benchmark::State& state)
+    {
+        const size_t liveCount = static_cast<size_t>(state.range(0));
+
+        std::mt19937 random(1);
+        const auto getCount = [&]
+        {
+            return 1 + random() % (random() % 16 == 0 ? 256 : 16);
+        };
+
+        TAllocator allocator;
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+
+        for (size_t i = 0; i < liveCount; i++)
+        {
+            const uint32_t count = getCount();
+            ranges.emplace_back(allocator.allocate(count), count);
+        }
+
+        for (auto _ : state)
+        {
+            auto& range = ranges[random() % ranges.size()];
+            allocator.free(range.first, range.second);
+
+            range.second = getCount();
+            range.first = allocator.allocate(range.second);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.counters["Capacity"] = static_cast<double>(allocator.getCapacity());
+    }
+}
+
+static void BM_RangeAllocatorLegacy(benchmark::State& state)
+{
+    runChurn<LegacyRangeAllocator>(state);
+}
+
+static void BM_RangeAllocator(benchmark::State& state)
+{
+    runChurn<RangeAllocator>(state);
+}
+
+BENCHMARK(BM_RangeAllocatorLegacy)->Arg(1000)->Arg(10000)->Arg(100000)->ArgName("Live");
+BENCHMARK(BM_RangeAllocator)->Arg(1000)->Arg(10000)->Arg(100000)->ArgName("Live");
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "ShaderCacheIndex.h"
+
+namespace
+{
+    // Neither side compresses, so both only measure what happens around the decompression.
+    struct ShaderCacheFiles
+    {
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> block;
+        std::vector<uint8_t> file;
+    };
+
+    const ShaderCacheFiles& getFiles(uint32_t shaderCount)
+    {
+        static std::map<uint32_t, ShaderCacheFiles> s_files;
+
+        auto& files = s_files[shaderCount];
+        if (files.hashes.empty())
+        {
+            std::mt19937_64 random(1);
+            std::vector<std::vector<uint8_t>> data(shaderCount);
+            std::vector<CompressedShader> shaders;
+
+            for (uint32_t i = 0; i < shaderCount; i++)
+            {
+                const uint64_t hash = random();
+                data[i].resize(512 + random() % 4096, static_cast<uint8_t>(i));
+
+                const ShaderCacheBlockShader header{ hash, static_cast<uint32_t>(data[i].size()) };
+                const size_t offset = files.block.size();
+                files.block.resize(offset + sizeof(ShaderCacheBlockShader) + data[i].size());
+                memcpy(files.block.data() + offset, &header, sizeof(ShaderCacheBlockShader));
+                memcpy(files.block.data() + offset + sizeof(ShaderCacheBlockShader), data[i].data(), data[i].size());
+
+                files.hashes.push_back(hash);
+                shaders.push_back({ hash, data[i].data(), static_cast<uint32_t>(data[i].size()), static_cast<uint32_t>(data[i].size()) });
+            }
+
+            FILE* file = tmpfile();
+            ShaderCacheIndex::write(file, shaders);
+            files.file.resize(static_cast<size_t>(ftell(file)));
+            fseek(file, 0, SEEK_SET);
+            fread(files.file.data(), 1, files.file.size(), file);
+            fclose(file);
+        }
+
+        return files;
+    }
+
+    // A stage uses a few percent of the cache, and every shader gets requested several times.
+    std::vector<uint64_t> getRequests(const ShaderCacheFiles& files)
+    {
+        std::mt19937 random(2);
+        std::vector<uint64_t> requests;
+
+        for (uint32_t i = 0; i < 500; i++)
+        {
+            const uint64_t hash = files.hashes[random() % files.hashes.size()];
+            for (uint32_t j = 0; j < 4; j++)
+                requests.push_back(hash);
+        }
+
+        std::shuffle(requests.begin(), requests.end(), random);
+        return requests;
+    }
+}
+
+// Every shader inserted into a map at startup, and copied out on every request.
+static void BM_ShaderCacheLegacy(benchmark::State& state)
+{
+    const auto& files = getFiles(static_cast<uint32_t>(state.range(0)));
+    const auto requests = getRequests(files);
+
+    for (auto _ : state)
+    {
+        std::unordered_map<uint64_t, std::vector<uint8_t>> shaders;
+
+        ShaderCacheIndex::forEachBlockShader(files.block.data(), static_cast<uint32_t>(files.block.size()),
+            [&](uint64_t hash, const uint8_t* data, uint32_t dataSize)
+            {
+                shaders.emplace(hash, std::vector<uint8_t>(data, data + dataSize));
+            });
+
+        for (const uint64_t hash : requests)
+        {
+            const auto& shader = shaders.find(hash)->second;
+            auto copy = std::make_unique<uint8_t[]>(shader.size());
+            memcpy(copy.get(), shader.data(), shader.size());
+            benchmark::DoNotOptimize(copy.get());
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * requests.size()));
+}
+
+// Binary search on the index, and each shader copied out of the file once on its first request.
+static void BM_ShaderCacheIndex(benchmark::State& state)
+{
+    const auto& files = getFiles(static_cast<uint32_t>(state.range(0)));
+    const auto requests = getRequests(files);
+
+    for (auto _ : state)
+    {
+        ShaderCacheIndex index;
+        index.open(files.file.data(), files.file.size());
+
+        std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> shaders;
+
+        for (const uint64_t hash : requests)
+        {
+            auto& shader = shaders[hash];
+            if (shader == nullptr)
+            {
+                const ShaderCacheEntry* entry = index.find(hash);
+                shader = std::make_unique<uint8_t[]>(entry->uncompressedSize);
+                memcpy(shader.get(), index.getCompressedData(*entry), entry->uncompressedSize);
+            }
+
+            benchmark::DoNotOptimize(shader.get());
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * requests.size()));
+}
+
+BENCHMARK(BM_ShaderCacheLegacy)->Arg(1000)->Arg(10000)->ArgName("Shaders")->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ShaderCacheIndex)->Arg(1000)->Arg(10000)->ArgName("Shaders")->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "CpuVirtualBlock.h"
+#include "SubAllocatorPolicy.h"
+
+namespace
+{
+    constexpr uint32_t s_blockSize = 8 * 1024 * 1024;
+    constexpr uint32_t s_alignment = 256;
+
+    // The previous policy, which walked every block for every allocation.
+    class LinearSubAllocatorPolicy
+    {
+    protected:
+        std::vector<CpuVirtualBlock> m_blocks;
+
+    public:
+        SubAllocatorPolicy<CpuVirtualBlock>::Allocation allocate(uint32_t byteSize, bool& createdBlock)
+        {
+            SubAllocatorPolicy<CpuVirtualBlock>::Allocation allocation{};
+            allocation.byteSize = byteSize;
+            createdBlock = false;
+
+            for (uint32_t i = 0; i < m_blocks.size(); i++)
+            {
+                if (m_blocks[i].allocate(byteSize, s_alignment, allocation.handle, allocation.byteOffset))
+                {
+                    allocation.blockIndex = i;
+                    return allocation;
+                }
+            }
+
+            allocation.blockIndex = static_cast<uint32_t>(m_blocks.size());
+            auto& block = m_blocks.emplace_back();
+            block.create(s_blockSize);
+            block.allocate(byteSize, s_alignment, allocation.handle, allocation.byteOffset);
+            createdBlock = true;
+
+            return allocation;
+        }
+
+        void free(const SubAllocatorPolicy<CpuVirtualBlock>::Allocation& allocation)
+        {
+            m_blocks[allocation.blockIndex].free(allocation.handle);
+        }
+    };
+
+    // Keeps the number of live allocations given in the argument around while replacing random ones, with the
+    // size mix of acceleration structures, mostly small ones with the occasional few hundred kilobytes.
+    template<typename TPolicy>
+    void runChurn(benchmark::State& state, TPolicy& policy)
+    {
+        const size_t liveCount = static_cast<size_t>(state.range(0));
+
+        std::mt19937 random(1);
+        const auto getByteSize = [&]
+        {
+            return 1024 + random() % (random() % 16 == 0 ? 512 * 1024 : 32 * 1024);
+        };
+
+        std::vector<SubAllocatorPolicy<CpuVirtualBlock>::Allocation> allocations;
+        bool createdBlock;
+        int64_t createdBlockCount = 0;
+
+        for (size_t i = 0; i < liveCount; i++)
+            allocations.push_back(policy.allocate(getByteSize(), createdBlock));
+
+        for (auto _ : state)
+        {
+            auto& allocation = allocations[random() % allocations.size()];
+            policy.free(allocation);
+            allocation = policy.allocate(getByteSize(), createdBlock);
+            createdBlockCount += createdBlock;
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.counters["CreatedBlocks"] = static_cast<double>(createdBlockCount);
+    }
+}
+
+static void BM_SubAllocatorLinear(benchmark::State& state)
+{
+    LinearSubAllocatorPolicy policy;
+    runChurn(state, policy);
+}
+
+static void BM_SubAllocatorPolicy(benchmark::State& state)
+{
+    SubAllocatorPolicy<CpuVirtualBlock> policy(s_blockSize, s_alignment);
+    runChurn(state, policy);
+}
+
+BENCHMARK(BM_SubAllocatorLinear)->Arg(1000)->Arg(10000)->Arg(50000)->ArgName("Live");
+BENCHMARK(BM_SubAllocatorPolicy)->Arg(1000)->Arg(10000)->Arg(50000)->ArgName("Live");
\ No newline at end of file
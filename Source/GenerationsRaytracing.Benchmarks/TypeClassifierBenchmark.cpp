@@ -0,0 +1,109 @@
+#include "TypeClassifier.h"
+
+namespace
+{
+    enum class Kind
+    {
+        Unknown,
+        SingleElement,
+        Bundle,
+        OptimalBundle,
+        ReelRenderer,
+        RopeRenderable,
+        InstanceRenderObj,
+        WallJumpBlockRender
+    };
+
+    // A few levels deep like the game classes, so a failed dynamic_cast has a hierarchy to walk.
+    struct Renderable { virtual ~Renderable() = default; };
+    struct Object : Renderable {};
+    struct RenderObject : Object {};
+
+    struct SingleElement : RenderObject {};
+    struct Bundle : RenderObject {};
+    struct OptimalBundle : RenderObject {};
+    struct ReelRenderer : RenderObject {};
+    struct RopeRenderable : RenderObject {};
+    struct InstanceRenderObj : RenderObject {};
+    struct WallJumpBlockRender : RenderObject {};
+    struct Particle : RenderObject {};
+
+    // The chain the traversal used before.
+    Kind classifyWithDynamicCast(Renderable* renderable)
+    {
+        if (dynamic_cast<SingleElement*>(renderable) != nullptr) return Kind::SingleElement;
+        if (dynamic_cast<Bundle*>(renderable) != nullptr) return Kind::Bundle;
+        if (dynamic_cast<OptimalBundle*>(renderable) != nullptr) return Kind::OptimalBundle;
+        if (dynamic_cast<ReelRenderer*>(renderable) != nullptr) return Kind::ReelRenderer;
+        if (dynamic_cast<RopeRenderable*>(renderable) != nullptr) return Kind::RopeRenderable;
+        if (dynamic_cast<InstanceRenderObj*>(renderable) != nullptr) return Kind::InstanceRenderObj;
+        if (dynamic_cast<WallJumpBlockRender*>(renderable) != nullptr) return Kind::WallJumpBlockRender;
+        return Kind::Unknown;
+    }
+
+    // Mostly single elements and bundles, with the rarer types and unknown ones mixed in.
+    const std::vector<std::unique_ptr<Renderable>>& getRenderables()
+    {
+        static std::vector<std::unique_ptr<Renderable>> s_renderables;
+
+        if (s_renderables.empty())
+        {
+            std::mt19937 random(1);
+
+            for (uint32_t i = 0; i < 4096; i++)
+            {
+                const uint32_t value = random() % 100;
+
+                if (value < 60) s_renderables.push_back(std::make_unique<SingleElement>());
+                else if (value < 75) s_renderables.push_back(std::make_unique<Bundle>());
+                else if (value < 85) s_renderables.push_back(std::make_unique<OptimalBundle>());
+                else if (value < 88) s_renderables.push_back(std::make_unique<ReelRenderer>());
+                else if (value < 91) s_renderables.push_back(std::make_unique<RopeRenderable>());
+                else if (value < 94) s_renderables.push_back(std::make_unique<InstanceRenderObj>());
+                else if (value < 97) s_renderables.push_back(std::make_unique<WallJumpBlockRender>());
+                else s_renderables.push_back(std::make_unique<Particle>());
+            }
+        }
+
+        return s_renderables;
+    }
+
+    template<typename TFunction>
+    void runClassify(benchmark::State& state, TFunction&& function)
+    {
+        const auto& renderables = getRenderables();
+        uint32_t checksum = 0;
+
+        for (auto _ : state)
+        {
+            for (const auto& renderable : renderables)
+                checksum += static_cast<uint32_t>(function(renderable.get()));
+
+            benchmark::DoNotOptimize(checksum);
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * renderables.size());
+    }
+}
+
+static void BM_ClassifyDynamicCast(benchmark::State& state)
+{
+    runClassify(state, classifyWithDynamicCast);
+}
+
+static void BM_ClassifyTypeClassifier(benchmark::State& state)
+{
+    auto classifier = TypeClassifier<Renderable, Kind>(Kind::Unknown)
+        .add<SingleElement>(Kind::SingleElement)
+        .add<Bundle>(Kind::Bundle)
+        .add<OptimalBundle>(Kind::OptimalBundle)
+        .add<ReelRenderer>(Kind::ReelRenderer)
+        .add<RopeRenderable>(Kind::RopeRenderable)
+        .add<InstanceRenderObj>(Kind::InstanceRenderObj)
+        .add<WallJumpBlockRender>(Kind::WallJumpBlockRender);
+
+    runClassify(state, [&](Renderable* renderable) { return classifier.classify(renderable); });
+}
+
+BENCHMARK(BM_ClassifyDynamicCast);
+BENCHMARK(BM_ClassifyTypeClassifier);
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include <cstdio>
+
+#include "HeadlessReplayBackend.h"
+#include "MessageReplayer.h"
+
+// Replays a capture made through MessageCaptureFilePath without a GPU. The x64 executable
+// replays through D3D12 instead when run with "--replay <file>".
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <capture file>\n", argv[0]);
+        return -1;
+    }
+
+    const auto capture = MessageCaptureReader::readFile(argv[1]);
+
+    HeadlessReplayBackend backend;
+    MessageReplayer replayer(capture.data(), capture.size(), backend);
+
+    if (!replayer.isValid())
+    {
+        printf("Unable to replay %s, it is missing or was captured with a different version\n", argv[1]);
+        return -1;
+    }
+
+    replayer.replay();
+    replayer.printStatistics(stdout);
+
+    printf("Hash: %016llx\n", static_cast<unsigned long long>(backend.getHash()));
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Same layout as D3D12_RAYTRACING_INSTANCE_DESC, so the policies can be driven without D3D12.
+struct AccelStructInstance
+{
+    float transform[3][4];
+    uint32_t instanceIdAndMask;
+    uint32_t hitGroupIndexAndFlags;
+    uint64_t accelStruct;
+};
+
+static_assert(sizeof(AccelStructInstance) == 64);
+
+enum class AccelStructBuildType
+{
+    Build,
+    Update
+};
+
+// Decides whether a top level acceleration structure can be refit from the instances of its previous build.
+class AccelStructBuildPolicy
+{
+public:
+    virtual ~AccelStructBuildPolicy() = default;
+
+    // Called once for every build with the instances about to be built.
+    virtual AccelStructBuildType getBuildType(const AccelStructInstance* instances, size_t instanceCount) = 0;
+
+    // Forgets the previous build, for when its memory is gone.
+    virtual void reset() = 0;
+};
+
+// Always builds from scratch.
+class RebuildAccelStructPolicy final : public AccelStructBuildPolicy
+{
+public:
+    AccelStructBuildType getBuildType(const AccelStructInstance* instances, size_t instanceCount) override;
+    void reset() override;
+};
+
+// Refits as long as the instance set is the same as the last full build and the hierarchy hasn't degraded too much.
+// Refitting keeps the tree of the last full build and only grows its boxes, so every instance that drifts away from
+// where it was built makes the boxes above it bigger. The drift is measured as the distance every instance moved
+// since the full build, summed up and relative to the extent of the scene at that build.
+class RefitAccelStructPolicy final : public AccelStructBuildPolicy
+{
+protected:
+    uint32_t m_maxRefitCount;
+    float m_maxBoundsGrowth;
+
+    // Instances of the last full build.
+    std::vector<AccelStructInstance> m_builtInstances;
+    float m_builtExtent = 0.0f;
+
+    uint32_t m_refitCount = 0;
+    float m_boundsGrowth = 0.0f;
+
+    void build(const AccelStructInstance* instances, size_t instanceCount);
+
+public:
+    static constexpr uint32_t s_defaultMaxRefitCount = 600;
+    static constexpr float s_defaultMaxBoundsGrowth = 0.5f;
+
+    explicit RefitAccelStructPolicy(uint32_t maxRefitCount = s_defaultMaxRefitCount, float maxBoundsGrowth = s_defaultMaxBoundsGrowth);
+
+    AccelStructBuildType getBuildType(const AccelStructInstance* instances, size_t instanceCount) override;
+    void reset() override;
+
+    uint32_t getRefitCount() const;
+    float getBoundsGrowth() const;
+};
+
+#include "AccelStructBuildPolicy.inl"
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+inline AccelStructBuildType RebuildAccelStructPolicy::getBuildType(const AccelStructInstance*, size_t)
+{
+    return AccelStructBuildType::Build;
+}
+
+inline void RebuildAccelStructPolicy::reset()
+{
+}
+
+inline RefitAccelStructPolicy::RefitAccelStructPolicy(uint32_t maxRefitCount, float maxBoundsGrowth)
+    : m_maxRefitCount(maxRefitCount), m_maxBoundsGrowth(maxBoundsGrowth)
+{
+}
+
+inline void RefitAccelStructPolicy::build(const AccelStructInstance* instances, size_t instanceCount)
+{
+    m_builtInstances.assign(instances, instances + instanceCount);
+    m_refitCount = 0;
+    m_boundsGrowth = 0.0f;
+
+    float min[3]{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float max[3]{ std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+    for (size_t i = 0; i < instanceCount; i++)
+    {
+        for (size_t j = 0; j < 3; j++)
+        {
+            min[j] = std::fmin(min[j], instances[i].transform[j][3]);
+            max[j] = std::fmax(max[j], instances[i].transform[j][3]);
+        }
+    }
+
+    // Keeps a scene with a single instance, or every instance in the same spot, from dividing by zero.
+    m_builtExtent = 1.0f;
+    if (instanceCount > 0)
+        m_builtExtent = std::fmax(m_builtExtent, std::sqrt((max[0] - min[0]) * (max[0] - min[0]) + (max[1] - min[1]) * (max[1] - min[1]) + (max[2] - min[2]) * (max[2] - min[2])));
+}
+
+inline AccelStructBuildType RefitAccelStructPolicy::getBuildType(const AccelStructInstance* instances, size_t instanceCount)
+{
+    if (m_builtInstances.empty() || instanceCount != m_builtInstances.size() || m_refitCount >= m_maxRefitCount)
+    {
+        build(instances, instanceCount);
+        return AccelStructBuildType::Build;
+    }
+
+    float distance = 0.0f;
+
+    for (size_t i = 0; i < instanceCount; i++)
+    {
+        const auto& instance = instances[i];
+        const auto& builtInstance = m_builtInstances[i];
+
+        // Anything but the transform changing makes it a different set of instances.
+        if (memcmp(&instance.instanceIdAndMask, &builtInstance.instanceIdAndMask, 
+            sizeof(AccelStructInstance) - offsetof(AccelStructInstance, instanceIdAndMask)) != 0)
+        {
+            build(instances, instanceCount);
+            return AccelStructBuildType::Build;
+        }
+
+        const float x = instance.transform[0][3] - builtInstance.transform[0][3];
+        const float y = instance.transform[1][3] - builtInstance.transform[1][3];
+        const float z = instance.transform[2][3] - builtInstance.transform[2][3];
+        distance += std::sqrt(x * x + y * y + z * z);
+    }
+
+    // Compared against the full build, so instances moving back and forth don't add up.
+    const float boundsGrowth = distance / m_builtExtent;
+
+    if (!(boundsGrowth <= m_maxBoundsGrowth))
+    {
+        build(instances, instanceCount);
+        return AccelStructBuildType::Build;
+    }
+
+    ++m_refitCount;
+    m_boundsGrowth = boundsGrowth;
+
+    return AccelStructBuildType::Update;
+}
+
+inline void RefitAccelStructPolicy::reset()
+{
+    m_builtInstances.clear();
+    m_refitCount = 0;
+    m_boundsGrowth = 0.0f;
+}
+
+inline uint32_t RefitAccelStructPolicy::getRefitCount() const
+{
+    return m_refitCount;
+}
+
+inline float RefitAccelStructPolicy::getBoundsGrowth() const
+{
+    return m_boundsGrowth;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The part of the device the compactor talks to. x64 implements it with D3D12, the tests with a fake device.
+class AccelStructCompactionDevice
+{
+public:
+    virtual ~AccelStructCompactionDevice() = default;
+
+    // Reads back the compacted sizes the builds of the frame wrote, in request order.
+    virtual void readCompactedSizes(uint32_t frame, uint32_t* compactedSizes, uint32_t count) = 0;
+
+    // Returns the current byte size of the acceleration structure, 
+    // or 0 if it got released or rebuilt since the build index.
+    virtual uint32_t getByteSize(uint32_t id, uint64_t buildIndex) = 0;
+
+    // Records a compacting copy into a new allocation. The original needs to stay alive until releaseOriginals.
+    virtual void copyCompacted(uint32_t frame, uint32_t id, uint32_t compactedSize) = 0;
+
+    // Frees the originals copied during the frame, which the GPU is done with by then.
+    virtual void releaseOriginals(uint32_t frame) = 0;
+};
+
+// Moves static acceleration structures through pending, size ready, copied and original freed states.
+// Builds write their compacted size into a slot of the frame. Once the frame completes, the sizes get read back
+// and the next compaction pass copies each structure into a right-sized allocation. The original is freed
+// once the frame of the copy completes, since instances recorded before the copy still point to it.
+template<uint32_t FrameNum>
+class AccelStructCompactor
+{
+public:
+    struct Request
+    {
+        uint32_t id;
+        uint64_t buildIndex;
+        uint32_t compactedSize;
+    };
+
+protected:
+    AccelStructCompactionDevice& m_device;
+    uint32_t m_maxRequestCount;
+    uint32_t m_frame = 0;
+
+    std::vector<Request> m_pendingRequests[FrameNum];
+    std::vector<Request> m_sizeReadyRequests;
+    uint32_t m_copiedCounts[FrameNum]{};
+    std::vector<uint32_t> m_compactedSizes;
+
+    uint64_t m_savedByteSize = 0;
+
+public:
+    AccelStructCompactor(AccelStructCompactionDevice& device, uint32_t maxRequestCount);
+
+    // Needs to be called once the GPU is done with the frame.
+    void beginFrame(uint32_t frame);
+
+    // Returns the slot the build needs to write its compacted size to, or ~0 if the frame ran out of them.
+    uint32_t request(uint32_t id, uint64_t buildIndex);
+
+    // Copies the structures whose sizes are ready, skipping the ones that changed meanwhile.
+    void compact();
+
+    uint32_t getMaxRequestCount() const;
+    // Requests of the current frame so far, which is also the next free slot.
+    uint32_t getRequestCount() const;
+
+    size_t getPendingCount() const;
+    size_t getSizeReadyCount() const;
+    // Copies whose originals are not freed yet.
+    size_t getCopiedCount() const;
+    uint64_t getSavedByteSize() const;
+};
+
+#include "AccelStructCompactor.inl"
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <cassert>
+
+template<uint32_t FrameNum>
+AccelStructCompactor<FrameNum>::AccelStructCompactor(AccelStructCompactionDevice& device, uint32_t maxRequestCount)
+    : m_device(device), m_maxRequestCount(maxRequestCount)
+{
+}
+
+template<uint32_t FrameNum>
+void AccelStructCompactor<FrameNum>::beginFrame(uint32_t frame)
+{
+    assert(frame < FrameNum);
+    m_frame = frame;
+
+    if (m_copiedCounts[frame] != 0)
+    {
+        m_device.releaseOriginals(frame);
+        m_copiedCounts[frame] = 0;
+    }
+
+    auto& pendingRequests = m_pendingRequests[frame];
+
+    if (!pendingRequests.empty())
+    {
+        m_compactedSizes.resize(pendingRequests.size());
+        m_device.readCompactedSizes(frame, m_compactedSizes.data(), static_cast<uint32_t>(pendingRequests.size()));
+
+        for (size_t i = 0; i < pendingRequests.size(); i++)
+        {
+            auto& request = m_sizeReadyRequests.emplace_back(pendingRequests[i]);
+            request.compactedSize = m_compactedSizes[i];
+        }
+
+        pendingRequests.clear();
+    }
+}
+
+template<uint32_t FrameNum>
+uint32_t AccelStructCompactor<FrameNum>::request(uint32_t id, uint64_t buildIndex)
+{
+    auto& pendingRequests = m_pendingRequests[m_frame];
+
+    if (pendingRequests.size() >= m_maxRequestCount)
+        return ~0u;
+
+    pendingRequests.push_back({ id, buildIndex, 0 });
+    return static_cast<uint32_t>(pendingRequests.size() - 1);
+}
+
+template<uint32_t FrameNum>
+void AccelStructCompactor<FrameNum>::compact()
+{
+    for (const auto& request : m_sizeReadyRequests)
+    {
+        const uint32_t byteSize = m_device.getByteSize(request.id, request.buildIndex);
+
+        // Skip if it got released or rebuilt since the request, or would not get any smaller.
+        if (byteSize == 0 || request.compactedSize == 0 || request.compactedSize >= byteSize)
+            continue;
+
+        m_device.copyCompacted(m_frame, request.id, request.compactedSize);
+        ++m_copiedCounts[m_frame];
+        m_savedByteSize += byteSize - request.compactedSize;
+    }
+
+    m_sizeReadyRequests.clear();
+}
+
+template<uint32_t FrameNum>
+uint32_t AccelStructCompactor<FrameNum>::getMaxRequestCount() const
+{
+    return m_maxRequestCount;
+}
+
+template<uint32_t FrameNum>
+uint32_t AccelStructCompactor<FrameNum>::getRequestCount() const
+{
+    return static_cast<uint32_t>(m_pendingRequests[m_frame].size());
+}
+
+template<uint32_t FrameNum>
+size_t AccelStructCompactor<FrameNum>::getPendingCount() const
+{
+    size_t count = 0;
+    for (const auto& pendingRequests : m_pendingRequests)
+        count += pendingRequests.size();
+
+    return count;
+}
+
+template<uint32_t FrameNum>
+size_t AccelStructCompactor<FrameNum>::getSizeReadyCount() const
+{
+    return m_sizeReadyRequests.size();
+}
+
+template<uint32_t FrameNum>
+size_t AccelStructCompactor<FrameNum>::getCopiedCount() const
+{
+    size_t count = 0;
+    for (const auto copiedCount : m_copiedCounts)
+        count += copiedCount;
+
+    return count;
+}
+
+template<uint32_t FrameNum>
+uint64_t AccelStructCompactor<FrameNum>::getSavedByteSize() const
+{
+    return m_savedByteSize;
+}
\ No newline at end of file
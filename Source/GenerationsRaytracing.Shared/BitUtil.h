@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit, the value must not be zero.
+inline uint32_t findFirstSetBit(uint32_t value)
+{
+    assert(value != 0);
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward(&bit, value);
+    return bit;
+#else
+    return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+// Index of the highest set bit, the value must not be zero.
+inline uint32_t findLastSetBit(uint32_t value)
+{
+    assert(value != 0);
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanReverse(&bit, value);
+    return bit;
+#else
+    return 31 - static_cast<uint32_t>(__builtin_clz(value));
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "MessageQueue.h"
+
+// Sub-allocates the bulk data memory. Every block begins with a BulkDataHeader that x64 flags once it
+// processed the message referring to the block. Released blocks are reclaimed in any order, so a block
+// that was allocated but not sent yet doesn't hold up the ones allocated after it.
+class BulkDataAllocator
+{
+protected:
+    uint8_t* m_memory;
+    uint32_t m_size;
+
+    // Free blocks by offset. Allocations continue after the previous one like a ring
+    // does, which keeps the search short since blocks tend to be released in order too.
+    std::map<uint32_t, uint32_t> m_freeBlocks;
+    uint32_t m_nextOffset = 0;
+
+    // Offsets of blocks that haven't been reclaimed yet.
+    std::vector<uint32_t> m_usedBlocks;
+
+    void freeBlock(uint32_t offset, uint32_t byteSize);
+    std::map<uint32_t, uint32_t>::iterator findFreeBlock(uint32_t blockSize);
+
+public:
+    BulkDataAllocator(uint8_t* memory, uint32_t size);
+
+    // Size of the block including the header.
+    static uint32_t getBlockSize(uint32_t byteSize);
+
+    // Payloads failing this can never be allocated, no matter how long the caller waits.
+    static bool canAllocate(uint32_t size, uint32_t byteSize);
+
+    // Returns the offset of the data right after the header, or false when x64 needs to release blocks first.
+    bool tryAllocate(uint32_t byteSize, uint32_t& offset);
+
+    // Frees every block flagged by x64, returns whether there were any.
+    bool reclaim();
+
+    uint32_t getUsedBlockCount() const;
+    uint32_t getFreeBlockCount() const;
+};
+
+#include "BulkDataAllocator.inl"
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include <cassert>
+
+#include "AlignmentUtil.h"
+
+inline BulkDataAllocator::BulkDataAllocator(uint8_t* memory, uint32_t size)
+    : m_memory(memory), m_size(alignDown<uint32_t>(size, alignof(BulkDataHeader)))
+{
+    m_freeBlocks.emplace(0, m_size);
+}
+
+inline void BulkDataAllocator::freeBlock(uint32_t offset, uint32_t byteSize)
+{
+    auto next = m_freeBlocks.lower_bound(offset);
+
+    if (next != m_freeBlocks.end() && offset + byteSize == next->first)
+    {
+        byteSize += next->second;
+        next = m_freeBlocks.erase(next);
+    }
+
+    if (next != m_freeBlocks.begin())
+    {
+        const auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += byteSize;
+            return;
+        }
+    }
+
+    m_freeBlocks.emplace_hint(next, offset, byteSize);
+}
+
+inline std::map<uint32_t, uint32_t>::iterator BulkDataAllocator::findFreeBlock(uint32_t blockSize)
+{
+    // The block containing the next offset is the first candidate.
+    auto start = m_freeBlocks.upper_bound(m_nextOffset);
+    if (start != m_freeBlocks.begin())
+    {
+        const auto prev = std::prev(start);
+        if (prev->first + prev->second > m_nextOffset)
+            start = prev;
+    }
+
+    for (auto it = start; it != m_freeBlocks.end(); ++it)
+    {
+        if (it->second >= blockSize)
+            return it;
+    }
+
+    for (auto it = m_freeBlocks.begin(); it != start; ++it)
+    {
+        if (it->second >= blockSize)
+            return it;
+    }
+
+    return m_freeBlocks.end();
+}
+
+inline uint32_t BulkDataAllocator::getBlockSize(uint32_t byteSize)
+{
+    return alignUp<uint32_t>(byteSize, alignof(BulkDataHeader)) + sizeof(BulkDataHeader);
+}
+
+inline bool BulkDataAllocator::canAllocate(uint32_t size, uint32_t byteSize)
+{
+    return byteSize <= alignDown<uint32_t>(size, alignof(BulkDataHeader)) - sizeof(BulkDataHeader);
+}
+
+inline bool BulkDataAllocator::tryAllocate(uint32_t byteSize, uint32_t& offset)
+{
+    assert(canAllocate(m_size, byteSize));
+
+    const uint32_t blockSize = getBlockSize(byteSize);
+
+    auto it = findFreeBlock(blockSize);
+    if (it == m_freeBlocks.end())
+    {
+        if (!reclaim())
+            return false;
+
+        it = findFreeBlock(blockSize);
+        if (it == m_freeBlocks.end())
+            return false;
+    }
+
+    const auto [freeOffset, freeSize] = *it;
+    it = m_freeBlocks.erase(it);
+
+    if (freeSize > blockSize)
+        m_freeBlocks.emplace_hint(it, freeOffset + blockSize, freeSize - blockSize);
+
+    m_nextOffset = freeOffset + blockSize;
+
+    const auto header = reinterpret_cast<BulkDataHeader*>(m_memory + freeOffset);
+    header->byteSize = blockSize;
+    header->released = false;
+
+    m_usedBlocks.push_back(freeOffset);
+
+    offset = freeOffset + sizeof(BulkDataHeader);
+    return true;
+}
+
+inline bool BulkDataAllocator::reclaim()
+{
+    bool reclaimed = false;
+
+    for (size_t i = 0; i < m_usedBlocks.size();)
+    {
+        const uint32_t offset = m_usedBlocks[i];
+        const auto header = reinterpret_cast<BulkDataHeader*>(m_memory + offset);
+
+        if (header->released)
+        {
+            freeBlock(offset, header->byteSize);
+
+            m_usedBlocks[i] = m_usedBlocks.back();
+            m_usedBlocks.pop_back();
+
+            reclaimed = true;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    return reclaimed;
+}
+
+inline uint32_t BulkDataAllocator::getUsedBlockCount() const
+{
+    return static_cast<uint32_t>(m_usedBlocks.size());
+}
+
+inline uint32_t BulkDataAllocator::getFreeBlockCount() const
+{
+    return static_cast<uint32_t>(m_freeBlocks.size());
+}
\ No newline at end of file
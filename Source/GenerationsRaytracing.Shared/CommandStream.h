@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Commands recorded on one thread and played back on another. A command is a trivially copyable struct
+// with an s_id, optionally followed by a variable amount of data, for arrays the command only points to
+// otherwise. Records are played back in the order they were appended. The buffer keeps its memory across clears.
+class CommandStream
+{
+public:
+    struct Record
+    {
+        uint32_t id;
+        const void* command;
+        const void* data;
+        uint32_t dataSize;
+    };
+
+protected:
+    static constexpr size_t s_recordAlignment = 8;
+
+    struct alignas(s_recordAlignment) RecordHeader
+    {
+        uint32_t id;
+        uint32_t commandSize;
+        uint32_t dataSize;
+    };
+
+    std::vector<uint8_t> m_data;
+
+    static size_t alignSize(size_t size);
+
+public:
+    // The memory stays valid until the next append.
+    void* append(uint32_t id, uint32_t commandSize, const void* data, uint32_t dataSize);
+
+    template<typename T>
+    T& append();
+
+    template<typename T>
+    T& append(const void* data, uint32_t dataSize);
+
+    // Calls the function with every record.
+    template<typename T>
+    void play(const T& function) const;
+
+    bool isEmpty() const;
+    void clear();
+};
+
+#include "CommandStream.inl"
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+inline size_t CommandStream::alignSize(size_t size)
+{
+    return (size + s_recordAlignment - 1) / s_recordAlignment * s_recordAlignment;
+}
+
+inline void* CommandStream::append(uint32_t id, uint32_t commandSize, const void* data, uint32_t dataSize)
+{
+    const size_t offset = m_data.size();
+    m_data.resize(offset + sizeof(RecordHeader) + alignSize(commandSize) + alignSize(dataSize));
+
+    const auto header = reinterpret_cast<RecordHeader*>(m_data.data() + offset);
+    header->id = id;
+    header->commandSize = commandSize;
+    header->dataSize = dataSize;
+
+    uint8_t* command = m_data.data() + offset + sizeof(RecordHeader);
+
+    if (dataSize != 0)
+        memcpy(command + alignSize(commandSize), data, dataSize);
+
+    return command;
+}
+
+template<typename T>
+T& CommandStream::append()
+{
+    return append<T>(nullptr, 0);
+}
+
+template<typename T>
+T& CommandStream::append(const void* data, uint32_t dataSize)
+{
+    static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= s_recordAlignment);
+    return *new (append(T::s_id, sizeof(T), data, dataSize)) T();
+}
+
+template<typename T>
+void CommandStream::play(const T& function) const
+{
+    size_t offset = 0;
+
+    while (offset < m_data.size())
+    {
+        const auto header = reinterpret_cast<const RecordHeader*>(m_data.data() + offset);
+        const uint8_t* command = m_data.data() + offset + sizeof(RecordHeader);
+
+        Record record;
+        record.id = header->id;
+        record.command = command;
+        record.data = command + alignSize(header->commandSize);
+        record.dataSize = header->dataSize;
+
+        function(record);
+
+        offset += sizeof(RecordHeader) + alignSize(header->commandSize) + alignSize(header->dataSize);
+    }
+}
+
+inline bool CommandStream::isEmpty() const
+{
+    return m_data.empty();
+}
+
+inline void CommandStream::clear()
+{
+    m_data.clear();
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// The part of the GPU the copy scheduler talks to. x64 implements it with D3D12 queues, the tests with a mock.
+class CopyQueueBackend
+{
+public:
+    virtual ~CopyQueueBackend() = default;
+
+    virtual void openCopyCommandList() = 0;
+
+    // Closes the copy command list, executes it and signals the fence value on the copy queue.
+    virtual void submitCopyCommandList(uint64_t fenceValue) = 0;
+
+    // Makes the graphics queue wait for the copy queue to reach the fence value, without blocking the CPU.
+    virtual void waitForCopies(uint64_t fenceValue) = 0;
+
+    virtual uint64_t getCompletedCopyFenceValue() const = 0;
+};
+
+// Batches copies into a single submission, which the graphics queue waits on before running anything
+// recorded after it. Staging memory the copies read from is kept alive until the copy queue is done with it.
+template<typename T>
+class CopyScheduler
+{
+protected:
+    CopyQueueBackend& m_backend;
+    bool m_isRecording = false;
+    std::vector<T> m_recordingStaging;
+    // In submission order, so retiring can stop at the first one that is still in flight.
+    std::deque<std::pair<uint64_t, T>> m_submittedStaging;
+
+public:
+    explicit CopyScheduler(CopyQueueBackend& backend);
+
+    // Opens the copy command list on the first copy since the last submission.
+    void record();
+
+    // Needs to be called after recording the copy that reads from it.
+    void addStaging(T&& staging);
+
+    bool isRecording() const;
+
+    // Does nothing if no copies were recorded since the last submission.
+    void submit(uint64_t fenceValue);
+
+    // Releases the staging memory of submissions the copy queue has finished.
+    void retire();
+
+    size_t getStagingCount() const;
+};
+
+#include "CopyScheduler.inl"
\ No newline at end of file
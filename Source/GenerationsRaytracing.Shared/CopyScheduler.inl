@@ -0,0 +1,63 @@
+#include <cassert>
+
+template<typename T>
+CopyScheduler<T>::CopyScheduler(CopyQueueBackend& backend) : m_backend(backend)
+{
+}
+
+template<typename T>
+void CopyScheduler<T>::record()
+{
+    if (!m_isRecording)
+    {
+        m_backend.openCopyCommandList();
+        m_isRecording = true;
+    }
+}
+
+template<typename T>
+void CopyScheduler<T>::addStaging(T&& staging)
+{
+    assert(m_isRecording);
+    m_recordingStaging.push_back(std::move(staging));
+}
+
+template<typename T>
+bool CopyScheduler<T>::isRecording() const
+{
+    return m_isRecording;
+}
+
+template<typename T>
+void CopyScheduler<T>::submit(uint64_t fenceValue)
+{
+    if (!m_isRecording)
+        return;
+
+    m_backend.submitCopyCommandList(fenceValue);
+    m_backend.waitForCopies(fenceValue);
+
+    for (auto& staging : m_recordingStaging)
+        m_submittedStaging.emplace_back(fenceValue, std::move(staging));
+
+    m_recordingStaging.clear();
+    m_isRecording = false;
+}
+
+template<typename T>
+void CopyScheduler<T>::retire()
+{
+    if (m_submittedStaging.empty())
+        return;
+
+    const uint64_t completedFenceValue = m_backend.getCompletedCopyFenceValue();
+
+    while (!m_submittedStaging.empty() && m_submittedStaging.front().first <= completedFenceValue)
+        m_submittedStaging.pop_front();
+}
+
+template<typename T>
+size_t CopyScheduler<T>::getStagingCount() const
+{
+    return m_recordingStaging.size() + m_submittedStaging.size();
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+// First fit replacement for D3D12MA virtual blocks, so SubAllocatorPolicy can be tested and benchmarked without a GPU.
+// Handles are the allocation offsets plus one, leaving zero for no allocation.
+class CpuVirtualBlock
+{
+protected:
+    // Offset to byte size.
+    std::map<uint32_t, uint32_t> m_freeRanges;
+    std::map<uint32_t, uint32_t> m_allocations;
+
+public:
+    void create(uint32_t byteSize);
+
+    bool allocate(uint32_t byteSize, uint32_t alignment, uint64_t& handle, uint32_t& byteOffset);
+    void free(uint64_t handle);
+
+    bool isEmpty() const;
+    size_t getAllocationCount() const;
+};
+
+#include "CpuVirtualBlock.inl"
\ No newline at end of file
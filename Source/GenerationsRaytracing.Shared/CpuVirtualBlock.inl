@@ -0,0 +1,78 @@
+#include <cassert>
+
+inline void CpuVirtualBlock::create(uint32_t byteSize)
+{
+    m_freeRanges.clear();
+    m_allocations.clear();
+    m_freeRanges.emplace(0, byteSize);
+}
+
+inline bool CpuVirtualBlock::allocate(uint32_t byteSize, uint32_t alignment, uint64_t& handle, uint32_t& byteOffset)
+{
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+    {
+        const uint32_t rangeOffset = it->first;
+        const uint32_t rangeEnd = it->first + it->second;
+        const uint32_t offset = (rangeOffset + alignment - 1) / alignment * alignment;
+
+        if (offset > rangeEnd || rangeEnd - offset < byteSize)
+            continue;
+
+        m_freeRanges.erase(it);
+
+        // The padding stays free, it merges back once its neighbors get freed.
+        if (offset != rangeOffset)
+            m_freeRanges.emplace(rangeOffset, offset - rangeOffset);
+
+        if (offset + byteSize != rangeEnd)
+            m_freeRanges.emplace(offset + byteSize, rangeEnd - (offset + byteSize));
+
+        m_allocations.emplace(offset, byteSize);
+
+        handle = static_cast<uint64_t>(offset) + 1;
+        byteOffset = offset;
+        return true;
+    }
+
+    return false;
+}
+
+inline void CpuVirtualBlock::free(uint64_t handle)
+{
+    const auto allocation = m_allocations.find(static_cast<uint32_t>(handle - 1));
+    assert(allocation != m_allocations.end());
+
+    uint32_t offset = allocation->first;
+    uint32_t byteSize = allocation->second;
+    m_allocations.erase(allocation);
+
+    auto next = m_freeRanges.lower_bound(offset);
+    if (next != m_freeRanges.begin())
+    {
+        const auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            byteSize += prev->second;
+            m_freeRanges.erase(prev);
+        }
+    }
+
+    if (next != m_freeRanges.end() && offset + byteSize == next->first)
+    {
+        byteSize += next->second;
+        m_freeRanges.erase(next);
+    }
+
+    m_freeRanges.emplace(offset, byteSize);
+}
+
+inline bool CpuVirtualBlock::isEmpty() const
+{
+    return m_allocations.empty();
+}
+
+inline size_t CpuVirtualBlock::getAllocationCount() const
+{
+    return m_allocations.size();
+}
\ No newline at end of file
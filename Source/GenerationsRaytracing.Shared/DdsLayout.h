@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Byte range of a mip level of an array slice or cube face inside the DDS data.
+struct DdsSubresource
+{
+    uint32_t offset;
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowPitch;
+    uint32_t rowCount; // Block rows for compressed formats
+};
+
+// Whole rows of a single subresource.
+struct DdsChunk
+{
+    uint32_t subresource;
+    uint32_t row;
+    uint32_t rowCount;
+    uint32_t offset;
+    uint32_t byteSize;
+};
+
+// Layout of 2D textures, arrays and cube maps stored in DDS files, independent of D3D so both sides
+// of the texture streaming protocol can agree on it. Formats are DXGI_FORMAT values, and subresources
+// are ordered the same way as D3D12 numbers them, every mip level of an array slice after another.
+class DdsLayout
+{
+protected:
+    uint32_t m_headerSize = 0;
+    uint32_t m_format = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_mipLevels = 0;
+    uint32_t m_arraySize = 0;
+    bool m_isCubeMap = false;
+    uint32_t m_blockSize = 0;
+    uint32_t m_dataSize = 0;
+    std::vector<DdsSubresource> m_subresources;
+
+    static uint32_t getLegacyFormat(const uint8_t* header);
+
+public:
+    // Magic, DDS_HEADER and DDS_HEADER_DXT10.
+    static constexpr uint32_t s_maxHeaderSize = 4 + 124 + 20;
+
+    // Returns block size in pixels and bits per block, or false for formats this doesn't know about.
+    static bool getFormatInfo(uint32_t format, uint32_t& blockSize, uint32_t& bitsPerBlock);
+
+    // Only needs the header, returns false for volume textures and anything else that should go through the full loader.
+    bool parse(const uint8_t* data, size_t dataSize);
+
+    uint32_t getHeaderSize() const;
+    uint32_t getFormat() const;
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+    uint32_t getMipLevels() const;
+    // Includes the faces of cube maps.
+    uint32_t getArraySize() const;
+    bool isCubeMap() const;
+    uint32_t getBlockSize() const;
+    // Size of the pixel data following the header.
+    uint32_t getDataSize() const;
+
+    const std::vector<DdsSubresource>& getSubresources() const;
+
+    // Splits the pixel data into chunks of whole rows that are at most the specified size,
+    // unless a single row is larger than that. Offsets are relative to the end of the header.
+    template<typename T>
+    void forEachChunk(uint32_t maxChunkSize, const T& function) const;
+};
+
+#include "DdsLayout.inl"
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cstring>
+
+#define DDS_MAKE_FOURCC(A, B, C, D) \
+    (static_cast<uint32_t>(A) | (static_cast<uint32_t>(B) << 8) | (static_cast<uint32_t>(C) << 16) | (static_cast<uint32_t>(D) << 24))
+
+inline bool DdsLayout::getFormatInfo(uint32_t format, uint32_t& blockSize, uint32_t& bitsPerBlock)
+{
+    blockSize = 1;
+
+    switch (format)
+    {
+    case 2: // R32G32B32A32_FLOAT
+        bitsPerBlock = 128;
+        return true;
+
+    case 10: // R16G16B16A16_FLOAT
+    case 11: // R16G16B16A16_UNORM
+    case 16: // R32G32_FLOAT
+        bitsPerBlock = 64;
+        return true;
+
+    case 24: // R10G10B10A2_UNORM
+    case 26: // R11G11B10_FLOAT
+    case 28: // R8G8B8A8_UNORM
+    case 29: // R8G8B8A8_UNORM_SRGB
+    case 34: // R16G16_FLOAT
+    case 41: // R32_FLOAT
+    case 87: // B8G8R8A8_UNORM
+    case 88: // B8G8R8X8_UNORM
+    case 91: // B8G8R8A8_UNORM_SRGB
+    case 93: // B8G8R8X8_UNORM_SRGB
+        bitsPerBlock = 32;
+        return true;
+
+    case 49: // R8G8_UNORM
+    case 54: // R16_FLOAT
+    case 56: // R16_UNORM
+    case 85: // B5G6R5_UNORM
+    case 86: // B5G5R5A1_UNORM
+    case 115: // B4G4R4A4_UNORM
+        bitsPerBlock = 16;
+        return true;
+
+    case 61: // R8_UNORM
+    case 65: // A8_UNORM
+        bitsPerBlock = 8;
+        return true;
+
+    case 70: case 71: case 72: // BC1
+    case 79: case 80: case 81: // BC4
+        blockSize = 4;
+        bitsPerBlock = 64;
+        return true;
+
+    case 73: case 74: case 75: // BC2
+    case 76: case 77: case 78: // BC3
+    case 82: case 83: case 84: // BC5
+    case 94: case 95: case 96: // BC6H
+    case 97: case 98: case 99: // BC7
+        blockSize = 4;
+        bitsPerBlock = 128;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+inline uint32_t DdsLayout::getLegacyFormat(const uint8_t* header)
+{
+    uint32_t flags, fourCC, bitCount, masks[4];
+    memcpy(&flags, header + 80, sizeof(flags));
+    memcpy(&fourCC, header + 84, sizeof(fourCC));
+    memcpy(&bitCount, header + 88, sizeof(bitCount));
+    memcpy(masks, header + 92, sizeof(masks));
+
+    const auto isMask = [&](uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+    {
+        return masks[0] == r && masks[1] == g && masks[2] == b && masks[3] == a;
+    };
+
+    if (flags & 0x4) // DDPF_FOURCC
+    {
+        switch (fourCC)
+        {
+        case DDS_MAKE_FOURCC('D', 'X', 'T', '1'): return 71;
+        case DDS_MAKE_FOURCC('D', 'X', 'T', '2'): 
+        case DDS_MAKE_FOURCC('D', 'X', 'T', '3'): return 74;
+        case DDS_MAKE_FOURCC('D', 'X', 'T', '4'): 
+        case DDS_MAKE_FOURCC('D', 'X', 'T', '5'): return 77;
+        case DDS_MAKE_FOURCC('A', 'T', 'I', '1'):
+        case DDS_MAKE_FOURCC('B', 'C', '4', 'U'): return 80;
+        case DDS_MAKE_FOURCC('B', 'C', '4', 'S'): return 81;
+        case DDS_MAKE_FOURCC('A', 'T', 'I', '2'):
+        case DDS_MAKE_FOURCC('B', 'C', '5', 'U'): return 83;
+        case DDS_MAKE_FOURCC('B', 'C', '5', 'S'): return 84;
+        case 36: return 11;
+        case 111: return 54;
+        case 112: return 34;
+        case 113: return 10;
+        case 114: return 41;
+        case 115: return 16;
+        case 116: return 2;
+        default: return 0;
+        }
+    }
+
+    if (flags & 0x40) // DDPF_RGB
+    {
+        if (bitCount == 32)
+        {
+            if (isMask(0xFF, 0xFF00, 0xFF0000, 0xFF000000)) return 28;
+            if (isMask(0xFF0000, 0xFF00, 0xFF, 0xFF000000)) return 87;
+            if (isMask(0xFF0000, 0xFF00, 0xFF, 0)) return 88;
+        }
+        else if (bitCount == 16)
+        {
+            if (isMask(0xF800, 0x7E0, 0x1F, 0)) return 85;
+            if (isMask(0x7C00, 0x3E0, 0x1F, 0x8000)) return 86;
+            if (isMask(0xF00, 0xF0, 0xF, 0xF000)) return 115;
+        }
+        return 0;
+    }
+
+    if (flags & 0x20000) // DDPF_LUMINANCE
+    {
+        if (bitCount == 8 && masks[0] == 0xFF) return 61;
+        if (bitCount == 16 && masks[0] == 0xFFFF) return 56;
+        if (bitCount == 16 && masks[0] == 0xFF && masks[3] == 0xFF00) return 49;
+        return 0;
+    }
+
+    if (flags & 0x2) // DDPF_ALPHA
+        return bitCount == 8 ? 65 : 0;
+
+    return 0;
+}
+
+inline bool DdsLayout::parse(const uint8_t* data, size_t dataSize)
+{
+    m_subresources.clear();
+
+    uint32_t magic, headerSize, flags, caps2, depth;
+    if (dataSize < 128)
+        return false;
+
+    memcpy(&magic, data, sizeof(magic));
+    memcpy(&headerSize, data + 4, sizeof(headerSize));
+    memcpy(&flags, data + 8, sizeof(flags));
+    memcpy(&m_height, data + 12, sizeof(m_height));
+    memcpy(&m_width, data + 16, sizeof(m_width));
+    memcpy(&depth, data + 24, sizeof(depth));
+    memcpy(&m_mipLevels, data + 28, sizeof(m_mipLevels));
+    memcpy(&caps2, data + 112, sizeof(caps2));
+
+    if (magic != DDS_MAKE_FOURCC('D', 'D', 'S', ' ') || headerSize != 124 || m_width == 0 || m_height == 0)
+        return false;
+
+    if ((flags & 0x20000) == 0 || m_mipLevels == 0) // DDSD_MIPMAPCOUNT
+        m_mipLevels = 1;
+
+    m_headerSize = 128;
+    m_arraySize = 1;
+    m_isCubeMap = false;
+
+    uint32_t fourCC;
+    memcpy(&fourCC, data + 84, sizeof(fourCC));
+
+    if (fourCC == DDS_MAKE_FOURCC('D', 'X', '1', '0'))
+    {
+        if (dataSize < s_maxHeaderSize)
+            return false;
+
+        uint32_t resourceDimension, miscFlag;
+        memcpy(&m_format, data + 128, sizeof(m_format));
+        memcpy(&resourceDimension, data + 132, sizeof(resourceDimension));
+        memcpy(&miscFlag, data + 136, sizeof(miscFlag));
+        memcpy(&m_arraySize, data + 140, sizeof(m_arraySize));
+
+        // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        if (resourceDimension != 3 || m_arraySize == 0)
+            return false;
+
+        m_headerSize = s_maxHeaderSize;
+        m_isCubeMap = (miscFlag & 0x4) != 0; // RESOURCE_MISC_TEXTURECUBE
+    }
+    else
+    {
+        m_format = getLegacyFormat(data);
+
+        if ((flags & 0x800000) && (caps2 & 0x200000) && depth > 1) // Volume
+            return false;
+
+        if (caps2 & 0x200) // DDSCAPS2_CUBEMAP
+        {
+            // Partial cube maps aren't supported by D3D12.
+            if ((caps2 & 0xFC00) != 0xFC00)
+                return false;
+
+            m_isCubeMap = true;
+        }
+    }
+
+    if (m_isCubeMap)
+        m_arraySize *= 6;
+
+    uint32_t bitsPerBlock;
+    if (!getFormatInfo(m_format, m_blockSize, bitsPerBlock) || m_mipLevels > 32)
+        return false;
+
+    uint64_t offset = 0;
+    m_subresources.reserve(m_arraySize * m_mipLevels);
+
+    for (uint32_t i = 0; i < m_arraySize; i++)
+    {
+        for (uint32_t j = 0; j < m_mipLevels; j++)
+        {
+            auto& subresource = m_subresources.emplace_back();
+            subresource.offset = static_cast<uint32_t>(offset);
+            subresource.width = std::max(1u, m_width >> j);
+            subresource.height = std::max(1u, m_height >> j);
+
+            const uint64_t columnCount = (subresource.width + m_blockSize - 1) / m_blockSize;
+            subresource.rowPitch = static_cast<uint32_t>((columnCount * bitsPerBlock + 7) / 8);
+            subresource.rowCount = (subresource.height + m_blockSize - 1) / m_blockSize;
+
+            offset += static_cast<uint64_t>(subresource.rowPitch) * subresource.rowCount;
+
+            if (offset > 0xFFFFFFFF)
+                return false;
+        }
+    }
+
+    m_dataSize = static_cast<uint32_t>(offset);
+    return true;
+}
+
+inline uint32_t DdsLayout::getHeaderSize() const
+{
+    return m_headerSize;
+}
+
+inline uint32_t DdsLayout::getFormat() const
+{
+    return m_format;
+}
+
+inline uint32_t DdsLayout::getWidth() const
+{
+    return m_width;
+}
+
+inline uint32_t DdsLayout::getHeight() const
+{
+    return m_height;
+}
+
+inline uint32_t DdsLayout::getMipLevels() const
+{
+    return m_mipLevels;
+}
+
+inline uint32_t DdsLayout::getArraySize() const
+{
+    return m_arraySize;
+}
+
+inline bool DdsLayout::isCubeMap() const
+{
+    return m_isCubeMap;
+}
+
+inline uint32_t DdsLayout::getBlockSize() const
+{
+    return m_blockSize;
+}
+
+inline uint32_t DdsLayout::getDataSize() const
+{
+    return m_dataSize;
+}
+
+inline const std::vector<DdsSubresource>& DdsLayout::getSubresources() const
+{
+    return m_subresources;
+}
+
+template<typename T>
+void DdsLayout::forEachChunk(uint32_t maxChunkSize, const T& function) const
+{
+    for (uint32_t i = 0; i < m_subresources.size(); i++)
+    {
+        const auto& subresource = m_subresources[i];
+        const uint32_t maxRowCount = std::max(1u, maxChunkSize / subresource.rowPitch);
+
+        for (uint32_t row = 0; row < subresource.rowCount; row += maxRowCount)
+        {
+            DdsChunk chunk;
+            chunk.subresource = i;
+            chunk.row = row;
+            chunk.rowCount = std::min(subresource.rowCount - row, maxRowCount);
+            chunk.offset = subresource.offset + row * subresource.rowPitch;
+            chunk.byteSize = chunk.rowCount * subresource.rowPitch;
+
+            function(chunk);
+        }
+    }
+}
\ No newline at end of file
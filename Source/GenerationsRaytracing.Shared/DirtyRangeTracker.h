@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Records byte ranges written to a CPU-side table so only those spans need to be copied to its GPU copy.
+class DirtyRangeTracker
+{
+public:
+    // Begin and end offsets, end exclusive.
+    using Range = std::pair<uint32_t, uint32_t>;
+
+protected:
+    uint32_t m_mergeDistance;
+    std::vector<Range> m_ranges;
+
+public:
+    // Ranges with a gap of at most the merge distance get copied as one,
+    // fewer copy calls are worth more than the few bytes in between.
+    explicit DirtyRangeTracker(uint32_t mergeDistance = 256);
+
+    void markDirty(uint32_t offset, uint32_t byteSize);
+
+    // Drops everything recorded so far in favour of a single range covering the whole table.
+    void markAll(uint32_t byteSize);
+
+    // Sorts and merges the ranges, and clamps them to the current table size.
+    // Ranges past the end belong to entries that were freed since and are dropped.
+    const std::vector<Range>& coalesce(uint32_t byteSize);
+
+    void clear();
+
+    bool isEmpty() const;
+    const std::vector<Range>& getRanges() const;
+    uint32_t getDirtyByteCount() const;
+};
+
+#include "DirtyRangeTracker.inl"
\ No newline at end of file
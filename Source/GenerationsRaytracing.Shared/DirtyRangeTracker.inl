@@ -0,0 +1,76 @@
+#include <algorithm>
+
+inline DirtyRangeTracker::DirtyRangeTracker(uint32_t mergeDistance) : m_mergeDistance(mergeDistance)
+{
+}
+
+inline void DirtyRangeTracker::markDirty(uint32_t offset, uint32_t byteSize)
+{
+    if (byteSize == 0)
+        return;
+
+    const uint32_t end = offset + byteSize;
+
+    // Consecutive writes are the common case, extend the last range for them.
+    if (!m_ranges.empty() && m_ranges.back().first <= end && offset <= m_ranges.back().second)
+    {
+        auto& range = m_ranges.back();
+        range.first = std::min(range.first, offset);
+        range.second = std::max(range.second, end);
+    }
+    else
+    {
+        m_ranges.emplace_back(offset, end);
+    }
+}
+
+inline void DirtyRangeTracker::markAll(uint32_t byteSize)
+{
+    m_ranges.clear();
+    markDirty(0, byteSize);
+}
+
+inline const std::vector<DirtyRangeTracker::Range>& DirtyRangeTracker::coalesce(uint32_t byteSize)
+{
+    std::sort(m_ranges.begin(), m_ranges.end());
+
+    size_t count = 0;
+    for (auto [begin, end] : m_ranges)
+    {
+        end = std::min(end, byteSize);
+        if (begin >= end)
+            break;
+
+        if (count > 0 && (begin <= m_ranges[count - 1].second || begin - m_ranges[count - 1].second <= m_mergeDistance))
+            m_ranges[count - 1].second = std::max(m_ranges[count - 1].second, end);
+        else
+            m_ranges[count++] = { begin, end };
+    }
+
+    m_ranges.resize(count);
+    return m_ranges;
+}
+
+inline void DirtyRangeTracker::clear()
+{
+    m_ranges.clear();
+}
+
+inline bool DirtyRangeTracker::isEmpty() const
+{
+    return m_ranges.empty();
+}
+
+inline const std::vector<DirtyRangeTracker::Range>& DirtyRangeTracker::getRanges() const
+{
+    return m_ranges;
+}
+
+inline uint32_t DirtyRangeTracker::getDirtyByteCount() const
+{
+    uint32_t byteCount = 0;
+    for (const auto& [begin, end] : m_ranges)
+        byteCount += end - begin;
+
+    return byteCount;
+}
\ No newline at end of file
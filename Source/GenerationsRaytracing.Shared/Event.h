@@ -1,16 +1,30 @@
 ﻿#pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include "PosixCompat.h"
+#include <semaphore.h>
+#include <string>
+#endif
 
 struct Event
 {
 protected:
+#ifdef _WIN32
     HANDLE m_handle = nullptr;
+#else
+    // Emulates an auto reset event, which is the only kind we use.
+    sem_t* m_handle = SEM_FAILED;
+    std::string m_name;
+    bool m_owner = false;
+#endif
 
 public:
     static constexpr TCHAR s_x86EventName[] = TEXT("GenerationsRaytracingX86Event");
     static constexpr TCHAR s_x64EventName[] = TEXT("GenerationsRaytracingX64Event");
     static constexpr TCHAR s_swapChainEventName[] = TEXT("GenerationsRaytracingSwapChainEvent");
+    static constexpr TCHAR s_frameEventName[] = TEXT("GenerationsRaytracingFrameEvent");
 
     Event(LPCTSTR name, BOOL manualReset, BOOL initialState);
     Event(LPCTSTR name);
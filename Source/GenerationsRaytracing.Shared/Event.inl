@@ -1,5 +1,7 @@
 #include <cassert>
 
+#ifdef _WIN32
+
 inline Event::Event(LPCTSTR name, BOOL manualReset, BOOL initialState)
 {
     m_handle = CreateEvent(
@@ -49,3 +51,80 @@ inline void Event::reset() const
     const BOOL result = ResetEvent(m_handle);
     assert(result == TRUE);
 }
+
+#else
+
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+
+inline Event::Event(LPCTSTR name, BOOL manualReset, BOOL initialState)
+    : m_name(std::string("/") + name), m_owner(true)
+{
+    assert(!manualReset);
+
+    // Semaphores outlive crashed processes, so never pick up a stale count.
+    sem_unlink(m_name.c_str());
+    m_handle = sem_open(m_name.c_str(), O_CREAT | O_EXCL, 0600, initialState ? 1u : 0u);
+
+    assert(m_handle != SEM_FAILED);
+}
+
+inline Event::Event(LPCTSTR name)
+    : m_name(std::string("/") + name)
+{
+    m_handle = sem_open(m_name.c_str(), 0);
+
+    assert(m_handle != SEM_FAILED);
+}
+
+inline Event::~Event()
+{
+    sem_close(m_handle);
+
+    if (m_owner)
+        sem_unlink(m_name.c_str());
+}
+
+inline void Event::wait() const
+{
+    while (sem_wait(m_handle) != 0)
+        assert(errno == EINTR);
+}
+
+inline bool Event::waitImm() const
+{
+    timespec time;
+    clock_gettime(CLOCK_REALTIME, &time);
+
+    time.tv_nsec += 1000000;
+    if (time.tv_nsec >= 1000000000)
+    {
+        time.tv_nsec -= 1000000000;
+        ++time.tv_sec;
+    }
+
+    return sem_timedwait(m_handle, &time) == 0;
+}
+
+inline void Event::set() const
+{
+    // Racing setters can leave the count at two, which only causes a spurious 
+    // wake up. Every wait is done in a loop that checks its condition anyway.
+    int value = 0;
+    sem_getvalue(m_handle, &value);
+
+    if (value <= 0)
+    {
+        const int result = sem_post(m_handle);
+        assert(result == 0);
+    }
+}
+
+inline void Event::reset() const
+{
+    while (sem_trywait(m_handle) == 0)
+        ;
+}
+
+#endif
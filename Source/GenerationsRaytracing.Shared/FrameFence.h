@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Event.h"
+
+// Counter of frames completed by x64 in shared memory. x86 waits on it at the end of 
+// every frame, which bounds how many frames it can run ahead without a full sync.
+class FrameFence
+{
+protected:
+    std::atomic<uint32_t>& m_completedFrame;
+    const Event& m_event;
+
+public:
+    FrameFence(std::atomic<uint32_t>& completedFrame, const Event& event);
+
+    uint32_t getCompletedFrame() const;
+
+    // Called by x64 once it's done with a frame.
+    void signal() const;
+
+    // Called by x86 after sending the specified frame, returns once x64 is 
+    // at most maxFramesAhead frames behind or the process is about to exit.
+    void wait(uint32_t frame, uint32_t maxFramesAhead, const size_t* shouldExit) const;
+};
+
+#include "FrameFence.inl"
\ No newline at end of file
@@ -0,0 +1,22 @@
+inline FrameFence::FrameFence(std::atomic<uint32_t>& completedFrame, const Event& event)
+    : m_completedFrame(completedFrame), m_event(event)
+{
+}
+
+inline uint32_t FrameFence::getCompletedFrame() const
+{
+    return m_completedFrame.load(std::memory_order_acquire);
+}
+
+inline void FrameFence::signal() const
+{
+    m_completedFrame.fetch_add(1, std::memory_order_release);
+    m_event.set();
+}
+
+inline void FrameFence::wait(uint32_t frame, uint32_t maxFramesAhead, const size_t* shouldExit) const
+{
+    // The event stays set if x64 signals between the check and the wait, so no wake up gets lost.
+    while (frame - getCompletedFrame() > maxFramesAhead && !(*shouldExit))
+        m_event.waitImm();
+}
\ No newline at end of file
@@ -1,23 +1,42 @@
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <set>
 #include <vector>
 
 #ifndef _WIN64
 #include "Mutex.h"
 #endif
 
+// Hands out the lowest free index first. Free indices are tracked in a bit hierarchy, where each bit
+// of an upper level tells whether the corresponding word of the level below has any free bits.
 class FreeListAllocator
 {
 protected:
-    std::vector<uint32_t> m_indices;
-    uint32_t m_capacity = 1; // Reserve first index for NULL
+    static constexpr uint32_t s_levelNum = 5; // 32^5 indices
+
+    std::vector<uint32_t> m_levels[s_levelNum];
+    std::atomic<uint32_t> m_capacity = 1; // Reserve first index for NULL
+    std::atomic<uint32_t> m_freeCount = 0;
+    // Ranges handed back by freeMany, by beginning for merging neighbors and by count for best fit.
+    std::map<uint32_t, uint32_t> m_freeRanges;
+    std::set<std::pair<uint32_t, uint32_t>> m_freeRangesByCount;
 #ifndef _WIN64
     Mutex m_mutex;
 #endif
 
+    void insertFreeRange(uint32_t index, uint32_t count);
+    void removeFreeRange(uint32_t index, uint32_t count);
+
 public:
     uint32_t allocate();
     void free(uint32_t index);
+
+    // Contiguous range for descriptor tables. Reuses the smallest freed range that fits, or takes it from the end.
+    // Ranges and single indices never mix, so neither ever has to search the other.
+    uint32_t allocateMany(uint32_t count);
+    void freeMany(uint32_t index, uint32_t count);
 };
 
-#include "FreeListAllocator.inl"
+#include "FreeListAllocator.inl"
\ No newline at end of file
@@ -1,34 +1,133 @@
+#include "BitUtil.h"
 #include "LockGuard.h"
 #include <cassert>
 
 inline uint32_t FreeListAllocator::allocate()
 {
+    // Nothing to reuse, no need to touch the bits.
+    if (m_freeCount.load(std::memory_order_acquire) == 0)
+        return m_capacity.fetch_add(1);
+
 #ifndef _WIN64
     LockGuard lock(m_mutex);
-#endif
 
-    uint32_t index;
+    if (m_freeCount.load(std::memory_order_relaxed) == 0)
+        return m_capacity.fetch_add(1);
+#endif
 
-    if (!m_indices.empty())
+    uint32_t index = 0;
+    for (uint32_t i = s_levelNum; i > 0; i--)
     {
-        index = m_indices.back();
-        m_indices.pop_back();
+        index = index * 32 + findFirstSetBit(m_levels[i - 1][index]);
     }
-    else
+
+    // Clear the bit and propagate emptied words upwards.
+    uint32_t word = index;
+    for (auto& level : m_levels)
     {
-        index = m_capacity;
-        ++m_capacity;
+        level[word / 32] &= ~(1u << (word % 32));
+        if (level[word / 32] != 0)
+            break;
+
+        word /= 32;
     }
 
+    m_freeCount.fetch_sub(1, std::memory_order_release);
     return index;
 }
 
 inline void FreeListAllocator::free(uint32_t index)
 {
-    assert(index != NULL);
+    assert(index != 0 && index < m_capacity);
+#ifndef _WIN64
+    LockGuard lock(m_mutex);
+#endif
+
+    // Set the bit and propagate newly filled words upwards.
+    uint32_t word = index;
+    for (auto& level : m_levels)
+    {
+        if (level.size() <= word / 32)
+            level.resize(word / 32 + 1);
+
+        const bool wasEmpty = level[word / 32] == 0;
+        assert((level[word / 32] & (1u << (word % 32))) == 0);
+
+        level[word / 32] |= 1u << (word % 32);
+        if (!wasEmpty)
+            break;
+
+        word /= 32;
+    }
+
+    m_freeCount.fetch_add(1, std::memory_order_release);
+}
+
+inline void FreeListAllocator::insertFreeRange(uint32_t index, uint32_t count)
+{
+    m_freeRanges.emplace(index, count);
+    m_freeRangesByCount.emplace(count, index);
+}
+
+inline void FreeListAllocator::removeFreeRange(uint32_t index, uint32_t count)
+{
+    m_freeRanges.erase(index);
+    m_freeRangesByCount.erase({ count, index });
+}
+
+inline uint32_t FreeListAllocator::allocateMany(uint32_t count)
+{
+    assert(count != 0);
 #ifndef _WIN64
     LockGuard lock(m_mutex);
 #endif
-    m_indices.insert(std::lower_bound(m_indices.begin(), m_indices.end(), index, std::greater<uint32_t>()), index);
+
+    const auto freeRange = m_freeRangesByCount.lower_bound({ count, 0 });
+    if (freeRange == m_freeRangesByCount.end())
+        return m_capacity.fetch_add(count);
+
+    const uint32_t rangeCount = freeRange->first;
+    const uint32_t index = freeRange->second;
+    removeFreeRange(index, rangeCount);
+
+    if (rangeCount > count)
+        insertFreeRange(index + count, rangeCount - count);
+
+    return index;
 }
 
+inline void FreeListAllocator::freeMany(uint32_t index, uint32_t count)
+{
+    assert(index != 0 && count != 0 && index + count <= m_capacity);
+#ifndef _WIN64
+    LockGuard lock(m_mutex);
+#endif
+
+    const auto next = m_freeRanges.lower_bound(index);
+    assert(next == m_freeRanges.end() || next->first >= index + count);
+
+    if (next != m_freeRanges.end() && next->first == index + count)
+    {
+        const uint32_t nextCount = next->second;
+        removeFreeRange(index + count, nextCount);
+        count += nextCount;
+    }
+
+    const auto prev = m_freeRanges.lower_bound(index);
+    if (prev != m_freeRanges.begin())
+    {
+        const auto it = std::prev(prev);
+        assert(it->first + it->second <= index);
+
+        if (it->first + it->second == index)
+        {
+            const uint32_t prevIndex = it->first;
+            const uint32_t prevCount = it->second;
+            removeFreeRange(prevIndex, prevCount);
+            index = prevIndex;
+            count += prevCount;
+        }
+    }
+
+    insertFreeRange(index, count);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "ReplayBackend.h"
+
+// Replays without a GPU, so captures can be replayed on any platform. Messages only get sized 
+// and hashed, which makes the replay times cover decoding and dispatch, and the hash
+// tells whether two replays of the same capture saw the same stream.
+class HeadlessReplayBackend final : public ReplayBackend
+{
+protected:
+    std::vector<uint8_t> m_bulkData;
+    uint64_t m_hash = 0xCBF29CE484222325;
+
+public:
+    void writeBulkData(uint32_t offset, const uint8_t* data, uint32_t dataSize) override;
+    uint32_t processMessage(const uint8_t* message) override;
+
+    const uint8_t* getBulkData(uint32_t offset) const;
+    uint64_t getHash() const;
+};
+
+#include "HeadlessReplayBackend.inl"
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include <cassert>
+#include <cstring>
+
+#include "MessageSize.h"
+
+inline void HeadlessReplayBackend::writeBulkData(uint32_t offset, const uint8_t* data, uint32_t dataSize)
+{
+    if (m_bulkData.size() < offset + dataSize)
+        m_bulkData.resize(offset + dataSize);
+
+    memcpy(m_bulkData.data() + offset, data, dataSize);
+}
+
+inline uint32_t HeadlessReplayBackend::processMessage(const uint8_t* message)
+{
+    const uint32_t byteSize = getMessageByteSize(message);
+    assert(byteSize != 0);
+
+    // FNV-1a
+    for (uint32_t i = 0; i < byteSize; i++)
+        m_hash = (m_hash ^ message[i]) * 0x100000001B3;
+
+    return byteSize;
+}
+
+inline const uint8_t* HeadlessReplayBackend::getBulkData(uint32_t offset) const
+{
+    return m_bulkData.data() + offset;
+}
+
+inline uint64_t HeadlessReplayBackend::getHash() const
+{
+    return m_hash;
+}
\ No newline at end of file
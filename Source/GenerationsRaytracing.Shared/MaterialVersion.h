@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Decides when a material needs to be sent again. Code modifying a material goes through the setters,
+// which mark it dirty only if a value actually changed. Marking only advances the generation while the
+// material is clean, so the 16-bit counters can wrap any number of times without a dirty material ever
+// looking clean. Modifications that bypass the setters are caught by validating the material hash in
+// slices, and materials sent while a texture was still missing are validated every frame until it arrives.
+struct MaterialVersion
+{
+    static constexpr uint32_t s_validationInterval = 16;
+
+    uint32_t hash;
+    uint16_t generation;
+    uint16_t createdGeneration;
+    bool hasPendingTextures;
+
+    void reset();
+
+    void markDirty();
+    bool isDirty() const;
+
+    // Copies the value if it differs, returns whether it did.
+    bool set(void* dst, const void* src, size_t byteSize);
+
+    template<typename T>
+    bool set(T& dst, const T& src);
+
+    // Whether the material gets its hash validated in the given frame.
+    static bool shouldValidate(uint32_t materialId, uint32_t frame);
+
+    // Returns whether the material needs to be sent, which it always does when forced. The hash function
+    // returns the material hash and sets its argument if any of the material's textures isn't loaded yet.
+    template<typename THashFunction>
+    bool update(bool force, bool validate, const THashFunction& hashFunction);
+
+    // For materials sharing parameters with other materials, where changes to them can't be observed.
+    template<typename THashFunction>
+    void markDirtyIfChanged(const THashFunction& hashFunction);
+};
+
+#include "MaterialVersion.inl"
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <cstring>
+
+inline void MaterialVersion::reset()
+{
+    hash = 0;
+    generation = 0;
+    createdGeneration = 0;
+    hasPendingTextures = false;
+}
+
+inline void MaterialVersion::markDirty()
+{
+    if (generation == createdGeneration)
+        ++generation;
+}
+
+inline bool MaterialVersion::isDirty() const
+{
+    return generation != createdGeneration;
+}
+
+inline bool MaterialVersion::set(void* dst, const void* src, size_t byteSize)
+{
+    if (memcmp(dst, src, byteSize) == 0)
+        return false;
+
+    memcpy(dst, src, byteSize);
+    markDirty();
+    return true;
+}
+
+template<typename T>
+bool MaterialVersion::set(T& dst, const T& src)
+{
+    if (dst == src)
+        return false;
+
+    dst = src;
+    markDirty();
+    return true;
+}
+
+inline bool MaterialVersion::shouldValidate(uint32_t materialId, uint32_t frame)
+{
+    return (materialId % s_validationInterval) == (frame % s_validationInterval);
+}
+
+template<typename THashFunction>
+bool MaterialVersion::update(bool force, bool validate, const THashFunction& hashFunction)
+{
+    if (!force && !isDirty() && !validate && !hasPendingTextures)
+        return false;
+
+    bool pendingTextures = false;
+    const uint32_t newHash = hashFunction(pendingTextures);
+    const bool shouldCreate = force || isDirty() || newHash != hash;
+
+    hash = newHash;
+    hasPendingTextures = pendingTextures;
+
+    if (shouldCreate)
+        createdGeneration = generation;
+
+    return shouldCreate;
+}
+
+template<typename THashFunction>
+void MaterialVersion::markDirtyIfChanged(const THashFunction& hashFunction)
+{
+    bool pendingTextures = false;
+    if (hashFunction(pendingTextures) != hash)
+        markDirty();
+}
\ No newline at end of file
@@ -1,20 +1,34 @@
 ﻿#pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include "PosixCompat.h"
+#include <string>
+#endif
 
 class MemoryMappedFile
 {
 protected:
+#ifdef _WIN32
     HANDLE m_handle = nullptr;
+#else
+    int m_handle = -1;
+    size_t m_size = 0;
+    std::string m_name;
+#endif
 #ifdef _DEBUG
     mutable bool m_mapped = false;
 #endif
 
 public:
-    static constexpr size_t s_size = 256 * 1024 * 1024;
+    static constexpr size_t s_size = 32 * 1024 * 1024;
     static constexpr TCHAR s_name[] = TEXT("GenerationsRaytracingMemoryMappedFile");
 
-    MemoryMappedFile();
+    static constexpr size_t s_bulkDataSize = 224 * 1024 * 1024;
+    static constexpr TCHAR s_bulkDataName[] = TEXT("GenerationsRaytracingBulkDataMemoryMappedFile");
+
+    MemoryMappedFile(LPCTSTR name, size_t size);
     ~MemoryMappedFile();
 
     void* map() const;
@@ -1,12 +1,14 @@
 #include <cassert>
 
-inline MemoryMappedFile::MemoryMappedFile()
+#ifdef _WIN32
+
+inline MemoryMappedFile::MemoryMappedFile(LPCTSTR name, size_t size)
 {
 #ifdef _WIN64
     m_handle = OpenFileMapping(
-        FILE_MAP_READ,
+        FILE_MAP_READ | FILE_MAP_WRITE,
         FALSE,
-        s_name);
+        name);
 
     static_assert(sizeof(size_t) == 8);
 #else
@@ -15,8 +17,8 @@ inline MemoryMappedFile::MemoryMappedFile()
         nullptr,
         PAGE_READWRITE,
         0,
-        s_size,
-        s_name);
+        size,
+        name);
 
     static_assert(sizeof(size_t) == 4);
 #endif
@@ -36,11 +38,7 @@ inline void* MemoryMappedFile::map() const
 
     void* result = MapViewOfFile(
         m_handle,
-#ifdef _WIN64
-        FILE_MAP_READ,
-#else
         FILE_MAP_WRITE,
-#endif
         0,
         0,
         0);
@@ -67,4 +65,67 @@ inline void MemoryMappedFile::unmap(void* buffer) const
 #ifdef _DEBUG
     m_mapped = false;
 #endif
-}
\ No newline at end of file
+}
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Both sides create the file if it doesn't exist yet, since there is 
+// no 32-bit/64-bit split to tell the creator apart from the opener.
+inline MemoryMappedFile::MemoryMappedFile(LPCTSTR name, size_t size)
+    : m_size(size), m_name(std::string("/") + name)
+{
+    m_handle = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0600);
+    assert(m_handle != -1);
+
+    struct stat status{};
+    fstat(m_handle, &status);
+
+    if (static_cast<size_t>(status.st_size) != size)
+    {
+        const int result = ftruncate(m_handle, static_cast<off_t>(size));
+        assert(result == 0);
+    }
+}
+
+inline MemoryMappedFile::~MemoryMappedFile()
+{
+    assert(!m_mapped);
+    close(m_handle);
+    shm_unlink(m_name.c_str());
+}
+
+inline void* MemoryMappedFile::map() const
+{
+    assert(!m_mapped);
+
+    void* result = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_handle, 0);
+    assert(result != MAP_FAILED);
+
+#ifdef _DEBUG
+    m_mapped = true;
+#endif
+    return result;
+}
+
+inline void MemoryMappedFile::flush(void* buffer, size_t size) const
+{
+    const int result = msync(buffer, size, MS_SYNC);
+    assert(result == 0);
+}
+
+inline void MemoryMappedFile::unmap(void* buffer) const
+{
+    assert(m_mapped);
+    const int result = munmap(buffer, m_size);
+    assert(result == 0);
+#ifdef _DEBUG
+    m_mapped = false;
+#endif
+}
+
+#endif
\ No newline at end of file
@@ -229,8 +229,8 @@ struct MsgWriteVertexBuffer
     uint32_t vertexBufferId;
     uint32_t offset;
     bool initialWrite;
-    uint32_t dataSize;
-    alignas(0x10) uint8_t data[1u];
+    uint32_t bulkOffset;
+    uint32_t bulkSize;
 };
 
 struct MsgCreateIndexBuffer
@@ -247,8 +247,8 @@ struct MsgWriteIndexBuffer
     uint32_t indexBufferId;
     uint32_t offset;
     bool initialWrite;
-    uint32_t dataSize;
-    alignas(0x10) uint8_t data[1u];
+    uint32_t bulkOffset;
+    uint32_t bulkSize;
 };
 
 struct MsgWriteTexture
@@ -259,19 +259,40 @@ struct MsgWriteTexture
     uint32_t height;
     uint32_t level;
     uint32_t pitch;
-    uint32_t dataSize;
-    alignas(0x10) uint8_t data[1u];
+    uint32_t bulkOffset;
+    uint32_t bulkSize;
 };
 
-struct MsgMakeTexture
+// Carries the DDS header, x64 creates the texture right away and writes the chunks into it as they come.
+struct MsgBeginMakeTexture
 {
     MSG_DEFINE_MESSAGE(MsgWriteTexture);
     uint32_t textureId;
+    uint8_t dataSize;
+    uint8_t data[1u];
+};
+
+// Whole rows of a subresource, see DdsLayout::forEachChunk.
+struct MsgWriteMakeTextureChunk
+{
+    MSG_DEFINE_MESSAGE(MsgBeginMakeTexture);
+    uint32_t textureId;
+    uint32_t subresource;
+    uint32_t row;
+    uint32_t bulkOffset;
+    uint32_t bulkSize;
+};
+
+struct MsgMakeTexture
+{
+    MSG_DEFINE_MESSAGE(MsgWriteMakeTextureChunk);
+    uint32_t textureId;
 #ifdef _DEBUG
     char textureName[0x100];
 #endif
-    uint32_t dataSize;
-    alignas(0x10) uint8_t data[1u];
+    // Zero when the data was streamed with the chunk messages, which this finishes.
+    uint32_t bulkOffset;
+    uint32_t bulkSize;
 };
 
 struct MsgDrawIndexedPrimitive
@@ -345,7 +366,8 @@ struct MsgCreateBottomLevelAccelStruct
 enum class RaytracingResourceType : uint8_t
 {
     BottomLevelAccelStruct,
-    Material
+    Material,
+    Instance
 };
 
 struct MsgReleaseRaytracingResource
@@ -607,4 +629,121 @@ struct MsgComputeGrassInstancer
     uint8_t data[1u];
 };
 
-#pragma pack(pop)
\ No newline at end of file
+// Instances that persist across frames until they get released, 
+// x86 only sends these again when something changes.
+struct MsgCreatePersistentInstance
+{
+    MSG_DEFINE_MESSAGE(MsgComputeGrassInstancer);
+
+    uint32_t instanceId;
+    float transform[3][4];
+    float headTransform[3][4];
+    uint32_t bottomLevelAccelStructId;
+    bool isMirrored;
+    uint8_t instanceMask;
+    uint8_t instanceType;
+    float playableParam;
+    float chrPlayableMenuParam;
+    float forceAlphaColor;
+    float edgeEmissionParam;
+    uint32_t dataSize;
+    uint8_t data[1u]; // Material remap pairs, same as MsgCreateInstance
+};
+
+struct MsgUpdatePersistentInstance
+{
+    MSG_DEFINE_MESSAGE(MsgCreatePersistentInstance);
+
+    uint32_t instanceId;
+    float transform[3][4];
+    float headTransform[3][4];
+    bool isMirrored;
+    float playableParam;
+    float chrPlayableMenuParam;
+    float forceAlphaColor;
+    float edgeEmissionParam;
+};
+
+struct MsgUpdatePersistentInstanceMaterials
+{
+    MSG_DEFINE_MESSAGE(MsgUpdatePersistentInstance);
+
+    uint32_t instanceId;
+    uint32_t dataSize;
+    uint8_t data[1u]; // Replaces every material remap pair of the instance
+};
+
+struct MsgWrap
+{
+    MSG_DEFINE_MESSAGE(MsgUpdatePersistentInstanceMaterials);
+};
+
+#pragma pack(pop)
+
+// Indexed by message ID, keep in the same order as the messages above.
+inline constexpr const char* s_messageNames[] =
+{
+    "Padding",
+    "CreateSwapChain",
+    "SetRenderTarget",
+    "CreateVertexDeclaration",
+    "CreatePixelShader",
+    "CreateVertexShader",
+    "SetRenderState",
+    "CreateTexture",
+    "SetTexture",
+    "SetDepthStencilSurface",
+    "Clear",
+    "SetVertexShader",
+    "SetPixelShader",
+    "SetPixelShaderConstantF",
+    "SetVertexShaderConstantF",
+    "SetVertexShaderConstantB",
+    "SetSamplerState",
+    "SetViewport",
+    "SetScissorRect",
+    "SetVertexDeclaration",
+    "DrawPrimitiveUP",
+    "SetStreamSource",
+    "SetIndices",
+    "Present",
+    "ProcessWindowMessages",
+    "WaitOnSwapChain",
+    "CreateVertexBuffer",
+    "WriteVertexBuffer",
+    "CreateIndexBuffer",
+    "WriteIndexBuffer",
+    "WriteTexture",
+    "BeginMakeTexture",
+    "WriteMakeTextureChunk",
+    "MakeTexture",
+    "DrawIndexedPrimitive",
+    "SetStreamSourceFreq",
+    "ReleaseResource",
+    "DrawPrimitive",
+    "CreateBottomLevelAccelStruct",
+    "ReleaseRaytracingResource",
+    "CreateInstance",
+    "TraceRays",
+    "CreateMaterial",
+    "ComputePose",
+    "BuildBottomLevelAccelStruct",
+    "CopyVertexBuffer",
+    "RenderSky",
+    "CreateLocalLight",
+    "SetPixelShaderConstantB",
+    "SaveShaderCache",
+    "ComputeSmoothNormal",
+    "DrawIndexedPrimitiveUP",
+    "ShowCursor",
+    "DispatchUpscaler",
+    "DrawIm3d",
+    "CopyHdrTexture",
+    "ComputeGrassInstancer",
+    "CreatePersistentInstance",
+    "UpdatePersistentInstance",
+    "UpdatePersistentInstanceMaterials",
+    "Wrap"
+};
+
+static_assert(sizeof(s_messageNames) / sizeof(*s_messageNames) == MsgWrap::s_id + 1);
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+// Captures are a header followed by records, each padded to the record alignment
+// so that messages can be read in place. Message IDs change whenever messages get
+// added, so captures only replay with the build that made them.
+struct MessageCaptureHeader
+{
+    static constexpr uint32_t s_magic = 0x50434D47; // GMCP
+
+    uint32_t magic;
+    uint32_t lastMessageId;
+    int64_t frequency;
+};
+
+enum class MessageCaptureRecordType : uint32_t
+{
+    Message,
+    BulkData, // Starts with the offset of the block
+    Frame
+};
+
+struct alignas(0x10) MessageCaptureRecord
+{
+    MessageCaptureRecordType type;
+    uint32_t byteSize;
+    int64_t timestamp;
+};
+
+static_assert((sizeof(MessageCaptureHeader) % alignof(MessageCaptureRecord)) == 0);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MessageCapture.h"
+
+// Walks the records of a capture that is already in memory. Records are read in place,
+// so the memory needs to be aligned to the record alignment.
+class MessageCaptureReader
+{
+protected:
+    const uint8_t* m_data;
+    size_t m_dataSize;
+    size_t m_offset = sizeof(MessageCaptureHeader);
+
+public:
+    MessageCaptureReader(const uint8_t* data, size_t dataSize);
+
+    // Checks the magic, and that the capture was made with the same set of messages.
+    bool isValid() const;
+    int64_t getFrequency() const;
+
+    // Returns null once there are no records left. A record cut off at the end counts as none.
+    const MessageCaptureRecord* next();
+    bool isFinished() const;
+
+    static const uint8_t* getRecordData(const MessageCaptureRecord* record);
+
+    // Returns an empty vector when the file can't be read.
+    static std::vector<uint8_t> readFile(const char* filePath);
+};
+
+#include "MessageCaptureReader.inl"
\ No newline at end of file
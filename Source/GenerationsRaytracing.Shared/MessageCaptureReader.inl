@@ -0,0 +1,77 @@
+#include <cassert>
+#include <cstdio>
+
+#include "AlignmentUtil.h"
+#include "Message.h"
+
+inline MessageCaptureReader::MessageCaptureReader(const uint8_t* data, size_t dataSize)
+    : m_data(data), m_dataSize(dataSize)
+{
+    assert((reinterpret_cast<size_t>(data) & (alignof(MessageCaptureRecord) - 1)) == 0);
+}
+
+inline bool MessageCaptureReader::isValid() const
+{
+    if (m_dataSize < sizeof(MessageCaptureHeader))
+        return false;
+
+    const auto header = reinterpret_cast<const MessageCaptureHeader*>(m_data);
+    return header->magic == MessageCaptureHeader::s_magic && header->lastMessageId == MsgWrap::s_id;
+}
+
+inline int64_t MessageCaptureReader::getFrequency() const
+{
+    return reinterpret_cast<const MessageCaptureHeader*>(m_data)->frequency;
+}
+
+inline const MessageCaptureRecord* MessageCaptureReader::next()
+{
+    if (isFinished())
+        return nullptr;
+
+    const auto record = reinterpret_cast<const MessageCaptureRecord*>(m_data + m_offset);
+    const size_t recordSize = sizeof(MessageCaptureRecord) + alignUp<size_t>(record->byteSize, alignof(MessageCaptureRecord));
+
+    if (m_offset + sizeof(MessageCaptureRecord) + record->byteSize > m_dataSize)
+    {
+        m_offset = m_dataSize;
+        return nullptr;
+    }
+
+    m_offset += recordSize;
+    return record;
+}
+
+inline bool MessageCaptureReader::isFinished() const
+{
+    return m_offset + sizeof(MessageCaptureRecord) > m_dataSize;
+}
+
+inline const uint8_t* MessageCaptureReader::getRecordData(const MessageCaptureRecord* record)
+{
+    return reinterpret_cast<const uint8_t*>(record + 1);
+}
+
+inline std::vector<uint8_t> MessageCaptureReader::readFile(const char* filePath)
+{
+    std::vector<uint8_t> data;
+
+    FILE* file = fopen(filePath, "rb");
+    if (file != nullptr)
+    {
+        // Read in chunks, ftell can't report sizes past 2 GB on Windows.
+        constexpr size_t s_chunkSize = 16 * 1024 * 1024;
+        size_t dataSize = 0;
+
+        do
+        {
+            data.resize(dataSize + s_chunkSize);
+            dataSize += fread(data.data() + dataSize, 1, s_chunkSize, file);
+        } while (dataSize == data.size());
+
+        data.resize(dataSize);
+        fclose(file);
+    }
+
+    return data;
+}
\ No newline at end of file
@@ -3,10 +3,35 @@
 #include <cstdint>
 #include <atomic>
 
+#include "MessageStatisticsRing.h"
+
+// Single producer/single consumer ring. Offsets are relative to the start of the memory map,
+// and the queue is empty when head equals tail. x86 wraps back to the start by writing a MsgWrap.
 struct MessageQueue
 {
-    std::atomic<uint32_t> offset;
-    std::atomic<bool> sync;
+    // Written by x86
+    alignas(0x40) std::atomic<uint32_t> head;
+    // Threads blocked on tail, x64 only keeps tail up to date and signals while this isn't zero.
+    std::atomic<uint32_t> tailWaiterCount;
+    // Threads blocked on bulk data memory, x64 only signals releases while this isn't zero.
+    std::atomic<uint32_t> bulkDataWaiterCount;
+
+    // Written by x64
+    alignas(0x40) std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> completedFrame;
+    std::atomic<bool> sleeping;
+
+    // Dispatch statistics of the last few frames completed by x64.
+    MessageStatisticsRing statistics;
+};
+
+// Large payloads live in a separate memory mapped file that x86 sub-allocates, see BulkDataAllocator.
+// Messages only refer to the offset of the data, and x64 flags the block as released once processed.
+struct alignas(0x10) BulkDataHeader
+{
+    uint32_t byteSize; // Includes the header
+    std::atomic<bool> released;
 };
 
-#define MESSAGE_QUEUE reinterpret_cast<MessageQueue*>(m_memoryMap)
\ No newline at end of file
+#define MESSAGE_QUEUE reinterpret_cast<MessageQueue*>(m_memoryMap)
+#define BULK_DATA_HEADER(OFFSET) reinterpret_cast<BulkDataHeader*>(m_bulkDataMap + (OFFSET) - sizeof(BulkDataHeader))
\ No newline at end of file
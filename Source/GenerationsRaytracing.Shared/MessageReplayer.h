@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdio>
+
+#include "MessageCaptureReader.h"
+#include "MessageStatistics.h"
+#include "ReplayBackend.h"
+
+// Feeds a capture made through MessageCaptureFilePath to a backend one frame at a time, 
+// and keeps track of how long the backend takes to process each message type.
+class MessageReplayer
+{
+protected:
+    MessageCaptureReader m_reader;
+    ReplayBackend& m_backend;
+
+    // Durations are in nanoseconds.
+    MessageStatistics m_statistics{};
+    uint32_t m_frameCount = 0;
+    uint64_t m_bulkDataSize = 0;
+
+    void replayMessages(const uint8_t* messages, uint32_t byteSize);
+
+public:
+    MessageReplayer(const uint8_t* data, size_t dataSize, ReplayBackend& backend);
+
+    bool isValid() const;
+
+    // Processes records up to and including the next frame boundary.
+    // Returns false once the end of the capture is reached.
+    bool replayFrame();
+    void replay();
+
+    const MessageStatistics& getStatistics() const;
+    uint32_t getFrameCount() const;
+    uint64_t getBulkDataSize() const;
+
+    void printStatistics(FILE* file) const;
+};
+
+#include "MessageReplayer.inl"
\ No newline at end of file
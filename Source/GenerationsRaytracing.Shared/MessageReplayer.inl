@@ -0,0 +1,122 @@
+#include <cassert>
+#include <chrono>
+
+#include "Message.h"
+
+inline MessageReplayer::MessageReplayer(const uint8_t* data, size_t dataSize, ReplayBackend& backend)
+    : m_reader(data, dataSize), m_backend(backend)
+{
+}
+
+inline void MessageReplayer::replayMessages(const uint8_t* messages, uint32_t byteSize)
+{
+    uint32_t offset = 0;
+    while (offset < byteSize)
+    {
+        const uint8_t id = messages[offset];
+
+        const auto begin = std::chrono::steady_clock::now();
+        const uint32_t messageSize = m_backend.processMessage(messages + offset);
+        const auto end = std::chrono::steady_clock::now();
+
+        // An unknown message means the rest of the record can't be trusted.
+        assert(messageSize != 0);
+        if (messageSize == 0)
+            break;
+
+        m_statistics.add(id, messageSize, std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        offset += messageSize;
+    }
+}
+
+inline bool MessageReplayer::isValid() const
+{
+    return m_reader.isValid();
+}
+
+inline bool MessageReplayer::replayFrame()
+{
+    while (const auto record = m_reader.next())
+    {
+        const uint8_t* recordData = MessageCaptureReader::getRecordData(record);
+
+        switch (record->type)
+        {
+        case MessageCaptureRecordType::Message:
+            replayMessages(recordData, record->byteSize);
+            break;
+
+        case MessageCaptureRecordType::BulkData:
+        {
+            const uint32_t offset = *reinterpret_cast<const uint32_t*>(recordData);
+            const uint32_t dataSize = record->byteSize - sizeof(uint32_t);
+
+            m_backend.writeBulkData(offset, recordData + sizeof(uint32_t), dataSize);
+            m_bulkDataSize += dataSize;
+            break;
+        }
+
+        case MessageCaptureRecordType::Frame:
+            ++m_frameCount;
+            return true;
+
+        default:
+            assert(false);
+            break;
+        }
+    }
+
+    return false;
+}
+
+inline void MessageReplayer::replay()
+{
+    while (replayFrame())
+        ;
+}
+
+inline const MessageStatistics& MessageReplayer::getStatistics() const
+{
+    return m_statistics;
+}
+
+inline uint32_t MessageReplayer::getFrameCount() const
+{
+    return m_frameCount;
+}
+
+inline uint64_t MessageReplayer::getBulkDataSize() const
+{
+    return m_bulkDataSize;
+}
+
+inline void MessageReplayer::printStatistics(FILE* file) const
+{
+    constexpr double s_milliseconds = 1.0 / 1000000.0;
+
+    int64_t totalTime = 0;
+
+    fprintf(file, "%-32s%-12s%-16s%-16s%s\n", "Message", "Count", "Bytes", "Time (ms)", "Average (us)");
+
+    for (size_t i = 0; i < sizeof(s_messageNames) / sizeof(*s_messageNames); i++)
+    {
+        const uint32_t count = m_statistics.counts[i];
+        if (count == 0)
+            continue;
+
+        const int64_t time = m_statistics.durations[i];
+        totalTime += time;
+
+        fprintf(file, "%-32s%-12u%-16llu%-16.3f%.3f\n", s_messageNames[i], count, 
+            static_cast<unsigned long long>(m_statistics.byteSizes[i]), time * s_milliseconds, time * s_milliseconds * 1000.0 / count);
+    }
+
+    fprintf(file, "\nFrames: %u\n", m_frameCount);
+    fprintf(file, "Bulk data: %llu bytes\n", static_cast<unsigned long long>(m_bulkDataSize));
+    fprintf(file, "Total: %.3f ms", totalTime * s_milliseconds);
+
+    if (m_frameCount != 0)
+        fprintf(file, " (%.3f ms per frame)", totalTime * s_milliseconds / m_frameCount);
+
+    fprintf(file, "\n");
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Moves head past reserved messages as they get committed, in reservation order no matter in which order
+// or from which threads they are committed. Reserving needs to be serialized along with the ring allocation
+// by the caller, committing needs no lock. Only the thread holding the publishing token writes head, so it
+// never moves backwards. The others leave their commits to it, and it checks the front once more after
+// giving the token back. Each reservation carries a T that the publisher gets to see before head moves past it.
+template<typename T>
+class MessageReservationQueue
+{
+public:
+    struct Reservation
+    {
+        uint32_t offset;
+        uint32_t byteSize;
+        // Ring offset head moves to once the reservation is published.
+        uint32_t end;
+        T data;
+    };
+
+protected:
+    struct Slot
+    {
+        Reservation reservation{};
+        std::atomic<bool> committed{ false };
+    };
+
+    std::atomic<uint32_t>& m_head;
+    uint32_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+
+    std::atomic<uint32_t> m_reserveIndex{ 0 };
+    std::atomic<uint32_t> m_publishIndex{ 0 };
+    std::atomic<bool> m_publishing{ false };
+
+    Slot& getSlot(uint32_t index) const;
+
+public:
+    // The capacity needs to be a power of two and bounds the amount of reservations that aren't published yet.
+    MessageReservationQueue(std::atomic<uint32_t>& head, uint32_t capacity);
+
+    // Only committers free up slots, the caller needs to let them catch up otherwise.
+    bool canReserve() const;
+
+    // Returns the index to commit. The data can be filled in until then.
+    uint32_t reserve(uint32_t offset, uint32_t byteSize, uint32_t end);
+    T& getData(uint32_t index) const;
+
+    // Calls the function with every reservation head moves past on this thread. Returns whether head moved.
+    template<typename TFunction>
+    bool commit(uint32_t index, const TFunction& function);
+
+    template<typename TFunction>
+    bool publish(const TFunction& function);
+
+    // Runs the first function while nothing gets published, then publishes whatever got committed in the meantime.
+    template<typename TFunction, typename TPublishFunction>
+    bool runExclusive(const TFunction& function, const TPublishFunction& publishFunction);
+};
+
+#include "MessageReservationQueue.inl"
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <cassert>
+#include <thread>
+
+template<typename T>
+typename MessageReservationQueue<T>::Slot& MessageReservationQueue<T>::getSlot(uint32_t index) const
+{
+    return m_slots[index & (m_capacity - 1)];
+}
+
+template<typename T>
+MessageReservationQueue<T>::MessageReservationQueue(std::atomic<uint32_t>& head, uint32_t capacity)
+    : m_head(head), m_capacity(capacity), m_slots(std::make_unique<Slot[]>(capacity))
+{
+    assert(capacity != 0 && (capacity & (capacity - 1)) == 0);
+}
+
+template<typename T>
+bool MessageReservationQueue<T>::canReserve() const
+{
+    return m_reserveIndex - m_publishIndex < m_capacity;
+}
+
+template<typename T>
+uint32_t MessageReservationQueue<T>::reserve(uint32_t offset, uint32_t byteSize, uint32_t end)
+{
+    assert(canReserve());
+
+    const uint32_t index = m_reserveIndex;
+    auto& reservation = getSlot(index).reservation;
+    reservation.offset = offset;
+    reservation.byteSize = byteSize;
+    reservation.end = end;
+
+    m_reserveIndex = index + 1;
+    return index;
+}
+
+template<typename T>
+T& MessageReservationQueue<T>::getData(uint32_t index) const
+{
+    return getSlot(index).reservation.data;
+}
+
+template<typename T>
+template<typename TFunction>
+bool MessageReservationQueue<T>::commit(uint32_t index, const TFunction& function)
+{
+    auto& slot = getSlot(index);
+    assert(!slot.committed);
+    slot.committed = true;
+
+    return publish(function);
+}
+
+template<typename T>
+template<typename TFunction>
+bool MessageReservationQueue<T>::publish(const TFunction& function)
+{
+    bool published = false;
+
+    // Whoever finds the token taken can count on the holder seeing its commit once it gives the token back.
+    while (getSlot(m_publishIndex).committed && !m_publishing.exchange(true))
+    {
+        // Another holder might have gotten to the front in the meantime.
+        const uint32_t firstIndex = m_publishIndex;
+        uint32_t index = firstIndex;
+        uint32_t end = 0;
+
+        for (auto* slot = &getSlot(index); slot->committed; slot = &getSlot(index))
+        {
+            function(slot->reservation);
+            end = slot->reservation.end;
+
+            // The slot can get reserved again right after the index moves past it.
+            slot->committed = false;
+            m_publishIndex = ++index;
+        }
+
+        if (index != firstIndex)
+        {
+            m_head = end;
+            published = true;
+        }
+
+        m_publishing = false;
+    }
+
+    return published;
+}
+
+template<typename T>
+template<typename TFunction, typename TPublishFunction>
+bool MessageReservationQueue<T>::runExclusive(const TFunction& function, const TPublishFunction& publishFunction)
+{
+    while (m_publishing.exchange(true))
+        std::this_thread::yield();
+
+    function();
+    m_publishing = false;
+
+    return publish(publishFunction);
+}
\ No newline at end of file
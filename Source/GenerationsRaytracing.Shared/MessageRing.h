@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "MessageQueue.h"
+
+// Both halves of the message queue ring, without any of the waiting or publishing, which is up to
+// the sender and the receiver. Offsets are relative to the start of the memory, the ring itself 
+// begins right after the MessageQueue header.
+class MessageRingWriter
+{
+protected:
+    uint8_t* m_memory;
+    uint32_t m_size;
+    uint32_t m_offset = sizeof(MessageQueue);
+
+    // Makes room for a MsgPadding when the offset isn't aligned already.
+    static uint32_t alignOffset(uint32_t offset, uint32_t alignment);
+
+public:
+    MessageRingWriter(uint8_t* memory, uint32_t size);
+
+    // One byte at the end of the ring is always kept free for MsgWrap.
+    static bool canAllocate(uint32_t size, uint32_t byteSize, uint32_t alignment);
+
+    uint32_t getOffset() const;
+
+    // Returns false when the consumer needs to make progress first. The writer might have wrapped around
+    // by then, so the caller needs to publish head before waiting for tail to change and trying again.
+    bool tryAllocate(uint32_t byteSize, uint32_t alignment, uint32_t tail, uint32_t& offset);
+};
+
+class MessageRingReader
+{
+protected:
+    const uint8_t* m_memory;
+
+public:
+    MessageRingReader(const uint8_t* memory);
+
+    // Returns whether there is a message at the offset, moving past MsgWrap if there is one.
+    bool hasNext(uint32_t head, uint32_t& offset) const;
+};
+
+#include "MessageRing.inl"
\ No newline at end of file
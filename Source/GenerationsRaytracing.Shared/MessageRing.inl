@@ -0,0 +1,80 @@
+#include "Message.h"
+
+inline MessageRingWriter::MessageRingWriter(uint8_t* memory, uint32_t size)
+    : m_memory(memory), m_size(size)
+{
+}
+
+inline uint32_t MessageRingWriter::alignOffset(uint32_t offset, uint32_t alignment)
+{
+    if ((offset & (alignment - 1)) != 0)
+    {
+        offset += offsetof(MsgPadding, data);
+        offset += alignment - 1;
+        offset &= ~(alignment - 1);
+    }
+    return offset;
+}
+
+inline bool MessageRingWriter::canAllocate(uint32_t size, uint32_t byteSize, uint32_t alignment)
+{
+    return alignOffset(sizeof(MessageQueue), alignment) + byteSize < size;
+}
+
+inline uint32_t MessageRingWriter::getOffset() const
+{
+    return m_offset;
+}
+
+inline bool MessageRingWriter::tryAllocate(uint32_t byteSize, uint32_t alignment, uint32_t tail, uint32_t& offset)
+{
+    uint32_t alignedOffset = alignOffset(m_offset, alignment);
+    if (alignedOffset + byteSize >= m_size)
+    {
+        // The consumer needs to be on the same lap for the start to be free, and it can't
+        // be at the start either, otherwise head catching up to it would look like an empty queue.
+        if (tail > m_offset || tail == sizeof(MessageQueue))
+            return false;
+
+        m_memory[m_offset] = MsgWrap::s_id;
+        m_offset = sizeof(MessageQueue);
+
+        alignedOffset = alignOffset(m_offset, alignment);
+    }
+
+    const uint32_t nextOffset = alignedOffset + byteSize;
+
+    // Tail being behind means the consumer is on the same lap, so we can write until the end.
+    if (tail > m_offset && nextOffset >= tail)
+        return false;
+
+    if (m_offset != alignedOffset)
+    {
+        const auto padding = reinterpret_cast<MsgPadding*>(&m_memory[m_offset]);
+        padding->id = MsgPadding::s_id;
+        padding->dataSize = static_cast<uint8_t>(alignedOffset - (m_offset + offsetof(MsgPadding, data)));
+    }
+
+    m_offset = nextOffset;
+    offset = alignedOffset;
+
+    return true;
+}
+
+inline MessageRingReader::MessageRingReader(const uint8_t* memory)
+    : m_memory(memory)
+{
+}
+
+inline bool MessageRingReader::hasNext(uint32_t head, uint32_t& offset) const
+{
+    while (offset != head)
+    {
+        if (m_memory[offset] != MsgWrap::s_id)
+            return true;
+
+        offset = sizeof(MessageQueue);
+    }
+
+    return false;
+}
\ No newline at end of file
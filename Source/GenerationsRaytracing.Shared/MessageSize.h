@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Message.h"
+
+template<typename T, typename = void>
+struct has_data_size : std::false_type {};
+
+template<typename T>
+struct has_data_size<T, std::void_t<decltype(T::dataSize)>> : std::true_type {};
+
+// Size of the message as x86 wrote it, including the data that trails it.
+template<typename T>
+uint32_t getMessageByteSize(const T* message);
+
+// Same as above for a message only known by its ID. Returns 0 for IDs that belong to no message.
+uint32_t getMessageByteSize(const uint8_t* message);
+
+#include "MessageSize.inl"
\ No newline at end of file
@@ -0,0 +1,77 @@
+template<typename T>
+uint32_t getMessageByteSize(const T* message)
+{
+    if constexpr (has_data_size<T>::value)
+        return static_cast<uint32_t>(offsetof(T, data) + message->dataSize);
+    else
+        return static_cast<uint32_t>(sizeof(T));
+}
+
+inline uint32_t getMessageByteSize(const uint8_t* message)
+{
+    switch (*message)
+    {
+    case MsgPadding::s_id: return getMessageByteSize(reinterpret_cast<const MsgPadding*>(message));
+    case MsgCreateSwapChain::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateSwapChain*>(message));
+    case MsgSetRenderTarget::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetRenderTarget*>(message));
+    case MsgCreateVertexDeclaration::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateVertexDeclaration*>(message));
+    case MsgCreatePixelShader::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreatePixelShader*>(message));
+    case MsgCreateVertexShader::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateVertexShader*>(message));
+    case MsgSetRenderState::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetRenderState*>(message));
+    case MsgCreateTexture::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateTexture*>(message));
+    case MsgSetTexture::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetTexture*>(message));
+    case MsgSetDepthStencilSurface::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetDepthStencilSurface*>(message));
+    case MsgClear::s_id: return getMessageByteSize(reinterpret_cast<const MsgClear*>(message));
+    case MsgSetVertexShader::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetVertexShader*>(message));
+    case MsgSetPixelShader::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetPixelShader*>(message));
+    case MsgSetPixelShaderConstantF::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetPixelShaderConstantF*>(message));
+    case MsgSetVertexShaderConstantF::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetVertexShaderConstantF*>(message));
+    case MsgSetVertexShaderConstantB::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetVertexShaderConstantB*>(message));
+    case MsgSetSamplerState::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetSamplerState*>(message));
+    case MsgSetViewport::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetViewport*>(message));
+    case MsgSetScissorRect::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetScissorRect*>(message));
+    case MsgSetVertexDeclaration::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetVertexDeclaration*>(message));
+    case MsgDrawPrimitiveUP::s_id: return getMessageByteSize(reinterpret_cast<const MsgDrawPrimitiveUP*>(message));
+    case MsgSetStreamSource::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetStreamSource*>(message));
+    case MsgSetIndices::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetIndices*>(message));
+    case MsgPresent::s_id: return getMessageByteSize(reinterpret_cast<const MsgPresent*>(message));
+    case MsgProcessWindowMessages::s_id: return getMessageByteSize(reinterpret_cast<const MsgProcessWindowMessages*>(message));
+    case MsgWaitOnSwapChain::s_id: return getMessageByteSize(reinterpret_cast<const MsgWaitOnSwapChain*>(message));
+    case MsgCreateVertexBuffer::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateVertexBuffer*>(message));
+    case MsgWriteVertexBuffer::s_id: return getMessageByteSize(reinterpret_cast<const MsgWriteVertexBuffer*>(message));
+    case MsgCreateIndexBuffer::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateIndexBuffer*>(message));
+    case MsgWriteIndexBuffer::s_id: return getMessageByteSize(reinterpret_cast<const MsgWriteIndexBuffer*>(message));
+    case MsgWriteTexture::s_id: return getMessageByteSize(reinterpret_cast<const MsgWriteTexture*>(message));
+    case MsgBeginMakeTexture::s_id: return getMessageByteSize(reinterpret_cast<const MsgBeginMakeTexture*>(message));
+    case MsgWriteMakeTextureChunk::s_id: return getMessageByteSize(reinterpret_cast<const MsgWriteMakeTextureChunk*>(message));
+    case MsgMakeTexture::s_id: return getMessageByteSize(reinterpret_cast<const MsgMakeTexture*>(message));
+    case MsgDrawIndexedPrimitive::s_id: return getMessageByteSize(reinterpret_cast<const MsgDrawIndexedPrimitive*>(message));
+    case MsgSetStreamSourceFreq::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetStreamSourceFreq*>(message));
+    case MsgReleaseResource::s_id: return getMessageByteSize(reinterpret_cast<const MsgReleaseResource*>(message));
+    case MsgDrawPrimitive::s_id: return getMessageByteSize(reinterpret_cast<const MsgDrawPrimitive*>(message));
+    case MsgCreateBottomLevelAccelStruct::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateBottomLevelAccelStruct*>(message));
+    case MsgReleaseRaytracingResource::s_id: return getMessageByteSize(reinterpret_cast<const MsgReleaseRaytracingResource*>(message));
+    case MsgCreateInstance::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateInstance*>(message));
+    case MsgTraceRays::s_id: return getMessageByteSize(reinterpret_cast<const MsgTraceRays*>(message));
+    case MsgCreateMaterial::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateMaterial*>(message));
+    case MsgComputePose::s_id: return getMessageByteSize(reinterpret_cast<const MsgComputePose*>(message));
+    case MsgBuildBottomLevelAccelStruct::s_id: return getMessageByteSize(reinterpret_cast<const MsgBuildBottomLevelAccelStruct*>(message));
+    case MsgCopyVertexBuffer::s_id: return getMessageByteSize(reinterpret_cast<const MsgCopyVertexBuffer*>(message));
+    case MsgRenderSky::s_id: return getMessageByteSize(reinterpret_cast<const MsgRenderSky*>(message));
+    case MsgCreateLocalLight::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreateLocalLight*>(message));
+    case MsgSetPixelShaderConstantB::s_id: return getMessageByteSize(reinterpret_cast<const MsgSetPixelShaderConstantB*>(message));
+    case MsgSaveShaderCache::s_id: return getMessageByteSize(reinterpret_cast<const MsgSaveShaderCache*>(message));
+    case MsgComputeSmoothNormal::s_id: return getMessageByteSize(reinterpret_cast<const MsgComputeSmoothNormal*>(message));
+    case MsgDrawIndexedPrimitiveUP::s_id: return getMessageByteSize(reinterpret_cast<const MsgDrawIndexedPrimitiveUP*>(message));
+    case MsgShowCursor::s_id: return getMessageByteSize(reinterpret_cast<const MsgShowCursor*>(message));
+    case MsgDispatchUpscaler::s_id: return getMessageByteSize(reinterpret_cast<const MsgDispatchUpscaler*>(message));
+    case MsgDrawIm3d::s_id: return getMessageByteSize(reinterpret_cast<const MsgDrawIm3d*>(message));
+    case MsgCopyHdrTexture::s_id: return getMessageByteSize(reinterpret_cast<const MsgCopyHdrTexture*>(message));
+    case MsgComputeGrassInstancer::s_id: return getMessageByteSize(reinterpret_cast<const MsgComputeGrassInstancer*>(message));
+    case MsgCreatePersistentInstance::s_id: return getMessageByteSize(reinterpret_cast<const MsgCreatePersistentInstance*>(message));
+    case MsgUpdatePersistentInstance::s_id: return getMessageByteSize(reinterpret_cast<const MsgUpdatePersistentInstance*>(message));
+    case MsgUpdatePersistentInstanceMaterials::s_id: return getMessageByteSize(reinterpret_cast<const MsgUpdatePersistentInstanceMaterials*>(message));
+    case MsgWrap::s_id: return getMessageByteSize(reinterpret_cast<const MsgWrap*>(message));
+    default: return 0;
+    }
+}
\ No newline at end of file
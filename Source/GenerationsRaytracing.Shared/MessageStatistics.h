@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Per message type counters for a single frame. Durations are in performance counter
+// ticks, which both processes share since they run on the same machine.
+struct MessageStatistics
+{
+    static constexpr uint32_t s_frameNum = 4;
+
+    uint32_t counts[256];
+    uint64_t byteSizes[256];
+    int64_t durations[256];
+
+    void add(uint8_t id, uint32_t byteSize, int64_t duration);
+    void accumulate(const MessageStatistics& other);
+    void reset();
+};
+
+#include "MessageStatistics.inl"
@@ -0,0 +1,23 @@
+#include <cstring>
+
+inline void MessageStatistics::add(uint8_t id, uint32_t byteSize, int64_t duration)
+{
+    ++counts[id];
+    byteSizes[id] += byteSize;
+    durations[id] += duration;
+}
+
+inline void MessageStatistics::accumulate(const MessageStatistics& other)
+{
+    for (size_t i = 0; i < sizeof(counts) / sizeof(*counts); i++)
+    {
+        counts[i] += other.counts[i];
+        byteSizes[i] += other.byteSizes[i];
+        durations[i] += other.durations[i];
+    }
+}
+
+inline void MessageStatistics::reset()
+{
+    memset(this, 0, sizeof(*this));
+}
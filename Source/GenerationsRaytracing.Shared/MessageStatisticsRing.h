@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+
+#include "MessageStatistics.h"
+
+// Hands the statistics of completed frames from x64 to x86 through shared memory. Every slot
+// is guarded by a sequence number derived from the frame it holds, which is odd while x64 is
+// writing to it. Readers copy a slot out and only keep the copy if the sequence number
+// matched the frame they asked for before and after copying.
+struct MessageStatisticsRing
+{
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        MessageStatistics statistics;
+    };
+
+    Slot slots[MessageStatistics::s_frameNum];
+
+    // Single writer only.
+    void publish(uint32_t frame, const MessageStatistics& statistics);
+
+    // Fails if the frame was not published yet, was overwritten by a later one, or is being written to.
+    bool tryRead(uint32_t frame, MessageStatistics& statistics) const;
+};
+
+#include "MessageStatisticsRing.inl"
\ No newline at end of file
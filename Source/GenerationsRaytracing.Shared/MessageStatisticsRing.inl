@@ -0,0 +1,27 @@
+#include <cstring>
+
+inline void MessageStatisticsRing::publish(uint32_t frame, const MessageStatistics& statistics)
+{
+    auto& slot = slots[frame % MessageStatistics::s_frameNum];
+
+    slot.sequence.store(frame * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(&slot.statistics, &statistics, sizeof(MessageStatistics));
+
+    slot.sequence.store(frame * 2 + 2, std::memory_order_release);
+}
+
+inline bool MessageStatisticsRing::tryRead(uint32_t frame, MessageStatistics& statistics) const
+{
+    const auto& slot = slots[frame % MessageStatistics::s_frameNum];
+    const uint32_t sequence = frame * 2 + 2;
+
+    if (slot.sequence.load(std::memory_order_acquire) != sequence)
+        return false;
+
+    memcpy(&statistics, &slot.statistics, sizeof(MessageStatistics));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Event.h"
+
+// Consumer side waiting for new messages. Spins for a short while before yielding, and eventually 
+// goes to sleep until the producer sets the event, which it only needs to do when the flag is set.
+class MessageWaiter
+{
+public:
+    static constexpr uint32_t s_spinCount = 4096;
+    static constexpr uint32_t s_yieldCount = 64;
+
+    template<typename T>
+    static void wait(std::atomic<bool>& sleeping, const Event& event, const T& hasNext);
+
+    // Needs to be called after publishing new messages.
+    static void notify(const std::atomic<bool>& sleeping, const Event& event);
+};
+
+#include "MessageWaiter.inl"
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include <immintrin.h>
+#include <thread>
+
+template<typename T>
+void MessageWaiter::wait(std::atomic<bool>& sleeping, const Event& event, const T& hasNext)
+{
+    for (uint32_t i = 0; i < s_spinCount; i++)
+    {
+        if (hasNext())
+            return;
+
+        _mm_pause();
+    }
+
+    for (uint32_t i = 0; i < s_yieldCount; i++)
+    {
+        if (hasNext())
+            return;
+
+        std::this_thread::yield();
+    }
+
+    // The producer checks the flag after publishing, so one of us is guaranteed to see the other's write.
+    sleeping = true;
+
+    while (!hasNext())
+        event.wait();
+
+    sleeping = false;
+}
+
+inline void MessageWaiter::notify(const std::atomic<bool>& sleeping, const Event& event)
+{
+    if (sleeping)
+        event.set();
+}
\ No newline at end of file
@@ -1,9 +1,19 @@
 #pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
 
 class Mutex : protected CRITICAL_SECTION
 {
+#else
+#include <mutex>
+
+class Mutex
+{
+protected:
+    std::mutex m_mutex;
+
+#endif
 public:
     Mutex();
     ~Mutex();
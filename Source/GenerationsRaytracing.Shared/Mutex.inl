@@ -1,4 +1,7 @@
 #include "Mutex.h"
+
+#ifdef _WIN32
+
 inline Mutex::Mutex()
 {
     InitializeCriticalSection(this);
@@ -24,4 +27,26 @@ inline bool Mutex::tryLock()
     return TryEnterCriticalSection(this) != FALSE;
 }
 
+#else
+
+inline Mutex::Mutex() = default;
+
+inline Mutex::~Mutex() = default;
+
+inline void Mutex::lock()
+{
+    m_mutex.lock();
+}
+
+inline void Mutex::unlock()
+{
+    m_mutex.unlock();
+}
+
+inline bool Mutex::tryLock()
+{
+    return m_mutex.try_lock();
+}
+
+#endif
 
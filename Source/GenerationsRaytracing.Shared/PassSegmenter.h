@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// Decides where the graphics work of a frame gets split into command lists that are submitted right
+// away, so the GPU starts on earlier passes while later ones are still being recorded. Splits only
+// happen at pass boundaries, once enough draw calls were recorded and while there are lists left.
+class PassSegmenter
+{
+protected:
+    uint32_t m_minDrawCount;
+    uint32_t m_maxSegmentCount;
+    uint32_t m_segmentIndex = 0;
+    uint32_t m_drawCount = 0;
+
+public:
+    PassSegmenter(uint32_t minDrawCount, uint32_t maxSegmentCount);
+
+    // Render target changes, MsgTraceRays and MsgDispatchUpscaler.
+    static bool isPassBoundary(uint8_t messageId);
+    // For segmenting captures. The device only counts the draw calls it doesn't skip.
+    static bool isDraw(uint8_t messageId);
+
+    void addDraw();
+
+    // Called at a pass boundary.
+    bool shouldSplit() const;
+    void split();
+
+    // Starts the next frame on the first segment.
+    void reset();
+
+    uint32_t getSegmentIndex() const;
+    uint32_t getDrawCount() const;
+};
+
+#include "PassSegmenter.inl"
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "Message.h"
+
+#include <cassert>
+
+inline PassSegmenter::PassSegmenter(uint32_t minDrawCount, uint32_t maxSegmentCount)
+    : m_minDrawCount(minDrawCount), m_maxSegmentCount(maxSegmentCount)
+{
+}
+
+inline bool PassSegmenter::isPassBoundary(uint8_t messageId)
+{
+    switch (messageId)
+    {
+    case MsgSetRenderTarget::s_id:
+    case MsgTraceRays::s_id:
+    case MsgDispatchUpscaler::s_id:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+inline bool PassSegmenter::isDraw(uint8_t messageId)
+{
+    switch (messageId)
+    {
+    case MsgDrawPrimitiveUP::s_id:
+    case MsgDrawIndexedPrimitive::s_id:
+    case MsgDrawPrimitive::s_id:
+    case MsgDrawIndexedPrimitiveUP::s_id:
+    case MsgDrawIm3d::s_id:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+inline void PassSegmenter::addDraw()
+{
+    ++m_drawCount;
+}
+
+inline bool PassSegmenter::shouldSplit() const
+{
+    return m_drawCount >= m_minDrawCount && m_segmentIndex + 1 < m_maxSegmentCount;
+}
+
+inline void PassSegmenter::split()
+{
+    assert(shouldSplit());
+
+    ++m_segmentIndex;
+    m_drawCount = 0;
+}
+
+inline void PassSegmenter::reset()
+{
+    m_segmentIndex = 0;
+    m_drawCount = 0;
+}
+
+inline uint32_t PassSegmenter::getSegmentIndex() const
+{
+    return m_segmentIndex;
+}
+
+inline uint32_t PassSegmenter::getDrawCount() const
+{
+    return m_drawCount;
+}
\ No newline at end of file
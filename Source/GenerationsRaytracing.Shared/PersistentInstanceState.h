@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// What needs to be told to x64 about persistent instances. x86 turns these into messages, the tests record them.
+class PersistentInstanceSink
+{
+public:
+    virtual ~PersistentInstanceSink() = default;
+
+    virtual uint32_t allocateInstanceId() = 0;
+
+    // Sends the whole instance including its material remaps, which replaces it on x64 if the ID is already in use.
+    virtual void createInstance(uint32_t instanceId, size_t instanceType, uint32_t bottomLevelAccelStructId) = 0;
+
+    // Sends the current transform and parameters.
+    virtual void updateInstance(uint32_t instanceId) = 0;
+
+    // Sends the current material remaps.
+    virtual void updateMaterials(uint32_t instanceId) = 0;
+
+    // Releases the instance on x64 and frees the ID.
+    virtual void releaseInstance(uint32_t instanceId) = 0;
+};
+
+// What was last sent to x64 for an object that has a persistent instance per instance type.
+// Lives inside game objects, so it needs to be reset by hand instead of constructed.
+// Anything besides the transform is only tracked by a hash the caller computes:
+// - parameters get sent along with the transform,
+// - material remaps get sent on their own,
+// - a layout change recreates every instance, for whatever x64 only reads on creation.
+template<size_t TypeNum>
+struct PersistentInstanceState
+{
+    uint32_t instanceIds[TypeNum];
+    uint32_t bottomLevelAccelStructIds[TypeNum];
+    float transform[3][4];
+    uint32_t parameterHash;
+    uint32_t materialHash;
+    uint32_t layoutHash;
+
+    void reset();
+
+    // Sends only what changed since the previous call. Instance types
+    // that lost their bottom level acceleration structure get released.
+    void update(const uint32_t (&newBottomLevelAccelStructIds)[TypeNum], const float (&newTransform)[3][4],
+        uint32_t newParameterHash, uint32_t newMaterialHash, uint32_t newLayoutHash, PersistentInstanceSink& sink);
+
+    void release(PersistentInstanceSink& sink);
+};
+
+#include "PersistentInstanceState.inl"
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <cstring>
+
+template<size_t TypeNum>
+void PersistentInstanceState<TypeNum>::reset()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+template<size_t TypeNum>
+void PersistentInstanceState<TypeNum>::update(const uint32_t (&newBottomLevelAccelStructIds)[TypeNum], const float (&newTransform)[3][4],
+    uint32_t newParameterHash, uint32_t newMaterialHash, uint32_t newLayoutHash, PersistentInstanceSink& sink)
+{
+    // The transform is compared bitwise so NaNs don't cause an update every frame.
+    const bool changed = memcmp(transform, newTransform, sizeof(transform)) != 0 || parameterHash != newParameterHash;
+    const bool materialsChanged = materialHash != newMaterialHash;
+    const bool layoutChanged = layoutHash != newLayoutHash;
+
+    for (size_t i = 0; i < TypeNum; i++)
+    {
+        auto& instanceId = instanceIds[i];
+        const uint32_t bottomLevelAccelStructId = newBottomLevelAccelStructIds[i];
+
+        if (bottomLevelAccelStructId == 0)
+        {
+            if (instanceId != 0)
+            {
+                sink.releaseInstance(instanceId);
+                instanceId = 0;
+            }
+        }
+        else if (instanceId == 0 || layoutChanged || bottomLevelAccelStructIds[i] != bottomLevelAccelStructId)
+        {
+            if (instanceId == 0)
+                instanceId = sink.allocateInstanceId();
+
+            sink.createInstance(instanceId, i, bottomLevelAccelStructId);
+        }
+        else
+        {
+            if (changed)
+                sink.updateInstance(instanceId);
+
+            if (materialsChanged)
+                sink.updateMaterials(instanceId);
+        }
+
+        bottomLevelAccelStructIds[i] = bottomLevelAccelStructId;
+    }
+
+    memcpy(transform, newTransform, sizeof(transform));
+    parameterHash = newParameterHash;
+    materialHash = newMaterialHash;
+    layoutHash = newLayoutHash;
+}
+
+template<size_t TypeNum>
+void PersistentInstanceState<TypeNum>::release(PersistentInstanceSink& sink)
+{
+    for (auto& instanceId : instanceIds)
+    {
+        if (instanceId != 0)
+        {
+            sink.releaseInstance(instanceId);
+            instanceId = 0;
+        }
+    }
+
+    memset(bottomLevelAccelStructIds, 0, sizeof(bottomLevelAccelStructIds));
+}
\ No newline at end of file
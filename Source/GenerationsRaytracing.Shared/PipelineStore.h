@@ -0,0 +1,101 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// The part that turns stored pipeline descs into pipelines. x64 implements it with D3D12, the tests with a fake.
+template<typename TPipeline>
+class PipelineCompiler
+{
+public:
+    virtual ~PipelineCompiler() = default;
+
+    // Called from the worker threads. Returns an empty pipeline if the desc fails to compile.
+    virtual TPipeline compilePipeline(const uint8_t* data, uint32_t dataSize) = 0;
+};
+
+enum class PipelineStatus
+{
+    Unknown,
+    Pending,
+    Compiling,
+    Ready,
+    Failed
+};
+
+#pragma pack(push, 1)
+// Records are stored back to back in a block, each followed by its serialized desc.
+struct PipelineRecordHeader
+{
+    uint64_t key;
+    uint32_t dataSize;
+};
+#pragma pack(pop)
+
+// Serialized pipeline descs keyed by their contents, compiled in the background by a pool of worker threads.
+// Descs loaded from disk get queued in the order they were stored, while ones needed by a draw call jump
+// the queue. The descs are copied into the store, so the callers can keep reusing their serialization buffers.
+template<typename TPipeline>
+class PipelineStore
+{
+protected:
+    struct Entry
+    {
+        const uint8_t* data = nullptr;
+        uint32_t dataSize = 0;
+        PipelineStatus status = PipelineStatus::Unknown;
+        TPipeline pipeline{};
+        std::list<uint64_t>::iterator queuePosition;
+    };
+
+    PipelineCompiler<TPipeline>& m_compiler;
+
+    std::vector<std::unique_ptr<uint8_t[]>> m_blocks;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    std::list<uint64_t> m_queue;
+    std::vector<uint64_t> m_newKeys;
+    size_t m_savedKeyCount = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_queueCondition;
+    std::condition_variable m_compiledCondition;
+    std::vector<std::thread> m_threads;
+    bool m_shouldExit = false;
+
+    Entry& emplace(uint64_t key, const uint8_t* data, uint32_t dataSize, bool& emplaced);
+    void compile(std::unique_lock<std::mutex>& lock, Entry& entry);
+    void runWorkerThread();
+
+public:
+    PipelineStore(PipelineCompiler<TPipeline>& compiler, uint32_t threadCount);
+    ~PipelineStore();
+
+    // Queues the records of a block read from disk, unless a record is out of bounds.
+    bool loadBlock(std::unique_ptr<uint8_t[]> block, uint32_t blockSize);
+
+    // Queues the desc ahead of everything else unless the key is known already. Returns false if it was.
+    bool addPipeline(uint64_t key, const uint8_t* data, uint32_t dataSize);
+
+    // Returns an empty pipeline while the pipeline is compiling or if it failed to compile. A pending pipeline
+    // is moved to the front of the queue, or compiled on the calling thread if async compilation is disabled.
+    TPipeline getPipeline(uint64_t key, bool async);
+
+    PipelineStatus getStatus(uint64_t key);
+
+    // Compiles the next pipeline in the queue on the calling thread. Returns false if the queue is empty.
+    bool compileNext();
+
+    // Serializes the pipelines added since the last save, except the ones that failed to compile.
+    // Returns false if there is nothing new to save.
+    bool saveBlock(std::vector<uint8_t>& block);
+
+    size_t getPendingCount();
+};
+
+#include "PipelineStore.inl"
\ No newline at end of file
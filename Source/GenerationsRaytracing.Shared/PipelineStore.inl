@@ -0,0 +1,226 @@
+#include <cassert>
+#include <cstring>
+
+template<typename TPipeline>
+typename PipelineStore<TPipeline>::Entry& PipelineStore<TPipeline>::emplace(uint64_t key, const uint8_t* data, uint32_t dataSize, bool& emplaced)
+{
+    auto& entry = m_entries[key];
+    emplaced = entry.status == PipelineStatus::Unknown;
+
+    if (emplaced)
+    {
+        entry.data = data;
+        entry.dataSize = dataSize;
+        entry.status = PipelineStatus::Pending;
+    }
+
+    return entry;
+}
+
+template<typename TPipeline>
+void PipelineStore<TPipeline>::compile(std::unique_lock<std::mutex>& lock, Entry& entry)
+{
+    assert(entry.status == PipelineStatus::Pending);
+
+    m_queue.erase(entry.queuePosition);
+    entry.status = PipelineStatus::Compiling;
+
+    lock.unlock();
+    TPipeline pipeline = m_compiler.compilePipeline(entry.data, entry.dataSize);
+    lock.lock();
+
+    entry.status = pipeline != nullptr ? PipelineStatus::Ready : PipelineStatus::Failed;
+    entry.pipeline = std::move(pipeline);
+
+    m_compiledCondition.notify_all();
+}
+
+template<typename TPipeline>
+void PipelineStore<TPipeline>::runWorkerThread()
+{
+    std::unique_lock lock(m_mutex);
+
+    while (true)
+    {
+        m_queueCondition.wait(lock, [&] { return m_shouldExit || !m_queue.empty(); });
+
+        if (m_shouldExit)
+            return;
+
+        compile(lock, m_entries.find(m_queue.front())->second);
+    }
+}
+
+template<typename TPipeline>
+PipelineStore<TPipeline>::PipelineStore(PipelineCompiler<TPipeline>& compiler, uint32_t threadCount) : m_compiler(compiler)
+{
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&PipelineStore::runWorkerThread, this);
+}
+
+template<typename TPipeline>
+PipelineStore<TPipeline>::~PipelineStore()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldExit = true;
+    }
+
+    m_queueCondition.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+template<typename TPipeline>
+bool PipelineStore<TPipeline>::loadBlock(std::unique_ptr<uint8_t[]> block, uint32_t blockSize)
+{
+    // Validate everything first so a truncated block doesn't leave half of its records behind.
+    uint32_t offset = 0;
+    while (offset < blockSize)
+    {
+        if (blockSize - offset < sizeof(PipelineRecordHeader))
+            return false;
+
+        PipelineRecordHeader header;
+        memcpy(&header, block.get() + offset, sizeof(PipelineRecordHeader));
+        offset += sizeof(PipelineRecordHeader);
+
+        if (header.dataSize == 0 || header.dataSize > blockSize - offset)
+            return false;
+
+        offset += header.dataSize;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        offset = 0;
+        while (offset < blockSize)
+        {
+            PipelineRecordHeader header;
+            memcpy(&header, block.get() + offset, sizeof(PipelineRecordHeader));
+            offset += sizeof(PipelineRecordHeader);
+
+            bool emplaced;
+            auto& entry = emplace(header.key, block.get() + offset, header.dataSize, emplaced);
+            if (emplaced)
+                entry.queuePosition = m_queue.insert(m_queue.end(), header.key);
+
+            offset += header.dataSize;
+        }
+
+        m_blocks.push_back(std::move(block));
+    }
+
+    m_queueCondition.notify_all();
+    return true;
+}
+
+template<typename TPipeline>
+bool PipelineStore<TPipeline>::addPipeline(uint64_t key, const uint8_t* data, uint32_t dataSize)
+{
+    assert(dataSize != 0);
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto findResult = m_entries.find(key);
+        if (findResult != m_entries.end())
+            return false;
+
+        auto& block = m_blocks.emplace_back(new uint8_t[dataSize]);
+        memcpy(block.get(), data, dataSize);
+
+        bool emplaced;
+        auto& entry = emplace(key, block.get(), dataSize, emplaced);
+        entry.queuePosition = m_queue.insert(m_queue.begin(), key);
+
+        m_newKeys.push_back(key);
+    }
+
+    m_queueCondition.notify_one();
+    return true;
+}
+
+template<typename TPipeline>
+TPipeline PipelineStore<TPipeline>::getPipeline(uint64_t key, bool async)
+{
+    std::unique_lock lock(m_mutex);
+
+    const auto findResult = m_entries.find(key);
+    if (findResult == m_entries.end())
+        return {};
+
+    auto& entry = findResult->second;
+
+    if (entry.status == PipelineStatus::Pending)
+    {
+        if (async)
+            m_queue.splice(m_queue.begin(), m_queue, entry.queuePosition);
+        else
+            compile(lock, entry);
+    }
+    else if (entry.status == PipelineStatus::Compiling && !async)
+    {
+        m_compiledCondition.wait(lock, [&] { return entry.status != PipelineStatus::Compiling; });
+    }
+
+    return entry.status == PipelineStatus::Ready ? entry.pipeline : TPipeline{};
+}
+
+template<typename TPipeline>
+PipelineStatus PipelineStore<TPipeline>::getStatus(uint64_t key)
+{
+    std::lock_guard lock(m_mutex);
+
+    const auto findResult = m_entries.find(key);
+    return findResult != m_entries.end() ? findResult->second.status : PipelineStatus::Unknown;
+}
+
+template<typename TPipeline>
+bool PipelineStore<TPipeline>::compileNext()
+{
+    std::unique_lock lock(m_mutex);
+
+    if (m_queue.empty())
+        return false;
+
+    compile(lock, m_entries.find(m_queue.front())->second);
+
+    return true;
+}
+
+template<typename TPipeline>
+bool PipelineStore<TPipeline>::saveBlock(std::vector<uint8_t>& block)
+{
+    std::lock_guard lock(m_mutex);
+
+    block.clear();
+
+    for (size_t i = m_savedKeyCount; i < m_newKeys.size(); i++)
+    {
+        const auto& entry = m_entries.find(m_newKeys[i])->second;
+        if (entry.status == PipelineStatus::Failed)
+            continue;
+
+        PipelineRecordHeader header;
+        header.key = m_newKeys[i];
+        header.dataSize = entry.dataSize;
+
+        const size_t offset = block.size();
+        block.resize(offset + sizeof(PipelineRecordHeader) + entry.dataSize);
+        memcpy(block.data() + offset, &header, sizeof(PipelineRecordHeader));
+        memcpy(block.data() + offset + sizeof(PipelineRecordHeader), entry.data, entry.dataSize);
+    }
+
+    m_savedKeyCount = m_newKeys.size();
+    return !block.empty();
+}
+
+template<typename TPipeline>
+size_t PipelineStore<TPipeline>::getPendingCount()
+{
+    std::lock_guard lock(m_mutex);
+    return m_queue.size();
+}
\ No newline at end of file
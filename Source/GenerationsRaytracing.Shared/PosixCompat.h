@@ -0,0 +1,11 @@
+#pragma once
+
+// The few Windows types the shared headers use in their interfaces, 
+// so that the transport can be built against its POSIX backend.
+typedef char TCHAR;
+typedef const char* LPCTSTR;
+typedef int BOOL;
+
+#define TEXT(x) x
+#define FALSE 0
+#define TRUE 1
\ No newline at end of file
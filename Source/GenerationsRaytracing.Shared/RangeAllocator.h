@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Two level segregated fit allocator for contiguous index ranges. Every range stores its size
+// at the first index and its beginning at the last index, so neighbours can be merged in constant time.
+class RangeAllocator
+{
+protected:
+    static constexpr uint32_t s_secondLevelLog2 = 4;
+    static constexpr uint32_t s_secondLevelNum = 1 << s_secondLevelLog2;
+    static constexpr uint32_t s_firstLevelNum = 32 - s_secondLevelLog2 + 1;
+    static constexpr uint32_t s_invalidIndex = ~0u;
+
+    struct Node
+    {
+        uint32_t size;
+        uint32_t begin;
+        uint32_t prevFree;
+        uint32_t nextFree;
+        bool free;
+    };
+
+    std::vector<Node> m_nodes;
+    uint32_t m_firstLevelBits = 0;
+    uint32_t m_secondLevelBits[s_firstLevelNum]{};
+    uint32_t m_freeHeads[s_firstLevelNum][s_secondLevelNum]{};
+
+    static void getLevels(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+    void setRange(uint32_t index, uint32_t size, bool free);
+    void insertFreeRange(uint32_t index);
+    void removeFreeRange(uint32_t index);
+
+public:
+    uint32_t allocate(uint32_t count);
+    void free(uint32_t index, uint32_t count);
+
+    // Shrinks when the last range gets freed.
+    uint32_t getCapacity() const;
+};
+
+#include "RangeAllocator.inl"
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "BitUtil.h"
+#include <cassert>
+
+inline void RangeAllocator::getLevels(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+    if (size < s_secondLevelNum)
+    {
+        firstLevel = 0;
+        secondLevel = size;
+    }
+    else
+    {
+        const uint32_t log2 = findLastSetBit(size);
+
+        firstLevel = log2 - s_secondLevelLog2 + 1;
+        secondLevel = (size >> (log2 - s_secondLevelLog2)) - s_secondLevelNum;
+    }
+}
+
+inline void RangeAllocator::setRange(uint32_t index, uint32_t size, bool free)
+{
+    m_nodes[index].size = size;
+    m_nodes[index].free = free;
+    m_nodes[index + size - 1].begin = index;
+}
+
+inline void RangeAllocator::insertFreeRange(uint32_t index)
+{
+    uint32_t firstLevel, secondLevel;
+    getLevels(m_nodes[index].size, firstLevel, secondLevel);
+
+    uint32_t& head = m_freeHeads[firstLevel][secondLevel];
+
+    if (m_secondLevelBits[firstLevel] & (1u << secondLevel))
+    {
+        m_nodes[head].prevFree = index;
+        m_nodes[index].nextFree = head;
+    }
+    else
+    {
+        m_nodes[index].nextFree = s_invalidIndex;
+    }
+
+    m_nodes[index].prevFree = s_invalidIndex;
+    head = index;
+
+    m_firstLevelBits |= 1u << firstLevel;
+    m_secondLevelBits[firstLevel] |= 1u << secondLevel;
+}
+
+inline void RangeAllocator::removeFreeRange(uint32_t index)
+{
+    uint32_t firstLevel, secondLevel;
+    getLevels(m_nodes[index].size, firstLevel, secondLevel);
+
+    const auto& node = m_nodes[index];
+
+    if (node.prevFree != s_invalidIndex)
+        m_nodes[node.prevFree].nextFree = node.nextFree;
+    else
+        m_freeHeads[firstLevel][secondLevel] = node.nextFree;
+
+    if (node.nextFree != s_invalidIndex)
+        m_nodes[node.nextFree].prevFree = node.prevFree;
+
+    if (node.prevFree == s_invalidIndex && node.nextFree == s_invalidIndex)
+    {
+        m_secondLevelBits[firstLevel] &= ~(1u << secondLevel);
+        if (m_secondLevelBits[firstLevel] == 0)
+            m_firstLevelBits &= ~(1u << firstLevel);
+    }
+}
+
+inline uint32_t RangeAllocator::allocate(uint32_t count)
+{
+    assert(count != 0);
+
+    // Round up to the next list so that any range found in it is guaranteed to fit.
+    uint32_t searchSize = count;
+    if (count >= s_secondLevelNum)
+    {
+        const uint32_t log2 = findLastSetBit(count);
+        searchSize += (1u << (log2 - s_secondLevelLog2)) - 1;
+    }
+
+    uint32_t firstLevel, secondLevel;
+    getLevels(searchSize, firstLevel, secondLevel);
+
+    uint32_t secondLevelBits = m_secondLevelBits[firstLevel] & (~0u << secondLevel);
+    if (secondLevelBits == 0)
+    {
+        const uint32_t firstLevelBits = firstLevel + 1 < 32 ? m_firstLevelBits & (~0u << (firstLevel + 1)) : 0;
+
+        // Nothing fits, append to the end.
+        if (firstLevelBits == 0)
+        {
+            const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.resize(m_nodes.size() + count);
+            setRange(index, count, false);
+            return index;
+        }
+
+        firstLevel = findFirstSetBit(firstLevelBits);
+        secondLevelBits = m_secondLevelBits[firstLevel];
+    }
+
+    const uint32_t index = m_freeHeads[firstLevel][findFirstSetBit(secondLevelBits)];
+    removeFreeRange(index);
+
+    // Take the end of the range to leave the beginning of the remnant intact.
+    const uint32_t remnant = m_nodes[index].size - count;
+    if (remnant > 0)
+    {
+        setRange(index, remnant, true);
+        insertFreeRange(index);
+    }
+
+    setRange(index + remnant, count, false);
+    return index + remnant;
+}
+
+inline void RangeAllocator::free(uint32_t index, uint32_t count)
+{
+    assert(index + count <= m_nodes.size() && m_nodes[index].size == count && !m_nodes[index].free);
+
+    const uint32_t next = index + count;
+
+    if (index > 0)
+    {
+        const uint32_t prev = m_nodes[index - 1].begin;
+        if (m_nodes[prev].free)
+        {
+            removeFreeRange(prev);
+            count += index - prev;
+            index = prev;
+        }
+    }
+
+    if (next < m_nodes.size() && m_nodes[next].free)
+    {
+        removeFreeRange(next);
+        count += m_nodes[next].size;
+    }
+
+    if (index + count == m_nodes.size())
+    {
+        m_nodes.resize(index);
+    }
+    else
+    {
+        setRange(index, count, true);
+        insertFreeRange(index);
+    }
+}
+
+inline uint32_t RangeAllocator::getCapacity() const
+{
+    return static_cast<uint32_t>(m_nodes.size());
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Whatever processes the messages of a capture for MessageReplayer. x64 plugs in the D3D12
+// device through it, HeadlessReplayBackend stands in for it where there is no GPU.
+class ReplayBackend
+{
+public:
+    virtual ~ReplayBackend() = default;
+
+    // Puts a block of bulk data where x86 had it, before any message referring to it gets processed.
+    virtual void writeBulkData(uint32_t offset, const uint8_t* data, uint32_t dataSize) = 0;
+
+    // Processes the message and returns how many bytes it took up.
+    virtual uint32_t processMessage(const uint8_t* message) = 0;
+};
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+template<typename TState>
+struct ResourceStates
+{
+    TState stateInitial;
+    TState stateBefore;
+    TState stateAfter;
+};
+
+// Tracks the states of resources while a command list gets recorded. Resources start in their initial
+// state, and transitions are batched until the next commit, which only reports the ones that change
+// anything. Closing returns every resource to its initial state, while splitting resolves the starting
+// states of the next segment to the ones this segment left behind. TMap maps resources to ResourceStates.
+template<typename TMap>
+class ResourceStateTracker
+{
+public:
+    using Resource = typename TMap::key_type;
+    using State = decltype(TMap::mapped_type::stateInitial);
+
+protected:
+    TMap m_resourceStates;
+
+public:
+    void transition(Resource resource, State stateInitial, State stateAfter);
+
+    // Calls the function with the resource, the state before and the state after for every due transition.
+    template<typename T>
+    void commit(const T& function);
+
+    // Makes the next commit return every resource to its initial state, for closing the command list.
+    void restoreInitialStates();
+    void clear();
+
+    // Hands the committed states over to the next segment, which needs to be empty.
+    void moveTo(ResourceStateTracker& next);
+
+    bool isEmpty() const;
+
+    // The state the resource is in once pending transitions are committed. Returns false if it isn't tracked.
+    bool getState(Resource resource, State& state) const;
+};
+
+#include "ResourceStateTracker.inl"
\ No newline at end of file
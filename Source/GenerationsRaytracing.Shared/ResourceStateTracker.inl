@@ -0,0 +1,71 @@
+#include <cassert>
+#include <utility>
+
+template<typename TMap>
+void ResourceStateTracker<TMap>::transition(Resource resource, State stateInitial, State stateAfter)
+{
+    const auto result = m_resourceStates.find(resource);
+
+    if (result != m_resourceStates.end())
+    {
+        assert(result->second.stateInitial == stateInitial);
+        result->second.stateAfter = stateAfter;
+    }
+    else
+    {
+        m_resourceStates.emplace(resource, ResourceStates<State>{ stateInitial, stateInitial, stateAfter });
+    }
+}
+
+template<typename TMap>
+template<typename T>
+void ResourceStateTracker<TMap>::commit(const T& function)
+{
+    for (auto& [resource, states] : m_resourceStates)
+    {
+        if (states.stateBefore != states.stateAfter)
+        {
+            function(resource, states.stateBefore, states.stateAfter);
+            states.stateBefore = states.stateAfter;
+        }
+    }
+}
+
+template<typename TMap>
+void ResourceStateTracker<TMap>::restoreInitialStates()
+{
+    for (auto& [resource, states] : m_resourceStates)
+        states.stateAfter = states.stateInitial;
+}
+
+template<typename TMap>
+void ResourceStateTracker<TMap>::clear()
+{
+    m_resourceStates.clear();
+}
+
+template<typename TMap>
+void ResourceStateTracker<TMap>::moveTo(ResourceStateTracker& next)
+{
+    assert(&next != this && next.m_resourceStates.empty());
+
+    next.m_resourceStates = std::move(m_resourceStates);
+    m_resourceStates.clear();
+}
+
+template<typename TMap>
+bool ResourceStateTracker<TMap>::isEmpty() const
+{
+    return m_resourceStates.empty();
+}
+
+template<typename TMap>
+bool ResourceStateTracker<TMap>::getState(Resource resource, State& state) const
+{
+    const auto result = m_resourceStates.find(resource);
+    if (result == m_resourceStates.end())
+        return false;
+
+    state = result->second.stateAfter;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+// The part of the GPU the scratch buffer scheduler talks to. x64 implements it with D3D12, the tests with a mock.
+class ScratchBufferRecorder
+{
+public:
+    virtual ~ScratchBufferRecorder() = default;
+
+    // Replaces the pool of the frame, which the GPU is done with by then. Returns its GPU address.
+    virtual uint64_t createPoolBuffer(uint32_t frame, uint32_t byteSize) = 0;
+
+    // For builds that do not fit to the pool. Needs to live until the frame begins again.
+    virtual uint64_t createTempBuffer(uint32_t frame, uint32_t byteSize) = 0;
+    virtual void releaseTempBuffers(uint32_t frame) = 0;
+
+    // Makes everything recorded after it wait for the builds using the pool so far.
+    virtual void recordPoolBarrier(uint32_t frame) = 0;
+};
+
+// Packs acceleration structure build scratch memory into a pool per frame. Builds in the pool run back to back,
+// and only once it fills up, a single barrier ends the batch before starting over from the beginning of the pool.
+// The pool is sized after a slowly decaying peak of demand, so stage loads that build a lot need fewer batches.
+template<uint32_t FrameNum>
+class ScratchBufferScheduler
+{
+protected:
+    ScratchBufferRecorder& m_recorder;
+    uint32_t m_minByteSize;
+    uint32_t m_maxByteSize;
+    uint32_t m_alignment;
+    uint32_t m_granularity;
+
+    uint64_t m_poolAddresses[FrameNum]{};
+    uint32_t m_poolByteSizes[FrameNum]{};
+    uint32_t m_frame = 0;
+    uint32_t m_offset = 0;
+    uint32_t m_batchCount = 0;
+    uint64_t m_demand = 0;
+    uint64_t m_peak = 0;
+
+public:
+    ScratchBufferScheduler(ScratchBufferRecorder& recorder, uint32_t minByteSize,
+        uint32_t maxByteSize, uint32_t alignment, uint32_t granularity);
+
+    // Needs to be called once the GPU is done with the frame, including the first one.
+    void beginFrame(uint32_t frame);
+
+    uint64_t allocate(uint32_t byteSize);
+
+    uint32_t getPoolByteSize() const;
+    uint32_t getOffset() const;
+    // Barriers recorded by the frame so far.
+    uint32_t getBatchCount() const;
+    uint64_t getPeak() const;
+};
+
+#include "ScratchBufferScheduler.inl"
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cassert>
+
+template<uint32_t FrameNum>
+ScratchBufferScheduler<FrameNum>::ScratchBufferScheduler(ScratchBufferRecorder& recorder, uint32_t minByteSize,
+    uint32_t maxByteSize, uint32_t alignment, uint32_t granularity)
+    : m_recorder(recorder), m_minByteSize(minByteSize), m_maxByteSize(maxByteSize), m_alignment(alignment), m_granularity(granularity)
+{
+    assert(minByteSize <= maxByteSize && alignment != 0 && granularity != 0);
+}
+
+template<uint32_t FrameNum>
+void ScratchBufferScheduler<FrameNum>::beginFrame(uint32_t frame)
+{
+    assert(frame < FrameNum);
+
+    m_frame = frame;
+    m_offset = 0;
+    m_batchCount = 0;
+    m_recorder.releaseTempBuffers(frame);
+
+    // Let the peak decay slowly to give the memory back after a stage load.
+    m_peak = std::max(m_demand, m_peak - m_peak / 64);
+    m_demand = 0;
+
+    const uint64_t peak = (m_peak + m_granularity - 1) / m_granularity * m_granularity;
+    const uint32_t byteSize = static_cast<uint32_t>(std::clamp<uint64_t>(peak, m_minByteSize, m_maxByteSize));
+
+    // Shrink lazily to avoid recreating the pool back and forth.
+    if (byteSize > m_poolByteSizes[frame] || byteSize < m_poolByteSizes[frame] / 2)
+    {
+        m_poolAddresses[frame] = m_recorder.createPoolBuffer(frame, byteSize);
+        m_poolByteSizes[frame] = byteSize;
+    }
+}
+
+template<uint32_t FrameNum>
+uint64_t ScratchBufferScheduler<FrameNum>::allocate(uint32_t byteSize)
+{
+    byteSize = (byteSize + m_alignment - 1) / m_alignment * m_alignment;
+    m_demand += byteSize;
+
+    if (byteSize > m_poolByteSizes[m_frame])
+        return m_recorder.createTempBuffer(m_frame, byteSize);
+
+    if (m_offset + byteSize > m_poolByteSizes[m_frame])
+    {
+        m_recorder.recordPoolBarrier(m_frame);
+        m_offset = 0;
+        ++m_batchCount;
+    }
+
+    const uint64_t address = m_poolAddresses[m_frame] + m_offset;
+    m_offset += byteSize;
+
+    return address;
+}
+
+template<uint32_t FrameNum>
+uint32_t ScratchBufferScheduler<FrameNum>::getPoolByteSize() const
+{
+    return m_poolByteSizes[m_frame];
+}
+
+template<uint32_t FrameNum>
+uint32_t ScratchBufferScheduler<FrameNum>::getOffset() const
+{
+    return m_offset;
+}
+
+template<uint32_t FrameNum>
+uint32_t ScratchBufferScheduler<FrameNum>::getBatchCount() const
+{
+    return m_batchCount;
+}
+
+template<uint32_t FrameNum>
+uint64_t ScratchBufferScheduler<FrameNum>::getPeak() const
+{
+    return m_peak;
+}
\ No newline at end of file
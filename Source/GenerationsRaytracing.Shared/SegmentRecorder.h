@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Finishes recording segments of a frame on worker threads while the render thread carries on with the next
+// one. Segments get picked up as soon as they are pushed and can finish in any order, but submit hands them
+// back in push order, so the queue sees them exactly as if the render thread recorded them. Calls record()
+// on the segment, which can't touch anything the render thread keeps using. Without threads, push records right away.
+template<typename T>
+class SegmentRecorder
+{
+protected:
+    struct Job
+    {
+        T* segment;
+        bool recorded;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_pushCondition;
+    std::condition_variable m_recordCondition;
+    std::vector<std::thread> m_threads;
+    bool m_shouldExit = false;
+
+    // In push order, the ones before the next index are taken by workers.
+    std::deque<Job> m_jobs;
+    size_t m_nextJobIndex = 0;
+
+    void runWorkerThread();
+
+public:
+    explicit SegmentRecorder(uint32_t threadCount);
+    ~SegmentRecorder();
+
+    void push(T& segment);
+
+    // Waits for every pushed segment in order and calls the function with it.
+    template<typename TFunction>
+    void submit(const TFunction& function);
+
+    bool isEmpty();
+};
+
+#include "SegmentRecorder.inl"
\ No newline at end of file
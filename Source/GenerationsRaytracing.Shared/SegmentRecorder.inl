@@ -0,0 +1,94 @@
+template<typename T>
+void SegmentRecorder<T>::runWorkerThread()
+{
+    std::unique_lock lock(m_mutex);
+
+    while (true)
+    {
+        m_pushCondition.wait(lock, [&] { return m_shouldExit || m_nextJobIndex < m_jobs.size(); });
+
+        if (m_shouldExit)
+            return;
+
+        // Only submit removes jobs, and only once they are recorded.
+        auto& job = m_jobs[m_nextJobIndex];
+        ++m_nextJobIndex;
+
+        lock.unlock();
+        job.segment->record();
+        lock.lock();
+
+        job.recorded = true;
+        m_recordCondition.notify_all();
+    }
+}
+
+template<typename T>
+SegmentRecorder<T>::SegmentRecorder(uint32_t threadCount)
+{
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&SegmentRecorder::runWorkerThread, this);
+}
+
+template<typename T>
+SegmentRecorder<T>::~SegmentRecorder()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldExit = true;
+    }
+
+    m_pushCondition.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+template<typename T>
+void SegmentRecorder<T>::push(T& segment)
+{
+    if (m_threads.empty())
+    {
+        segment.record();
+
+        std::lock_guard lock(m_mutex);
+        m_jobs.push_back({ &segment, true });
+        ++m_nextJobIndex;
+    }
+    else
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back({ &segment, false });
+        }
+
+        m_pushCondition.notify_one();
+    }
+}
+
+template<typename T>
+template<typename TFunction>
+void SegmentRecorder<T>::submit(const TFunction& function)
+{
+    std::unique_lock lock(m_mutex);
+
+    while (!m_jobs.empty())
+    {
+        m_recordCondition.wait(lock, [&] { return m_jobs.front().recorded; });
+
+        T* segment = m_jobs.front().segment;
+        m_jobs.pop_front();
+        --m_nextJobIndex;
+
+        lock.unlock();
+        function(*segment);
+        lock.lock();
+    }
+}
+
+template<typename T>
+bool SegmentRecorder<T>::isEmpty()
+{
+    std::lock_guard lock(m_mutex);
+    return m_jobs.empty();
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#define SHADER_CACHE_SIGNATURE 0x43535247 // GRSC
+#define SHADER_CACHE_VERSION 1
+
+#pragma pack(push, 1)
+struct ShaderCacheFileHeader
+{
+    uint32_t signature;
+    uint32_t version;
+    uint32_t entryCount;
+};
+
+// Sorted by hash, followed by the compressed data of every entry.
+struct ShaderCacheEntry
+{
+    uint64_t hash;
+    uint32_t offset;
+    uint32_t compressedSize;
+    uint32_t uncompressedSize;
+};
+
+// The previous format, a sequence of compressed blocks holding shaders back to back.
+struct ShaderCacheBlockHeader
+{
+    uint32_t version;
+    uint32_t uncompressedSize;
+    uint32_t compressedSize;
+};
+
+struct ShaderCacheBlockShader
+{
+    uint64_t hash;
+    uint32_t dataSize;
+};
+#pragma pack(pop)
+
+struct CompressedShader
+{
+    uint64_t hash;
+    const uint8_t* data;
+    uint32_t compressedSize;
+    uint32_t uncompressedSize;
+};
+
+// Read only view of a shader cache file in memory. Opening it only checks the header, entries are
+// bounds checked once looked up, so the cost of opening doesn't grow with the size of the file.
+// The compression itself is up to the caller, the tests store the shaders uncompressed.
+class ShaderCacheIndex
+{
+protected:
+    const uint8_t* m_data = nullptr;
+    size_t m_dataSize = 0;
+    const ShaderCacheEntry* m_entries = nullptr;
+    uint32_t m_entryCount = 0;
+
+public:
+    // Returns false if the data is not a shader cache file of the current version.
+    bool open(const uint8_t* data, size_t dataSize);
+    void close();
+    bool isOpen() const;
+
+    // Returns null if the hash is missing or its data lies outside of the file.
+    const ShaderCacheEntry* find(uint64_t hash) const;
+    const uint8_t* getCompressedData(const ShaderCacheEntry& entry) const;
+    uint32_t getEntryCount() const;
+
+    // Appends every entry with valid bounds, so they can be written again without recompressing them.
+    void getShaders(std::vector<CompressedShader>& shaders) const;
+
+    // Sorts the shaders by hash and writes them as a new file. Duplicate hashes keep their first shader.
+    static bool write(FILE* file, std::vector<CompressedShader>& shaders);
+
+    // Calls the function with the hash, data and size of every shader in an uncompressed block of the
+    // previous format. Returns false without calling it at all if a shader is out of bounds.
+    template<typename T>
+    static bool forEachBlockShader(const uint8_t* block, uint32_t blockSize, const T& function);
+};
+
+#include "ShaderCacheIndex.inl"
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstring>
+
+inline bool ShaderCacheIndex::open(const uint8_t* data, size_t dataSize)
+{
+    close();
+
+    if (dataSize < sizeof(ShaderCacheFileHeader))
+        return false;
+
+    ShaderCacheFileHeader fileHeader;
+    memcpy(&fileHeader, data, sizeof(ShaderCacheFileHeader));
+
+    if (fileHeader.signature != SHADER_CACHE_SIGNATURE || fileHeader.version != SHADER_CACHE_VERSION ||
+        (dataSize - sizeof(ShaderCacheFileHeader)) / sizeof(ShaderCacheEntry) < fileHeader.entryCount)
+    {
+        return false;
+    }
+
+    m_data = data;
+    m_dataSize = dataSize;
+    m_entries = reinterpret_cast<const ShaderCacheEntry*>(data + sizeof(ShaderCacheFileHeader));
+    m_entryCount = fileHeader.entryCount;
+
+    return true;
+}
+
+inline void ShaderCacheIndex::close()
+{
+    m_data = nullptr;
+    m_dataSize = 0;
+    m_entries = nullptr;
+    m_entryCount = 0;
+}
+
+inline bool ShaderCacheIndex::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+inline const ShaderCacheEntry* ShaderCacheIndex::find(uint64_t hash) const
+{
+    const auto entriesEnd = m_entries + m_entryCount;
+
+    const auto entry = std::lower_bound(m_entries, entriesEnd, hash,
+        [](const ShaderCacheEntry& entry, uint64_t hash) { return entry.hash < hash; });
+
+    if (entry == entriesEnd || entry->hash != hash || entry->offset > m_dataSize || 
+        entry->compressedSize > m_dataSize - entry->offset)
+    {
+        return nullptr;
+    }
+
+    return entry;
+}
+
+inline const uint8_t* ShaderCacheIndex::getCompressedData(const ShaderCacheEntry& entry) const
+{
+    return m_data + entry.offset;
+}
+
+inline uint32_t ShaderCacheIndex::getEntryCount() const
+{
+    return m_entryCount;
+}
+
+inline void ShaderCacheIndex::getShaders(std::vector<CompressedShader>& shaders) const
+{
+    for (uint32_t i = 0; i < m_entryCount; i++)
+    {
+        const auto& entry = m_entries[i];
+
+        if (entry.offset <= m_dataSize && entry.compressedSize <= m_dataSize - entry.offset)
+            shaders.push_back({ entry.hash, m_data + entry.offset, entry.compressedSize, entry.uncompressedSize });
+    }
+}
+
+inline bool ShaderCacheIndex::write(FILE* file, std::vector<CompressedShader>& shaders)
+{
+    std::stable_sort(shaders.begin(), shaders.end(), [](const auto& lhs, const auto& rhs) { return lhs.hash < rhs.hash; });
+    shaders.erase(std::unique(shaders.begin(), shaders.end(), [](const auto& lhs, const auto& rhs) { return lhs.hash == rhs.hash; }), shaders.end());
+
+    ShaderCacheFileHeader fileHeader{};
+    fileHeader.signature = SHADER_CACHE_SIGNATURE;
+    fileHeader.version = SHADER_CACHE_VERSION;
+    fileHeader.entryCount = static_cast<uint32_t>(shaders.size());
+
+    if (fwrite(&fileHeader, sizeof(ShaderCacheFileHeader), 1, file) != 1)
+        return false;
+
+    uint64_t offset = sizeof(ShaderCacheFileHeader) + shaders.size() * sizeof(ShaderCacheEntry);
+
+    for (const auto& shader : shaders)
+    {
+        // Offsets are 32-bit.
+        if (offset + shader.compressedSize > UINT32_MAX)
+            return false;
+
+        const ShaderCacheEntry entry{ shader.hash, static_cast<uint32_t>(offset), shader.compressedSize, shader.uncompressedSize };
+        if (fwrite(&entry, sizeof(ShaderCacheEntry), 1, file) != 1)
+            return false;
+
+        offset += shader.compressedSize;
+    }
+
+    for (const auto& shader : shaders)
+    {
+        if (fwrite(shader.data, 1, shader.compressedSize, file) != shader.compressedSize)
+            return false;
+    }
+
+    return true;
+}
+
+template<typename T>
+bool ShaderCacheIndex::forEachBlockShader(const uint8_t* block, uint32_t blockSize, const T& function)
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        uint32_t offset = 0;
+
+        while (offset < blockSize)
+        {
+            if (blockSize - offset < sizeof(ShaderCacheBlockShader))
+                return false;
+
+            ShaderCacheBlockShader shader;
+            memcpy(&shader, block + offset, sizeof(ShaderCacheBlockShader));
+            offset += sizeof(ShaderCacheBlockShader);
+
+            if (shader.dataSize > blockSize - offset)
+                return false;
+
+            if (pass != 0)
+                function(shader.hash, block + offset, shader.dataSize);
+
+            offset += shader.dataSize;
+        }
+    }
+
+    return true;
+}
\ No newline at end of file
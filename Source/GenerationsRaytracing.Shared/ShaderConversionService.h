@@ -0,0 +1,100 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// The part that finds and converts DX9 shaders. x64 implements it with the shader cache files
+// and the unmanaged shader converter library, the tests with a mock.
+class ShaderConversionBackend
+{
+public:
+    virtual ~ShaderConversionBackend() = default;
+
+    // Returns null if the shader isn't in any of the cache files.
+    virtual const uint8_t* findCachedShader(uint64_t hash, uint32_t& dataSize) = 0;
+
+    // Called before the first conversion gets queued.
+    virtual void loadConverter() = 0;
+
+    // Called from the worker threads. Returns a handle to the converted shader, or null if the conversion failed.
+    virtual void* convertShader(const void* data, uint32_t dataSize, uint32_t& convertedSize) = 0;
+    virtual const uint8_t* getConvertedData(void* handle) = 0;
+    virtual void freeConvertedShader(void* handle) = 0;
+};
+
+struct ConvertedShader
+{
+    uint64_t hash;
+    void* handle;
+    uint32_t dataSize;
+};
+
+// Converts shaders missing from the cache files on a pool of worker threads. Shaders get queued as soon
+// as the game creates them, so most of them are ready by their first draw call. A shader created several
+// times is only converted once, and draw calls using a shader that isn't ready yet need to be skipped.
+class ShaderConversionService
+{
+protected:
+    struct Shader
+    {
+        const uint8_t* data = nullptr;
+        uint32_t dataSize = 0;
+        bool pending = false;
+        bool failed = false;
+    };
+
+    struct Job
+    {
+        uint64_t hash;
+        std::unique_ptr<uint8_t[]> data;
+        uint32_t dataSize;
+    };
+
+    ShaderConversionBackend& m_backend;
+    bool m_converterLoaded = false;
+
+    // Only accessed by the render thread.
+    std::unordered_map<uint64_t, Shader> m_shaders;
+    std::vector<ConvertedShader> m_convertedShaders;
+    size_t m_pendingCount = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Job> m_jobs;
+    std::vector<ConvertedShader> m_finishedShaders;
+    std::vector<std::thread> m_threads;
+    bool m_shouldExit = false;
+
+    void loadConverter();
+    void convert(Job& job);
+    void addConvertedShader(const ConvertedShader& convertedShader);
+    void collectConvertedShaders();
+    void runWorkerThread();
+
+public:
+    ShaderConversionService(ShaderConversionBackend& backend, uint32_t threadCount);
+    ~ShaderConversionService();
+
+    // Returns null while the shader is being converted or if it failed to convert, in which case
+    // getConvertedShader needs to be polled. The data gets copied, so the caller can reuse its memory.
+    const uint8_t* getShader(uint64_t hash, const void* data, uint32_t dataSize, uint32_t& convertedSize, bool async);
+
+    // Returns null if the shader isn't ready.
+    const uint8_t* getConvertedShader(uint64_t hash, uint32_t& convertedSize);
+
+    // Converts the next queued shader on the calling thread. Returns false if the queue is empty.
+    bool convertNext();
+
+    // Shaders converted this session in the order they became ready, for saving them to the cache files.
+    const std::vector<ConvertedShader>& getConvertedShaders();
+
+    size_t getPendingCount();
+};
+
+#include "ShaderConversionService.inl"
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include <cassert>
+#include <cstring>
+
+inline void ShaderConversionService::loadConverter()
+{
+    if (!m_converterLoaded)
+    {
+        m_backend.loadConverter();
+        m_converterLoaded = true;
+    }
+}
+
+inline void ShaderConversionService::convert(Job& job)
+{
+    ConvertedShader convertedShader{};
+    convertedShader.hash = job.hash;
+    convertedShader.handle = m_backend.convertShader(job.data.get(), job.dataSize, convertedShader.dataSize);
+
+    std::lock_guard lock(m_mutex);
+    m_finishedShaders.push_back(convertedShader);
+}
+
+inline void ShaderConversionService::addConvertedShader(const ConvertedShader& convertedShader)
+{
+    auto& shader = m_shaders[convertedShader.hash];
+
+    if (convertedShader.handle != nullptr)
+    {
+        shader.data = m_backend.getConvertedData(convertedShader.handle);
+        shader.dataSize = convertedShader.dataSize;
+        m_convertedShaders.push_back(convertedShader);
+    }
+    else
+    {
+        // Draw calls using it keep getting skipped, but it doesn't get converted over and over again.
+        shader.failed = true;
+    }
+}
+
+inline void ShaderConversionService::collectConvertedShaders()
+{
+    if (m_pendingCount == 0)
+        return;
+
+    std::lock_guard lock(m_mutex);
+
+    for (const auto& convertedShader : m_finishedShaders)
+    {
+        m_shaders[convertedShader.hash].pending = false;
+        addConvertedShader(convertedShader);
+        --m_pendingCount;
+    }
+
+    m_finishedShaders.clear();
+}
+
+inline void ShaderConversionService::runWorkerThread()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [&] { return m_shouldExit || !m_jobs.empty(); });
+
+            if (m_shouldExit)
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        convert(job);
+    }
+}
+
+inline ShaderConversionService::ShaderConversionService(ShaderConversionBackend& backend, uint32_t threadCount)
+    : m_backend(backend)
+{
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&ShaderConversionService::runWorkerThread, this);
+}
+
+inline ShaderConversionService::~ShaderConversionService()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldExit = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+
+    for (const auto& convertedShader : m_finishedShaders)
+    {
+        if (convertedShader.handle != nullptr)
+            m_backend.freeConvertedShader(convertedShader.handle);
+    }
+
+    for (const auto& convertedShader : m_convertedShaders)
+        m_backend.freeConvertedShader(convertedShader.handle);
+}
+
+inline const uint8_t* ShaderConversionService::getShader(uint64_t hash, const void* data, uint32_t dataSize, uint32_t& convertedSize, bool async)
+{
+    collectConvertedShaders();
+
+    auto& shader = m_shaders[hash];
+
+    if (shader.data == nullptr && !shader.pending && !shader.failed)
+    {
+        shader.data = m_backend.findCachedShader(hash, shader.dataSize);
+
+        if (shader.data == nullptr)
+        {
+            loadConverter();
+
+            if (async)
+            {
+                // The message memory gets reused, keep a copy until the conversion is done.
+                Job job;
+                job.hash = hash;
+                job.data = std::make_unique<uint8_t[]>(dataSize);
+                job.dataSize = dataSize;
+                memcpy(job.data.get(), data, dataSize);
+
+                shader.pending = true;
+                ++m_pendingCount;
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_jobs.push_back(std::move(job));
+                }
+
+                m_condition.notify_one();
+            }
+            else
+            {
+                ConvertedShader convertedShader{};
+                convertedShader.hash = hash;
+                convertedShader.handle = m_backend.convertShader(data, dataSize, convertedShader.dataSize);
+                addConvertedShader(convertedShader);
+            }
+        }
+    }
+
+    convertedSize = shader.dataSize;
+    return shader.data;
+}
+
+inline const uint8_t* ShaderConversionService::getConvertedShader(uint64_t hash, uint32_t& convertedSize)
+{
+    collectConvertedShaders();
+
+    const auto findResult = m_shaders.find(hash);
+    if (findResult == m_shaders.end())
+    {
+        convertedSize = 0;
+        return nullptr;
+    }
+
+    convertedSize = findResult->second.dataSize;
+    return findResult->second.data;
+}
+
+inline bool ShaderConversionService::convertNext()
+{
+    Job job;
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (m_jobs.empty())
+            return false;
+
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+    }
+
+    convert(job);
+    return true;
+}
+
+inline const std::vector<ConvertedShader>& ShaderConversionService::getConvertedShaders()
+{
+    collectConvertedShaders();
+    return m_convertedShaders;
+}
+
+inline size_t ShaderConversionService::getPendingCount()
+{
+    collectConvertedShaders();
+    return m_pendingCount;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#define SIZE_CLASS_NUM 3
+#define MAX_DEFRAGMENTATION_FRAMES 64
+
+// Decides which block every sub-allocation goes to, independent of the GPU resources backing the blocks.
+// The virtual block type needs create, allocate, free and isEmpty, see CpuVirtualBlock.
+template<typename TVirtualBlock>
+class SubAllocatorPolicy
+{
+public:
+    struct Allocation
+    {
+        // Zero if nothing was allocated.
+        uint64_t handle = 0;
+        uint32_t blockIndex = 0;
+        uint32_t byteOffset = 0;
+        uint32_t byteSize = 0;
+    };
+
+protected:
+    struct Block
+    {
+        TVirtualBlock virtualBlock;
+        bool isCreated = false;
+        uint32_t sizeClass = 0;
+        uint32_t usedSize = 0;
+        // Position in the free block index of the size class, or ~0 if the block is not in it.
+        uint32_t freeBlockPosition = ~0u;
+    };
+
+    std::vector<Block> m_blocks;
+    // Blocks of each size class that are not known to be full.
+    std::vector<uint32_t> m_freeBlockIndices[SIZE_CLASS_NUM];
+    uint32_t m_defragmentationBlockIndex = ~0u;
+    uint32_t m_defragmentationFrames = 0;
+    uint32_t m_blockSize;
+    uint32_t m_alignment;
+
+    void addFreeBlock(uint32_t blockIndex);
+    void removeFreeBlock(uint32_t blockIndex);
+
+public:
+    SubAllocatorPolicy(uint32_t blockSize, uint32_t alignment);
+
+    // Allocations this large should get a resource of their own instead.
+    bool isDedicated(uint32_t byteSize) const;
+    uint32_t getSizeClass(uint32_t byteSize) const;
+
+    // Sets createdBlock if the allocation went to a new block, whose resource the caller needs to create.
+    Allocation allocate(uint32_t byteSize, bool& createdBlock);
+    void free(const Allocation& allocation);
+
+    // Calls the function with the index of every block that became empty, so the caller can release its resource.
+    template<typename T>
+    void freeBlocks(const T& function);
+
+    // Picks a sparse block whose allocations should be moved elsewhere so it can be freed.
+    // The block receives no new allocations until it becomes empty or the attempt times out.
+    uint32_t getDefragmentationBlockIndex();
+
+    uint32_t getBlockCount() const;
+    bool isBlockCreated(uint32_t blockIndex) const;
+    uint32_t getUsedSize(uint32_t blockIndex) const;
+    size_t getFreeBlockCount(uint32_t sizeClass) const;
+    const TVirtualBlock& getVirtualBlock(uint32_t blockIndex) const;
+};
+
+#include "SubAllocatorPolicy.inl"
\ No newline at end of file
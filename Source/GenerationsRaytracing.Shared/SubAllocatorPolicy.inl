@@ -0,0 +1,229 @@
+#include <cassert>
+
+template<typename TVirtualBlock>
+SubAllocatorPolicy<TVirtualBlock>::SubAllocatorPolicy(uint32_t blockSize, uint32_t alignment)
+    : m_blockSize(blockSize), m_alignment(alignment)
+{
+}
+
+template<typename TVirtualBlock>
+bool SubAllocatorPolicy<TVirtualBlock>::isDedicated(uint32_t byteSize) const
+{
+    return byteSize >= m_blockSize / 2;
+}
+
+template<typename TVirtualBlock>
+uint32_t SubAllocatorPolicy<TVirtualBlock>::getSizeClass(uint32_t byteSize) const
+{
+    if (byteSize < m_blockSize / 64)
+        return 0;
+
+    if (byteSize < m_blockSize / 8)
+        return 1;
+
+    return 2;
+}
+
+template<typename TVirtualBlock>
+typename SubAllocatorPolicy<TVirtualBlock>::Allocation SubAllocatorPolicy<TVirtualBlock>::allocate(uint32_t byteSize, bool& createdBlock)
+{
+    assert(!isDedicated(byteSize));
+
+    Allocation allocation{};
+    allocation.byteSize = byteSize;
+    createdBlock = false;
+
+    const uint32_t sizeClass = getSizeClass(byteSize);
+    auto& freeBlockIndices = m_freeBlockIndices[sizeClass];
+
+    // Blocks that fail to fit the allocation are dropped from the index until something gets freed from them.
+    // Allocations within a size class are similar in size, so this rarely gives up on a usable block.
+    while (!freeBlockIndices.empty())
+    {
+        const uint32_t blockIndex = freeBlockIndices.back();
+        auto& block = m_blocks[blockIndex];
+
+        if (block.virtualBlock.allocate(byteSize, m_alignment, allocation.handle, allocation.byteOffset))
+        {
+            block.usedSize += byteSize;
+            allocation.blockIndex = blockIndex;
+            return allocation;
+        }
+
+        removeFreeBlock(blockIndex);
+    }
+
+    // Reuse or create new block if the allocation couldn't fit to any of them
+    uint32_t blockIndex = 0;
+    while (blockIndex < m_blocks.size() && m_blocks[blockIndex].isCreated)
+        ++blockIndex;
+
+    if (blockIndex == m_blocks.size())
+        m_blocks.emplace_back().virtualBlock.create(m_blockSize);
+
+    auto& block = m_blocks[blockIndex];
+    block.isCreated = true;
+    block.sizeClass = sizeClass;
+    block.usedSize = byteSize;
+
+    const bool allocated = block.virtualBlock.allocate(byteSize, m_alignment, allocation.handle, allocation.byteOffset);
+    assert(allocated);
+
+    addFreeBlock(blockIndex);
+
+    allocation.blockIndex = blockIndex;
+    createdBlock = true;
+
+    return allocation;
+}
+
+template<typename TVirtualBlock>
+void SubAllocatorPolicy<TVirtualBlock>::free(const Allocation& allocation)
+{
+    if (allocation.handle == 0)
+        return;
+
+    auto& block = m_blocks[allocation.blockIndex];
+    block.virtualBlock.free(allocation.handle);
+    block.usedSize -= allocation.byteSize;
+
+    if (allocation.blockIndex != m_defragmentationBlockIndex)
+        addFreeBlock(allocation.blockIndex);
+}
+
+template<typename TVirtualBlock>
+template<typename T>
+void SubAllocatorPolicy<TVirtualBlock>::freeBlocks(const T& function)
+{
+    for (uint32_t i = 0; i < m_blocks.size(); i++)
+    {
+        auto& block = m_blocks[i];
+        if (block.isCreated && block.virtualBlock.isEmpty())
+        {
+            function(i);
+            block.isCreated = false;
+            removeFreeBlock(i);
+
+            if (i == m_defragmentationBlockIndex)
+                m_defragmentationBlockIndex = ~0u;
+        }
+    }
+
+    while (!m_blocks.empty() && !m_blocks.back().isCreated)
+        m_blocks.pop_back();
+}
+
+template<typename TVirtualBlock>
+uint32_t SubAllocatorPolicy<TVirtualBlock>::getDefragmentationBlockIndex()
+{
+    if (m_defragmentationBlockIndex != ~0u)
+    {
+        // Give up on blocks with allocations that never get moved out.
+        if (++m_defragmentationFrames <= MAX_DEFRAGMENTATION_FRAMES)
+            return m_defragmentationBlockIndex;
+
+        const uint32_t blockIndex = m_defragmentationBlockIndex;
+        m_defragmentationBlockIndex = ~0u;
+        addFreeBlock(blockIndex);
+    }
+
+    size_t usedSizes[SIZE_CLASS_NUM]{};
+    uint32_t blockCounts[SIZE_CLASS_NUM]{};
+
+    for (const auto& block : m_blocks)
+    {
+        if (block.isCreated)
+        {
+            usedSizes[block.sizeClass] += block.usedSize;
+            ++blockCounts[block.sizeClass];
+        }
+    }
+
+    // Pick the emptiest block that is below a quarter full, as long as
+    // the rest of its size class has plenty of room for its allocations.
+    uint32_t blockIndex = ~0u;
+    uint32_t minUsedSize = m_blockSize / 4;
+
+    for (uint32_t i = 0; i < m_blocks.size(); i++)
+    {
+        const auto& block = m_blocks[i];
+        if (!block.isCreated || block.usedSize >= minUsedSize || blockCounts[block.sizeClass] < 2)
+            continue;
+
+        const size_t freeSize = (blockCounts[block.sizeClass] - 1) * static_cast<size_t>(m_blockSize) - (usedSizes[block.sizeClass] - block.usedSize);
+        if (freeSize >= block.usedSize * 2)
+        {
+            blockIndex = i;
+            minUsedSize = block.usedSize;
+        }
+    }
+
+    if (blockIndex != ~0u)
+    {
+        m_defragmentationBlockIndex = blockIndex;
+        m_defragmentationFrames = 0;
+        removeFreeBlock(blockIndex);
+    }
+
+    return blockIndex;
+}
+
+template<typename TVirtualBlock>
+void SubAllocatorPolicy<TVirtualBlock>::addFreeBlock(uint32_t blockIndex)
+{
+    auto& block = m_blocks[blockIndex];
+    if (block.freeBlockPosition == ~0u)
+    {
+        auto& freeBlockIndices = m_freeBlockIndices[block.sizeClass];
+        block.freeBlockPosition = static_cast<uint32_t>(freeBlockIndices.size());
+        freeBlockIndices.push_back(blockIndex);
+    }
+}
+
+template<typename TVirtualBlock>
+void SubAllocatorPolicy<TVirtualBlock>::removeFreeBlock(uint32_t blockIndex)
+{
+    auto& block = m_blocks[blockIndex];
+    if (block.freeBlockPosition != ~0u)
+    {
+        // Move the last entry into the hole, keeping the positions up to date.
+        auto& freeBlockIndices = m_freeBlockIndices[block.sizeClass];
+        const uint32_t lastBlockIndex = freeBlockIndices.back();
+
+        freeBlockIndices[block.freeBlockPosition] = lastBlockIndex;
+        m_blocks[lastBlockIndex].freeBlockPosition = block.freeBlockPosition;
+        freeBlockIndices.pop_back();
+
+        block.freeBlockPosition = ~0u;
+    }
+}
+
+template<typename TVirtualBlock>
+uint32_t SubAllocatorPolicy<TVirtualBlock>::getBlockCount() const
+{
+    return static_cast<uint32_t>(m_blocks.size());
+}
+
+template<typename TVirtualBlock>
+bool SubAllocatorPolicy<TVirtualBlock>::isBlockCreated(uint32_t blockIndex) const
+{
+    return blockIndex < m_blocks.size() && m_blocks[blockIndex].isCreated;
+}
+
+template<typename TVirtualBlock>
+uint32_t SubAllocatorPolicy<TVirtualBlock>::getUsedSize(uint32_t blockIndex) const
+{
+    return m_blocks[blockIndex].usedSize;
+}
+
+template<typename TVirtualBlock>
+size_t SubAllocatorPolicy<TVirtualBlock>::getFreeBlockCount(uint32_t sizeClass) const
+{
+    return m_freeBlockIndices[sizeClass].size();
+}
+
+template<typename TVirtualBlock>
+const TVirtualBlock& SubAllocatorPolicy<TVirtualBlock>::getVirtualBlock(uint32_t blockIndex) const
+{
+    return m_blocks[blockIndex].virtualBlock;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "DdsLayout.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The part that creates textures from DDS files. x64 implements it with D3D12, the tests with a mock.
+template<typename TTexture>
+class TextureLoadBackend
+{
+public:
+    virtual ~TextureLoadBackend() = default;
+
+    // Called from the worker threads. The layout is null for files DdsLayout doesn't handle, like volume
+    // textures, which the backend can still hand to a full loader. The data stays alive until the texture is collected.
+    virtual TTexture loadTexture(const DdsLayout* layout, const uint8_t* data, size_t dataSize, const char* name) = 0;
+};
+
+template<typename TTexture>
+struct LoadedTexture
+{
+    uint32_t textureId;
+    uint32_t ticket;
+    TTexture texture;
+    std::vector<uint8_t> data;
+};
+
+// Loads DDS textures on a pool of worker threads. Textures are handed back in the order they finish
+// without waiting for the rest of the queue, so the render thread binds a placeholder until a texture
+// shows up in collectLoadedTextures. Every load gets a ticket, which tells apart results of textures
+// released in the meantime from the texture that reused the id.
+template<typename TTexture>
+class TextureLoadQueue
+{
+protected:
+    struct Job
+    {
+        uint32_t textureId;
+        uint32_t ticket;
+        std::vector<uint8_t> data;
+        std::string name;
+    };
+
+    TextureLoadBackend<TTexture>& m_backend;
+    uint32_t m_nextTicket = 1;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Job> m_jobs;
+    std::vector<LoadedTexture<TTexture>> m_loadedTextures;
+    size_t m_pendingCount = 0;
+    std::vector<std::thread> m_threads;
+    bool m_shouldExit = false;
+
+    void load(Job& job);
+    void runWorkerThread();
+
+public:
+    TextureLoadQueue(TextureLoadBackend<TTexture>& backend, uint32_t threadCount);
+    ~TextureLoadQueue();
+
+    // Returns the ticket of the load, never zero.
+    uint32_t loadTexture(uint32_t textureId, std::vector<uint8_t>&& data, const char* name);
+
+    // Drops the load if no worker picked it up yet. Otherwise it gets collected like any other.
+    bool cancel(uint32_t ticket);
+
+    // Loads the next queued texture on the calling thread. Returns false if the queue is empty.
+    bool loadNext();
+
+    // Never waits, only returns the textures that are done.
+    void collectLoadedTextures(std::vector<LoadedTexture<TTexture>>& loadedTextures);
+
+    // Loads that haven't been collected yet.
+    size_t getPendingCount();
+};
+
+#include "TextureLoadQueue.inl"
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <algorithm>
+
+template<typename TTexture>
+void TextureLoadQueue<TTexture>::load(Job& job)
+{
+    // Files cut short are left to the full loader to reject.
+    DdsLayout layout;
+    const bool parsed = layout.parse(job.data.data(), job.data.size()) &&
+        static_cast<size_t>(layout.getHeaderSize()) + layout.getDataSize() <= job.data.size();
+
+    LoadedTexture<TTexture> loadedTexture;
+    loadedTexture.textureId = job.textureId;
+    loadedTexture.ticket = job.ticket;
+    loadedTexture.texture = m_backend.loadTexture(parsed ? &layout : nullptr, job.data.data(), job.data.size(), job.name.c_str());
+    loadedTexture.data = std::move(job.data);
+
+    std::lock_guard lock(m_mutex);
+    m_loadedTextures.push_back(std::move(loadedTexture));
+}
+
+template<typename TTexture>
+void TextureLoadQueue<TTexture>::runWorkerThread()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [&] { return m_shouldExit || !m_jobs.empty(); });
+
+            if (m_shouldExit)
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        load(job);
+    }
+}
+
+template<typename TTexture>
+TextureLoadQueue<TTexture>::TextureLoadQueue(TextureLoadBackend<TTexture>& backend, uint32_t threadCount)
+    : m_backend(backend)
+{
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&TextureLoadQueue::runWorkerThread, this);
+}
+
+template<typename TTexture>
+TextureLoadQueue<TTexture>::~TextureLoadQueue()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldExit = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+template<typename TTexture>
+uint32_t TextureLoadQueue<TTexture>::loadTexture(uint32_t textureId, std::vector<uint8_t>&& data, const char* name)
+{
+    const uint32_t ticket = m_nextTicket;
+
+    if (++m_nextTicket == 0)
+        m_nextTicket = 1;
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_jobs.push_back({ textureId, ticket, std::move(data), name });
+        ++m_pendingCount;
+    }
+
+    m_condition.notify_one();
+    return ticket;
+}
+
+template<typename TTexture>
+bool TextureLoadQueue<TTexture>::cancel(uint32_t ticket)
+{
+    std::lock_guard lock(m_mutex);
+
+    const auto findResult = std::find_if(m_jobs.begin(), m_jobs.end(), [&](const Job& job) { return job.ticket == ticket; });
+    if (findResult == m_jobs.end())
+        return false;
+
+    m_jobs.erase(findResult);
+    --m_pendingCount;
+    return true;
+}
+
+template<typename TTexture>
+bool TextureLoadQueue<TTexture>::loadNext()
+{
+    Job job;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_jobs.empty())
+            return false;
+
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+    }
+
+    load(job);
+    return true;
+}
+
+template<typename TTexture>
+void TextureLoadQueue<TTexture>::collectLoadedTextures(std::vector<LoadedTexture<TTexture>>& loadedTextures)
+{
+    std::lock_guard lock(m_mutex);
+
+    for (auto& loadedTexture : m_loadedTextures)
+        loadedTextures.push_back(std::move(loadedTexture));
+
+    m_pendingCount -= m_loadedTextures.size();
+    m_loadedTextures.clear();
+}
+
+template<typename TTexture>
+size_t TextureLoadQueue<TTexture>::getPendingCount()
+{
+    std::lock_guard lock(m_mutex);
+    return m_pendingCount;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Classifies polymorphic objects by their vtable pointer. A vtable is resolved through the registered
+// types only the first time it is seen, the result is then memoized in an open addressing table.
+template<typename TBase, typename TKind>
+class TypeClassifier
+{
+protected:
+    using CheckFunction = bool(*)(TBase*);
+
+    struct Registration
+    {
+        CheckFunction check;
+        TKind kind;
+    };
+
+    struct Entry
+    {
+        const void* vtable;
+        TKind kind;
+    };
+
+    std::vector<Registration> m_registrations;
+    std::vector<Entry> m_entries;
+    size_t m_entryCount = 0;
+    TKind m_defaultKind;
+
+    static size_t getSlot(const void* vtable, size_t mask);
+    void grow();
+
+public:
+    explicit TypeClassifier(TKind defaultKind);
+
+    // Types are tried in registration order, so register derived types before their bases.
+    template<typename T>
+    TypeClassifier& add(TKind kind);
+
+    TKind classify(TBase* object);
+};
+
+#include "TypeClassifier.inl"
\ No newline at end of file
@@ -0,0 +1,80 @@
+template<typename TBase, typename TKind>
+size_t TypeClassifier<TBase, TKind>::getSlot(const void* vtable, size_t mask)
+{
+    // Vtables are pointer aligned, discard the low bits and fold the well mixed upper half back in.
+    const size_t hash = (reinterpret_cast<size_t>(vtable) >> 3) * static_cast<size_t>(0x9E3779B97F4A7C15ull);
+    return (hash ^ (hash >> (sizeof(size_t) * 4))) & mask;
+}
+
+template<typename TBase, typename TKind>
+void TypeClassifier<TBase, TKind>::grow()
+{
+    std::vector<Entry> entries(std::max<size_t>(m_entries.size() * 2, 64), Entry{ nullptr, m_defaultKind });
+    const size_t mask = entries.size() - 1;
+
+    for (const auto& entry : m_entries)
+    {
+        if (entry.vtable != nullptr)
+        {
+            size_t slot = getSlot(entry.vtable, mask);
+            while (entries[slot].vtable != nullptr)
+                slot = (slot + 1) & mask;
+
+            entries[slot] = entry;
+        }
+    }
+
+    m_entries = std::move(entries);
+}
+
+template<typename TBase, typename TKind>
+TypeClassifier<TBase, TKind>::TypeClassifier(TKind defaultKind)
+    : m_defaultKind(defaultKind)
+{
+    grow();
+}
+
+template<typename TBase, typename TKind>
+template<typename T>
+TypeClassifier<TBase, TKind>& TypeClassifier<TBase, TKind>::add(TKind kind)
+{
+    m_registrations.push_back({ [](TBase* object) { return dynamic_cast<T*>(object) != nullptr; }, kind });
+    return *this;
+}
+
+template<typename TBase, typename TKind>
+TKind TypeClassifier<TBase, TKind>::classify(TBase* object)
+{
+    const void* vtable = *reinterpret_cast<const void* const*>(object);
+    const size_t mask = m_entries.size() - 1;
+
+    size_t slot = getSlot(vtable, mask);
+
+    while (m_entries[slot].vtable != nullptr)
+    {
+        if (m_entries[slot].vtable == vtable)
+            return m_entries[slot].kind;
+
+        slot = (slot + 1) & mask;
+    }
+
+    // Objects sharing a vtable share their most derived type, so the casts only need to happen once.
+    TKind kind = m_defaultKind;
+
+    for (const auto& registration : m_registrations)
+    {
+        if (registration.check(object))
+        {
+            kind = registration.kind;
+            break;
+        }
+    }
+
+    m_entries[slot] = { vtable, kind };
+
+    // Keep the load factor at or below one half.
+    if ((++m_entryCount) * 2 > m_entries.size())
+        grow();
+
+    return kind;
+}
\ No newline at end of file
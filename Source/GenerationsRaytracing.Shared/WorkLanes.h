@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// One append-only byte buffer per worker, so workers can write results without locking. Records are
+// tagged with the index of the item that produced them. A worker has to append in increasing item order
+// (WorkerPool hands out items that way), then the cursor merges the lanes back into item order no matter
+// how the items were split between the workers. The buffers keep their memory across resets.
+class WorkLanes
+{
+public:
+    struct Record
+    {
+        uint32_t itemIndex;
+        uint32_t byteSize;
+        const uint8_t* data;
+    };
+
+    class Cursor
+    {
+    protected:
+        const WorkLanes& m_lanes;
+        std::vector<size_t> m_offsets;
+        size_t m_nextLaneIndex = 0;
+
+        void findNextLane();
+
+    public:
+        explicit Cursor(const WorkLanes& lanes);
+
+        // Returns false once every lane has been read.
+        bool next(Record& record);
+
+        // Skips records of items before the given one. Returns true and reads the
+        // next record if it belongs to the item, otherwise leaves it for later.
+        bool seek(uint32_t itemIndex, Record& record);
+    };
+
+protected:
+    struct RecordHeader
+    {
+        uint32_t itemIndex;
+        uint32_t byteSize;
+    };
+
+    static constexpr size_t s_recordAlignment = alignof(RecordHeader);
+
+    std::vector<std::vector<uint8_t>> m_lanes;
+
+public:
+    void reset(size_t laneCount);
+
+    // The memory stays valid until the next append to the same lane.
+    uint8_t* append(size_t laneIndex, uint32_t itemIndex, uint32_t byteSize);
+
+    size_t getLaneCount() const;
+    size_t getByteSize(size_t laneIndex) const;
+};
+
+#include "WorkLanes.inl"
\ No newline at end of file
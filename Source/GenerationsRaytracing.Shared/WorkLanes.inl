@@ -0,0 +1,98 @@
+inline void WorkLanes::Cursor::findNextLane()
+{
+    m_nextLaneIndex = m_offsets.size();
+    uint32_t nextItemIndex = 0;
+
+    for (size_t i = 0; i < m_offsets.size(); i++)
+    {
+        const auto& lane = m_lanes.m_lanes[i];
+        if (m_offsets[i] >= lane.size())
+            continue;
+
+        const auto header = reinterpret_cast<const RecordHeader*>(lane.data() + m_offsets[i]);
+
+        if (m_nextLaneIndex == m_offsets.size() || header->itemIndex < nextItemIndex)
+        {
+            m_nextLaneIndex = i;
+            nextItemIndex = header->itemIndex;
+        }
+    }
+}
+
+inline WorkLanes::Cursor::Cursor(const WorkLanes& lanes)
+    : m_lanes(lanes), m_offsets(lanes.m_lanes.size())
+{
+    findNextLane();
+}
+
+inline bool WorkLanes::Cursor::next(Record& record)
+{
+    if (m_nextLaneIndex == m_offsets.size())
+        return false;
+
+    const auto& lane = m_lanes.m_lanes[m_nextLaneIndex];
+    auto& offset = m_offsets[m_nextLaneIndex];
+    const auto header = reinterpret_cast<const RecordHeader*>(lane.data() + offset);
+
+    record.itemIndex = header->itemIndex;
+    record.byteSize = header->byteSize;
+    record.data = lane.data() + offset + sizeof(RecordHeader);
+
+    offset += sizeof(RecordHeader) + (header->byteSize + s_recordAlignment - 1) / s_recordAlignment * s_recordAlignment;
+
+    // Records of the same item stay in the lane they were written to.
+    if (offset >= lane.size() || reinterpret_cast<const RecordHeader*>(lane.data() + offset)->itemIndex != record.itemIndex)
+        findNextLane();
+
+    return true;
+}
+
+inline bool WorkLanes::Cursor::seek(uint32_t itemIndex, Record& record)
+{
+    while (m_nextLaneIndex != m_offsets.size())
+    {
+        const auto header = reinterpret_cast<const RecordHeader*>(
+            m_lanes.m_lanes[m_nextLaneIndex].data() + m_offsets[m_nextLaneIndex]);
+
+        if (header->itemIndex > itemIndex)
+            return false;
+
+        next(record);
+
+        if (record.itemIndex == itemIndex)
+            return true;
+    }
+
+    return false;
+}
+
+inline void WorkLanes::reset(size_t laneCount)
+{
+    m_lanes.resize(laneCount);
+
+    for (auto& lane : m_lanes)
+        lane.clear();
+}
+
+inline uint8_t* WorkLanes::append(size_t laneIndex, uint32_t itemIndex, uint32_t byteSize)
+{
+    auto& lane = m_lanes[laneIndex];
+    const size_t offset = lane.size();
+    lane.resize(offset + sizeof(RecordHeader) + (byteSize + s_recordAlignment - 1) / s_recordAlignment * s_recordAlignment);
+
+    const auto header = reinterpret_cast<RecordHeader*>(lane.data() + offset);
+    header->itemIndex = itemIndex;
+    header->byteSize = byteSize;
+
+    return lane.data() + offset + sizeof(RecordHeader);
+}
+
+inline size_t WorkLanes::getLaneCount() const
+{
+    return m_lanes.size();
+}
+
+inline size_t WorkLanes::getByteSize(size_t laneIndex) const
+{
+    return m_lanes[laneIndex].size();
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent threads that split a range of items into chunks. The calling thread works along with them
+// and run returns once every item is done. Chunks are claimed from the front of the range, so the items
+// a single worker sees are always in increasing order, which is what WorkLanes relies on to merge.
+class WorkerPool
+{
+protected:
+    using Function = void(*)(const void* context, size_t itemIndex, size_t workerIndex);
+
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_finishCondition;
+    std::vector<std::thread> m_threads;
+    bool m_shouldExit = false;
+
+    // Set up by run, read by the threads once they see a new generation.
+    Function m_function = nullptr;
+    const void* m_context = nullptr;
+    size_t m_itemCount = 0;
+    size_t m_chunkSize = 1;
+    uint32_t m_generation = 0;
+    size_t m_busyThreadCount = 0;
+
+    std::atomic<size_t> m_nextItemIndex = 0;
+
+    void work(size_t workerIndex);
+    void runWorkerThread(size_t workerIndex);
+    void run(size_t itemCount, size_t chunkSize, Function function, const void* context);
+
+public:
+    explicit WorkerPool(uint32_t threadCount);
+    ~WorkerPool();
+
+    // Threads plus the calling thread.
+    size_t getWorkerCount() const;
+
+    // Calls function(itemIndex, workerIndex) for every item. Worker zero is the calling thread.
+    template<typename T>
+    void run(size_t itemCount, size_t chunkSize, const T& function);
+};
+
+#include "WorkerPool.inl"
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cassert>
+
+inline void WorkerPool::work(size_t workerIndex)
+{
+    while (true)
+    {
+        const size_t begin = m_nextItemIndex.fetch_add(m_chunkSize);
+        if (begin >= m_itemCount)
+            break;
+
+        const size_t end = std::min(begin + m_chunkSize, m_itemCount);
+
+        for (size_t i = begin; i < end; i++)
+            m_function(m_context, i, workerIndex);
+    }
+}
+
+inline void WorkerPool::runWorkerThread(size_t workerIndex)
+{
+    uint32_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_startCondition.wait(lock, [&] { return m_shouldExit || m_generation != generation; });
+
+            if (m_shouldExit)
+                return;
+
+            generation = m_generation;
+        }
+
+        work(workerIndex);
+
+        std::lock_guard lock(m_mutex);
+        if (--m_busyThreadCount == 0)
+            m_finishCondition.notify_one();
+    }
+}
+
+inline void WorkerPool::run(size_t itemCount, size_t chunkSize, Function function, const void* context)
+{
+    assert(chunkSize != 0);
+
+    if (itemCount == 0)
+        return;
+
+    m_function = function;
+    m_context = context;
+    m_itemCount = itemCount;
+    m_chunkSize = chunkSize;
+    m_nextItemIndex = 0;
+
+    // Not worth waking the threads for a single chunk.
+    if (itemCount <= chunkSize || m_threads.empty())
+    {
+        work(0);
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_busyThreadCount = m_threads.size();
+        ++m_generation;
+    }
+
+    m_startCondition.notify_all();
+
+    work(0);
+
+    std::unique_lock lock(m_mutex);
+    m_finishCondition.wait(lock, [&] { return m_busyThreadCount == 0; });
+}
+
+inline WorkerPool::WorkerPool(uint32_t threadCount)
+{
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&WorkerPool::runWorkerThread, this, i + 1);
+}
+
+inline WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldExit = true;
+    }
+
+    m_startCondition.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+inline size_t WorkerPool::getWorkerCount() const
+{
+    return m_threads.size() + 1;
+}
+
+template<typename T>
+void WorkerPool::run(size_t itemCount, size_t chunkSize, const T& function)
+{
+    run(itemCount, chunkSize, [](const void* context, size_t itemIndex, size_t workerIndex)
+    {
+        (*static_cast<const T*>(context))(itemIndex, workerIndex);
+    }, &function);
+}
\ No newline at end of file
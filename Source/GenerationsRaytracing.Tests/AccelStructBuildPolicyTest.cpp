@@ -0,0 +1,232 @@
+#include "AccelStructBuildPolicy.h"
+
+namespace
+{
+    // A synthetic scene that gets mutated between frames, standing in for what x86 sends.
+    struct Trace
+    {
+        std::vector<AccelStructInstance> instances;
+
+        explicit Trace(size_t instanceCount, float spacing = 10.0f)
+        {
+            for (size_t i = 0; i < instanceCount; i++)
+                add(static_cast<float>(i) * spacing, 0.0f, 0.0f);
+        }
+
+        void add(float x, float y, float z)
+        {
+            AccelStructInstance instance{};
+            instance.transform[0][0] = 1.0f;
+            instance.transform[1][1] = 1.0f;
+            instance.transform[2][2] = 1.0f;
+            instance.transform[0][3] = x;
+            instance.transform[1][3] = y;
+            instance.transform[2][3] = z;
+            instance.instanceIdAndMask = static_cast<uint32_t>(instances.size()) | (0xFF << 24);
+            instance.accelStruct = 0x10000 + instances.size() * 0x100;
+            instances.push_back(instance);
+        }
+
+        void move(size_t index, float x, float y, float z)
+        {
+            instances[index].transform[0][3] += x;
+            instances[index].transform[1][3] += y;
+            instances[index].transform[2][3] += z;
+        }
+
+        // Runs the policy for a number of frames, calling the mutation before each one, and
+        // returns a character per frame, B for a full build and U for a refit.
+        template<typename T>
+        std::string run(AccelStructBuildPolicy& policy, size_t frameCount, const T& mutate)
+        {
+            std::string result;
+            for (size_t i = 0; i < frameCount; i++)
+            {
+                mutate(i);
+                result += policy.getBuildType(instances.data(), instances.size()) == AccelStructBuildType::Build ? 'B' : 'U';
+            }
+
+            return result;
+        }
+
+        std::string run(AccelStructBuildPolicy& policy, size_t frameCount)
+        {
+            return run(policy, frameCount, [](size_t) {});
+        }
+    };
+}
+
+TEST(AccelStructBuildPolicy, RebuildPolicyAlwaysBuilds)
+{
+    Trace trace(100);
+    RebuildAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 5), "BBBBB");
+}
+
+TEST(AccelStructBuildPolicy, StaticSceneRefitsAfterFirstBuild)
+{
+    Trace trace(1000);
+    RefitAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 8), "BUUUUUUU");
+    EXPECT_EQ(policy.getBoundsGrowth(), 0.0f);
+}
+
+TEST(AccelStructBuildPolicy, RebuildsAfterMaxRefitCount)
+{
+    Trace trace(10);
+    RefitAccelStructPolicy policy(3);
+
+    EXPECT_EQ(trace.run(policy, 9), "BUUUBUUUB");
+}
+
+TEST(AccelStructBuildPolicy, RebuildsWhenInstanceCountChanges)
+{
+    Trace trace(10);
+    RefitAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 6, [&](size_t frame)
+    {
+        if (frame == 3)
+            trace.add(5.0f, 5.0f, 5.0f);
+        else if (frame == 4)
+            trace.instances.pop_back();
+    }), "BUUBBU");
+}
+
+TEST(AccelStructBuildPolicy, RebuildsWhenInstanceSetChanges)
+{
+    Trace trace(10);
+    RefitAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 8, [&](size_t frame)
+    {
+        switch (frame)
+        {
+        case 1: trace.instances[3].accelStruct = 0xDEAD00; break;
+        case 3: trace.instances[5].instanceIdAndMask ^= 1u << 24; break;
+        case 5: trace.instances[7].hitGroupIndexAndFlags = 4; break;
+        case 6: std::swap(trace.instances[1], trace.instances[2]); break;
+        }
+    }), "BBUBUBBU");
+}
+
+TEST(AccelStructBuildPolicy, RefitsWhileSmallInstancesMoveAround)
+{
+    // A player sized instance running back and forth in a large stage never drifts far from the build.
+    Trace trace(1000);
+    RefitAccelStructPolicy policy;
+
+    const std::string result = trace.run(policy, 300, [&](size_t frame)
+    {
+        trace.move(500, frame % 20 < 10 ? 1.0f : -1.0f, 0.0f, 0.0f);
+    });
+
+    EXPECT_EQ(result, "B" + std::string(299, 'U'));
+    EXPECT_LE(policy.getBoundsGrowth(), 0.01f);
+}
+
+TEST(AccelStructBuildPolicy, RebuildsOnceInstancesDriftAway)
+{
+    // 100 instances 10 units apart make a scene about 990 units wide. Half a
+    // scene worth of drift, 495 units, is reached on the 50th frame moving 10 instances by 1 unit.
+    Trace trace(100);
+    RefitAccelStructPolicy policy(1000, 0.5f);
+
+    const std::string result = trace.run(policy, 60, [&](size_t)
+    {
+        for (size_t i = 0; i < 10; i++)
+            trace.move(i * 10, 0.0f, 1.0f, 0.0f);
+    });
+
+    EXPECT_EQ(result.find('B', 1), 50u);
+    EXPECT_EQ(result.substr(1, 49), std::string(49, 'U'));
+}
+
+TEST(AccelStructBuildPolicy, RebuildsImmediatelyOnTeleport)
+{
+    Trace trace(100);
+    RefitAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 4, [&](size_t frame)
+    {
+        if (frame == 2)
+            trace.move(0, 5000.0f, 0.0f, 0.0f);
+    }), "BUBU");
+}
+
+TEST(AccelStructBuildPolicy, RebuildsOnNaN)
+{
+    Trace trace(10);
+    RefitAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 3, [&](size_t frame)
+    {
+        if (frame == 1)
+            trace.instances[0].transform[0][3] = std::numeric_limits<float>::quiet_NaN();
+    }), "BBB");
+}
+
+TEST(AccelStructBuildPolicy, ResetForgetsPreviousBuild)
+{
+    Trace trace(10);
+    RefitAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 2), "BU");
+    policy.reset();
+    EXPECT_EQ(trace.run(policy, 2), "BU");
+}
+
+TEST(AccelStructBuildPolicy, SingleInstanceScene)
+{
+    Trace trace(1);
+    RefitAccelStructPolicy policy;
+
+    EXPECT_EQ(trace.run(policy, 4, [&](size_t frame)
+    {
+        if (frame == 3)
+            trace.move(0, 1.0f, 0.0f, 0.0f);
+    }), "BUUB");
+}
+
+// Replays a mixed trace and checks the refit count stays consistent with the build decisions.
+TEST(AccelStructBuildPolicy, RandomTraceKeepsCountersConsistent)
+{
+    std::mt19937 random(0x9ABC);
+    Trace trace(200);
+    RefitAccelStructPolicy policy(50, 0.25f);
+
+    uint32_t expectedRefitCount = 0;
+    size_t buildCount = 0;
+
+    for (size_t frame = 0; frame < 2000; frame++)
+    {
+        const uint32_t event = random() % 100;
+        if (event == 0)
+            trace.add(static_cast<float>(random() % 2000), 0.0f, 0.0f);
+        else if (event == 1 && trace.instances.size() > 1)
+            trace.instances.pop_back();
+        else if (event < 50)
+            trace.move(random() % trace.instances.size(), static_cast<float>(random() % 3) - 1.0f, 0.0f, 0.0f);
+
+        const auto buildType = policy.getBuildType(trace.instances.data(), trace.instances.size());
+
+        if (buildType == AccelStructBuildType::Build)
+        {
+            expectedRefitCount = 0;
+            ++buildCount;
+        }
+        else
+        {
+            ++expectedRefitCount;
+        }
+
+        ASSERT_EQ(policy.getRefitCount(), expectedRefitCount);
+        ASSERT_LE(policy.getRefitCount(), 50u);
+        ASSERT_LE(policy.getBoundsGrowth(), 0.25f);
+    }
+
+    // Far from rebuilding every frame.
+    EXPECT_LT(buildCount, 200u);
+}
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "AccelStructCompactor.h"
+
+namespace
+{
+    // Keeps track of structure sizes and submissions like the GPU would, and checks 
+    // that originals only get freed once the submission that copied them completes.
+    class FakeCompactionDevice final : public AccelStructCompactionDevice
+    {
+    public:
+        struct Structure
+        {
+            uint64_t buildIndex = 0;
+            uint32_t byteSize = 0;
+            bool released = false;
+        };
+
+        struct Original
+        {
+            uint32_t byteSize;
+            uint64_t submission;
+        };
+
+        std::vector<std::string> calls;
+        std::vector<Structure> structures;
+        std::vector<uint32_t> writtenSizes[2];
+        std::vector<Original> originals[2];
+        uint64_t submission = 0;
+        uint64_t completedSubmission = 0;
+
+        void readCompactedSizes(uint32_t frame, uint32_t* compactedSizes, uint32_t count) override
+        {
+            calls.push_back("read " + std::to_string(frame) + " " + std::to_string(count));
+            EXPECT_EQ(count, writtenSizes[frame].size());
+
+            for (uint32_t i = 0; i < count; i++)
+                compactedSizes[i] = writtenSizes[frame][i];
+
+            writtenSizes[frame].clear();
+        }
+
+        uint32_t getByteSize(uint32_t id, uint64_t buildIndex) override
+        {
+            const auto& structure = structures[id];
+            return structure.released || structure.buildIndex != buildIndex ? 0 : structure.byteSize;
+        }
+
+        void copyCompacted(uint32_t frame, uint32_t id, uint32_t compactedSize) override
+        {
+            calls.push_back("copy " + std::to_string(id) + " " + std::to_string(compactedSize));
+
+            auto& structure = structures[id];
+            EXPECT_FALSE(structure.released);
+            EXPECT_LT(compactedSize, structure.byteSize);
+
+            originals[frame].push_back({ structure.byteSize, submission });
+            structure.byteSize = compactedSize;
+        }
+
+        void releaseOriginals(uint32_t frame) override
+        {
+            calls.push_back("release " + std::to_string(frame));
+            EXPECT_FALSE(originals[frame].empty());
+
+            for (const auto& original : originals[frame])
+                EXPECT_LE(original.submission, completedSubmission);
+
+            originals[frame].clear();
+        }
+
+        uint64_t getOriginalByteSize() const
+        {
+            uint64_t byteSize = 0;
+            for (const auto& frameOriginals : originals)
+            {
+                for (const auto& original : frameOriginals)
+                    byteSize += original.byteSize;
+            }
+
+            return byteSize;
+        }
+    };
+
+    struct AccelStructCompactorTest : testing::Test
+    {
+        FakeCompactionDevice device;
+        AccelStructCompactor<2> compactor{ device, 4 };
+        uint64_t submissions[2]{};
+        uint64_t submissionCount = 0;
+        uint32_t frame = 0;
+
+        // Frame completion is in order, so beginning a frame means its previous submission is done.
+        void beginFrame(uint32_t newFrame)
+        {
+            frame = newFrame;
+            device.completedSubmission = submissions[frame];
+            compactor.beginFrame(frame);
+            device.submission = ++submissionCount;
+            submissions[frame] = device.submission;
+        }
+
+        void nextFrame()
+        {
+            beginFrame(frame ^ 1);
+        }
+
+        // Builds the structure, with the GPU writing the compacted size into the slot it got.
+        uint32_t build(uint32_t id, uint32_t byteSize, uint32_t compactedSize)
+        {
+            if (id >= device.structures.size())
+                device.structures.resize(id + 1);
+
+            auto& structure = device.structures[id];
+            ++structure.buildIndex;
+            structure.byteSize = byteSize;
+            structure.released = false;
+
+            const uint32_t slot = compactor.request(id, structure.buildIndex);
+            if (slot != ~0u)
+            {
+                auto& writtenSizes = device.writtenSizes[frame];
+                EXPECT_EQ(slot, writtenSizes.size());
+                writtenSizes.push_back(compactedSize);
+            }
+
+            return slot;
+        }
+
+        void SetUp() override
+        {
+            beginFrame(0);
+        }
+    };
+
+    using Calls = std::vector<std::string>;
+}
+
+TEST_F(AccelStructCompactorTest, GoesThroughEveryState)
+{
+    build(0, 1000, 600);
+    EXPECT_EQ(compactor.getPendingCount(), 1u);
+
+    // Sizes are not ready until the frame that built it completes.
+    compactor.compact();
+    nextFrame();
+    compactor.compact();
+    EXPECT_EQ(compactor.getPendingCount(), 1u);
+    EXPECT_TRUE(device.calls.empty());
+
+    nextFrame();
+    EXPECT_EQ(compactor.getPendingCount(), 0u);
+    EXPECT_EQ(compactor.getSizeReadyCount(), 1u);
+
+    compactor.compact();
+    EXPECT_EQ(compactor.getSizeReadyCount(), 0u);
+    EXPECT_EQ(compactor.getCopiedCount(), 1u);
+    EXPECT_EQ(device.structures[0].byteSize, 600u);
+    EXPECT_EQ(device.getOriginalByteSize(), 1000u);
+    EXPECT_EQ(compactor.getSavedByteSize(), 400u);
+
+    // The original outlives the frame that copied it.
+    nextFrame();
+    EXPECT_EQ(compactor.getCopiedCount(), 1u);
+
+    nextFrame();
+    EXPECT_EQ(compactor.getCopiedCount(), 0u);
+    EXPECT_EQ(device.getOriginalByteSize(), 0u);
+
+    EXPECT_EQ(device.calls, Calls({ "read 0 1", "copy 0 600", "release 0" }));
+}
+
+TEST_F(AccelStructCompactorTest, SlotsFollowRequestOrder)
+{
+    EXPECT_EQ(build(0, 1000, 100), 0u);
+    EXPECT_EQ(build(1, 2000, 200), 1u);
+    EXPECT_EQ(build(2, 3000, 300), 2u);
+
+    nextFrame();
+    nextFrame();
+    compactor.compact();
+
+    EXPECT_EQ(device.structures[0].byteSize, 100u);
+    EXPECT_EQ(device.structures[1].byteSize, 200u);
+    EXPECT_EQ(device.structures[2].byteSize, 300u);
+    EXPECT_EQ(compactor.getSavedByteSize(), 5400u);
+}
+
+TEST_F(AccelStructCompactorTest, RunsOutOfSlotsPerFrame)
+{
+    for (uint32_t i = 0; i < 4; i++)
+        EXPECT_EQ(build(i, 1000, 500), i);
+
+    EXPECT_EQ(build(4, 1000, 500), ~0u);
+    EXPECT_EQ(compactor.getRequestCount(), 4u);
+
+    // The other frame has its own slots.
+    nextFrame();
+    EXPECT_EQ(build(4, 1000, 500), 0u);
+}
+
+TEST_F(AccelStructCompactorTest, SkipsRebuiltStructures)
+{
+    build(0, 1000, 600);
+    nextFrame();
+
+    // Rebuilt before the size of the first build got read back.
+    build(0, 1200, 700);
+    nextFrame();
+    compactor.compact();
+    EXPECT_EQ(device.structures[0].byteSize, 1200u);
+
+    nextFrame();
+    compactor.compact();
+    EXPECT_EQ(device.structures[0].byteSize, 700u);
+
+    EXPECT_EQ(std::count_if(device.calls.begin(), device.calls.end(),
+        [](const std::string& call) { return call.compare(0, 4, "copy") == 0; }), 1);
+}
+
+TEST_F(AccelStructCompactorTest, SkipsReleasedStructures)
+{
+    build(0, 1000, 600);
+    device.structures[0].released = true;
+
+    nextFrame();
+    nextFrame();
+    compactor.compact();
+
+    EXPECT_EQ(compactor.getCopiedCount(), 0u);
+    EXPECT_EQ(device.calls, Calls({ "read 0 1" }));
+}
+
+TEST_F(AccelStructCompactorTest, SkipsStructuresThatWouldNotShrink)
+{
+    build(0, 1000, 1000);
+    build(1, 1000, 1200);
+    build(2, 1000, 0);
+
+    nextFrame();
+    nextFrame();
+    compactor.compact();
+
+    EXPECT_EQ(compactor.getCopiedCount(), 0u);
+    EXPECT_EQ(compactor.getSavedByteSize(), 0u);
+}
+
+TEST_F(AccelStructCompactorTest, ReleasesOriginalsOfEachFrameSeparately)
+{
+    build(0, 1000, 500);
+    nextFrame();
+    build(1, 1000, 500);
+
+    // Frame 0 copies 0, frame 1 copies 1.
+    nextFrame();
+    compactor.compact();
+    nextFrame();
+    compactor.compact();
+    EXPECT_EQ(compactor.getCopiedCount(), 2u);
+
+    nextFrame();
+    EXPECT_EQ(compactor.getCopiedCount(), 1u);
+    EXPECT_EQ(device.originals[1].size(), 1u);
+
+    nextFrame();
+    EXPECT_EQ(compactor.getCopiedCount(), 0u);
+}
+
+TEST_F(AccelStructCompactorTest, RandomBuildsEndUpCompacted)
+{
+    std::mt19937 random(0xC0DE);
+    const uint32_t structureCount = 64;
+
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        for (uint32_t j = random() % 6; j != 0; j--)
+        {
+            const uint32_t id = random() % structureCount;
+            if (random() % 4 == 0 && id < device.structures.size())
+            {
+                device.structures[id].released = true;
+            }
+            else
+            {
+                const uint32_t byteSize = 256 + random() % 4096;
+                build(id, byteSize, random() % 8 == 0 ? byteSize : byteSize / 2 + random() % (byteSize / 2));
+            }
+        }
+
+        compactor.compact();
+        nextFrame();
+    }
+
+    // Drain every state.
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        compactor.compact();
+        nextFrame();
+    }
+
+    EXPECT_EQ(compactor.getPendingCount(), 0u);
+    EXPECT_EQ(compactor.getSizeReadyCount(), 0u);
+    EXPECT_EQ(compactor.getCopiedCount(), 0u);
+    EXPECT_EQ(device.getOriginalByteSize(), 0u);
+    EXPECT_GT(compactor.getSavedByteSize(), 0u);
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "BulkDataAllocator.h"
+
+namespace
+{
+    constexpr uint32_t s_headerSize = sizeof(BulkDataHeader);
+
+    struct Heap
+    {
+        std::vector<uint8_t> memory;
+        BulkDataAllocator allocator;
+
+        Heap(uint32_t size) : memory(size), allocator(memory.data(), size)
+        {
+        }
+
+        void release(uint32_t offset)
+        {
+            reinterpret_cast<BulkDataHeader*>(memory.data() + offset - s_headerSize)->released = true;
+        }
+    };
+}
+
+TEST(BulkDataAllocator, CanAllocateAccountsForHeader)
+{
+    EXPECT_TRUE(BulkDataAllocator::canAllocate(1024, 1024 - s_headerSize));
+    EXPECT_FALSE(BulkDataAllocator::canAllocate(1024, 1024 - s_headerSize + 1));
+    EXPECT_FALSE(BulkDataAllocator::canAllocate(1024, 0xFFFFFFFF));
+}
+
+TEST(BulkDataAllocator, FillsWholeHeap)
+{
+    Heap heap(1024);
+    uint32_t offset;
+
+    ASSERT_TRUE(heap.allocator.tryAllocate(1024 - s_headerSize, offset));
+    EXPECT_EQ(offset, s_headerSize);
+    EXPECT_FALSE(heap.allocator.tryAllocate(1, offset));
+
+    heap.release(s_headerSize);
+    EXPECT_TRUE(heap.allocator.tryAllocate(1024 - s_headerSize, offset));
+}
+
+TEST(BulkDataAllocator, AlignsBlocks)
+{
+    Heap heap(1024);
+    uint32_t offset;
+
+    for (uint32_t byteSize : { 1u, 17u, 3u, 32u })
+    {
+        ASSERT_TRUE(heap.allocator.tryAllocate(byteSize, offset));
+        EXPECT_EQ(offset % alignof(BulkDataHeader), 0u);
+    }
+}
+
+TEST(BulkDataAllocator, UnreleasedBlockDoesNotStallLaterOnes)
+{
+    Heap heap(1024);
+    uint32_t first, offset;
+
+    // The first block stays allocated as if its message was never sent.
+    ASSERT_TRUE(heap.allocator.tryAllocate(64, first));
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        ASSERT_TRUE(heap.allocator.tryAllocate(256, offset)) << i;
+        heap.release(offset);
+    }
+
+    EXPECT_EQ(heap.allocator.getUsedBlockCount(), 2u);
+}
+
+TEST(BulkDataAllocator, MergesBlocksReleasedOutOfOrder)
+{
+    Heap heap(4 * 256);
+    uint32_t offsets[4], offset;
+
+    for (auto& blockOffset : offsets)
+        ASSERT_TRUE(heap.allocator.tryAllocate(256 - s_headerSize, blockOffset));
+
+    EXPECT_FALSE(heap.allocator.tryAllocate(1, offset));
+
+    for (uint32_t index : { 2, 0, 3, 1 })
+        heap.release(offsets[index]);
+
+    EXPECT_TRUE(heap.allocator.reclaim());
+    EXPECT_EQ(heap.allocator.getUsedBlockCount(), 0u);
+    EXPECT_EQ(heap.allocator.getFreeBlockCount(), 1u);
+
+    EXPECT_TRUE(heap.allocator.tryAllocate(4 * 256 - s_headerSize, offset));
+}
+
+TEST(BulkDataAllocator, ContinuesAfterPreviousBlock)
+{
+    Heap heap(1024);
+    uint32_t first, second, offset;
+
+    ASSERT_TRUE(heap.allocator.tryAllocate(256 - s_headerSize, first));
+    ASSERT_TRUE(heap.allocator.tryAllocate(256 - s_headerSize, second));
+
+    heap.release(first);
+    heap.allocator.reclaim();
+
+    ASSERT_TRUE(heap.allocator.tryAllocate(256 - s_headerSize, offset));
+    EXPECT_EQ(offset, second + 256);
+
+    // Wraps back to the hole at the start once the end doesn't fit.
+    ASSERT_TRUE(heap.allocator.tryAllocate(256 - s_headerSize, offset));
+    EXPECT_EQ(offset, second + 512);
+
+    ASSERT_TRUE(heap.allocator.tryAllocate(256 - s_headerSize, offset));
+    EXPECT_EQ(offset, first);
+}
+
+// x64 releasing blocks in arbitrary order from another thread, with the blocks checked for overlap.
+TEST(BulkDataAllocator, ConcurrentRelease)
+{
+    constexpr uint32_t s_size = 256 * 1024;
+    constexpr uint32_t s_count = 100000;
+
+    Heap heap(s_size);
+    std::mutex mutex;
+    std::vector<uint32_t> pending;
+    std::atomic<bool> done = false;
+    std::atomic<uint32_t> corruptCount = 0;
+
+    std::thread consumer([&]
+    {
+        std::mt19937 random(1);
+
+        while (true)
+        {
+            std::unique_lock lock(mutex);
+
+            if (pending.empty())
+            {
+                lock.unlock();
+
+                if (done)
+                    break;
+
+                std::this_thread::yield();
+                continue;
+            }
+
+            const size_t index = random() % pending.size();
+            const uint32_t offset = pending[index];
+            pending[index] = pending.back();
+            pending.pop_back();
+            lock.unlock();
+
+            const auto header = reinterpret_cast<BulkDataHeader*>(heap.memory.data() + offset - s_headerSize);
+            const uint8_t pattern = static_cast<uint8_t>(offset >> 4);
+
+            for (uint32_t i = 0; i < header->byteSize - s_headerSize; i++)
+            {
+                if (heap.memory[offset + i] != pattern)
+                {
+                    ++corruptCount;
+                    break;
+                }
+            }
+
+            header->released = true;
+        }
+    });
+
+    std::mt19937 random(2);
+
+    for (uint32_t i = 0; i < s_count; i++)
+    {
+        const uint32_t byteSize = 1 + random() % (random() % 16 == 0 ? 32 * 1024 : 512);
+        uint32_t offset;
+
+        while (!heap.allocator.tryAllocate(byteSize, offset))
+            std::this_thread::yield();
+
+        // Fill the padding too so the consumer can check the whole block.
+        const uint32_t blockSize = BulkDataAllocator::getBlockSize(byteSize) - s_headerSize;
+        memset(heap.memory.data() + offset, static_cast<uint8_t>(offset >> 4), blockSize);
+
+        std::lock_guard lock(mutex);
+        pending.push_back(offset);
+    }
+
+    done = true;
+    consumer.join();
+
+    EXPECT_EQ(corruptCount, 0u);
+
+    heap.allocator.reclaim();
+    EXPECT_EQ(heap.allocator.getUsedBlockCount(), 0u);
+    EXPECT_EQ(heap.allocator.getFreeBlockCount(), 1u);
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AlignmentUtil.h"
+#include "Message.h"
+#include "MessageCapture.h"
+#include "MessageSize.h"
+
+// Builds captures in memory the same way MessageSender writes them to disk.
+class CaptureBuilder
+{
+protected:
+    std::vector<uint8_t> m_data;
+
+    void append(const void* data, size_t dataSize)
+    {
+        m_data.insert(m_data.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + dataSize);
+    }
+
+public:
+    explicit CaptureBuilder(uint32_t magic = MessageCaptureHeader::s_magic, uint32_t lastMessageId = MsgWrap::s_id)
+    {
+        MessageCaptureHeader header{};
+        header.magic = magic;
+        header.lastMessageId = lastMessageId;
+        header.frequency = 1000000000;
+        append(&header, sizeof(header));
+    }
+
+    CaptureBuilder& record(MessageCaptureRecordType type, const void* data, uint32_t dataSize, const void* prefix = nullptr, uint32_t prefixSize = 0)
+    {
+        MessageCaptureRecord record{};
+        record.type = type;
+        record.byteSize = prefixSize + dataSize;
+        append(&record, sizeof(record));
+        append(prefix, prefixSize);
+        append(data, dataSize);
+        m_data.resize(m_data.size() + alignUp<size_t>(record.byteSize, alignof(MessageCaptureRecord)) - record.byteSize);
+        return *this;
+    }
+
+    template<typename T>
+    CaptureBuilder& message(const T& message)
+    {
+        return record(MessageCaptureRecordType::Message, &message, getMessageByteSize(&message));
+    }
+
+    CaptureBuilder& padding(uint8_t dataSize)
+    {
+        std::vector<uint8_t> message(offsetof(MsgPadding, data) + dataSize, 0xCD);
+        message[0] = MsgPadding::s_id;
+        message[1] = dataSize;
+        return record(MessageCaptureRecordType::Message, message.data(), static_cast<uint32_t>(message.size()));
+    }
+
+    CaptureBuilder& bulkData(uint32_t offset, const std::vector<uint8_t>& data)
+    {
+        return record(MessageCaptureRecordType::BulkData, data.data(), static_cast<uint32_t>(data.size()), &offset, sizeof(offset));
+    }
+
+    CaptureBuilder& frame(uint32_t frame)
+    {
+        return record(MessageCaptureRecordType::Frame, &frame, sizeof(frame));
+    }
+
+    std::vector<uint8_t>& get()
+    {
+        return m_data;
+    }
+};
\ No newline at end of file
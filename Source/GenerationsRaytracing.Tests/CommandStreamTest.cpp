@@ -0,0 +1,93 @@
+#include "CommandStream.h"
+
+namespace
+{
+    struct SetValue
+    {
+        static constexpr uint32_t s_id = 1;
+        uint32_t value;
+    };
+
+    struct SetPointer
+    {
+        static constexpr uint32_t s_id = 2;
+        const void* pointer;
+        uint64_t count;
+    };
+
+    std::vector<std::pair<uint32_t, uint64_t>> playAll(const CommandStream& stream)
+    {
+        std::vector<std::pair<uint32_t, uint64_t>> records;
+
+        stream.play([&](const CommandStream::Record& record)
+        {
+            switch (record.id)
+            {
+            case SetValue::s_id:
+                EXPECT_EQ(record.dataSize, 0u);
+                records.emplace_back(record.id, static_cast<const SetValue*>(record.command)->value);
+                break;
+
+            case SetPointer::s_id:
+            {
+                const auto command = static_cast<const SetPointer*>(record.command);
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(command) % alignof(SetPointer), 0u);
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(record.data) % alignof(uint64_t), 0u);
+                EXPECT_EQ(record.dataSize, command->count * sizeof(uint64_t));
+
+                uint64_t sum = 0;
+                for (uint64_t i = 0; i < command->count; i++)
+                    sum += static_cast<const uint64_t*>(record.data)[i];
+
+                records.emplace_back(record.id, sum);
+                break;
+            }
+
+            default:
+                ADD_FAILURE() << "Unknown record " << record.id;
+                break;
+            }
+        });
+
+        return records;
+    }
+}
+
+TEST(CommandStreamTest, PlaysRecordsInOrder)
+{
+    CommandStream stream;
+    EXPECT_TRUE(stream.isEmpty());
+
+    const uint64_t values[] = { 1, 2, 3 };
+
+    stream.append<SetValue>().value = 5;
+    stream.append<SetPointer>(values, sizeof(values)).count = 3;
+    stream.append<SetValue>().value = 7;
+    stream.append<SetPointer>(values, sizeof(uint64_t)).count = 1;
+
+    const std::vector<std::pair<uint32_t, uint64_t>> expected =
+    {
+        { SetValue::s_id, 5 }, { SetPointer::s_id, 6 }, { SetValue::s_id, 7 }, { SetPointer::s_id, 1 }
+    };
+
+    EXPECT_FALSE(stream.isEmpty());
+    EXPECT_EQ(playAll(stream), expected);
+
+    // Playing back doesn't consume the records.
+    EXPECT_EQ(playAll(stream), expected);
+}
+
+TEST(CommandStreamTest, ClearDropsRecords)
+{
+    CommandStream stream;
+    stream.append<SetValue>().value = 1;
+    stream.clear();
+
+    EXPECT_TRUE(stream.isEmpty());
+    EXPECT_TRUE(playAll(stream).empty());
+
+    stream.append<SetValue>().value = 2;
+
+    const std::vector<std::pair<uint32_t, uint64_t>> expected = { { SetValue::s_id, 2 } };
+    EXPECT_EQ(playAll(stream), expected);
+}
\ No newline at end of file
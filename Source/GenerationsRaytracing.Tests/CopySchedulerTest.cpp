@@ -0,0 +1,154 @@
+#include "CopyScheduler.h"
+
+namespace
+{
+    // Logs every call so the tests can check the order the GPU would see.
+    class MockCopyQueue final : public CopyQueueBackend
+    {
+    public:
+        std::vector<std::string> calls;
+        uint64_t completedFenceValue = 0;
+        bool isOpen = false;
+
+        void openCopyCommandList() override
+        {
+            EXPECT_FALSE(isOpen);
+            isOpen = true;
+            calls.push_back("open");
+        }
+
+        void submitCopyCommandList(uint64_t fenceValue) override
+        {
+            EXPECT_TRUE(isOpen);
+            isOpen = false;
+            calls.push_back("submit " + std::to_string(fenceValue));
+        }
+
+        void waitForCopies(uint64_t fenceValue) override
+        {
+            calls.push_back("wait " + std::to_string(fenceValue));
+        }
+
+        uint64_t getCompletedCopyFenceValue() const override
+        {
+            return completedFenceValue;
+        }
+    };
+
+    using Staging = std::shared_ptr<int>;
+
+    struct CopySchedulerTest : testing::Test
+    {
+        MockCopyQueue queue;
+        CopyScheduler<Staging> scheduler{ queue };
+
+        std::weak_ptr<int> addStaging()
+        {
+            auto staging = std::make_shared<int>();
+            std::weak_ptr<int> result = staging;
+            scheduler.addStaging(std::move(staging));
+            return result;
+        }
+    };
+}
+
+TEST_F(CopySchedulerTest, BatchesCopiesIntoOneSubmission)
+{
+    for (uint32_t i = 0; i < 100; i++)
+        scheduler.record();
+
+    EXPECT_TRUE(scheduler.isRecording());
+    scheduler.submit(5);
+
+    EXPECT_EQ(queue.calls, (std::vector<std::string>{ "open", "submit 5", "wait 5" }));
+    EXPECT_FALSE(scheduler.isRecording());
+}
+
+TEST_F(CopySchedulerTest, SkipsEmptySubmissions)
+{
+    scheduler.submit(1);
+    EXPECT_TRUE(queue.calls.empty());
+
+    scheduler.record();
+    scheduler.submit(2);
+    scheduler.submit(3);
+
+    EXPECT_EQ(queue.calls, (std::vector<std::string>{ "open", "submit 2", "wait 2" }));
+}
+
+TEST_F(CopySchedulerTest, GraphicsWaitsAfterEverySubmission)
+{
+    scheduler.record();
+    scheduler.submit(1);
+    scheduler.record();
+    scheduler.submit(4);
+
+    EXPECT_EQ(queue.calls, (std::vector<std::string>{ "open", "submit 1", "wait 1", "open", "submit 4", "wait 4" }));
+}
+
+TEST_F(CopySchedulerTest, KeepsStagingUntilFenceCompletes)
+{
+    scheduler.record();
+    const auto first = addStaging();
+    scheduler.submit(1);
+
+    scheduler.record();
+    const auto second = addStaging();
+
+    // Recorded but not submitted yet, nothing can be released.
+    scheduler.retire();
+    EXPECT_FALSE(first.expired());
+    EXPECT_FALSE(second.expired());
+
+    scheduler.submit(2);
+
+    queue.completedFenceValue = 1;
+    scheduler.retire();
+    EXPECT_TRUE(first.expired());
+    EXPECT_FALSE(second.expired());
+    EXPECT_EQ(scheduler.getStagingCount(), 1u);
+
+    queue.completedFenceValue = 2;
+    scheduler.retire();
+    EXPECT_TRUE(second.expired());
+    EXPECT_EQ(scheduler.getStagingCount(), 0u);
+}
+
+TEST_F(CopySchedulerTest, StagingOfLaterSubmissionWaitsForItsOwnFence)
+{
+    std::vector<std::weak_ptr<int>> stagings;
+
+    for (uint64_t fenceValue = 1; fenceValue <= 10; fenceValue++)
+    {
+        scheduler.record();
+        stagings.push_back(addStaging());
+        stagings.push_back(addStaging());
+        scheduler.submit(fenceValue * 10);
+    }
+
+    for (uint64_t completed = 0; completed <= 100; completed += 5)
+    {
+        queue.completedFenceValue = completed;
+        scheduler.retire();
+
+        for (size_t i = 0; i < stagings.size(); i++)
+            EXPECT_EQ(stagings[i].expired(), (i / 2 + 1) * 10 <= completed) << i << " at " << completed;
+    }
+}
+
+TEST_F(CopySchedulerTest, DestroyingReleasesEverything)
+{
+    std::weak_ptr<int> staging;
+    {
+        MockCopyQueue localQueue;
+        CopyScheduler<Staging> localScheduler(localQueue);
+
+        localScheduler.record();
+        auto shared = std::make_shared<int>();
+        staging = shared;
+        localScheduler.addStaging(std::move(shared));
+        localScheduler.submit(1);
+    }
+
+    EXPECT_TRUE(staging.expired());
+}
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "DdsLayout.h"
+
+namespace
+{
+    constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+    {
+        return DDS_MAKE_FOURCC(a, b, c, d);
+    }
+
+    struct DdsDesc
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t mipLevels;
+        uint32_t fourCC = 0;
+        uint32_t bitCount = 0;
+        uint32_t masks[4]{};
+        uint32_t pixelFormatFlags = 0x4;
+        uint32_t caps2 = 0;
+        uint32_t dxgiFormat = 0;
+        uint32_t arraySize = 1;
+        bool isCubeMap = false;
+    };
+
+    std::vector<uint8_t> makeHeader(const DdsDesc& desc)
+    {
+        const bool isDx10 = desc.fourCC == makeFourCC('D', 'X', '1', '0');
+        std::vector<uint8_t> header(isDx10 ? 148 : 128);
+
+        const auto write = [&](uint32_t offset, uint32_t value)
+        {
+            memcpy(header.data() + offset, &value, sizeof(value));
+        };
+
+        write(0, makeFourCC('D', 'D', 'S', ' '));
+        write(4, 124);
+        write(8, 0x1007 | (desc.mipLevels > 1 ? 0x20000 : 0));
+        write(12, desc.height);
+        write(16, desc.width);
+        write(28, desc.mipLevels);
+        write(76, 32);
+        write(80, desc.pixelFormatFlags);
+        write(84, desc.fourCC);
+        write(88, desc.bitCount);
+        for (uint32_t i = 0; i < 4; i++)
+            write(92 + i * 4, desc.masks[i]);
+        write(112, desc.caps2);
+
+        if (isDx10)
+        {
+            write(128, desc.dxgiFormat);
+            write(132, 3);
+            write(136, desc.isCubeMap ? 0x4 : 0);
+            write(140, desc.arraySize);
+        }
+
+        return header;
+    }
+
+    DdsDesc makeFourCCDesc(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t fourCC)
+    {
+        DdsDesc desc{ width, height, mipLevels };
+        desc.fourCC = fourCC;
+        return desc;
+    }
+
+    DdsDesc makeRgbDesc(uint32_t width, uint32_t height, uint32_t mipLevels)
+    {
+        DdsDesc desc{ width, height, mipLevels };
+        desc.pixelFormatFlags = 0x41;
+        desc.bitCount = 32;
+        desc.masks[0] = 0xFF0000;
+        desc.masks[1] = 0xFF00;
+        desc.masks[2] = 0xFF;
+        desc.masks[3] = 0xFF000000;
+        return desc;
+    }
+
+    DdsDesc makeDx10Desc(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t format, uint32_t arraySize, bool isCubeMap)
+    {
+        DdsDesc desc{ width, height, mipLevels };
+        desc.fourCC = makeFourCC('D', 'X', '1', '0');
+        desc.dxgiFormat = format;
+        desc.arraySize = arraySize;
+        desc.isCubeMap = isCubeMap;
+        return desc;
+    }
+
+    // Stands in for the texture on x64, with every subresource padded like an upload footprint.
+    struct Reassembler
+    {
+        static constexpr uint32_t s_pitchAlignment = 256;
+
+        const DdsLayout& layout;
+        std::vector<std::vector<uint8_t>> subresources;
+        std::vector<std::vector<uint32_t>> writeCounts;
+
+        Reassembler(const DdsLayout& layout) : layout(layout)
+        {
+            for (const auto& subresource : layout.getSubresources())
+            {
+                subresources.emplace_back(getPitch(subresource) * subresource.rowCount);
+                writeCounts.emplace_back(subresource.rowCount);
+            }
+        }
+
+        static uint32_t getPitch(const DdsSubresource& subresource)
+        {
+            return (subresource.rowPitch + s_pitchAlignment - 1) & ~(s_pitchAlignment - 1);
+        }
+
+        // Only knows what the chunk message carries.
+        void write(uint32_t index, uint32_t row, const uint8_t* data, uint32_t byteSize)
+        {
+            const auto& subresource = layout.getSubresources()[index];
+            const uint32_t rowCount = byteSize / subresource.rowPitch;
+
+            ASSERT_EQ(byteSize % subresource.rowPitch, 0u);
+            ASSERT_LE(row + rowCount, subresource.rowCount);
+
+            for (uint32_t i = 0; i < rowCount; i++)
+            {
+                memcpy(subresources[index].data() + (row + i) * getPitch(subresource), data + i * subresource.rowPitch, subresource.rowPitch);
+                ++writeCounts[index][row + i];
+            }
+        }
+
+        void verify(const uint8_t* pixels) const
+        {
+            for (uint32_t i = 0; i < subresources.size(); i++)
+            {
+                const auto& subresource = layout.getSubresources()[i];
+
+                for (uint32_t j = 0; j < subresource.rowCount; j++)
+                {
+                    ASSERT_EQ(writeCounts[i][j], 1u) << "subresource " << i << " row " << j;
+                    ASSERT_EQ(memcmp(subresources[i].data() + j * getPitch(subresource), 
+                        pixels + subresource.offset + j * subresource.rowPitch, subresource.rowPitch), 0) << "subresource " << i << " row " << j;
+                }
+            }
+        }
+    };
+
+    struct RoundTripParam
+    {
+        const char* name;
+        DdsDesc desc;
+        uint32_t chunkSize;
+    };
+
+    void PrintTo(const RoundTripParam& param, std::ostream* stream)
+    {
+        *stream << param.name << "/" << param.chunkSize;
+    }
+
+    class DdsRoundTrip : public testing::TestWithParam<RoundTripParam>
+    {
+    };
+}
+
+TEST(DdsLayout, LegacyFormats)
+{
+    struct Case
+    {
+        DdsDesc desc;
+        uint32_t format;
+    };
+
+    DdsDesc luminance{ 4, 4, 1 };
+    luminance.pixelFormatFlags = 0x20000;
+    luminance.bitCount = 8;
+    luminance.masks[0] = 0xFF;
+
+    DdsDesc alpha{ 4, 4, 1 };
+    alpha.pixelFormatFlags = 0x2;
+    alpha.bitCount = 8;
+    alpha.masks[3] = 0xFF;
+
+    const Case cases[] =
+    {
+        { makeFourCCDesc(4, 4, 1, makeFourCC('D', 'X', 'T', '1')), 71 },
+        { makeFourCCDesc(4, 4, 1, makeFourCC('D', 'X', 'T', '3')), 74 },
+        { makeFourCCDesc(4, 4, 1, makeFourCC('D', 'X', 'T', '5')), 77 },
+        { makeFourCCDesc(4, 4, 1, makeFourCC('A', 'T', 'I', '1')), 80 },
+        { makeFourCCDesc(4, 4, 1, makeFourCC('A', 'T', 'I', '2')), 83 },
+        { makeFourCCDesc(4, 4, 1, 113), 10 },
+        { makeFourCCDesc(4, 4, 1, 116), 2 },
+        { makeRgbDesc(4, 4, 1), 87 },
+        { luminance, 61 },
+        { alpha, 65 },
+    };
+
+    for (const auto& testCase : cases)
+    {
+        const auto header = makeHeader(testCase.desc);
+
+        DdsLayout layout;
+        ASSERT_TRUE(layout.parse(header.data(), header.size()));
+        EXPECT_EQ(layout.getFormat(), testCase.format);
+        EXPECT_EQ(layout.getHeaderSize(), 128u);
+    }
+}
+
+TEST(DdsLayout, RejectsWhatTheLoaderShouldHandle)
+{
+    DdsLayout layout;
+
+    auto header = makeHeader(makeFourCCDesc(4, 4, 1, makeFourCC('U', 'Y', 'V', 'Y')));
+    EXPECT_FALSE(layout.parse(header.data(), header.size()));
+
+    // Volume texture
+    auto volume = makeFourCCDesc(4, 4, 1, makeFourCC('D', 'X', 'T', '1'));
+    volume.caps2 = 0x200000;
+    header = makeHeader(volume);
+    header[10] |= 0x80;
+    header[24] = 4;
+    EXPECT_FALSE(layout.parse(header.data(), header.size()));
+
+    // Cube map missing faces
+    auto cube = makeFourCCDesc(4, 4, 1, makeFourCC('D', 'X', 'T', '1'));
+    cube.caps2 = 0x200 | 0x400;
+    header = makeHeader(cube);
+    EXPECT_FALSE(layout.parse(header.data(), header.size()));
+
+    // Truncated
+    header = makeHeader(makeDx10Desc(4, 4, 1, 98, 1, false));
+    EXPECT_FALSE(layout.parse(header.data(), 128));
+    EXPECT_FALSE(layout.parse(header.data(), 64));
+
+    header[0] = 'X';
+    EXPECT_FALSE(layout.parse(header.data(), header.size()));
+}
+
+TEST(DdsLayout, CompressedMipChain)
+{
+    const auto header = makeHeader(makeFourCCDesc(10, 6, 4, makeFourCC('D', 'X', 'T', '1')));
+
+    DdsLayout layout;
+    ASSERT_TRUE(layout.parse(header.data(), header.size()));
+
+    const auto& subresources = layout.getSubresources();
+    ASSERT_EQ(subresources.size(), 4u);
+
+    // 10x6, 5x3, 2x1 and 1x1 round up to whole blocks.
+    EXPECT_EQ(subresources[0].rowPitch, 3u * 8);
+    EXPECT_EQ(subresources[0].rowCount, 2u);
+    EXPECT_EQ(subresources[1].rowPitch, 2u * 8);
+    EXPECT_EQ(subresources[1].rowCount, 1u);
+    EXPECT_EQ(subresources[2].rowPitch, 8u);
+    EXPECT_EQ(subresources[3].rowPitch, 8u);
+    EXPECT_EQ(subresources[3].width, 1u);
+
+    EXPECT_EQ(subresources[1].offset, 48u);
+    EXPECT_EQ(layout.getDataSize(), 48u + 16 + 8 + 8);
+}
+
+TEST(DdsLayout, CubeMapFacesFollowEachOther)
+{
+    auto desc = makeRgbDesc(8, 8, 4);
+    desc.caps2 = 0x200 | 0xFC00;
+    const auto header = makeHeader(desc);
+
+    DdsLayout layout;
+    ASSERT_TRUE(layout.parse(header.data(), header.size()));
+
+    EXPECT_TRUE(layout.isCubeMap());
+    EXPECT_EQ(layout.getArraySize(), 6u);
+    ASSERT_EQ(layout.getSubresources().size(), 24u);
+
+    const uint32_t faceSize = (64 + 16 + 4 + 1) * 4;
+    EXPECT_EQ(layout.getSubresources()[4].offset, faceSize);
+    EXPECT_EQ(layout.getDataSize(), faceSize * 6);
+}
+
+TEST(DdsLayout, ChunksNeverSplitRows)
+{
+    const auto header = makeHeader(makeRgbDesc(300, 7, 1));
+
+    DdsLayout layout;
+    ASSERT_TRUE(layout.parse(header.data(), header.size()));
+
+    std::vector<DdsChunk> chunks;
+    layout.forEachChunk(1000, [&](const DdsChunk& chunk) { chunks.push_back(chunk); });
+
+    // Rows are 1200 bytes, which is larger than the chunk size.
+    ASSERT_EQ(chunks.size(), 7u);
+    for (uint32_t i = 0; i < chunks.size(); i++)
+    {
+        EXPECT_EQ(chunks[i].row, i);
+        EXPECT_EQ(chunks[i].byteSize, 1200u);
+    }
+
+    chunks.clear();
+    layout.forEachChunk(2500, [&](const DdsChunk& chunk) { chunks.push_back(chunk); });
+
+    ASSERT_EQ(chunks.size(), 4u);
+    EXPECT_EQ(chunks[3].rowCount, 1u);
+    EXPECT_EQ(chunks[3].offset, 6u * 1200);
+}
+
+TEST_P(DdsRoundTrip, Reassembles)
+{
+    const auto& param = GetParam();
+    const auto header = makeHeader(param.desc);
+
+    DdsLayout layout;
+    ASSERT_TRUE(layout.parse(header.data(), header.size()));
+
+    std::vector<uint8_t> file(header);
+    std::mt19937 random(layout.getDataSize());
+    for (uint32_t i = 0; i < layout.getDataSize(); i++)
+        file.push_back(static_cast<uint8_t>(random()));
+
+    // x86 only ever sends the header, x64 parses it again.
+    DdsLayout receiverLayout;
+    ASSERT_TRUE(receiverLayout.parse(file.data(), layout.getHeaderSize()));
+    ASSERT_EQ(receiverLayout.getDataSize(), layout.getDataSize());
+
+    Reassembler reassembler(receiverLayout);
+    const uint8_t* pixels = file.data() + layout.getHeaderSize();
+    uint32_t expectedOffset = 0;
+
+    layout.forEachChunk(param.chunkSize, [&](const DdsChunk& chunk)
+    {
+        EXPECT_EQ(chunk.offset, expectedOffset);
+        expectedOffset += chunk.byteSize;
+
+        if (chunk.rowCount > 1)
+        {
+            EXPECT_LE(chunk.byteSize, param.chunkSize);
+        }
+
+        reassembler.write(chunk.subresource, chunk.row, pixels + chunk.offset, chunk.byteSize);
+    });
+
+    EXPECT_EQ(expectedOffset, layout.getDataSize());
+    reassembler.verify(pixels);
+}
+
+INSTANTIATE_TEST_SUITE_P(Corpus, DdsRoundTrip, testing::ValuesIn(std::vector<RoundTripParam>
+{
+    { "Dxt1", makeFourCCDesc(1024, 512, 11, makeFourCC('D', 'X', 'T', '1')), 64 * 1024 },
+    { "Dxt5", makeFourCCDesc(1000, 600, 10, makeFourCC('D', 'X', 'T', '5')), 4096 },
+    { "Dxt5Tiny", makeFourCCDesc(3, 3, 2, makeFourCC('D', 'X', 'T', '5')), 1 },
+    { "Ati2", makeFourCCDesc(256, 256, 9, makeFourCC('A', 'T', 'I', '2')), 1000 },
+    { "Bgra", makeRgbDesc(513, 257, 10), 16 * 1024 },
+    { "BgraSingleRow", makeRgbDesc(4096, 1, 1), 1024 },
+    { "Rgba16f", makeFourCCDesc(128, 64, 8, 113), 4 * 1024 * 1024 },
+    { "Bc7Array", makeDx10Desc(256, 128, 9, 98, 3, false), 8192 },
+    { "Bc6hCube", makeDx10Desc(64, 64, 7, 95, 1, true), 2048 },
+    { "Bc1CubeArray", makeDx10Desc(32, 32, 6, 71, 2, true), 100 },
+}));
\ No newline at end of file
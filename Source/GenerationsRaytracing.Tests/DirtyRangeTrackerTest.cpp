@@ -0,0 +1,146 @@
+#include "DirtyRangeTracker.h"
+
+using Ranges = std::vector<DirtyRangeTracker::Range>;
+
+TEST(DirtyRangeTracker, StartsClean)
+{
+    DirtyRangeTracker tracker;
+
+    EXPECT_TRUE(tracker.isEmpty());
+    EXPECT_TRUE(tracker.coalesce(1024).empty());
+}
+
+TEST(DirtyRangeTracker, IgnoresEmptyWrites)
+{
+    DirtyRangeTracker tracker;
+    tracker.markDirty(64, 0);
+
+    EXPECT_TRUE(tracker.isEmpty());
+}
+
+TEST(DirtyRangeTracker, ExtendsConsecutiveWrites)
+{
+    DirtyRangeTracker tracker(0);
+
+    for (uint32_t i = 0; i < 100; i++)
+        tracker.markDirty(i * 16, 16);
+
+    EXPECT_EQ(tracker.getRanges(), (Ranges{ { 0, 1600 } }));
+}
+
+TEST(DirtyRangeTracker, MergesOverlappingRanges)
+{
+    DirtyRangeTracker tracker(0);
+    tracker.markDirty(100, 50);
+    tracker.markDirty(10, 20);
+    tracker.markDirty(120, 100);
+    tracker.markDirty(25, 10);
+
+    EXPECT_EQ(tracker.coalesce(1024), (Ranges{ { 10, 35 }, { 100, 220 } }));
+}
+
+TEST(DirtyRangeTracker, MergesRangesWithinDistance)
+{
+    DirtyRangeTracker tracker(16);
+    tracker.markDirty(0, 16);
+    tracker.markDirty(32, 16);
+    tracker.markDirty(65, 16);
+
+    EXPECT_EQ(tracker.coalesce(1024), (Ranges{ { 0, 48 }, { 65, 81 } }));
+}
+
+TEST(DirtyRangeTracker, ClampsToTableSize)
+{
+    DirtyRangeTracker tracker(0);
+    tracker.markDirty(0, 16);
+    tracker.markDirty(100, 100);
+    tracker.markDirty(500, 16);
+
+    EXPECT_EQ(tracker.coalesce(150), (Ranges{ { 0, 16 }, { 100, 150 } }));
+}
+
+TEST(DirtyRangeTracker, MarkAllReplacesRanges)
+{
+    DirtyRangeTracker tracker;
+    tracker.markDirty(0, 16);
+    tracker.markDirty(4096, 16);
+    tracker.markAll(256);
+
+    EXPECT_EQ(tracker.getRanges(), (Ranges{ { 0, 256 } }));
+}
+
+TEST(DirtyRangeTracker, CountsDirtyBytes)
+{
+    DirtyRangeTracker tracker(0);
+    tracker.markDirty(0, 16);
+    tracker.markDirty(1000, 24);
+
+    EXPECT_EQ(tracker.getDirtyByteCount(), 40u);
+
+    tracker.clear();
+    EXPECT_EQ(tracker.getDirtyByteCount(), 0u);
+}
+
+TEST(DirtyRangeTracker, HandlesRangesNearTheEndOfTheAddressSpace)
+{
+    DirtyRangeTracker tracker(256);
+    tracker.markDirty(0xFFFFFE00, 0x100);
+    tracker.markDirty(0xFFFFFF00, 0xFF);
+
+    EXPECT_EQ(tracker.coalesce(0xFFFFFFFF), (Ranges{ { 0xFFFFFE00, 0xFFFFFFFF } }));
+}
+
+// Replays random writes against a byte map and checks that the coalesced ranges cover every
+// written byte, stay sorted and disjoint, and only span clean bytes across gaps within the merge distance.
+TEST(DirtyRangeTracker, MatchesReferenceOnRandomWrites)
+{
+    std::mt19937 random(0x1234);
+
+    for (uint32_t iteration = 0; iteration < 200; iteration++)
+    {
+        const uint32_t mergeDistance = random() % 64;
+        const uint32_t tableSize = 1 + random() % 4096;
+
+        DirtyRangeTracker tracker(mergeDistance);
+        std::vector<bool> written(tableSize + 512);
+
+        const uint32_t writeCount = random() % 64;
+        for (uint32_t i = 0; i < writeCount; i++)
+        {
+            const uint32_t offset = random() % (tableSize + 256);
+            const uint32_t byteSize = random() % 256;
+            tracker.markDirty(offset, byteSize);
+
+            for (uint32_t j = offset; j < offset + byteSize; j++)
+                written[j] = true;
+        }
+
+        const auto& ranges = tracker.coalesce(tableSize);
+
+        std::vector<bool> covered(tableSize);
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            const auto [begin, end] = ranges[i];
+            ASSERT_LT(begin, end);
+            ASSERT_LE(end, tableSize);
+            ASSERT_TRUE(written[begin]);
+            ASSERT_TRUE(written[end - 1]);
+
+            if (i > 0)
+            {
+                ASSERT_GT(begin, ranges[i - 1].second + mergeDistance);
+            }
+
+            uint32_t gap = 0;
+            for (uint32_t j = begin; j < end; j++)
+            {
+                covered[j] = true;
+                gap = written[j] ? 0 : gap + 1;
+                ASSERT_LE(gap, mergeDistance);
+            }
+        }
+
+        for (uint32_t i = 0; i < tableSize; i++)
+            ASSERT_TRUE(covered[i] || !written[i]) << i;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "FrameFence.h"
+#include "MemoryMappedFile.h"
+#include "MessageQueue.h"
+
+namespace
+{
+    constexpr TCHAR s_memoryMappedFileName[] = TEXT("GenerationsRaytracingFrameFenceTest");
+    constexpr TCHAR s_eventName[] = TEXT("GenerationsRaytracingFrameFenceTestEvent");
+
+    struct SharedState
+    {
+        MessageQueue queue;
+        std::atomic<uint32_t> sentFrame;
+    };
+
+    // Plays x64, opening the shared memory and the event by name like the other process would.
+    void consume(uint32_t frameCount, uint32_t& maxFramesInFlight)
+    {
+        MemoryMappedFile memoryMappedFile(s_memoryMappedFileName, sizeof(SharedState));
+        auto state = static_cast<SharedState*>(memoryMappedFile.map());
+
+        Event event(s_eventName);
+        FrameFence frameFence(state->queue.completedFrame, event);
+
+        for (uint32_t frame = 1; frame <= frameCount; frame++)
+        {
+            while (state->sentFrame.load() < frame)
+                std::this_thread::yield();
+
+            maxFramesInFlight = std::max(maxFramesInFlight, state->sentFrame.load() - frameFence.getCompletedFrame());
+            frameFence.signal();
+        }
+
+        memoryMappedFile.unmap(state);
+    }
+}
+
+class FrameFenceTest : public testing::TestWithParam<uint32_t>
+{
+};
+
+TEST_P(FrameFenceTest, ProducerStaysWithinMaxFramesAhead)
+{
+    constexpr uint32_t s_frameCount = 200;
+    const uint32_t maxFramesAhead = GetParam();
+
+    MemoryMappedFile memoryMappedFile(s_memoryMappedFileName, sizeof(SharedState));
+    auto state = static_cast<SharedState*>(memoryMappedFile.map());
+    state->queue.completedFrame = 0;
+    state->sentFrame = 0;
+
+    Event event(s_eventName, FALSE, FALSE);
+    FrameFence frameFence(state->queue.completedFrame, event);
+
+    uint32_t maxFramesInFlight = 0;
+    std::thread consumer(consume, s_frameCount, std::ref(maxFramesInFlight));
+
+    const size_t shouldExit = 0;
+
+    for (uint32_t frame = 1; frame <= s_frameCount; frame++)
+    {
+        state->sentFrame = frame;
+        frameFence.wait(frame, maxFramesAhead, &shouldExit);
+
+        EXPECT_LE(frame - frameFence.getCompletedFrame(), maxFramesAhead);
+    }
+
+    consumer.join();
+
+    EXPECT_EQ(frameFence.getCompletedFrame(), s_frameCount);
+    EXPECT_LE(maxFramesInFlight, maxFramesAhead + 1);
+
+    memoryMappedFile.unmap(state);
+}
+
+INSTANTIATE_TEST_SUITE_P(MaxFramesAhead, FrameFenceTest, testing::Values(0u, 1u, 2u, 3u));
+
+TEST(FrameFence, WaitReturnsOnExit)
+{
+    std::atomic<uint32_t> completedFrame{ 0 };
+    Event event(s_eventName, FALSE, FALSE);
+    FrameFence frameFence(completedFrame, event);
+
+    const size_t shouldExit = 1;
+    frameFence.wait(10, 0, &shouldExit);
+
+    EXPECT_EQ(frameFence.getCompletedFrame(), 0u);
+}
+
+TEST(FrameFence, WaitHandlesCounterWrapAround)
+{
+    std::atomic<uint32_t> completedFrame{ UINT32_MAX };
+    Event event(s_eventName, FALSE, FALSE);
+    FrameFence frameFence(completedFrame, event);
+
+    frameFence.signal();
+    EXPECT_EQ(frameFence.getCompletedFrame(), 0u);
+
+    // Frame 1 is only one frame ahead of frame 0 even though the counter wrapped.
+    const size_t shouldExit = 0;
+    frameFence.wait(1, 1, &shouldExit);
+}
\ No newline at end of file
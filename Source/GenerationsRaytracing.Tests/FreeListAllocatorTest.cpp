@@ -0,0 +1,248 @@
+#include "BitUtil.h"
+#include "FreeListAllocator.h"
+#include "LegacyFreeListAllocator.h"
+
+TEST(BitUtil, FindsLowestAndHighestSetBit)
+{
+    for (uint32_t i = 0; i < 32; i++)
+    {
+        EXPECT_EQ(findFirstSetBit(1u << i), i);
+        EXPECT_EQ(findLastSetBit(1u << i), i);
+    }
+
+    EXPECT_EQ(findFirstSetBit(0xF0F0F000u), 12u);
+    EXPECT_EQ(findLastSetBit(0x0000F0F0u), 15u);
+    EXPECT_EQ(findFirstSetBit(~0u), 0u);
+    EXPECT_EQ(findLastSetBit(~0u), 31u);
+}
+
+TEST(FreeListAllocator, ReservesNull)
+{
+    FreeListAllocator allocator;
+    EXPECT_EQ(allocator.allocate(), 1u);
+    EXPECT_EQ(allocator.allocate(), 2u);
+}
+
+TEST(FreeListAllocator, ReusesLowestIndexFirst)
+{
+    FreeListAllocator allocator;
+    for (uint32_t i = 0; i < 10; i++)
+        allocator.allocate();
+
+    allocator.free(7);
+    allocator.free(3);
+    allocator.free(9);
+
+    EXPECT_EQ(allocator.allocate(), 3u);
+    EXPECT_EQ(allocator.allocate(), 7u);
+    EXPECT_EQ(allocator.allocate(), 9u);
+    EXPECT_EQ(allocator.allocate(), 11u);
+}
+
+// Crosses every level of the bit hierarchy.
+TEST(FreeListAllocator, ReusesAcrossLevels)
+{
+    FreeListAllocator allocator;
+    for (uint32_t i = 0; i < 70000; i++)
+        allocator.allocate();
+
+    allocator.free(69999);
+    allocator.free(33000);
+    allocator.free(1025);
+
+    EXPECT_EQ(allocator.allocate(), 1025u);
+    EXPECT_EQ(allocator.allocate(), 33000u);
+    EXPECT_EQ(allocator.allocate(), 69999u);
+    EXPECT_EQ(allocator.allocate(), 70001u);
+}
+
+TEST(FreeListAllocator, MatchesLegacyAllocator)
+{
+    std::mt19937 random(0xF1EE);
+    FreeListAllocator allocator;
+    LegacyFreeListAllocator legacyAllocator;
+    std::vector<uint32_t> indices;
+
+    for (uint32_t i = 0; i < 200000; i++)
+    {
+        // Alternate between growing, shrinking and mass releases like stage loads do.
+        const uint32_t phase = (i / 5000) % 4;
+        const bool shouldFree = !indices.empty() && (phase == 3 || random() % 4 < phase + 1);
+
+        if (shouldFree)
+        {
+            const size_t position = random() % indices.size();
+            allocator.free(indices[position]);
+            legacyAllocator.free(indices[position]);
+            indices[position] = indices.back();
+            indices.pop_back();
+        }
+        else
+        {
+            const uint32_t index = allocator.allocate();
+            ASSERT_EQ(index, legacyAllocator.allocate());
+            indices.push_back(index);
+        }
+    }
+}
+
+TEST(FreeListAllocator, MassReleaseInAnyOrder)
+{
+    FreeListAllocator allocator;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 50000; i++)
+        indices.push_back(allocator.allocate());
+
+    std::shuffle(indices.begin(), indices.end(), std::mt19937(7));
+    for (const auto index : indices)
+        allocator.free(index);
+
+    for (uint32_t i = 1; i <= 50000; i++)
+        ASSERT_EQ(allocator.allocate(), i);
+
+    EXPECT_EQ(allocator.allocate(), 50001u);
+}
+
+TEST(FreeListAllocator, RangesComeFromTheEnd)
+{
+    FreeListAllocator allocator;
+    allocator.allocate();
+    allocator.allocate();
+    allocator.free(1);
+
+    EXPECT_EQ(allocator.allocateMany(10), 3u);
+    EXPECT_EQ(allocator.allocate(), 1u);
+    EXPECT_EQ(allocator.allocate(), 13u);
+}
+
+TEST(FreeListAllocator, ReusesFreedRangesBestFit)
+{
+    FreeListAllocator allocator;
+    const uint32_t first = allocator.allocateMany(100);
+    const uint32_t second = allocator.allocateMany(30);
+    const uint32_t third = allocator.allocateMany(50);
+    allocator.allocateMany(1);
+
+    allocator.freeMany(first, 100);
+    allocator.freeMany(third, 50);
+
+    // The smaller range fits and gets split, the remnant stays available.
+    EXPECT_EQ(allocator.allocateMany(40), third);
+    EXPECT_EQ(allocator.allocateMany(10), third + 40);
+    EXPECT_EQ(allocator.allocateMany(100), first);
+
+    // Nothing left that fits.
+    EXPECT_EQ(allocator.allocateMany(1), third + 51);
+    (void)second;
+}
+
+TEST(FreeListAllocator, MergesNeighboringRanges)
+{
+    FreeListAllocator allocator;
+    const uint32_t first = allocator.allocateMany(10);
+    const uint32_t second = allocator.allocateMany(10);
+    const uint32_t third = allocator.allocateMany(10);
+    allocator.allocateMany(1);
+
+    allocator.freeMany(first, 10);
+    allocator.freeMany(third, 10);
+    allocator.freeMany(second, 10);
+
+    EXPECT_EQ(allocator.allocateMany(30), first);
+}
+
+TEST(FreeListAllocator, RangesNeverOverlap)
+{
+    std::mt19937 random(0xDE5C);
+    FreeListAllocator allocator;
+    std::map<uint32_t, uint32_t> ranges;
+    std::vector<uint32_t> singles;
+
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        const uint32_t action = random() % 4;
+        if (action == 0 && !ranges.empty())
+        {
+            auto it = ranges.begin();
+            std::advance(it, random() % ranges.size());
+            allocator.freeMany(it->first, it->second);
+            ranges.erase(it);
+        }
+        else if (action == 1 && !singles.empty())
+        {
+            allocator.free(singles.back());
+            singles.pop_back();
+        }
+        else if (action == 2)
+        {
+            singles.push_back(allocator.allocate());
+        }
+        else
+        {
+            const uint32_t count = 1 + random() % 64;
+            const uint32_t index = allocator.allocateMany(count);
+
+            const auto next = ranges.lower_bound(index);
+            ASSERT_TRUE(next == ranges.end() || next->first >= index + count);
+            if (next != ranges.begin())
+            {
+                ASSERT_LE(std::prev(next)->first + std::prev(next)->second, index);
+            }
+
+            ranges.emplace(index, count);
+        }
+    }
+
+    for (const auto single : singles)
+    {
+        auto next = ranges.upper_bound(single);
+        if (next != ranges.begin())
+        {
+            ASSERT_GE(single, std::prev(next)->first + std::prev(next)->second);
+        }
+    }
+}
+
+TEST(FreeListAllocator, ConcurrentAllocationsAreUnique)
+{
+    FreeListAllocator allocator;
+    constexpr uint32_t s_threadNum = 4;
+    constexpr uint32_t s_iterationNum = 20000;
+
+    std::vector<uint32_t> indices[s_threadNum];
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < s_threadNum; i++)
+    {
+        threads.emplace_back([&, i]
+        {
+            std::mt19937 random(i);
+            std::vector<uint32_t> live;
+
+            for (uint32_t j = 0; j < s_iterationNum; j++)
+            {
+                if (!live.empty() && random() % 2 == 0)
+                {
+                    allocator.free(live.back());
+                    live.pop_back();
+                }
+                else
+                {
+                    live.push_back(allocator.allocate());
+                }
+            }
+
+            indices[i] = std::move(live);
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<uint32_t> all;
+    for (const auto& threadIndices : indices)
+        all.insert(all.end(), threadIndices.begin(), threadIndices.end());
+
+    std::sort(all.begin(), all.end());
+    EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// The previous FreeListAllocator, which kept its free indices sorted in descending order.
+// The tests compare the new one against it, the benchmarks time both.
+class LegacyFreeListAllocator
+{
+protected:
+    std::vector<uint32_t> m_indices;
+    uint32_t m_capacity = 1;
+
+public:
+    uint32_t allocate()
+    {
+        if (m_indices.empty())
+            return m_capacity++;
+
+        const uint32_t index = m_indices.back();
+        m_indices.pop_back();
+        return index;
+    }
+
+    void free(uint32_t index)
+    {
+        m_indices.insert(std::lower_bound(m_indices.begin(), m_indices.end(), index, std::greater<uint32_t>()), index);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <map>
+
+// The previous geometry desc range allocator, exact best fit over a count ordered multimap with a map of
+// beginnings for merging. The tests compare the new one against it, the benchmarks time both.
+class LegacyRangeAllocator
+{
+protected:
+    std::multimap<uint32_t, uint32_t> m_freeCounts;
+    std::map<uint32_t, std::multimap<uint32_t, uint32_t>::iterator> m_freeIndices;
+    uint32_t m_capacity = 0;
+
+public:
+    uint32_t allocate(uint32_t count)
+    {
+        const auto it = m_freeCounts.lower_bound(count);
+        if (it == m_freeCounts.end())
+        {
+            const uint32_t index = m_capacity;
+            m_capacity += count;
+            return index;
+        }
+
+        const uint32_t remnant = it->first - count;
+        const uint32_t index = it->second + remnant;
+
+        const auto it2 = m_freeIndices.find(it->second);
+        assert(it2 != m_freeIndices.end());
+
+        if (remnant > 0)
+        {
+            auto node = m_freeCounts.extract(it);
+            node.key() = remnant;
+            it2->second = m_freeCounts.insert(std::move(node));
+        }
+        else
+        {
+            m_freeIndices.erase(it2);
+            m_freeCounts.erase(it);
+        }
+
+        return index;
+    }
+
+    void free(uint32_t id, uint32_t count)
+    {
+        const auto next = m_freeIndices.lower_bound(id);
+        if (next != m_freeIndices.begin())
+        {
+            const auto prev = std::prev(next);
+            if (prev->first + prev->second->first == id)
+            {
+                id = prev->first;
+                count += prev->second->first;
+
+                m_freeCounts.erase(prev->second);
+                m_freeIndices.erase(prev);
+            }
+        }
+
+        if (next != m_freeIndices.end() && id + count == next->first)
+        {
+            count += next->second->first;
+            m_freeCounts.erase(next->second);
+            m_freeIndices.erase(next);
+        }
+
+        if (id + count == m_capacity)
+            m_capacity = id;
+        else
+            m_freeIndices.emplace(id, m_freeCounts.emplace(count, id));
+    }
+
+    uint32_t getCapacity() const
+    {
+        return m_capacity;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,444 @@
+#include "MaterialVersion.h"
+
+namespace
+{
+    struct MockTexture
+    {
+        uint32_t id;
+    };
+
+    struct MockPicture
+    {
+        MockTexture* texture = nullptr;
+        bool made = false;
+    };
+
+    // Stands in for MaterialDataEx, with the kinds of state the game mutates.
+    struct MockMaterial
+    {
+        uint32_t id = 0;
+        MaterialVersion version{};
+        float diffuse[4]{};
+        std::shared_ptr<float[]> texcoordOffset = std::shared_ptr<float[]>(new float[8]{});
+        std::vector<MockPicture*> pictures;
+
+        MockMaterial()
+        {
+            version.reset();
+        }
+    };
+
+    // What the material looked like when it was last sent.
+    struct SentState
+    {
+        float diffuse[4];
+        float texcoordOffset[8];
+        std::vector<MockTexture*> textures;
+
+        bool operator==(const SentState& other) const
+        {
+            return memcmp(diffuse, other.diffuse, sizeof(diffuse)) == 0 &&
+                memcmp(texcoordOffset, other.texcoordOffset, sizeof(texcoordOffset)) == 0 &&
+                textures == other.textures;
+        }
+    };
+
+    SentState getState(const MockMaterial& material)
+    {
+        SentState state;
+        memcpy(state.diffuse, material.diffuse, sizeof(state.diffuse));
+        memcpy(state.texcoordOffset, material.texcoordOffset.get(), sizeof(state.texcoordOffset));
+
+        for (const auto picture : material.pictures)
+            state.textures.push_back(picture->texture);
+
+        return state;
+    }
+
+    uint32_t hashBytes(uint32_t hash, const void* data, size_t byteSize)
+    {
+        for (size_t i = 0; i < byteSize; i++)
+            hash = (hash ^ static_cast<const uint8_t*>(data)[i]) * 16777619u;
+
+        return hash;
+    }
+
+    // Mirrors computeMaterialHash on x86.
+    uint32_t computeHash(const MockMaterial& material, bool& hasPendingTextures)
+    {
+        uint32_t hash = 2166136261u;
+        hash = hashBytes(hash, material.diffuse, sizeof(material.diffuse));
+        hash = hashBytes(hash, material.texcoordOffset.get(), sizeof(float[8]));
+
+        for (const auto picture : material.pictures)
+        {
+            hash = hashBytes(hash, &picture->texture, sizeof(picture->texture));
+
+            if (picture->texture == nullptr && !picture->made)
+                hasPendingTextures = true;
+        }
+
+        return hash;
+    }
+
+    // Runs MaterialData::create for every material each frame, like the instance traversal does.
+    class MaterialHarness
+    {
+    public:
+        std::vector<std::unique_ptr<MockMaterial>> materials;
+        std::vector<SentState> sentStates;
+        std::vector<uint32_t> sendCounts;
+        uint32_t frame = 0;
+        uint32_t hashCount = 0;
+
+        MockMaterial& add()
+        {
+            auto& material = *materials.emplace_back(std::make_unique<MockMaterial>());
+            sentStates.emplace_back();
+            sendCounts.push_back(0);
+            return material;
+        }
+
+        void runFrame()
+        {
+            for (size_t i = 0; i < materials.size(); i++)
+            {
+                auto& material = *materials[i];
+                const bool isNew = material.id == 0;
+
+                if (isNew)
+                    material.id = static_cast<uint32_t>(i + 1);
+
+                const bool shouldCreate = material.version.update(isNew,
+                    MaterialVersion::shouldValidate(material.id, frame), [&](bool& hasPendingTextures)
+                    {
+                        ++hashCount;
+                        return computeHash(material, hasPendingTextures);
+                    });
+
+                if (shouldCreate)
+                {
+                    sentStates[i] = getState(material);
+                    ++sendCounts[i];
+                }
+            }
+
+            ++frame;
+        }
+
+        bool isSentStateCurrent(size_t index) const
+        {
+            return sentStates[index] == getState(*materials[index]);
+        }
+    };
+}
+
+TEST(MaterialVersionTest, UnchangedMaterialsAreSentOnce)
+{
+    MaterialHarness harness;
+    for (uint32_t i = 0; i < 40; i++)
+        harness.add();
+
+    for (uint32_t i = 0; i < 100; i++)
+        harness.runFrame();
+
+    for (const uint32_t sendCount : harness.sendCounts)
+        EXPECT_EQ(sendCount, 1u);
+}
+
+TEST(MaterialVersionTest, SettingSameValueKeepsMaterialClean)
+{
+    MaterialHarness harness;
+    auto& material = harness.add();
+    harness.runFrame();
+
+    const float diffuse[4]{};
+    EXPECT_FALSE(material.version.set(material.diffuse, diffuse, sizeof(diffuse)));
+
+    auto texcoordOffset = material.texcoordOffset;
+    EXPECT_FALSE(material.version.set(material.texcoordOffset, texcoordOffset));
+    EXPECT_FALSE(material.version.isDirty());
+
+    harness.runFrame();
+    EXPECT_EQ(harness.sendCounts[0], 1u);
+}
+
+TEST(MaterialVersionTest, ChangesAreSentOnceOnTheNextFrame)
+{
+    MaterialHarness harness;
+    auto& material = harness.add();
+    harness.runFrame();
+
+    const float diffuse[4]{ 1.0f, 0.5f, 0.25f, 1.0f };
+    EXPECT_TRUE(material.version.set(material.diffuse, diffuse, sizeof(diffuse)));
+
+    // Both samples land before the next frame, so there is a single send.
+    const auto texcoordOffset = std::shared_ptr<float[]>(new float[8]{ 0.5f });
+    EXPECT_TRUE(material.version.set(material.texcoordOffset, texcoordOffset));
+    EXPECT_TRUE(material.version.isDirty());
+
+    harness.runFrame();
+    EXPECT_EQ(harness.sendCounts[0], 2u);
+    EXPECT_TRUE(harness.isSentStateCurrent(0));
+    EXPECT_FALSE(material.version.isDirty());
+
+    for (uint32_t i = 0; i < 20; i++)
+        harness.runFrame();
+
+    EXPECT_EQ(harness.sendCounts[0], 2u);
+}
+
+TEST(MaterialVersionTest, GenerationWrapsAround)
+{
+    MaterialVersion version;
+    version.reset();
+    version.generation = 0xFFFE;
+    version.createdGeneration = 0xFFFE;
+
+    // Marking a dirty material again doesn't move the generation, so it can't wrap back to clean.
+    for (uint32_t i = 0; i < 0x10000; i++)
+        version.markDirty();
+
+    EXPECT_TRUE(version.isDirty());
+    EXPECT_EQ(version.generation, 0xFFFF);
+
+    const auto hashFunction = [](bool&) { return 0u; };
+    EXPECT_TRUE(version.update(false, false, hashFunction));
+
+    // Enough sends for both counters to wrap several times.
+    uint32_t sendCount = 0;
+
+    for (uint32_t i = 0; i < 0x30000; i++)
+    {
+        const bool dirty = (i % 3) != 0;
+        if (dirty)
+        {
+            version.markDirty();
+            version.markDirty();
+        }
+
+        const bool sent = version.update(false, false, hashFunction);
+        EXPECT_EQ(sent, dirty);
+        EXPECT_FALSE(version.isDirty());
+
+        sendCount += sent;
+    }
+
+    EXPECT_EQ(sendCount, 0x20000u);
+}
+
+TEST(MaterialVersionTest, UnmarkedChangesAreCaughtByValidation)
+{
+    MaterialHarness harness;
+    for (uint32_t i = 0; i < MaterialVersion::s_validationInterval * 2; i++)
+        harness.add();
+
+    harness.runFrame();
+
+    // Written directly, without going through a setter.
+    for (auto& material : harness.materials)
+        material->diffuse[0] = 2.0f;
+
+    for (uint32_t i = 0; i < MaterialVersion::s_validationInterval; i++)
+        harness.runFrame();
+
+    for (size_t i = 0; i < harness.materials.size(); i++)
+    {
+        EXPECT_EQ(harness.sendCounts[i], 2u);
+        EXPECT_TRUE(harness.isSentStateCurrent(i));
+    }
+
+    // Every frame only hashes its slice.
+    harness.hashCount = 0;
+    harness.runFrame();
+    EXPECT_EQ(harness.hashCount, 2u);
+}
+
+TEST(MaterialVersionTest, LateTextureIsSentOnTheNextFrame)
+{
+    MaterialHarness harness;
+    MockPicture picture;
+    MockTexture texture{ 1 };
+
+    // Picked so the texture doesn't arrive in the material's validation frame.
+    auto& material = harness.add();
+    material.pictures.push_back(&picture);
+
+    harness.runFrame();
+    EXPECT_TRUE(material.version.hasPendingTextures);
+
+    for (uint32_t i = 0; i < 3; i++)
+        harness.runFrame();
+
+    EXPECT_EQ(harness.sendCounts[0], 1u);
+
+    picture.texture = &texture;
+    picture.made = true;
+    ASSERT_FALSE(MaterialVersion::shouldValidate(material.id, harness.frame));
+
+    harness.runFrame();
+    EXPECT_EQ(harness.sendCounts[0], 2u);
+    EXPECT_TRUE(harness.isSentStateCurrent(0));
+    EXPECT_FALSE(material.version.hasPendingTextures);
+
+    // Once the texture is there the material goes back to being validated in slices.
+    harness.hashCount = 0;
+    for (uint32_t i = 0; i < MaterialVersion::s_validationInterval; i++)
+        harness.runFrame();
+
+    EXPECT_EQ(harness.hashCount, 1u);
+    EXPECT_EQ(harness.sendCounts[0], 2u);
+}
+
+TEST(MaterialVersionTest, FailedTextureIsNotPending)
+{
+    MaterialHarness harness;
+    MockPicture picture;
+    picture.made = true;
+
+    auto& material = harness.add();
+    material.pictures.push_back(&picture);
+
+    harness.runFrame();
+    EXPECT_FALSE(material.version.hasPendingTextures);
+}
+
+TEST(MaterialVersionTest, MarkDirtyIfChanged)
+{
+    MaterialHarness harness;
+    auto& material = harness.add();
+    harness.runFrame();
+
+    const auto hashFunction = [&](bool& hasPendingTextures) { return computeHash(material, hasPendingTextures); };
+
+    material.version.markDirtyIfChanged(hashFunction);
+    EXPECT_FALSE(material.version.isDirty());
+
+    // Shared with another material, which writes to it behind this one's back.
+    material.texcoordOffset[3] = 1.0f;
+    material.version.markDirtyIfChanged(hashFunction);
+    EXPECT_TRUE(material.version.isDirty());
+
+    harness.runFrame();
+    EXPECT_EQ(harness.sendCounts[0], 2u);
+}
+
+// Applies random mutations the way the hooks do. Changes through setters and arriving textures have to be
+// sent on the next frame, direct writes within a validation interval, and nothing may be sent without a change.
+TEST(MaterialVersionTest, RandomMutations)
+{
+    constexpr uint32_t s_materialCount = 64;
+    constexpr uint32_t s_frameCount = 2000;
+
+    std::mt19937 random(1);
+    MaterialHarness harness;
+    std::vector<std::unique_ptr<MockPicture>> pictures;
+    std::vector<MockTexture> textures(8);
+
+    for (uint32_t i = 0; i < textures.size(); i++)
+        textures[i].id = i;
+
+    for (uint32_t i = 0; i < s_materialCount; i++)
+    {
+        auto& material = harness.add();
+
+        for (uint32_t j = random() % 3; j > 0; j--)
+            material.pictures.push_back(pictures.emplace_back(std::make_unique<MockPicture>()).get());
+    }
+
+    // The first frame a direct write left a material different from what was sent.
+    std::vector<uint32_t> directWriteFrames(s_materialCount, ~0u);
+
+    for (uint32_t frame = 0; frame < s_frameCount; frame++)
+    {
+        std::vector<bool> expectSend(s_materialCount, frame == 0);
+        std::vector<bool> markedDirty(s_materialCount, false);
+
+        for (uint32_t i = 0; i < s_materialCount; i++)
+        {
+            auto& material = *harness.materials[i];
+            const auto prevState = getState(material);
+            bool directWrite = false;
+
+            switch (random() % 8)
+            {
+            case 0:
+            {
+                float diffuse[4]{ static_cast<float>(random() % 4) };
+                markedDirty[i] = material.version.set(material.diffuse, diffuse, sizeof(diffuse));
+                break;
+            }
+
+            case 1:
+            {
+                const auto texcoordOffset = std::shared_ptr<float[]>(new float[8]{ static_cast<float>(random() % 4) });
+                markedDirty[i] = material.version.set(material.texcoordOffset, texcoordOffset);
+                break;
+            }
+
+            case 2:
+                if (!material.pictures.empty())
+                {
+                    auto& picture = *material.pictures[random() % material.pictures.size()];
+                    if (!picture.made && random() % 2 == 0)
+                    {
+                        // Loaded, but the material wasn't touched.
+                        picture.texture = &textures[random() % textures.size()];
+                        picture.made = true;
+                    }
+                    else if (picture.made)
+                    {
+                        // Texpattern swaps go through a setter.
+                        markedDirty[i] = material.version.set(picture.texture, &textures[random() % textures.size()]);
+                    }
+                }
+                break;
+
+            case 3:
+                material.texcoordOffset[random() % 8] = static_cast<float>(random() % 4);
+                directWrite = true;
+
+                if (directWriteFrames[i] == ~0u && !(getState(material) == harness.sentStates[i]))
+                    directWriteFrames[i] = frame;
+
+                break;
+            }
+
+            if (!directWrite && !(getState(material) == prevState))
+                expectSend[i] = true;
+        }
+
+        const auto prevSendCounts = harness.sendCounts;
+        const auto prevSentStates = harness.sentStates;
+        harness.runFrame();
+
+        for (uint32_t i = 0; i < s_materialCount; i++)
+        {
+            const bool sent = harness.sendCounts[i] != prevSendCounts[i];
+
+            if (expectSend[i])
+            {
+                EXPECT_TRUE(sent) << "material " << i << ", frame " << frame;
+            }
+
+            // Without a setter reporting a change, only an actual difference may cause a send.
+            if (sent && frame != 0 && !markedDirty[i])
+            {
+                EXPECT_FALSE(prevSentStates[i] == harness.sentStates[i]) << "material " << i << ", frame " << frame;
+            }
+
+            if (harness.isSentStateCurrent(i))
+            {
+                directWriteFrames[i] = ~0u;
+            }
+            else if (directWriteFrames[i] != ~0u)
+            {
+                EXPECT_LT(frame - directWriteFrames[i], MaterialVersion::s_validationInterval) << "material " << i;
+            }
+            else
+            {
+                ADD_FAILURE() << "material " << i << " is stale at frame " << frame;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "CaptureBuilder.h"
+#include "HeadlessReplayBackend.h"
+#include "MessageReplayer.h"
+
+namespace
+{
+    // Logs what it was handed, in the order it was handed.
+    class MockReplayBackend final : public ReplayBackend
+    {
+    public:
+        std::vector<std::string> calls;
+
+        void writeBulkData(uint32_t offset, const uint8_t* /*data*/, uint32_t dataSize) override
+        {
+            calls.push_back("bulk " + std::to_string(offset) + " " + std::to_string(dataSize));
+        }
+
+        uint32_t processMessage(const uint8_t* message) override
+        {
+            calls.push_back(s_messageNames[*message]);
+            return getMessageByteSize(message);
+        }
+    };
+
+    MsgWriteVertexBuffer makeWriteVertexBuffer(uint32_t bulkOffset, uint32_t bulkSize)
+    {
+        MsgWriteVertexBuffer message{};
+        message.vertexBufferId = 1;
+        message.bulkOffset = bulkOffset;
+        message.bulkSize = bulkSize;
+        return message;
+    }
+}
+
+TEST(MessageSize, CoversEveryMessage)
+{
+    for (uint32_t id = 0; id <= MsgWrap::s_id; id++)
+    {
+        uint8_t message[0x100]{};
+        message[0] = static_cast<uint8_t>(id);
+
+        EXPECT_NE(getMessageByteSize(message), 0u) << s_messageNames[id];
+    }
+
+    const uint8_t unknown = MsgWrap::s_id + 1;
+    EXPECT_EQ(getMessageByteSize(&unknown), 0u);
+}
+
+TEST(MessageSize, IncludesTrailingData)
+{
+    alignas(0x10) uint8_t message[0x100]{};
+    message[0] = MsgPadding::s_id;
+    message[1] = 37;
+
+    EXPECT_EQ(getMessageByteSize(message), offsetof(MsgPadding, data) + 37);
+
+    const MsgPresent present{};
+    EXPECT_EQ(getMessageByteSize(&present), sizeof(MsgPresent));
+}
+
+TEST(MessageReplayer, RejectsOtherCaptures)
+{
+    MockReplayBackend backend;
+
+    auto wrongMagic = CaptureBuilder(0x12345678).get();
+    EXPECT_FALSE(MessageReplayer(wrongMagic.data(), wrongMagic.size(), backend).isValid());
+
+    auto wrongVersion = CaptureBuilder(MessageCaptureHeader::s_magic, MsgWrap::s_id - 1).get();
+    EXPECT_FALSE(MessageReplayer(wrongVersion.data(), wrongVersion.size(), backend).isValid());
+
+    auto tooSmall = CaptureBuilder().get();
+    EXPECT_FALSE(MessageReplayer(tooSmall.data(), sizeof(MessageCaptureHeader) - 1, backend).isValid());
+
+    auto valid = CaptureBuilder().get();
+    EXPECT_TRUE(MessageReplayer(valid.data(), valid.size(), backend).isValid());
+}
+
+TEST(MessageReplayer, HandsBulkDataOverBeforeTheMessage)
+{
+    auto capture = CaptureBuilder()
+        .bulkData(256, std::vector<uint8_t>(100, 0xAB))
+        .message(makeWriteVertexBuffer(256, 100))
+        .message(MsgPresent{})
+        .frame(0)
+        .get();
+
+    MockReplayBackend backend;
+    MessageReplayer replayer(capture.data(), capture.size(), backend);
+    replayer.replay();
+
+    EXPECT_EQ(backend.calls, (std::vector<std::string>{ "bulk 256 100", "WriteVertexBuffer", "Present" }));
+    EXPECT_EQ(replayer.getBulkDataSize(), 100u);
+}
+
+TEST(MessageReplayer, StopsAtFrameBoundaries)
+{
+    auto capture = CaptureBuilder()
+        .message(MsgPresent{})
+        .frame(0)
+        .padding(3)
+        .message(MsgPresent{})
+        .frame(1)
+        .message(MsgPresent{})
+        .get();
+
+    MockReplayBackend backend;
+    MessageReplayer replayer(capture.data(), capture.size(), backend);
+
+    EXPECT_TRUE(replayer.replayFrame());
+    EXPECT_EQ(backend.calls.size(), 1u);
+
+    EXPECT_TRUE(replayer.replayFrame());
+    EXPECT_EQ(backend.calls.size(), 3u);
+
+    // Messages after the last frame still get processed.
+    EXPECT_FALSE(replayer.replayFrame());
+    EXPECT_EQ(backend.calls.size(), 4u);
+    EXPECT_EQ(replayer.getFrameCount(), 2u);
+
+    EXPECT_FALSE(replayer.replayFrame());
+}
+
+TEST(MessageReplayer, CountsMessagesAndBytes)
+{
+    CaptureBuilder builder;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        builder.padding(static_cast<uint8_t>(i));
+        builder.message(MsgPresent{});
+        builder.frame(i);
+    }
+
+    auto& capture = builder.get();
+
+    MockReplayBackend backend;
+    MessageReplayer replayer(capture.data(), capture.size(), backend);
+    replayer.replay();
+
+    const auto& statistics = replayer.getStatistics();
+    EXPECT_EQ(statistics.counts[MsgPadding::s_id], 10u);
+    EXPECT_EQ(statistics.byteSizes[MsgPadding::s_id], 10 * offsetof(MsgPadding, data) + 45);
+    EXPECT_EQ(statistics.counts[MsgPresent::s_id], 10u);
+    EXPECT_EQ(statistics.byteSizes[MsgPresent::s_id], 10 * sizeof(MsgPresent));
+    EXPECT_EQ(replayer.getFrameCount(), 10u);
+}
+
+TEST(MessageReplayer, SplitsRecordsHoldingSeveralMessages)
+{
+    std::vector<uint8_t> messages(offsetof(MsgPadding, data) + 2);
+    messages[0] = MsgPadding::s_id;
+    messages[1] = 2;
+    messages.push_back(MsgPresent::s_id);
+    messages.push_back(MsgProcessWindowMessages::s_id);
+
+    auto capture = CaptureBuilder()
+        .record(MessageCaptureRecordType::Message, messages.data(), static_cast<uint32_t>(messages.size()))
+        .get();
+
+    MockReplayBackend backend;
+    MessageReplayer(capture.data(), capture.size(), backend).replay();
+
+    EXPECT_EQ(backend.calls, (std::vector<std::string>{ "Padding", "Present", "ProcessWindowMessages" }));
+}
+
+TEST(MessageReplayer, IgnoresTruncatedRecord)
+{
+    auto capture = CaptureBuilder()
+        .message(MsgPresent{})
+        .bulkData(0, std::vector<uint8_t>(64))
+        .get();
+
+    capture.resize(capture.size() - 32);
+
+    MockReplayBackend backend;
+    MessageReplayer replayer(capture.data(), capture.size(), backend);
+    replayer.replay();
+
+    EXPECT_EQ(backend.calls, (std::vector<std::string>{ "Present" }));
+}
+
+TEST(HeadlessReplayBackend, ReplaysDeterministically)
+{
+    std::vector<uint8_t> bulkData(1000);
+    for (size_t i = 0; i < bulkData.size(); i++)
+        bulkData[i] = static_cast<uint8_t>(i * 7);
+
+    auto capture = CaptureBuilder()
+        .bulkData(4096, bulkData)
+        .message(makeWriteVertexBuffer(4096, 1000))
+        .padding(8)
+        .message(MsgPresent{})
+        .frame(0)
+        .get();
+
+    HeadlessReplayBackend first;
+    MessageReplayer(capture.data(), capture.size(), first).replay();
+
+    HeadlessReplayBackend second;
+    MessageReplayer(capture.data(), capture.size(), second).replay();
+
+    EXPECT_EQ(first.getHash(), second.getHash());
+    EXPECT_EQ(memcmp(first.getBulkData(4096), bulkData.data(), bulkData.size()), 0);
+
+    auto other = CaptureBuilder()
+        .message(makeWriteVertexBuffer(4096, 999))
+        .get();
+
+    HeadlessReplayBackend third;
+    MessageReplayer(other.data(), other.size(), third).replay();
+
+    EXPECT_NE(first.getHash(), third.getHash());
+}
+
+TEST(MessageCaptureReader, ReadsFiles)
+{
+    auto capture = CaptureBuilder()
+        .message(MsgPresent{})
+        .frame(0)
+        .get();
+
+    const std::string filePath = testing::TempDir() + "MessageCaptureReaderTest.bin";
+
+    FILE* file = fopen(filePath.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(capture.data(), 1, capture.size(), file);
+    fclose(file);
+
+    EXPECT_EQ(MessageCaptureReader::readFile(filePath.c_str()), capture);
+    EXPECT_TRUE(MessageCaptureReader::readFile((filePath + ".missing").c_str()).empty());
+
+    remove(filePath.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "MessageReservationQueue.h"
+
+namespace
+{
+    struct ReservationData
+    {
+        uint32_t value;
+    };
+
+    using Queue = MessageReservationQueue<ReservationData>;
+
+    // Publishers are exclusive, so the recorded order is the order head moved in.
+    auto makeRecorder(std::vector<uint32_t>& offsets)
+    {
+        return [&offsets](Queue::Reservation& reservation) { offsets.push_back(reservation.offset); };
+    }
+}
+
+TEST(MessageReservationQueueTest, HeadWaitsForFrontReservation)
+{
+    std::atomic<uint32_t> head{ 0 };
+    Queue queue(head, 8);
+    std::vector<uint32_t> offsets;
+    const auto recorder = makeRecorder(offsets);
+
+    const uint32_t first = queue.reserve(0, 10, 10);
+    const uint32_t second = queue.reserve(10, 10, 20);
+    const uint32_t third = queue.reserve(20, 10, 30);
+
+    EXPECT_FALSE(queue.commit(second, recorder));
+    EXPECT_EQ(head, 0u);
+
+    EXPECT_TRUE(queue.commit(first, recorder));
+    EXPECT_EQ(head, 20u);
+
+    EXPECT_TRUE(queue.commit(third, recorder));
+    EXPECT_EQ(head, 30u);
+
+    EXPECT_EQ(offsets, (std::vector<uint32_t>{ 0, 10, 20 }));
+}
+
+TEST(MessageReservationQueueTest, PublisherSeesData)
+{
+    std::atomic<uint32_t> head{ 0 };
+    Queue queue(head, 4);
+
+    const uint32_t index = queue.reserve(0, 4, 4);
+    queue.getData(index).value = 1234;
+
+    uint32_t value = 0;
+    queue.commit(index, [&](Queue::Reservation& reservation) { value = reservation.data.value; });
+
+    EXPECT_EQ(value, 1234u);
+}
+
+TEST(MessageReservationQueueTest, SlotsFreeUpOncePublished)
+{
+    std::atomic<uint32_t> head{ 0 };
+    Queue queue(head, 2);
+    std::vector<uint32_t> offsets;
+    const auto recorder = makeRecorder(offsets);
+
+    const uint32_t first = queue.reserve(0, 4, 4);
+    const uint32_t second = queue.reserve(4, 4, 8);
+    EXPECT_FALSE(queue.canReserve());
+
+    // Committed but stuck behind the front.
+    queue.commit(second, recorder);
+    EXPECT_FALSE(queue.canReserve());
+
+    queue.commit(first, recorder);
+    EXPECT_TRUE(queue.canReserve());
+
+    // Wraps around to the first slot.
+    const uint32_t third = queue.reserve(8, 4, 12);
+    queue.commit(third, recorder);
+
+    EXPECT_EQ(head, 12u);
+    EXPECT_EQ(offsets, (std::vector<uint32_t>{ 0, 4, 8 }));
+}
+
+TEST(MessageReservationQueueTest, CommitsDuringExclusiveArePublishedAfter)
+{
+    std::atomic<uint32_t> head{ 0 };
+    Queue queue(head, 4);
+    std::vector<uint32_t> offsets;
+    const auto recorder = makeRecorder(offsets);
+
+    const uint32_t index = queue.reserve(0, 4, 4);
+
+    const bool published = queue.runExclusive([&]
+    {
+        EXPECT_FALSE(queue.commit(index, recorder));
+        EXPECT_EQ(head, 0u);
+
+    }, recorder);
+
+    EXPECT_TRUE(published);
+    EXPECT_EQ(head, 4u);
+    EXPECT_EQ(offsets, (std::vector<uint32_t>{ 0 }));
+}
+
+TEST(MessageReservationQueueTest, ConcurrentCommitsPublishInOrder)
+{
+    constexpr uint32_t s_threadCount = 4;
+    constexpr uint32_t s_reservationCount = 20000;
+
+    std::atomic<uint32_t> head{ 0 };
+    Queue queue(head, 64);
+    std::vector<uint32_t> offsets;
+    const auto recorder = makeRecorder(offsets);
+    std::mutex mutex;
+    uint32_t nextOffset = 0;
+
+    std::atomic<bool> done{ false };
+    std::atomic<uint32_t> regressionCount{ 0 };
+
+    std::thread watcher([&]
+    {
+        uint32_t lastHead = 0;
+        while (!done)
+        {
+            const uint32_t nextHead = head;
+            if (nextHead < lastHead)
+                ++regressionCount;
+
+            lastHead = nextHead;
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < s_threadCount; i++)
+    {
+        threads.emplace_back([&, i]
+        {
+            std::mt19937 random(i);
+            std::vector<uint32_t> pending;
+
+            for (uint32_t j = 0; j < s_reservationCount; j++)
+            {
+                {
+                    std::unique_lock lock(mutex);
+
+                    // Committers never need the lock, so they can always catch up, unless
+                    // the reservation at the front is one of those we are holding on to.
+                    while (!queue.canReserve())
+                    {
+                        lock.unlock();
+
+                        for (const uint32_t index : pending)
+                            queue.commit(index, recorder);
+
+                        pending.clear();
+                        std::this_thread::yield();
+
+                        lock.lock();
+                    }
+
+                    pending.push_back(queue.reserve(nextOffset, 1, nextOffset + 1));
+                    ++nextOffset;
+                }
+
+                // Hold on to a few reservations at a time to commit them out of order.
+                if (pending.size() > 2 || random() % 2 == 0)
+                {
+                    const size_t pendingIndex = random() % pending.size();
+                    queue.commit(pending[pendingIndex], recorder);
+                    pending.erase(pending.begin() + pendingIndex);
+                }
+            }
+
+            for (const uint32_t index : pending)
+                queue.commit(index, recorder);
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    done = true;
+    watcher.join();
+
+    EXPECT_EQ(regressionCount, 0u);
+    EXPECT_EQ(head, s_threadCount * s_reservationCount);
+    ASSERT_EQ(offsets.size(), s_threadCount * s_reservationCount);
+
+    for (uint32_t i = 0; i < offsets.size(); i++)
+    {
+        if (offsets[i] != i)
+        {
+            ADD_FAILURE() << "Reservation " << offsets[i] << " published at " << i;
+            break;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Message.h"
+#include "MessageRing.h"
+
+// Runs a producer and a consumer thread over a ring the same way MessageSender and MessageReceiver do,
+// except that both sides spin instead of waiting on events. Every message carries its sequence number
+// and a payload derived from it, which the consumer validates.
+struct MessageMix
+{
+    uint32_t smallMinSize;
+    uint32_t smallMaxSize;
+    uint32_t largeMinSize;
+    uint32_t largeMaxSize;
+    uint32_t largePercentage;
+};
+
+struct MessageRingStressResult
+{
+    uint64_t messageCount = 0;
+    uint64_t byteCount = 0;
+    uint64_t stallCount = 0;
+    std::chrono::nanoseconds stallTime{};
+    std::chrono::nanoseconds totalTime{};
+    uint64_t errorCount = 0;
+};
+
+namespace MessageRingStress
+{
+    constexpr uint8_t s_messageId = MsgCreateSwapChain::s_id;
+    constexpr uint32_t s_headerSize = 9; // ID, byte size and sequence
+    constexpr uint32_t s_alignments[] = { 1, 4, 16 };
+
+    inline uint8_t getPayloadByte(uint32_t sequence, uint32_t index)
+    {
+        return static_cast<uint8_t>(sequence * 31 + index);
+    }
+
+    inline void consume(uint8_t* memory, uint32_t messageCount, MessageRingStressResult& result)
+    {
+        auto queue = reinterpret_cast<MessageQueue*>(memory);
+        MessageRingReader reader(memory);
+        uint32_t offset = sizeof(MessageQueue);
+        uint32_t sequence = 0;
+
+        while (sequence < messageCount)
+        {
+            if (queue->tailWaiterCount > 0)
+                queue->tail = offset;
+
+            if (!reader.hasNext(queue->head, offset))
+            {
+                queue->tail = offset;
+                std::this_thread::yield();
+                continue;
+            }
+
+            const uint8_t* message = memory + offset;
+
+            if (message[0] == MsgPadding::s_id)
+            {
+                offset += offsetof(MsgPadding, data) + message[1];
+                continue;
+            }
+
+            uint32_t byteSize;
+            uint32_t messageSequence;
+            memcpy(&byteSize, message + 1, sizeof(byteSize));
+            memcpy(&messageSequence, message + 5, sizeof(messageSequence));
+
+            bool valid = message[0] == s_messageId && messageSequence == sequence;
+            for (uint32_t i = s_headerSize; valid && i < byteSize; i++)
+                valid = message[i] == getPayloadByte(sequence, i);
+
+            if (!valid)
+                ++result.errorCount;
+
+            offset += byteSize;
+            ++sequence;
+        }
+
+        queue->tail = offset;
+    }
+
+    inline MessageRingStressResult run(uint32_t ringSize, const MessageMix& mix, uint32_t messageCount, uint32_t seed)
+    {
+        std::vector<uint8_t> memory(ringSize);
+        auto queue = new (memory.data()) MessageQueue();
+        queue->head = sizeof(MessageQueue);
+        queue->tail = sizeof(MessageQueue);
+
+        MessageRingWriter writer(memory.data(), ringSize);
+        MessageRingStressResult result;
+        std::mt19937 random(seed);
+
+        const auto begin = std::chrono::steady_clock::now();
+        std::thread consumer(consume, memory.data(), messageCount, std::ref(result));
+
+        for (uint32_t sequence = 0; sequence < messageCount; sequence++)
+        {
+            const bool large = random() % 100 < mix.largePercentage;
+            const uint32_t minSize = std::max(s_headerSize, large ? mix.largeMinSize : mix.smallMinSize);
+            const uint32_t maxSize = std::max(minSize, large ? mix.largeMaxSize : mix.smallMaxSize);
+
+            const uint32_t byteSize = minSize + random() % (maxSize - minSize + 1);
+            const uint32_t alignment = s_alignments[random() % std::size(s_alignments)];
+
+            assert(MessageRingWriter::canAllocate(ringSize, byteSize, alignment));
+
+            uint32_t offset;
+            while (true)
+            {
+                const uint32_t tail = queue->tail;
+                if (writer.tryAllocate(byteSize, alignment, tail, offset))
+                    break;
+
+                queue->head = writer.getOffset();
+                ++queue->tailWaiterCount;
+
+                const auto stallBegin = std::chrono::steady_clock::now();
+                while (queue->tail == tail)
+                    std::this_thread::yield();
+
+                result.stallTime += std::chrono::steady_clock::now() - stallBegin;
+                ++result.stallCount;
+
+                --queue->tailWaiterCount;
+            }
+
+            uint8_t* message = memory.data() + offset;
+            message[0] = s_messageId;
+            memcpy(message + 1, &byteSize, sizeof(byteSize));
+            memcpy(message + 5, &sequence, sizeof(sequence));
+
+            for (uint32_t i = s_headerSize; i < byteSize; i++)
+                message[i] = getPayloadByte(sequence, i);
+
+            queue->head = writer.getOffset();
+
+            ++result.messageCount;
+            result.byteCount += byteSize;
+        }
+
+        consumer.join();
+        result.totalTime = std::chrono::steady_clock::now() - begin;
+
+        queue->~MessageQueue();
+        return result;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "MessageRingStress.h"
+
+namespace
+{
+    constexpr uint32_t s_begin = sizeof(MessageQueue);
+
+    struct Ring
+    {
+        std::vector<uint8_t> memory;
+        MessageRingWriter writer;
+        MessageRingReader reader;
+
+        Ring(uint32_t size) : memory(size), writer(memory.data(), size), reader(memory.data())
+        {
+        }
+    };
+}
+
+TEST(MessageRing, CanAllocateKeepsRoomForWrap)
+{
+    constexpr uint32_t s_size = s_begin + 256;
+
+    EXPECT_TRUE(MessageRingWriter::canAllocate(s_size, 255, 1));
+    EXPECT_FALSE(MessageRingWriter::canAllocate(s_size, 256, 1));
+    EXPECT_FALSE(MessageRingWriter::canAllocate(s_size, 255, 0x100));
+}
+
+TEST(MessageRing, PadsToAlignment)
+{
+    Ring ring(s_begin + 256);
+    uint32_t offset;
+
+    ASSERT_TRUE(ring.writer.tryAllocate(3, 1, s_begin, offset));
+    EXPECT_EQ(offset, s_begin);
+
+    ASSERT_TRUE(ring.writer.tryAllocate(16, 16, s_begin, offset));
+    EXPECT_EQ(offset % 16, 0u);
+    EXPECT_EQ(offset, s_begin + 16);
+
+    EXPECT_EQ(ring.memory[s_begin + 3], MsgPadding::s_id);
+    EXPECT_EQ(s_begin + 3 + offsetof(MsgPadding, data) + ring.memory[s_begin + 4], offset);
+}
+
+TEST(MessageRing, WrapsOnceTailLeftTheStart)
+{
+    Ring ring(s_begin + 64);
+    uint32_t offset;
+
+    ASSERT_TRUE(ring.writer.tryAllocate(40, 1, s_begin, offset));
+
+    // Consumer still at the start, wrapping would make the queue look empty.
+    EXPECT_FALSE(ring.writer.tryAllocate(30, 1, s_begin, offset));
+    EXPECT_EQ(ring.writer.getOffset(), s_begin + 40);
+
+    ASSERT_TRUE(ring.writer.tryAllocate(30, 1, s_begin + 40, offset));
+    EXPECT_EQ(offset, s_begin);
+    EXPECT_EQ(ring.memory[s_begin + 40], MsgWrap::s_id);
+}
+
+TEST(MessageRing, DoesNotWrapOverPreviousLap)
+{
+    Ring ring(s_begin + 64);
+    uint32_t offset;
+
+    ASSERT_TRUE(ring.writer.tryAllocate(40, 1, s_begin, offset));
+    ASSERT_TRUE(ring.writer.tryAllocate(30, 1, s_begin + 40, offset));
+    EXPECT_EQ(offset, s_begin);
+
+    // The consumer is still on the previous lap, so the start of the ring holds unread messages.
+    EXPECT_FALSE(ring.writer.tryAllocate(40, 1, s_begin + 40, offset));
+    EXPECT_EQ(ring.writer.getOffset(), s_begin + 30);
+    EXPECT_NE(ring.memory[s_begin + 30], MsgWrap::s_id);
+}
+
+TEST(MessageRing, NeverCatchesUpWithTail)
+{
+    Ring ring(s_begin + 64);
+    uint32_t offset;
+
+    ASSERT_TRUE(ring.writer.tryAllocate(40, 1, s_begin, offset));
+    ASSERT_TRUE(ring.writer.tryAllocate(30, 1, s_begin + 40, offset));
+
+    EXPECT_FALSE(ring.writer.tryAllocate(10, 1, s_begin + 40, offset));
+    ASSERT_TRUE(ring.writer.tryAllocate(9, 1, s_begin + 40, offset));
+    EXPECT_EQ(ring.writer.getOffset(), s_begin + 39);
+}
+
+TEST(MessageRing, ReaderSkipsWrap)
+{
+    Ring ring(s_begin + 64);
+    uint32_t offset;
+
+    ASSERT_TRUE(ring.writer.tryAllocate(40, 1, s_begin, offset));
+    ring.memory[offset] = MsgCreateSwapChain::s_id;
+
+    uint32_t readOffset = s_begin;
+    EXPECT_TRUE(ring.reader.hasNext(ring.writer.getOffset(), readOffset));
+    EXPECT_EQ(readOffset, s_begin);
+
+    readOffset += 40;
+    EXPECT_FALSE(ring.reader.hasNext(ring.writer.getOffset(), readOffset));
+
+    ASSERT_TRUE(ring.writer.tryAllocate(30, 1, readOffset, offset));
+    ring.memory[offset] = MsgCreateSwapChain::s_id;
+
+    EXPECT_TRUE(ring.reader.hasNext(ring.writer.getOffset(), readOffset));
+    EXPECT_EQ(readOffset, s_begin);
+}
+
+struct MessageRingStressParam
+{
+    const char* name;
+    uint32_t ringSize;
+    MessageMix mix;
+};
+
+void PrintTo(const MessageRingStressParam& param, std::ostream* stream)
+{
+    *stream << param.name;
+}
+
+class MessageRingStressTest : public testing::TestWithParam<MessageRingStressParam>
+{
+};
+
+TEST_P(MessageRingStressTest, DeliversEveryMessageIntact)
+{
+    const auto& param = GetParam();
+    const auto result = MessageRingStress::run(param.ringSize, param.mix, 20000, 0x1234);
+
+    EXPECT_EQ(result.messageCount, 20000u);
+    EXPECT_EQ(result.errorCount, 0u);
+
+    RecordProperty("StallCount", std::to_string(result.stallCount));
+    RecordProperty("StallMicroseconds", std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(result.stallTime).count()));
+}
+
+INSTANTIATE_TEST_SUITE_P(Mixes, MessageRingStressTest, testing::Values(
+    MessageRingStressParam{ "StateChanges", s_begin + 4096, { 9, 64, 0, 0, 0 } },
+    MessageRingStressParam{ "Uploads", s_begin + 64 * 1024, { 1024, 32 * 1024, 0, 0, 0 } },
+    MessageRingStressParam{ "Mixed", s_begin + 16 * 1024, { 9, 64, 1024, 8 * 1024, 5 } },
+    MessageRingStressParam{ "AlmostRingSized", s_begin + 4096, { 9, 64, 3000, 4000, 10 } }),
+    [](const auto& info) { return info.param.name; });
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "MessageStatisticsRing.h"
+
+namespace
+{
+    // Fills every counter with values derived from the frame, so a copy mixing two frames is detectable.
+    void fill(MessageStatistics& statistics, uint32_t frame)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            statistics.counts[i] = frame;
+            statistics.byteSizes[i] = frame * 3ull;
+            statistics.durations[i] = frame * 7ll;
+        }
+    }
+
+    bool isConsistent(const MessageStatistics& statistics, uint32_t frame)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            if (statistics.counts[i] != frame || statistics.byteSizes[i] != frame * 3ull || statistics.durations[i] != frame * 7ll)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+TEST(MessageStatistics, AddsPerMessageType)
+{
+    MessageStatistics statistics{};
+    statistics.add(5, 100, 10);
+    statistics.add(5, 50, 20);
+    statistics.add(200, 1, 1);
+
+    EXPECT_EQ(statistics.counts[5], 2u);
+    EXPECT_EQ(statistics.byteSizes[5], 150u);
+    EXPECT_EQ(statistics.durations[5], 30);
+    EXPECT_EQ(statistics.counts[200], 1u);
+    EXPECT_EQ(statistics.counts[6], 0u);
+}
+
+TEST(MessageStatistics, AccumulatesAndResets)
+{
+    MessageStatistics total{};
+    MessageStatistics frame{};
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        frame.add(1, 8, 2);
+        frame.add(255, 16, 4);
+        total.accumulate(frame);
+        frame.reset();
+    }
+
+    EXPECT_EQ(total.counts[1], 4u);
+    EXPECT_EQ(total.byteSizes[1], 32u);
+    EXPECT_EQ(total.durations[255], 16);
+    EXPECT_EQ(frame.counts[1], 0u);
+    EXPECT_EQ(frame.durations[255], 0);
+}
+
+TEST(MessageStatisticsRing, ReadsPublishedFrames)
+{
+    MessageStatisticsRing ring{};
+    MessageStatistics statistics{};
+
+    EXPECT_FALSE(ring.tryRead(0, statistics));
+
+    for (uint32_t frame = 0; frame < 10; frame++)
+    {
+        fill(statistics, frame);
+        ring.publish(frame, statistics);
+    }
+
+    MessageStatistics read{};
+    for (uint32_t frame = 10 - MessageStatistics::s_frameNum; frame < 10; frame++)
+    {
+        ASSERT_TRUE(ring.tryRead(frame, read));
+        EXPECT_TRUE(isConsistent(read, frame));
+    }
+}
+
+TEST(MessageStatisticsRing, RejectsOverwrittenAndFutureFrames)
+{
+    MessageStatisticsRing ring{};
+    MessageStatistics statistics{};
+
+    for (uint32_t frame = 0; frame <= MessageStatistics::s_frameNum; frame++)
+        ring.publish(frame, statistics);
+
+    // Shares its slot with the last frame.
+    EXPECT_FALSE(ring.tryRead(0, statistics));
+    EXPECT_FALSE(ring.tryRead(MessageStatistics::s_frameNum + 1, statistics));
+}
+
+TEST(MessageStatisticsRing, RejectsSlotBeingWritten)
+{
+    MessageStatisticsRing ring{};
+    MessageStatistics statistics{};
+    ring.publish(0, statistics);
+
+    // What x86 would observe while x64 is in the middle of publishing frame 4.
+    ring.slots[0].sequence = MessageStatistics::s_frameNum * 2 + 1;
+    EXPECT_FALSE(ring.tryRead(0, statistics));
+    EXPECT_FALSE(ring.tryRead(MessageStatistics::s_frameNum, statistics));
+}
+
+TEST(MessageStatisticsRing, NeverReturnsTornCopies)
+{
+    static MessageStatisticsRing ring{};
+    std::atomic<uint32_t> completedFrame{ 0 };
+    std::atomic<bool> done{ false };
+
+    std::thread writer([&]
+    {
+        static MessageStatistics statistics{};
+        for (uint32_t frame = 0; frame < 200000; frame++)
+        {
+            fill(statistics, frame);
+            ring.publish(frame, statistics);
+            completedFrame.store(frame + 1, std::memory_order_release);
+        }
+
+        done = true;
+    });
+
+    static MessageStatistics read{};
+    uint32_t successCount = 0;
+
+    while (!done)
+    {
+        // The oldest frame still in the ring is the one the writer overwrites next.
+        const uint32_t frame = completedFrame.load(std::memory_order_acquire);
+        if (frame < MessageStatistics::s_frameNum)
+            continue;
+
+        if (ring.tryRead(frame - MessageStatistics::s_frameNum, read))
+        {
+            ASSERT_TRUE(isConsistent(read, frame - MessageStatistics::s_frameNum)) << frame;
+            ++successCount;
+        }
+    }
+
+    writer.join();
+
+    EXPECT_GT(successCount, 0u);
+}
\ No newline at end of file
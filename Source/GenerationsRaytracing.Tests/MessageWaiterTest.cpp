@@ -0,0 +1,62 @@
+#include "MessageWaiter.h"
+
+namespace
+{
+    constexpr TCHAR s_eventName[] = TEXT("GenerationsRaytracingMessageWaiterTestEvent");
+}
+
+TEST(MessageWaiter, ReturnsImmediatelyWithPendingMessages)
+{
+    Event event(s_eventName, FALSE, FALSE);
+    std::atomic<bool> sleeping{ false };
+    uint32_t checkCount = 0;
+
+    MessageWaiter::wait(sleeping, event, [&] { ++checkCount; return true; });
+
+    EXPECT_EQ(checkCount, 1u);
+    EXPECT_FALSE(sleeping);
+}
+
+TEST(MessageWaiter, SleepsUntilNotified)
+{
+    Event event(s_eventName, FALSE, FALSE);
+    std::atomic<bool> sleeping{ false };
+    std::atomic<uint32_t> head{ 0 };
+
+    std::thread consumer([&] { MessageWaiter::wait(sleeping, event, [&] { return head != 0; }); });
+
+    while (!sleeping)
+        std::this_thread::yield();
+
+    head = 1;
+    MessageWaiter::notify(sleeping, event);
+
+    consumer.join();
+    EXPECT_FALSE(sleeping);
+}
+
+TEST(MessageWaiter, NoLostWakeUpsUnderRacingPublishes)
+{
+    Event event(s_eventName, FALSE, FALSE);
+    std::atomic<bool> sleeping{ false };
+    std::atomic<uint32_t> head{ 0 };
+
+    constexpr uint32_t s_messageCount = 2000;
+
+    std::thread consumer([&]
+    {
+        for (uint32_t offset = 0; offset < s_messageCount; offset++)
+            MessageWaiter::wait(sleeping, event, [&] { return offset != head; });
+    });
+
+    for (uint32_t i = 0; i < s_messageCount; i++)
+    {
+        if ((i % 16) == 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+        head = i + 1;
+        MessageWaiter::notify(sleeping, event);
+    }
+
+    consumer.join();
+}
\ No newline at end of file
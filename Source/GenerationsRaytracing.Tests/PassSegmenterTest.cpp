@@ -0,0 +1,183 @@
+#include "CaptureBuilder.h"
+#include "MessageCaptureReader.h"
+#include "PassSegmenter.h"
+
+namespace
+{
+    constexpr uint32_t s_minDrawCount = 256;
+    constexpr uint32_t s_maxSegmentCount = 4;
+
+    CaptureBuilder& draws(CaptureBuilder& builder, uint32_t count)
+    {
+        MsgDrawIndexedPrimitive message{};
+        message.indexCount = 3;
+
+        for (uint32_t i = 0; i < count; i++)
+            builder.message(message);
+
+        return builder;
+    }
+
+    CaptureBuilder& renderTarget(CaptureBuilder& builder)
+    {
+        MsgSetRenderTarget message{};
+        message.textureId = 1;
+        return builder.message(message);
+    }
+
+    // Walks a capture the way the device does, returns the draw calls of every segment of every frame.
+    std::vector<std::vector<uint32_t>> segmentCapture(std::vector<uint8_t>& capture)
+    {
+        MessageCaptureReader reader(capture.data(), capture.size());
+        EXPECT_TRUE(reader.isValid());
+
+        PassSegmenter segmenter(s_minDrawCount, s_maxSegmentCount);
+        std::vector<std::vector<uint32_t>> frames(1, std::vector<uint32_t>(1));
+
+        while (const auto record = reader.next())
+        {
+            if (record->type == MessageCaptureRecordType::Frame)
+            {
+                segmenter.reset();
+                frames.emplace_back(1);
+                continue;
+            }
+
+            if (record->type != MessageCaptureRecordType::Message)
+                continue;
+
+            const uint8_t messageId = *MessageCaptureReader::getRecordData(record);
+
+            if (PassSegmenter::isPassBoundary(messageId) && segmenter.shouldSplit())
+            {
+                segmenter.split();
+                frames.back().push_back(0);
+            }
+
+            if (PassSegmenter::isDraw(messageId))
+            {
+                segmenter.addDraw();
+                ++frames.back()[segmenter.getSegmentIndex()];
+            }
+        }
+
+        return frames;
+    }
+}
+
+TEST(PassSegmenter, ClassifiesMessages)
+{
+    EXPECT_TRUE(PassSegmenter::isPassBoundary(MsgSetRenderTarget::s_id));
+    EXPECT_TRUE(PassSegmenter::isPassBoundary(MsgTraceRays::s_id));
+    EXPECT_TRUE(PassSegmenter::isPassBoundary(MsgDispatchUpscaler::s_id));
+    EXPECT_FALSE(PassSegmenter::isPassBoundary(MsgSetDepthStencilSurface::s_id));
+    EXPECT_FALSE(PassSegmenter::isPassBoundary(MsgPresent::s_id));
+    EXPECT_FALSE(PassSegmenter::isPassBoundary(MsgDrawPrimitive::s_id));
+
+    EXPECT_TRUE(PassSegmenter::isDraw(MsgDrawPrimitive::s_id));
+    EXPECT_TRUE(PassSegmenter::isDraw(MsgDrawPrimitiveUP::s_id));
+    EXPECT_TRUE(PassSegmenter::isDraw(MsgDrawIndexedPrimitive::s_id));
+    EXPECT_TRUE(PassSegmenter::isDraw(MsgDrawIndexedPrimitiveUP::s_id));
+    EXPECT_FALSE(PassSegmenter::isDraw(MsgSetTexture::s_id));
+    EXPECT_FALSE(PassSegmenter::isDraw(MsgTraceRays::s_id));
+}
+
+TEST(PassSegmenter, WaitsForEnoughDrawCalls)
+{
+    PassSegmenter segmenter(3, 4);
+    EXPECT_FALSE(segmenter.shouldSplit());
+
+    segmenter.addDraw();
+    segmenter.addDraw();
+    EXPECT_FALSE(segmenter.shouldSplit());
+
+    segmenter.addDraw();
+    EXPECT_TRUE(segmenter.shouldSplit());
+
+    segmenter.split();
+    EXPECT_EQ(segmenter.getSegmentIndex(), 1u);
+    EXPECT_EQ(segmenter.getDrawCount(), 0u);
+    EXPECT_FALSE(segmenter.shouldSplit());
+}
+
+TEST(PassSegmenter, StaysOnLastSegment)
+{
+    PassSegmenter segmenter(1, 3);
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        segmenter.addDraw();
+        if (segmenter.shouldSplit())
+            segmenter.split();
+    }
+
+    EXPECT_EQ(segmenter.getSegmentIndex(), 2u);
+    EXPECT_EQ(segmenter.getDrawCount(), 8u);
+
+    segmenter.reset();
+    EXPECT_EQ(segmenter.getSegmentIndex(), 0u);
+    EXPECT_EQ(segmenter.getDrawCount(), 0u);
+}
+
+TEST(PassSegmenter, SplitsCaptureAtPassBoundaries)
+{
+    CaptureBuilder builder;
+
+    // Shadow map, a short pass that shares a segment with the next one, raytracing, then the upscaler
+    // with too few draw calls in front of it to split again.
+    renderTarget(builder);
+    draws(builder, 300);
+    renderTarget(builder);
+    draws(builder, 100);
+    renderTarget(builder);
+    draws(builder, 200);
+    builder.message(MsgTraceRays{});
+    draws(builder, 10);
+    builder.message(MsgDispatchUpscaler{});
+    draws(builder, 5);
+    builder.message(MsgPresent{});
+
+    const auto frames = segmentCapture(builder.get());
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0], (std::vector<uint32_t>{ 300, 300, 15 }));
+}
+
+TEST(PassSegmenter, SplitsEveryFrameFromTheStart)
+{
+    CaptureBuilder builder;
+
+    for (uint32_t frame = 0; frame < 3; frame++)
+    {
+        // More passes than there are command lists, the last one takes the rest.
+        for (uint32_t pass = 0; pass < 6; pass++)
+        {
+            renderTarget(builder);
+            draws(builder, 256 + frame);
+        }
+
+        builder.message(MsgPresent{});
+        builder.frame(frame);
+    }
+
+    const auto frames = segmentCapture(builder.get());
+    ASSERT_EQ(frames.size(), 4u);
+
+    for (uint32_t frame = 0; frame < 3; frame++)
+    {
+        const uint32_t drawCount = 256 + frame;
+        EXPECT_EQ(frames[frame], (std::vector<uint32_t>{ drawCount, drawCount, drawCount, drawCount * 3 })) << frame;
+    }
+
+    EXPECT_EQ(frames[3], std::vector<uint32_t>(1));
+}
+
+TEST(PassSegmenter, IgnoresFramesWithoutPasses)
+{
+    CaptureBuilder builder;
+    draws(builder, 1000);
+    builder.message(MsgPresent{});
+
+    const auto frames = segmentCapture(builder.get());
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0], std::vector<uint32_t>{ 1000 });
+}
\ No newline at end of file
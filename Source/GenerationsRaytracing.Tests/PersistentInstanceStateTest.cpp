@@ -0,0 +1,339 @@
+#include "PersistentInstanceState.h"
+
+namespace
+{
+    // Hands out IDs like FreeListAllocator would and logs what would have been sent.
+    class RecordingSink final : public PersistentInstanceSink
+    {
+    public:
+        std::vector<std::string> calls;
+        std::vector<uint32_t> freeIds;
+        uint32_t nextId = 1;
+
+        uint32_t allocateInstanceId() override
+        {
+            if (!freeIds.empty())
+            {
+                const uint32_t id = freeIds.back();
+                freeIds.pop_back();
+                return id;
+            }
+
+            return nextId++;
+        }
+
+        void createInstance(uint32_t instanceId, size_t instanceType, uint32_t bottomLevelAccelStructId) override
+        {
+            calls.push_back("create " + std::to_string(instanceId) + " " + std::to_string(instanceType) + " " + std::to_string(bottomLevelAccelStructId));
+        }
+
+        void updateInstance(uint32_t instanceId) override
+        {
+            calls.push_back("update " + std::to_string(instanceId));
+        }
+
+        void updateMaterials(uint32_t instanceId) override
+        {
+            calls.push_back("materials " + std::to_string(instanceId));
+        }
+
+        void releaseInstance(uint32_t instanceId) override
+        {
+            calls.push_back("release " + std::to_string(instanceId));
+            freeIds.push_back(instanceId);
+        }
+
+        std::vector<std::string> take()
+        {
+            return std::move(calls);
+        }
+    };
+
+    using Calls = std::vector<std::string>;
+
+    struct PersistentInstanceStateTest : testing::Test
+    {
+        PersistentInstanceState<3> state;
+        RecordingSink sink;
+        uint32_t bottomLevelAccelStructIds[3]{ 10, 0, 30 };
+        float transform[3][4]{ { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 } };
+        uint32_t parameterHash = 0;
+        uint32_t materialHash = 0;
+        uint32_t layoutHash = 0;
+
+        PersistentInstanceStateTest()
+        {
+            state.reset();
+        }
+
+        Calls update()
+        {
+            state.update(bottomLevelAccelStructIds, transform, parameterHash, materialHash, layoutHash, sink);
+            return sink.take();
+        }
+    };
+}
+
+TEST_F(PersistentInstanceStateTest, CreatesOnFirstUpdate)
+{
+    EXPECT_EQ(update(), (Calls{ "create 1 0 10", "create 2 2 30" }));
+}
+
+TEST_F(PersistentInstanceStateTest, SendsNothingForStaticInstances)
+{
+    update();
+
+    for (uint32_t i = 0; i < 100; i++)
+        EXPECT_TRUE(update().empty());
+}
+
+TEST_F(PersistentInstanceStateTest, UpdatesWhenTransformChanges)
+{
+    update();
+
+    transform[1][3] = 5.0f;
+    EXPECT_EQ(update(), (Calls{ "update 1", "update 2" }));
+    EXPECT_TRUE(update().empty());
+}
+
+TEST_F(PersistentInstanceStateTest, UpdatesWhenParametersChange)
+{
+    update();
+
+    parameterHash = 1;
+    EXPECT_EQ(update(), (Calls{ "update 1", "update 2" }));
+    EXPECT_TRUE(update().empty());
+}
+
+TEST_F(PersistentInstanceStateTest, UpdatesMaterialsOnTheirOwn)
+{
+    update();
+
+    materialHash = 1;
+    EXPECT_EQ(update(), (Calls{ "materials 1", "materials 2" }));
+    EXPECT_TRUE(update().empty());
+
+    materialHash = 2;
+    transform[0][3] = 1.0f;
+    EXPECT_EQ(update(), (Calls{ "update 1", "materials 1", "update 2", "materials 2" }));
+}
+
+TEST_F(PersistentInstanceStateTest, CreateCarriesMaterials)
+{
+    materialHash = 1;
+    EXPECT_EQ(update(), (Calls{ "create 1 0 10", "create 2 2 30" }));
+
+    bottomLevelAccelStructIds[0] = 11;
+    materialHash = 2;
+    EXPECT_EQ(update(), (Calls{ "create 1 0 11", "materials 2" }));
+}
+
+TEST_F(PersistentInstanceStateTest, RecreatesWhenLayoutChanges)
+{
+    update();
+
+    layoutHash = 1;
+    parameterHash = 1;
+    materialHash = 1;
+
+    // Same IDs, everything else comes with the recreated instances.
+    EXPECT_EQ(update(), (Calls{ "create 1 0 10", "create 2 2 30" }));
+    EXPECT_TRUE(update().empty());
+}
+
+TEST_F(PersistentInstanceStateTest, IgnoresUnchangedNaN)
+{
+    transform[0][0] = std::numeric_limits<float>::quiet_NaN();
+    update();
+
+    EXPECT_TRUE(update().empty());
+}
+
+TEST_F(PersistentInstanceStateTest, RecreatesWhenBottomLevelAccelStructChanges)
+{
+    update();
+
+    bottomLevelAccelStructIds[2] = 31;
+    transform[0][3] = 1.0f;
+
+    // The recreated instance already carries the new transform.
+    EXPECT_EQ(update(), (Calls{ "update 1", "create 2 2 31" }));
+}
+
+TEST_F(PersistentInstanceStateTest, ReleasesTypesThatLoseTheirBottomLevelAccelStruct)
+{
+    update();
+
+    bottomLevelAccelStructIds[0] = 0;
+    EXPECT_EQ(update(), (Calls{ "release 1" }));
+    EXPECT_TRUE(update().empty());
+
+    bottomLevelAccelStructIds[0] = 11;
+    EXPECT_EQ(update(), (Calls{ "create 1 0 11" }));
+}
+
+TEST_F(PersistentInstanceStateTest, ReleasesEverything)
+{
+    update();
+
+    state.release(sink);
+    EXPECT_EQ(sink.take(), (Calls{ "release 1", "release 2" }));
+
+    state.release(sink);
+    EXPECT_TRUE(sink.take().empty());
+
+    // Comes back with everything sent again, even though nothing else changed.
+    EXPECT_EQ(update(), (Calls{ "create 2 0 10", "create 1 2 30" }));
+}
+
+// Drives many objects through random changes and checks that replaying
+// the calls on a mirror of the x64 table always ends up with the x86 state.
+TEST(PersistentInstanceState, MirrorMatchesAfterRandomChanges)
+{
+    struct MirroredSink final : PersistentInstanceSink
+    {
+        struct Instance
+        {
+            size_t instanceType;
+            uint32_t bottomLevelAccelStructId;
+            float transform[3][4];
+            uint32_t parameterHash;
+            uint32_t materialHash;
+            uint32_t layoutHash;
+        };
+
+        std::unordered_map<uint32_t, Instance> instances;
+        uint32_t nextId = 1;
+        const float (*transform)[4] = nullptr;
+        uint32_t parameterHash = 0;
+        uint32_t materialHash = 0;
+        uint32_t layoutHash = 0;
+        size_t messageCount = 0;
+
+        uint32_t allocateInstanceId() override
+        {
+            return nextId++;
+        }
+
+        void createInstance(uint32_t instanceId, size_t instanceType, uint32_t bottomLevelAccelStructId) override
+        {
+            auto& instance = instances[instanceId];
+            instance.instanceType = instanceType;
+            instance.bottomLevelAccelStructId = bottomLevelAccelStructId;
+            memcpy(instance.transform, transform, sizeof(instance.transform));
+            instance.parameterHash = parameterHash;
+            instance.materialHash = materialHash;
+            instance.layoutHash = layoutHash;
+            ++messageCount;
+        }
+
+        void updateInstance(uint32_t instanceId) override
+        {
+            auto& instance = instances.at(instanceId);
+            memcpy(instance.transform, transform, sizeof(instance.transform));
+            instance.parameterHash = parameterHash;
+            ++messageCount;
+        }
+
+        void updateMaterials(uint32_t instanceId) override
+        {
+            instances.at(instanceId).materialHash = materialHash;
+            ++messageCount;
+        }
+
+        void releaseInstance(uint32_t instanceId) override
+        {
+            EXPECT_EQ(instances.erase(instanceId), 1u);
+            ++messageCount;
+        }
+    };
+
+    struct Object
+    {
+        PersistentInstanceState<3> state;
+        uint32_t bottomLevelAccelStructIds[3];
+        float transform[3][4];
+        uint32_t parameterHash;
+        uint32_t materialHash;
+        uint32_t layoutHash;
+    };
+
+    std::mt19937 random(0x5678);
+    std::vector<Object> objects(64);
+
+    for (auto& object : objects)
+    {
+        object.state.reset();
+        for (auto& bottomLevelAccelStructId : object.bottomLevelAccelStructIds)
+            bottomLevelAccelStructId = random() % 4;
+
+        for (auto& row : object.transform)
+        {
+            for (auto& value : row)
+                value = static_cast<float>(random() % 8);
+        }
+
+        object.parameterHash = 0;
+        object.materialHash = 0;
+        object.layoutHash = 0;
+    }
+
+    MirroredSink sink;
+
+    for (uint32_t frame = 0; frame < 200; frame++)
+    {
+        for (auto& object : objects)
+        {
+            // Most objects stay put, like terrain does.
+            if (random() % 8 == 0)
+                object.transform[random() % 3][random() % 4] = static_cast<float>(random() % 8);
+            if (random() % 16 == 0)
+                object.bottomLevelAccelStructIds[random() % 3] = random() % 4;
+            if (random() % 32 == 0)
+                object.parameterHash = random() % 2;
+            if (random() % 32 == 0)
+                object.materialHash = random() % 2;
+            if (random() % 64 == 0)
+                object.layoutHash = random() % 2;
+
+            sink.transform = object.transform;
+            sink.parameterHash = object.parameterHash;
+            sink.materialHash = object.materialHash;
+            sink.layoutHash = object.layoutHash;
+            object.state.update(object.bottomLevelAccelStructIds, object.transform,
+                object.parameterHash, object.materialHash, object.layoutHash, sink);
+        }
+
+        size_t instanceCount = 0;
+        for (auto& object : objects)
+        {
+            for (size_t i = 0; i < 3; i++)
+            {
+                const uint32_t instanceId = object.state.instanceIds[i];
+                ASSERT_EQ(instanceId != 0, object.bottomLevelAccelStructIds[i] != 0);
+
+                if (instanceId != 0)
+                {
+                    const auto& instance = sink.instances.at(instanceId);
+                    ASSERT_EQ(instance.instanceType, i);
+                    ASSERT_EQ(instance.bottomLevelAccelStructId, object.bottomLevelAccelStructIds[i]);
+                    ASSERT_EQ(memcmp(instance.transform, object.transform, sizeof(instance.transform)), 0);
+                    ASSERT_EQ(instance.parameterHash, object.parameterHash);
+                    ASSERT_EQ(instance.materialHash, object.materialHash);
+                    ASSERT_EQ(instance.layoutHash, object.layoutHash);
+                    ++instanceCount;
+                }
+            }
+        }
+
+        ASSERT_EQ(sink.instances.size(), instanceCount);
+    }
+
+    // Far fewer messages than sending every instance every frame.
+    EXPECT_LT(sink.messageCount, 200u * objects.size() * 3 / 4);
+
+    for (auto& object : objects)
+        object.state.release(sink);
+
+    EXPECT_TRUE(sink.instances.empty());
+}
\ No newline at end of file
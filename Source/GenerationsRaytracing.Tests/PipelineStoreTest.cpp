@@ -0,0 +1,277 @@
+#include "PipelineStore.h"
+
+namespace
+{
+    using Pipeline = std::shared_ptr<std::string>;
+
+    // Compiles a desc into a copy of its text. Descs starting with '!' fail to compile like a stale cache entry would.
+    class FakePipelineCompiler final : public PipelineCompiler<Pipeline>
+    {
+    public:
+        std::mutex mutex;
+        std::vector<std::string> compiled;
+        std::chrono::microseconds delay{};
+
+        Pipeline compilePipeline(const uint8_t* data, uint32_t dataSize) override
+        {
+            std::string desc(reinterpret_cast<const char*>(data), dataSize);
+
+            if (delay.count() != 0)
+                std::this_thread::sleep_for(delay);
+
+            {
+                std::lock_guard lock(mutex);
+                compiled.push_back(desc);
+            }
+
+            if (desc[0] == '!')
+                return nullptr;
+
+            return std::make_shared<std::string>(std::move(desc));
+        }
+    };
+
+    void appendRecord(std::vector<uint8_t>& block, uint64_t key, const std::string& desc)
+    {
+        PipelineRecordHeader header;
+        header.key = key;
+        header.dataSize = static_cast<uint32_t>(desc.size());
+
+        const size_t offset = block.size();
+        block.resize(offset + sizeof(PipelineRecordHeader) + desc.size());
+        memcpy(block.data() + offset, &header, sizeof(PipelineRecordHeader));
+        memcpy(block.data() + offset + sizeof(PipelineRecordHeader), desc.data(), desc.size());
+    }
+
+    std::unique_ptr<uint8_t[]> copyBlock(const std::vector<uint8_t>& block)
+    {
+        std::unique_ptr<uint8_t[]> result(new uint8_t[block.size()]);
+        memcpy(result.get(), block.data(), block.size());
+        return result;
+    }
+
+    bool add(PipelineStore<Pipeline>& store, uint64_t key, const std::string& desc)
+    {
+        return store.addPipeline(key, reinterpret_cast<const uint8_t*>(desc.data()), static_cast<uint32_t>(desc.size()));
+    }
+
+    struct PipelineStoreTest : testing::Test
+    {
+        FakePipelineCompiler compiler;
+        PipelineStore<Pipeline> store{ compiler, 0 };
+
+        void load(std::initializer_list<const char*> descs)
+        {
+            std::vector<uint8_t> block;
+            for (const char* desc : descs)
+                appendRecord(block, std::hash<std::string>()(desc), desc);
+
+            ASSERT_TRUE(store.loadBlock(copyBlock(block), static_cast<uint32_t>(block.size())));
+        }
+
+        static uint64_t key(const char* desc)
+        {
+            return std::hash<std::string>()(desc);
+        }
+
+        void compileAll()
+        {
+            while (store.compileNext())
+                ;
+        }
+    };
+}
+
+TEST_F(PipelineStoreTest, CompilesLoadedPipelinesInStoredOrder)
+{
+    load({ "a", "b", "c" });
+    EXPECT_EQ(store.getPendingCount(), 3u);
+    EXPECT_EQ(store.getStatus(key("a")), PipelineStatus::Pending);
+
+    compileAll();
+
+    EXPECT_EQ(compiler.compiled, (std::vector<std::string>{ "a", "b", "c" }));
+    EXPECT_EQ(store.getStatus(key("c")), PipelineStatus::Ready);
+    EXPECT_EQ(*store.getPipeline(key("b"), true), "b");
+}
+
+TEST_F(PipelineStoreTest, DrawCallMissesJumpTheQueue)
+{
+    load({ "a", "b" });
+    EXPECT_TRUE(add(store, key("c"), "c"));
+
+    store.compileNext();
+    EXPECT_EQ(compiler.compiled, (std::vector<std::string>{ "c" }));
+}
+
+TEST_F(PipelineStoreTest, HitOnPendingPipelineMovesItToTheFront)
+{
+    load({ "a", "b", "c", "d" });
+
+    EXPECT_EQ(store.getPipeline(key("c"), true), nullptr);
+    EXPECT_EQ(store.getStatus(key("c")), PipelineStatus::Pending);
+
+    store.compileNext();
+    EXPECT_EQ(compiler.compiled, (std::vector<std::string>{ "c" }));
+
+    // Hits that are already compiled don't disturb the order of the rest.
+    EXPECT_EQ(*store.getPipeline(key("c"), true), "c");
+    compileAll();
+    EXPECT_EQ(compiler.compiled, (std::vector<std::string>{ "c", "a", "b", "d" }));
+}
+
+TEST_F(PipelineStoreTest, SynchronousGetCompilesOnTheCallingThread)
+{
+    load({ "a", "b", "c" });
+
+    EXPECT_EQ(*store.getPipeline(key("b"), false), "b");
+    EXPECT_EQ(store.getPendingCount(), 2u);
+
+    compileAll();
+    EXPECT_EQ(compiler.compiled, (std::vector<std::string>{ "b", "a", "c" }));
+}
+
+TEST_F(PipelineStoreTest, KnownKeysAreNotQueuedAgain)
+{
+    load({ "a" });
+    EXPECT_FALSE(add(store, key("a"), "a"));
+    EXPECT_TRUE(add(store, key("b"), "b"));
+    EXPECT_FALSE(add(store, key("b"), "b"));
+
+    load({ "a", "b", "c" });
+    EXPECT_EQ(store.getPendingCount(), 3u);
+}
+
+TEST_F(PipelineStoreTest, FailedPipelinesReturnNullWithoutRetrying)
+{
+    EXPECT_TRUE(add(store, key("!broken"), "!broken"));
+    EXPECT_EQ(store.getPipeline(key("!broken"), false), nullptr);
+    EXPECT_EQ(store.getStatus(key("!broken")), PipelineStatus::Failed);
+
+    EXPECT_EQ(store.getPipeline(key("!broken"), false), nullptr);
+    EXPECT_EQ(store.getPipeline(key("!broken"), true), nullptr);
+    EXPECT_EQ(compiler.compiled.size(), 1u);
+}
+
+TEST_F(PipelineStoreTest, UnknownKeysReturnNull)
+{
+    EXPECT_EQ(store.getPipeline(1234, false), nullptr);
+    EXPECT_EQ(store.getStatus(1234), PipelineStatus::Unknown);
+}
+
+TEST_F(PipelineStoreTest, SavedBlocksLoadBackWithTheSameKeys)
+{
+    load({ "loaded" });
+    add(store, key("a"), "a");
+    add(store, key("!broken"), "!broken");
+    add(store, key("b"), "b");
+    compileAll();
+
+    // Only pipelines added this session get saved, and failed ones are left out.
+    std::vector<uint8_t> block;
+    ASSERT_TRUE(store.saveBlock(block));
+
+    std::vector<uint8_t> expected;
+    appendRecord(expected, key("a"), "a");
+    appendRecord(expected, key("b"), "b");
+    EXPECT_EQ(block, expected);
+
+    EXPECT_FALSE(store.saveBlock(block));
+    EXPECT_TRUE(block.empty());
+
+    add(store, key("c"), "c");
+    ASSERT_TRUE(store.saveBlock(block));
+
+    expected.clear();
+    appendRecord(expected, key("c"), "c");
+    EXPECT_EQ(block, expected);
+
+    FakePipelineCompiler otherCompiler;
+    PipelineStore<Pipeline> otherStore(otherCompiler, 0);
+    ASSERT_TRUE(otherStore.loadBlock(copyBlock(block), static_cast<uint32_t>(block.size())));
+    EXPECT_EQ(*otherStore.getPipeline(key("c"), false), "c");
+}
+
+TEST_F(PipelineStoreTest, MalformedBlocksAreRejectedWhole)
+{
+    std::vector<uint8_t> block;
+    appendRecord(block, key("a"), "a");
+    appendRecord(block, key("bcd"), "bcd");
+
+    for (size_t size = 1; size < block.size(); size++)
+    {
+        if (size == sizeof(PipelineRecordHeader) + 1)
+            continue;
+
+        EXPECT_FALSE(store.loadBlock(copyBlock(block), static_cast<uint32_t>(size))) << size;
+    }
+
+    std::vector<uint8_t> emptyRecord;
+    appendRecord(emptyRecord, key(""), "");
+    EXPECT_FALSE(store.loadBlock(copyBlock(emptyRecord), static_cast<uint32_t>(emptyRecord.size())));
+
+    EXPECT_EQ(store.getPendingCount(), 0u);
+    EXPECT_EQ(store.getStatus(key("a")), PipelineStatus::Unknown);
+}
+
+TEST(PipelineStoreThreadTest, WorkerThreadsCompileEverythingOnce)
+{
+    FakePipelineCompiler compiler;
+    compiler.delay = std::chrono::microseconds(50);
+
+    std::vector<std::string> descs;
+    for (uint32_t i = 0; i < 200; i++)
+        descs.push_back((i % 17 == 0 ? "!" : "") + std::to_string(i));
+
+    std::vector<uint8_t> block;
+    for (uint32_t i = 0; i < 100; i++)
+        appendRecord(block, i, descs[i]);
+
+    {
+        PipelineStore<Pipeline> store(compiler, 4);
+        ASSERT_TRUE(store.loadBlock(copyBlock(block), static_cast<uint32_t>(block.size())));
+
+        // Draw calls keep adding and asking for pipelines while the workers are busy.
+        for (uint32_t i = 100; i < 200; i++)
+            add(store, i, descs[i]);
+
+        for (uint32_t i = 0; i < 200; i += 3)
+        {
+            const Pipeline pipeline = store.getPipeline(i, false);
+
+            if (i % 17 == 0)
+                EXPECT_EQ(pipeline, nullptr);
+            else
+                EXPECT_EQ(*pipeline, descs[i]);
+        }
+
+        for (uint32_t i = 0; i < 200; i++)
+        {
+            while (store.getStatus(i) == PipelineStatus::Pending || store.getStatus(i) == PipelineStatus::Compiling)
+                std::this_thread::yield();
+
+            EXPECT_EQ(store.getStatus(i), i % 17 == 0 ? PipelineStatus::Failed : PipelineStatus::Ready);
+        }
+    }
+
+    std::sort(compiler.compiled.begin(), compiler.compiled.end());
+    std::sort(descs.begin(), descs.end());
+    EXPECT_EQ(compiler.compiled, descs);
+}
+
+TEST(PipelineStoreThreadTest, DestroyingWithAQueueLeftStopsTheWorkers)
+{
+    FakePipelineCompiler compiler;
+    compiler.delay = std::chrono::microseconds(100);
+
+    std::vector<uint8_t> block;
+    for (uint32_t i = 0; i < 1000; i++)
+        appendRecord(block, i, std::to_string(i));
+
+    {
+        PipelineStore<Pipeline> store(compiler, 2);
+        ASSERT_TRUE(store.loadBlock(copyBlock(block), static_cast<uint32_t>(block.size())));
+    }
+
+    EXPECT_LT(compiler.compiled.size(), 1000u);
+}
\ No newline at end of file
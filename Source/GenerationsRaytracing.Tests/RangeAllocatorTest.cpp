@@ -0,0 +1,203 @@
+#include "LegacyRangeAllocator.h"
+#include "RangeAllocator.h"
+
+namespace
+{
+    // Keeps the live ranges alongside the allocator and checks them against each other.
+    template<typename TAllocator>
+    struct RangeModel
+    {
+        TAllocator allocator;
+        std::map<uint32_t, uint32_t> ranges;
+
+        uint32_t allocate(uint32_t count)
+        {
+            const uint32_t index = allocator.allocate(count);
+
+            EXPECT_LE(index + count, allocator.getCapacity());
+
+            const auto next = ranges.lower_bound(index);
+            EXPECT_TRUE(next == ranges.end() || next->first >= index + count);
+            if (next != ranges.begin())
+            {
+                EXPECT_LE(std::prev(next)->first + std::prev(next)->second, index);
+            }
+
+            ranges.emplace(index, count);
+            return index;
+        }
+
+        void freeAt(size_t position)
+        {
+            auto it = ranges.begin();
+            std::advance(it, position);
+            allocator.free(it->first, it->second);
+            ranges.erase(it);
+
+            // Shrinks down to the last live range.
+            const uint32_t end = ranges.empty() ? 0 : ranges.rbegin()->first + ranges.rbegin()->second;
+            EXPECT_EQ(allocator.getCapacity(), end);
+        }
+
+        // The largest gap between live ranges.
+        uint32_t getLargestFreeCount() const
+        {
+            uint32_t largest = 0;
+            uint32_t end = 0;
+
+            for (const auto& [index, count] : ranges)
+            {
+                largest = std::max(largest, index - end);
+                end = index + count;
+            }
+
+            return largest;
+        }
+    };
+
+    // Any free range at least this large is guaranteed to be found, see RangeAllocator::allocate.
+    uint32_t getGuaranteedFitCount(uint32_t count)
+    {
+        if (count < 16)
+            return count;
+
+        return count + (1u << (findLastSetBit(count) - 4)) - 1;
+    }
+}
+
+TEST(RangeAllocator, AppendsWhenNothingIsFree)
+{
+    RangeAllocator allocator;
+    EXPECT_EQ(allocator.allocate(4), 0u);
+    EXPECT_EQ(allocator.allocate(10), 4u);
+    EXPECT_EQ(allocator.getCapacity(), 14u);
+}
+
+TEST(RangeAllocator, ReusesFreedRangeFromItsEnd)
+{
+    RangeAllocator allocator;
+    const uint32_t first = allocator.allocate(10);
+    allocator.allocate(1);
+
+    allocator.free(first, 10);
+    EXPECT_EQ(allocator.allocate(4), 6u);
+    EXPECT_EQ(allocator.allocate(6), 0u);
+    EXPECT_EQ(allocator.getCapacity(), 11u);
+}
+
+TEST(RangeAllocator, MergesBothNeighbors)
+{
+    RangeAllocator allocator;
+    const uint32_t first = allocator.allocate(5);
+    const uint32_t second = allocator.allocate(5);
+    const uint32_t third = allocator.allocate(5);
+    allocator.allocate(1);
+
+    allocator.free(first, 5);
+    allocator.free(third, 5);
+    allocator.free(second, 5);
+
+    EXPECT_EQ(allocator.allocate(15), 0u);
+}
+
+TEST(RangeAllocator, ShrinksWhenLastRangeIsFreed)
+{
+    RangeAllocator allocator;
+    const uint32_t first = allocator.allocate(5);
+    const uint32_t second = allocator.allocate(5);
+
+    allocator.free(first, 5);
+    EXPECT_EQ(allocator.getCapacity(), 10u);
+
+    // Merges with the free range in front of it as well.
+    allocator.free(second, 5);
+    EXPECT_EQ(allocator.getCapacity(), 0u);
+}
+
+TEST(RangeAllocator, LargeRangesSpanEveryLevel)
+{
+    RangeAllocator allocator;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+
+    for (uint32_t log2 = 0; log2 < 20; log2++)
+    {
+        const uint32_t count = 1u << log2;
+        ranges.emplace_back(allocator.allocate(count), count);
+        allocator.allocate(1);
+    }
+
+    for (const auto& [index, count] : ranges)
+        allocator.free(index, count);
+
+    // Power of two sizes start their list, so freed ranges get reused by allocations of the same size.
+    for (const auto& [index, count] : ranges)
+        EXPECT_EQ(allocator.allocate(count), index);
+}
+
+TEST(RangeAllocator, RandomRangesNeverOverlap)
+{
+    std::mt19937 random(0x7151);
+    RangeModel<RangeAllocator> model;
+
+    for (uint32_t i = 0; i < 50000; i++)
+    {
+        if (!model.ranges.empty() && random() % 2 == 0)
+        {
+            model.freeAt(random() % model.ranges.size());
+        }
+        else
+        {
+            const uint32_t count = 1 + random() % (random() % 16 == 0 ? 4096 : 64);
+            const uint32_t capacity = model.allocator.getCapacity();
+            const uint32_t largestFreeCount = model.getLargestFreeCount();
+
+            model.allocate(count);
+
+            // Growing is only allowed when no free range is guaranteed to fit.
+            if (model.allocator.getCapacity() > capacity)
+            {
+                ASSERT_LT(largestFreeCount, getGuaranteedFitCount(count));
+            }
+        }
+
+        if (::testing::Test::HasFailure())
+            return;
+    }
+
+    while (!model.ranges.empty())
+        model.freeAt(random() % model.ranges.size());
+
+    EXPECT_EQ(model.allocator.getCapacity(), 0u);
+}
+
+TEST(RangeAllocator, FragmentsComparablyToLegacyAllocator)
+{
+    std::mt19937 random(0xB1A5);
+    RangeModel<RangeAllocator> model;
+    RangeModel<LegacyRangeAllocator> legacyModel;
+
+    uint64_t capacitySum = 0;
+    uint64_t legacyCapacitySum = 0;
+
+    for (uint32_t i = 0; i < 50000; i++)
+    {
+        if (!model.ranges.empty() && random() % 2 == 0)
+        {
+            const size_t position = random() % model.ranges.size();
+            model.freeAt(position);
+            legacyModel.freeAt(position);
+        }
+        else
+        {
+            const uint32_t count = 1 + random() % 64;
+            model.allocate(count);
+            legacyModel.allocate(count);
+        }
+
+        capacitySum += model.allocator.getCapacity();
+        legacyCapacitySum += legacyModel.allocator.getCapacity();
+    }
+
+    // Good fit instead of exact best fit costs little extra space on average.
+    EXPECT_LE(capacitySum, legacyCapacitySum + legacyCapacitySum / 4);
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "ResourceStateTracker.h"
+
+namespace
+{
+    enum State : uint32_t
+    {
+        STATE_COMMON,
+        STATE_RENDER_TARGET,
+        STATE_DEPTH_WRITE,
+        STATE_SHADER_RESOURCE,
+        STATE_UNORDERED_ACCESS,
+        STATE_COUNT
+    };
+
+    using Tracker = ResourceStateTracker<std::unordered_map<uint32_t, ResourceStates<State>>>;
+
+    struct Barrier
+    {
+        uint32_t resource;
+        State stateBefore;
+        State stateAfter;
+
+        bool operator==(const Barrier& other) const
+        {
+            return resource == other.resource && stateBefore == other.stateBefore && stateAfter == other.stateAfter;
+        }
+    };
+
+    // Stands in for CommandList, collects the barriers that would get recorded.
+    struct Segment
+    {
+        Tracker tracker;
+        std::vector<Barrier> barriers;
+
+        void commit()
+        {
+            tracker.commit([&](uint32_t resource, State stateBefore, State stateAfter)
+            {
+                barriers.push_back({ resource, stateBefore, stateAfter });
+            });
+        }
+
+        void close()
+        {
+            tracker.restoreInitialStates();
+            commit();
+            tracker.clear();
+        }
+
+        void split(Segment& next)
+        {
+            commit();
+            tracker.moveTo(next.tracker);
+        }
+    };
+
+    std::vector<Barrier> sorted(std::vector<Barrier> barriers)
+    {
+        std::stable_sort(barriers.begin(), barriers.end(), [](const Barrier& lhs, const Barrier& rhs) { return lhs.resource < rhs.resource; });
+        return barriers;
+    }
+}
+
+TEST(ResourceStateTracker, SkipsTransitionsThatChangeNothing)
+{
+    Segment segment;
+    segment.tracker.transition(1, STATE_SHADER_RESOURCE, STATE_SHADER_RESOURCE);
+    segment.commit();
+
+    EXPECT_TRUE(segment.barriers.empty());
+    EXPECT_FALSE(segment.tracker.isEmpty());
+}
+
+TEST(ResourceStateTracker, BatchesTransitionsUntilCommit)
+{
+    Segment segment;
+    segment.tracker.transition(1, STATE_COMMON, STATE_RENDER_TARGET);
+    segment.tracker.transition(1, STATE_COMMON, STATE_SHADER_RESOURCE);
+    segment.tracker.transition(2, STATE_DEPTH_WRITE, STATE_SHADER_RESOURCE);
+    segment.tracker.transition(2, STATE_DEPTH_WRITE, STATE_DEPTH_WRITE);
+    segment.commit();
+
+    // Only the last state of the batch counts, and a resource going back where it started needs nothing.
+    EXPECT_EQ(segment.barriers, (std::vector<Barrier>{ { 1, STATE_COMMON, STATE_SHADER_RESOURCE } }));
+
+    State state;
+    EXPECT_TRUE(segment.tracker.getState(2, state));
+    EXPECT_EQ(state, STATE_DEPTH_WRITE);
+    EXPECT_FALSE(segment.tracker.getState(3, state));
+}
+
+TEST(ResourceStateTracker, CloseReturnsToInitialStates)
+{
+    Segment segment;
+    segment.tracker.transition(1, STATE_RENDER_TARGET, STATE_SHADER_RESOURCE);
+    segment.tracker.transition(2, STATE_DEPTH_WRITE, STATE_SHADER_RESOURCE);
+    segment.commit();
+    segment.barriers.clear();
+
+    segment.tracker.transition(2, STATE_DEPTH_WRITE, STATE_DEPTH_WRITE);
+    segment.close();
+
+    EXPECT_EQ(sorted(segment.barriers), (std::vector<Barrier>{
+        { 1, STATE_SHADER_RESOURCE, STATE_RENDER_TARGET },
+        { 2, STATE_SHADER_RESOURCE, STATE_DEPTH_WRITE } }));
+    EXPECT_TRUE(segment.tracker.isEmpty());
+}
+
+TEST(ResourceStateTracker, SplitResolvesStatesOfNextSegment)
+{
+    Segment first;
+    Segment second;
+
+    first.tracker.transition(1, STATE_RENDER_TARGET, STATE_SHADER_RESOURCE);
+    first.tracker.transition(2, STATE_COMMON, STATE_UNORDERED_ACCESS);
+    first.split(second);
+
+    EXPECT_EQ(sorted(first.barriers), (std::vector<Barrier>{
+        { 1, STATE_RENDER_TARGET, STATE_SHADER_RESOURCE },
+        { 2, STATE_COMMON, STATE_UNORDERED_ACCESS } }));
+
+    EXPECT_TRUE(first.tracker.isEmpty());
+
+    // The second segment starts from where the first one left off, not from the initial states.
+    second.tracker.transition(1, STATE_RENDER_TARGET, STATE_RENDER_TARGET);
+    second.tracker.transition(3, STATE_DEPTH_WRITE, STATE_SHADER_RESOURCE);
+    second.commit();
+    second.close();
+
+    EXPECT_EQ(sorted(second.barriers), (std::vector<Barrier>{
+        { 1, STATE_SHADER_RESOURCE, STATE_RENDER_TARGET },
+        { 2, STATE_UNORDERED_ACCESS, STATE_COMMON },
+        { 3, STATE_DEPTH_WRITE, STATE_SHADER_RESOURCE },
+        { 3, STATE_SHADER_RESOURCE, STATE_DEPTH_WRITE } }));
+}
+
+TEST(ResourceStateTracker, BarriersChainAcrossRandomSegments)
+{
+    constexpr uint32_t s_resourceCount = 16;
+    constexpr uint32_t s_segmentCount = 4;
+
+    std::mt19937 random(1);
+
+    for (uint32_t frame = 0; frame < 200; frame++)
+    {
+        State initialStates[s_resourceCount];
+        for (auto& initialState : initialStates)
+            initialState = static_cast<State>(random() % STATE_COUNT);
+
+        Segment segments[s_segmentCount];
+
+        for (uint32_t i = 0; i < s_segmentCount; i++)
+        {
+            for (uint32_t j = 0; j < 64; j++)
+            {
+                const uint32_t resource = random() % s_resourceCount;
+                segments[i].tracker.transition(resource, initialStates[resource], static_cast<State>(random() % STATE_COUNT));
+
+                if (random() % 8 == 0)
+                    segments[i].commit();
+            }
+
+            if (i + 1 < s_segmentCount)
+                segments[i].split(segments[i + 1]);
+            else
+                segments[i].close();
+        }
+
+        // Submitted in order, every barrier needs to start from the state the previous one left the resource in.
+        State states[s_resourceCount];
+        std::copy(std::begin(initialStates), std::end(initialStates), states);
+
+        for (const auto& segment : segments)
+        {
+            for (const auto& barrier : segment.barriers)
+            {
+                ASSERT_EQ(barrier.stateBefore, states[barrier.resource]) << frame;
+                ASSERT_NE(barrier.stateBefore, barrier.stateAfter) << frame;
+                states[barrier.resource] = barrier.stateAfter;
+            }
+        }
+
+        for (uint32_t i = 0; i < s_resourceCount; i++)
+            ASSERT_EQ(states[i], initialStates[i]) << frame;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "ScratchBufferScheduler.h"
+
+namespace
+{
+    // Logs every call and checks that no two builds between barriers share scratch memory.
+    class MockScratchBufferRecorder final : public ScratchBufferRecorder
+    {
+    public:
+        struct Buffer
+        {
+            uint64_t address;
+            uint32_t byteSize;
+        };
+
+        std::vector<std::string> calls;
+        std::vector<Buffer> pools;
+        std::vector<Buffer> temps;
+        std::vector<Buffer> inFlight;
+        uint64_t nextAddress = 0x10000000;
+
+        uint64_t createPoolBuffer(uint32_t frame, uint32_t byteSize) override
+        {
+            calls.push_back("pool " + std::to_string(frame) + " " + std::to_string(byteSize));
+            pools.push_back({ nextAddress, byteSize });
+            nextAddress += 0x10000000;
+            return pools.back().address;
+        }
+
+        uint64_t createTempBuffer(uint32_t frame, uint32_t byteSize) override
+        {
+            calls.push_back("temp " + std::to_string(frame) + " " + std::to_string(byteSize));
+            temps.push_back({ nextAddress, byteSize });
+            nextAddress += 0x10000000;
+            return temps.back().address;
+        }
+
+        void releaseTempBuffers(uint32_t frame) override
+        {
+            calls.push_back("release " + std::to_string(frame));
+            // The GPU is done with the frame by the time it begins again.
+            inFlight.clear();
+        }
+
+        void recordPoolBarrier(uint32_t frame) override
+        {
+            calls.push_back("barrier " + std::to_string(frame));
+            inFlight.clear();
+        }
+
+        void recordBuild(uint64_t address, uint32_t byteSize)
+        {
+            const auto contains = [&](const Buffer& buffer)
+            {
+                return address >= buffer.address && address + byteSize <= buffer.address + buffer.byteSize;
+            };
+
+            EXPECT_TRUE(std::any_of(pools.begin(), pools.end(), contains) || std::any_of(temps.begin(), temps.end(), contains));
+
+            for (const auto& other : inFlight)
+                EXPECT_TRUE(address + byteSize <= other.address || other.address + other.byteSize <= address);
+
+            inFlight.push_back({ address, byteSize });
+            calls.push_back("build");
+        }
+    };
+
+    struct ScratchBufferSchedulerTest : testing::Test
+    {
+        MockScratchBufferRecorder recorder;
+        ScratchBufferScheduler<2> scheduler{ recorder, 1024, 8192, 256, 1024 };
+
+        void SetUp() override
+        {
+            scheduler.beginFrame(0);
+            recorder.calls.clear();
+        }
+
+        uint64_t build(uint32_t byteSize)
+        {
+            const uint64_t address = scheduler.allocate(byteSize);
+            recorder.recordBuild(address, byteSize);
+            return address;
+        }
+
+        uint64_t getPoolAddress() const
+        {
+            return recorder.pools.back().address;
+        }
+    };
+
+    using Calls = std::vector<std::string>;
+}
+
+TEST_F(ScratchBufferSchedulerTest, CreatesMinimumPoolOnFirstFrame)
+{
+    ASSERT_EQ(recorder.pools.size(), 1u);
+    EXPECT_EQ(recorder.pools[0].byteSize, 1024u);
+    EXPECT_EQ(scheduler.getPoolByteSize(), 1024u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, PacksBuildsBackToBack)
+{
+    for (uint32_t i = 0; i < 4; i++)
+        EXPECT_EQ(build(256), getPoolAddress() + i * 256);
+
+    EXPECT_EQ(recorder.calls, Calls({ "build", "build", "build", "build" }));
+    EXPECT_EQ(scheduler.getBatchCount(), 0u);
+    EXPECT_EQ(scheduler.getOffset(), 1024u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, AlignsAllocations)
+{
+    EXPECT_EQ(build(1), getPoolAddress());
+    EXPECT_EQ(build(300), getPoolAddress() + 256);
+    EXPECT_EQ(build(256), getPoolAddress() + 768);
+    EXPECT_EQ(scheduler.getOffset(), 1024u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, WrapsAroundWithOneBarrierPerBatch)
+{
+    for (uint32_t i = 0; i < 6; i++)
+        EXPECT_EQ(build(300), getPoolAddress() + (i % 2) * 512);
+
+    EXPECT_EQ(recorder.calls, Calls({
+        "build", "build", "barrier 0",
+        "build", "build", "barrier 0",
+        "build", "build" }));
+
+    EXPECT_EQ(scheduler.getBatchCount(), 2u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, WrapsOnlyWhenTheBuildDoesNotFit)
+{
+    build(768);
+    build(256);
+    EXPECT_EQ(scheduler.getBatchCount(), 0u);
+
+    build(256);
+    EXPECT_EQ(recorder.calls, Calls({ "build", "build", "barrier 0", "build" }));
+}
+
+TEST_F(ScratchBufferSchedulerTest, OversizedBuildsGetTempBufferWithoutBarrier)
+{
+    build(512);
+    const uint64_t address = build(4096);
+    EXPECT_EQ(address, recorder.temps.back().address);
+    EXPECT_EQ(build(512), getPoolAddress() + 512);
+
+    EXPECT_EQ(recorder.calls, Calls({ "build", "temp 0 4096", "build", "build" }));
+    EXPECT_EQ(scheduler.getBatchCount(), 0u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, ReleasesTempBuffersWhenFrameBeginsAgain)
+{
+    // Larger than even the biggest pool.
+    build(16384);
+    scheduler.beginFrame(1);
+    build(16384);
+    scheduler.beginFrame(0);
+
+    ASSERT_GE(recorder.calls.size(), 3u);
+    EXPECT_EQ(recorder.calls[0], "temp 0 16384");
+    EXPECT_EQ(recorder.calls[2], "release 1");
+    EXPECT_NE(std::find(recorder.calls.begin(), recorder.calls.end(), "temp 1 16384"), recorder.calls.end());
+    EXPECT_NE(std::find(recorder.calls.begin(), recorder.calls.end(), "release 0"), recorder.calls.end());
+}
+
+TEST_F(ScratchBufferSchedulerTest, KeepsSeparatePoolPerFrame)
+{
+    const uint64_t frame0Address = build(256);
+    scheduler.beginFrame(1);
+    const uint64_t frame1Address = build(256);
+
+    EXPECT_NE(frame0Address, frame1Address);
+    EXPECT_EQ(recorder.pools.size(), 2u);
+
+    // Frame 0 keeps using its pool once it comes around again.
+    scheduler.beginFrame(0);
+    EXPECT_EQ(build(256), frame0Address);
+    EXPECT_EQ(recorder.pools.size(), 2u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, GrowsPoolAfterDemandPeak)
+{
+    for (uint32_t i = 0; i < 20; i++)
+        build(256);
+
+    EXPECT_EQ(scheduler.getBatchCount(), 4u);
+
+    // 5120 bytes of demand round up to 5120.
+    scheduler.beginFrame(1);
+    EXPECT_EQ(scheduler.getPoolByteSize(), 5120u);
+    EXPECT_EQ(scheduler.getPeak(), 5120u);
+
+    recorder.calls.clear();
+    for (uint32_t i = 0; i < 20; i++)
+        build(256);
+
+    EXPECT_EQ(scheduler.getBatchCount(), 0u);
+    EXPECT_EQ(std::count(recorder.calls.begin(), recorder.calls.end(), "build"), 20);
+}
+
+TEST_F(ScratchBufferSchedulerTest, ClampsPoolToMaximum)
+{
+    for (uint32_t i = 0; i < 100; i++)
+        build(1024);
+
+    scheduler.beginFrame(1);
+    EXPECT_EQ(scheduler.getPoolByteSize(), 8192u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, ShrinksLazilyAfterPeakDecays)
+{
+    for (uint32_t i = 0; i < 8; i++)
+        build(1024);
+
+    const size_t poolCount = recorder.pools.size();
+    uint32_t frame = 1;
+
+    // Both frames grow to 8192 and then recreate a pool only once the peak falls under half of it.
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        scheduler.beginFrame(frame);
+        frame ^= 1;
+    }
+
+    EXPECT_EQ(scheduler.getPoolByteSize(), 1024u);
+    EXPECT_LE(recorder.pools.size() - poolCount, 2u * 4u);
+}
+
+TEST_F(ScratchBufferSchedulerTest, RandomBuildsNeverShareMemoryWithinBatch)
+{
+    std::mt19937 random(0x5C4A);
+    uint32_t frame = 0;
+    uint32_t barrierCount = 0;
+
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        const uint32_t buildCount = random() % 32;
+        for (uint32_t j = 0; j < buildCount; j++)
+            build(1 + random() % (random() % 8 == 0 ? 10000 : 1500));
+
+        barrierCount += scheduler.getBatchCount();
+        ASSERT_LE(scheduler.getOffset(), scheduler.getPoolByteSize());
+
+        frame ^= 1;
+        scheduler.beginFrame(frame);
+
+        ASSERT_GE(scheduler.getPoolByteSize(), 1024u);
+        ASSERT_LE(scheduler.getPoolByteSize(), 8192u);
+    }
+
+    EXPECT_EQ(static_cast<uint32_t>(std::count_if(recorder.calls.begin(), recorder.calls.end(),
+        [](const std::string& call) { return call.compare(0, 7, "barrier") == 0; })), barrierCount);
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "SegmentRecorder.h"
+
+namespace
+{
+    struct Segment
+    {
+        uint32_t index = 0;
+        std::atomic<bool>* release = nullptr;
+        std::atomic<uint32_t>* recordCount = nullptr;
+        std::thread::id recordThread;
+
+        void record()
+        {
+            if (release != nullptr)
+            {
+                while (!release->load())
+                    std::this_thread::yield();
+            }
+
+            recordThread = std::this_thread::get_id();
+            if (recordCount != nullptr)
+                ++*recordCount;
+        }
+    };
+
+    std::vector<uint32_t> submitAll(SegmentRecorder<Segment>& recorder)
+    {
+        std::vector<uint32_t> indices;
+        recorder.submit([&](Segment& segment) { indices.push_back(segment.index); });
+        return indices;
+    }
+}
+
+TEST(SegmentRecorderTest, RecordsInlineWithoutThreads)
+{
+    SegmentRecorder<Segment> recorder(0);
+
+    std::vector<Segment> segments(3);
+    for (uint32_t i = 0; i < segments.size(); i++)
+    {
+        segments[i].index = i;
+        recorder.push(segments[i]);
+        EXPECT_EQ(segments[i].recordThread, std::this_thread::get_id());
+    }
+
+    EXPECT_FALSE(recorder.isEmpty());
+    EXPECT_EQ(submitAll(recorder), (std::vector<uint32_t>{ 0, 1, 2 }));
+    EXPECT_TRUE(recorder.isEmpty());
+}
+
+TEST(SegmentRecorderTest, SubmitsInPushOrder)
+{
+    SegmentRecorder<Segment> recorder(4);
+
+    // The first segment is held back, so every later one finishes recording first.
+    std::atomic<bool> release = false;
+    std::atomic<uint32_t> recordCount = 0;
+
+    std::vector<Segment> segments(4);
+    for (uint32_t i = 0; i < segments.size(); i++)
+    {
+        segments[i].index = i;
+        segments[i].release = i == 0 ? &release : nullptr;
+        segments[i].recordCount = &recordCount;
+        recorder.push(segments[i]);
+    }
+
+    while (recordCount.load() < segments.size() - 1)
+        std::this_thread::yield();
+
+    std::thread releaser([&]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        release = true;
+    });
+
+    EXPECT_EQ(submitAll(recorder), (std::vector<uint32_t>{ 0, 1, 2, 3 }));
+    releaser.join();
+
+    for (const auto& segment : segments)
+        EXPECT_NE(segment.recordThread, std::this_thread::get_id());
+}
+
+TEST(SegmentRecorderTest, ReusesSegmentsAcrossSubmits)
+{
+    SegmentRecorder<Segment> recorder(2);
+    std::atomic<uint32_t> recordCount = 0;
+
+    std::vector<Segment> segments(3);
+    for (uint32_t i = 0; i < segments.size(); i++)
+    {
+        segments[i].index = i;
+        segments[i].recordCount = &recordCount;
+    }
+
+    std::vector<uint32_t> indices;
+    for (uint32_t frame = 0; frame < 100; frame++)
+    {
+        for (auto& segment : segments)
+            recorder.push(segment);
+
+        recorder.submit([&](Segment& segment) { indices.push_back(segment.index); });
+    }
+
+    EXPECT_EQ(recordCount.load(), 300u);
+    ASSERT_EQ(indices.size(), 300u);
+
+    for (size_t i = 0; i < indices.size(); i++)
+        EXPECT_EQ(indices[i], i % 3);
+}
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "ShaderCacheIndex.h"
+
+namespace
+{
+    // Shaders are stored uncompressed, the index doesn't care about the contents.
+    struct TestShader
+    {
+        uint64_t hash;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<TestShader> makeShaders(uint32_t count, uint32_t seed)
+    {
+        std::mt19937_64 random(seed);
+        std::vector<TestShader> shaders(count);
+
+        for (auto& shader : shaders)
+        {
+            shader.hash = random();
+            shader.data.resize(1 + random() % 2048);
+
+            for (auto& value : shader.data)
+                value = static_cast<uint8_t>(random());
+        }
+
+        return shaders;
+    }
+
+    std::vector<uint8_t> writeFile(const std::vector<TestShader>& testShaders)
+    {
+        std::vector<CompressedShader> shaders;
+        for (const auto& shader : testShaders)
+        {
+            const uint32_t dataSize = static_cast<uint32_t>(shader.data.size());
+            shaders.push_back({ shader.hash, shader.data.data(), dataSize, dataSize });
+        }
+
+        FILE* file = tmpfile();
+        EXPECT_NE(file, nullptr);
+        EXPECT_TRUE(ShaderCacheIndex::write(file, shaders));
+
+        std::vector<uint8_t> data(static_cast<size_t>(ftell(file)));
+        fseek(file, 0, SEEK_SET);
+        EXPECT_EQ(fread(data.data(), 1, data.size(), file), data.size());
+        fclose(file);
+
+        return data;
+    }
+
+    std::vector<uint8_t> getData(const ShaderCacheIndex& index, uint64_t hash)
+    {
+        const ShaderCacheEntry* entry = index.find(hash);
+        if (entry == nullptr)
+            return {};
+
+        EXPECT_EQ(entry->compressedSize, entry->uncompressedSize);
+
+        const uint8_t* data = index.getCompressedData(*entry);
+        return std::vector<uint8_t>(data, data + entry->compressedSize);
+    }
+
+    void appendBlockShader(std::vector<uint8_t>& block, uint64_t hash, const std::vector<uint8_t>& data)
+    {
+        const ShaderCacheBlockShader header{ hash, static_cast<uint32_t>(data.size()) };
+        const size_t offset = block.size();
+
+        block.resize(offset + sizeof(ShaderCacheBlockShader) + data.size());
+        memcpy(block.data() + offset, &header, sizeof(ShaderCacheBlockShader));
+        memcpy(block.data() + offset + sizeof(ShaderCacheBlockShader), data.data(), data.size());
+    }
+}
+
+TEST(ShaderCacheIndex, FindsEveryShaderItWrote)
+{
+    const auto shaders = makeShaders(1000, 1);
+    const auto file = writeFile(shaders);
+
+    ShaderCacheIndex index;
+    ASSERT_TRUE(index.open(file.data(), file.size()));
+    EXPECT_EQ(index.getEntryCount(), 1000u);
+
+    for (const auto& shader : shaders)
+        EXPECT_EQ(getData(index, shader.hash), shader.data);
+
+    std::mt19937_64 random(2);
+    for (uint32_t i = 0; i < 1000; i++)
+        EXPECT_EQ(index.find(random()), nullptr);
+}
+
+TEST(ShaderCacheIndex, EntriesAreSortedByHash)
+{
+    const auto file = writeFile(makeShaders(100, 3));
+
+    std::vector<ShaderCacheEntry> entries(100);
+    memcpy(entries.data(), file.data() + sizeof(ShaderCacheFileHeader), entries.size() * sizeof(ShaderCacheEntry));
+
+    EXPECT_TRUE(std::is_sorted(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) { return lhs.hash < rhs.hash; }));
+}
+
+TEST(ShaderCacheIndex, KeepsFirstShaderOfDuplicateHashes)
+{
+    auto shaders = makeShaders(10, 4);
+    shaders.push_back({ shaders[3].hash, { 1, 2, 3 } });
+    shaders.insert(shaders.begin(), { shaders[5].hash, { 4, 5, 6 } });
+
+    const auto file = writeFile(shaders);
+
+    ShaderCacheIndex index;
+    ASSERT_TRUE(index.open(file.data(), file.size()));
+    EXPECT_EQ(index.getEntryCount(), 10u);
+    EXPECT_EQ(getData(index, shaders[4].hash), shaders[4].data);
+    EXPECT_EQ(getData(index, shaders[0].hash), (std::vector<uint8_t>{ 4, 5, 6 }));
+}
+
+TEST(ShaderCacheIndex, OpensEmptyFile)
+{
+    const auto file = writeFile({});
+
+    ShaderCacheIndex index;
+    ASSERT_TRUE(index.open(file.data(), file.size()));
+    EXPECT_EQ(index.getEntryCount(), 0u);
+    EXPECT_EQ(index.find(0), nullptr);
+}
+
+TEST(ShaderCacheIndex, RejectsOtherFiles)
+{
+    const auto file = writeFile(makeShaders(10, 5));
+    ShaderCacheIndex index;
+
+    // A block of the previous format starts with its version.
+    std::vector<uint8_t> legacyFile(64);
+    const ShaderCacheBlockHeader blockHeader{ 1, 32, 32 };
+    memcpy(legacyFile.data(), &blockHeader, sizeof(ShaderCacheBlockHeader));
+    EXPECT_FALSE(index.open(legacyFile.data(), legacyFile.size()));
+
+    auto otherVersion = file;
+    otherVersion[offsetof(ShaderCacheFileHeader, version)] = SHADER_CACHE_VERSION + 1;
+    EXPECT_FALSE(index.open(otherVersion.data(), otherVersion.size()));
+
+    EXPECT_FALSE(index.open(file.data(), sizeof(ShaderCacheFileHeader) - 1));
+    EXPECT_FALSE(index.open(file.data(), sizeof(ShaderCacheFileHeader) + 10 * sizeof(ShaderCacheEntry) - 1));
+    EXPECT_FALSE(index.isOpen());
+
+    EXPECT_TRUE(index.open(file.data(), sizeof(ShaderCacheFileHeader) + 10 * sizeof(ShaderCacheEntry)));
+}
+
+TEST(ShaderCacheIndex, TruncatedShadersAreNotFound)
+{
+    const auto shaders = makeShaders(100, 6);
+    const auto file = writeFile(shaders);
+    const size_t truncatedSize = file.size() - file.size() / 4;
+
+    ShaderCacheIndex index;
+    ASSERT_TRUE(index.open(file.data(), truncatedSize));
+
+    uint32_t foundCount = 0;
+    for (const auto& shader : shaders)
+    {
+        const ShaderCacheEntry* entry = index.find(shader.hash);
+        if (entry != nullptr)
+        {
+            EXPECT_LE(entry->offset + entry->compressedSize, truncatedSize);
+            EXPECT_EQ(getData(index, shader.hash), shader.data);
+            ++foundCount;
+        }
+    }
+
+    EXPECT_GT(foundCount, 0u);
+    EXPECT_LT(foundCount, 100u);
+
+    std::vector<CompressedShader> validShaders;
+    index.getShaders(validShaders);
+    EXPECT_EQ(validShaders.size(), foundCount);
+}
+
+TEST(ShaderCacheIndex, RewritingKeepsExistingShaders)
+{
+    const auto shaders = makeShaders(200, 7);
+    const auto newShaders = makeShaders(50, 8);
+    const auto file = writeFile(shaders);
+
+    ShaderCacheIndex index;
+    ASSERT_TRUE(index.open(file.data(), file.size()));
+
+    std::vector<CompressedShader> compressedShaders;
+    index.getShaders(compressedShaders);
+
+    for (const auto& shader : newShaders)
+    {
+        const uint32_t dataSize = static_cast<uint32_t>(shader.data.size());
+        compressedShaders.push_back({ shader.hash, shader.data.data(), dataSize, dataSize });
+    }
+
+    FILE* rewrittenFile = tmpfile();
+    ASSERT_TRUE(ShaderCacheIndex::write(rewrittenFile, compressedShaders));
+
+    std::vector<uint8_t> rewritten(static_cast<size_t>(ftell(rewrittenFile)));
+    fseek(rewrittenFile, 0, SEEK_SET);
+    ASSERT_EQ(fread(rewritten.data(), 1, rewritten.size(), rewrittenFile), rewritten.size());
+    fclose(rewrittenFile);
+
+    ShaderCacheIndex rewrittenIndex;
+    ASSERT_TRUE(rewrittenIndex.open(rewritten.data(), rewritten.size()));
+    EXPECT_EQ(rewrittenIndex.getEntryCount(), 250u);
+
+    for (const auto& shader : shaders)
+        EXPECT_EQ(getData(rewrittenIndex, shader.hash), shader.data);
+
+    for (const auto& shader : newShaders)
+        EXPECT_EQ(getData(rewrittenIndex, shader.hash), shader.data);
+}
+
+TEST(ShaderCacheIndex, ReadsBlocksOfPreviousFormat)
+{
+    const auto shaders = makeShaders(20, 9);
+
+    std::vector<uint8_t> block;
+    for (const auto& shader : shaders)
+        appendBlockShader(block, shader.hash, shader.data);
+
+    std::vector<TestShader> readShaders;
+    EXPECT_TRUE(ShaderCacheIndex::forEachBlockShader(block.data(), static_cast<uint32_t>(block.size()),
+        [&](uint64_t hash, const uint8_t* data, uint32_t dataSize)
+        {
+            readShaders.push_back({ hash, std::vector<uint8_t>(data, data + dataSize) });
+        }));
+
+    ASSERT_EQ(readShaders.size(), shaders.size());
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        EXPECT_EQ(readShaders[i].hash, shaders[i].hash);
+        EXPECT_EQ(readShaders[i].data, shaders[i].data);
+    }
+}
+
+TEST(ShaderCacheIndex, RejectsTruncatedBlocksOfPreviousFormat)
+{
+    std::vector<uint8_t> block;
+    appendBlockShader(block, 1, { 1, 2, 3 });
+    appendBlockShader(block, 2, { 4, 5, 6, 7 });
+
+    const size_t firstShaderSize = sizeof(ShaderCacheBlockShader) + 3;
+
+    for (size_t size = 1; size < block.size(); size++)
+    {
+        if (size == firstShaderSize)
+            continue;
+
+        uint32_t callCount = 0;
+        EXPECT_FALSE(ShaderCacheIndex::forEachBlockShader(block.data(), static_cast<uint32_t>(size),
+            [&](uint64_t, const uint8_t*, uint32_t) { ++callCount; })) << size;
+
+        EXPECT_EQ(callCount, 0u);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "ShaderConversionService.h"
+
+namespace
+{
+    // Converts a shader into a copy of its bytes with every byte incremented. Shaders starting with 0xFF fail
+    // to convert. Logs the calls, and can hold the worker threads back to check what happens while converting.
+    class MockShaderConversionBackend final : public ShaderConversionBackend
+    {
+    public:
+        std::unordered_map<uint64_t, std::vector<uint8_t>> cachedShaders;
+        std::vector<uint64_t> cacheLookups;
+        uint32_t loadCount = 0;
+
+        std::mutex mutex;
+        std::vector<std::vector<uint8_t>> conversions;
+        std::atomic<bool> blocked = false;
+        std::atomic<uint32_t> liveHandleCount = 0;
+
+        const uint8_t* findCachedShader(uint64_t hash, uint32_t& dataSize) override
+        {
+            cacheLookups.push_back(hash);
+
+            const auto findResult = cachedShaders.find(hash);
+            if (findResult == cachedShaders.end())
+                return nullptr;
+
+            dataSize = static_cast<uint32_t>(findResult->second.size());
+            return findResult->second.data();
+        }
+
+        void loadConverter() override
+        {
+            ++loadCount;
+        }
+
+        void* convertShader(const void* data, uint32_t dataSize, uint32_t& convertedSize) override
+        {
+            while (blocked)
+                std::this_thread::yield();
+
+            const auto bytes = static_cast<const uint8_t*>(data);
+            {
+                std::lock_guard lock(mutex);
+                conversions.emplace_back(bytes, bytes + dataSize);
+            }
+
+            if (bytes[0] == 0xFF)
+                return nullptr;
+
+            auto converted = new std::vector<uint8_t>(bytes, bytes + dataSize);
+            for (auto& value : *converted)
+                ++value;
+
+            convertedSize = dataSize;
+            ++liveHandleCount;
+            return converted;
+        }
+
+        const uint8_t* getConvertedData(void* handle) override
+        {
+            return static_cast<std::vector<uint8_t>*>(handle)->data();
+        }
+
+        void freeConvertedShader(void* handle) override
+        {
+            delete static_cast<std::vector<uint8_t>*>(handle);
+            --liveHandleCount;
+        }
+    };
+
+    // Device skips a draw call unless both of its shaders are available.
+    bool canDraw(ShaderConversionService& service, uint64_t vertexShaderHash, uint64_t pixelShaderHash)
+    {
+        uint32_t dataSize;
+        return service.getConvertedShader(vertexShaderHash, dataSize) != nullptr &&
+            service.getConvertedShader(pixelShaderHash, dataSize) != nullptr;
+    }
+
+    struct ShaderConversionServiceTest : testing::Test
+    {
+        MockShaderConversionBackend backend;
+        std::unique_ptr<ShaderConversionService> service = std::make_unique<ShaderConversionService>(backend, 0);
+
+        const uint8_t* getShader(uint64_t hash, std::vector<uint8_t> data, bool async = true)
+        {
+            uint32_t convertedSize = 0;
+            const uint8_t* result = service->getShader(hash, data.data(), static_cast<uint32_t>(data.size()), convertedSize, async);
+
+            // The message memory gets reused right after.
+            std::fill(data.begin(), data.end(), 0xCD);
+
+            if (result != nullptr)
+            {
+                EXPECT_EQ(convertedSize, data.size());
+            }
+
+            return result;
+        }
+
+        void convertAll()
+        {
+            while (service->convertNext())
+                ;
+        }
+    };
+}
+
+TEST_F(ShaderConversionServiceTest, CachedShadersAreNotConverted)
+{
+    backend.cachedShaders[1] = { 10, 20, 30 };
+
+    EXPECT_EQ(getShader(1, { 1, 2, 3 }), backend.cachedShaders[1].data());
+    EXPECT_EQ(backend.loadCount, 0u);
+    EXPECT_FALSE(service->convertNext());
+
+    // Looked up only once.
+    EXPECT_EQ(getShader(1, { 1, 2, 3 }), backend.cachedShaders[1].data());
+    EXPECT_EQ(backend.cacheLookups.size(), 1u);
+}
+
+TEST_F(ShaderConversionServiceTest, MissesAreConvertedInTheBackground)
+{
+    EXPECT_EQ(getShader(1, { 1, 2, 3 }), nullptr);
+    EXPECT_EQ(backend.loadCount, 1u);
+    EXPECT_EQ(service->getPendingCount(), 1u);
+
+    uint32_t dataSize;
+    EXPECT_EQ(service->getConvertedShader(1, dataSize), nullptr);
+
+    EXPECT_TRUE(service->convertNext());
+    EXPECT_EQ(service->getPendingCount(), 0u);
+
+    const uint8_t* data = service->getConvertedShader(1, dataSize);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(std::vector<uint8_t>(data, data + dataSize), (std::vector<uint8_t>{ 2, 3, 4 }));
+}
+
+TEST_F(ShaderConversionServiceTest, DuplicateRequestsAreConvertedOnce)
+{
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        getShader(1, { 1, 2, 3 });
+        getShader(2, { 4, 5, 6 });
+    }
+
+    EXPECT_EQ(service->getPendingCount(), 2u);
+    convertAll();
+
+    EXPECT_EQ(backend.conversions.size(), 2u);
+    EXPECT_EQ(backend.loadCount, 1u);
+
+    // Created again after the conversion finished.
+    EXPECT_NE(getShader(1, { 1, 2, 3 }), nullptr);
+    EXPECT_FALSE(service->convertNext());
+    EXPECT_EQ(service->getConvertedShaders().size(), 2u);
+}
+
+TEST_F(ShaderConversionServiceTest, DrawsAreSkippedUntilBothShadersAreReady)
+{
+    getShader(1, { 1 });
+    getShader(2, { 2 });
+    EXPECT_FALSE(canDraw(*service, 1, 2));
+
+    service->convertNext();
+    EXPECT_FALSE(canDraw(*service, 1, 2));
+
+    service->convertNext();
+    EXPECT_TRUE(canDraw(*service, 1, 2));
+
+    // Shaders never created can't be drawn with either.
+    EXPECT_FALSE(canDraw(*service, 1, 3));
+}
+
+TEST_F(ShaderConversionServiceTest, SynchronousMissesAreConvertedImmediately)
+{
+    const uint8_t* data = getShader(1, { 1, 2, 3 }, false);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(data[0], 2);
+    EXPECT_EQ(service->getPendingCount(), 0u);
+    EXPECT_FALSE(service->convertNext());
+    EXPECT_EQ(service->getConvertedShaders().size(), 1u);
+}
+
+TEST_F(ShaderConversionServiceTest, FailedConversionsAreNotRetried)
+{
+    EXPECT_EQ(getShader(1, { 0xFF, 1 }), nullptr);
+    convertAll();
+
+    EXPECT_FALSE(canDraw(*service, 1, 1));
+    EXPECT_EQ(getShader(1, { 0xFF, 1 }), nullptr);
+    EXPECT_EQ(getShader(1, { 0xFF, 1 }, false), nullptr);
+
+    EXPECT_FALSE(service->convertNext());
+    EXPECT_EQ(backend.conversions.size(), 1u);
+    EXPECT_TRUE(service->getConvertedShaders().empty());
+}
+
+TEST_F(ShaderConversionServiceTest, ConvertsTheCopiedBytecode)
+{
+    getShader(1, { 1, 2, 3 });
+    convertAll();
+
+    EXPECT_EQ(backend.conversions[0], (std::vector<uint8_t>{ 1, 2, 3 }));
+}
+
+TEST_F(ShaderConversionServiceTest, ConvertedShadersFollowCompletionOrder)
+{
+    getShader(3, { 3 });
+    getShader(1, { 1 });
+    getShader(2, { 2 }, false);
+    convertAll();
+
+    const auto& convertedShaders = service->getConvertedShaders();
+    ASSERT_EQ(convertedShaders.size(), 3u);
+    EXPECT_EQ(convertedShaders[0].hash, 2u);
+    EXPECT_EQ(convertedShaders[1].hash, 3u);
+    EXPECT_EQ(convertedShaders[2].hash, 1u);
+}
+
+TEST_F(ShaderConversionServiceTest, DestroyingFreesEveryHandle)
+{
+    getShader(1, { 1 });
+    getShader(2, { 2 });
+    getShader(3, { 3 }, false);
+    service->convertNext();
+
+    // One converted but never collected, one still queued.
+    service.reset();
+    EXPECT_EQ(backend.liveHandleCount, 0u);
+}
+
+TEST(ShaderConversionServiceThreadTest, WorkersConvertEveryShaderOnce)
+{
+    MockShaderConversionBackend backend;
+    backend.blocked = true;
+
+    {
+        ShaderConversionService service(backend, 4);
+
+        // The game creates the same shaders repeatedly while the first conversions are held back.
+        for (uint32_t i = 0; i < 400; i++)
+        {
+            const uint8_t data[] = { static_cast<uint8_t>(i % 100), 1 };
+            uint32_t convertedSize;
+            EXPECT_EQ(service.getShader(i % 100, data, sizeof(data), convertedSize, true), nullptr);
+        }
+
+        EXPECT_EQ(service.getPendingCount(), 100u);
+        backend.blocked = false;
+
+        while (service.getPendingCount() != 0)
+            std::this_thread::yield();
+
+        for (uint64_t i = 0; i < 100; i++)
+            EXPECT_TRUE(canDraw(service, i, (i + 1) % 100));
+
+        EXPECT_EQ(service.getConvertedShaders().size(), 100u);
+    }
+
+    EXPECT_EQ(backend.conversions.size(), 100u);
+    EXPECT_EQ(backend.liveHandleCount, 0u);
+}
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "CpuVirtualBlock.h"
+#include "SubAllocatorPolicy.h"
+
+namespace
+{
+    constexpr uint32_t s_blockSize = 64 * 1024;
+    constexpr uint32_t s_alignment = 256;
+
+    using Policy = SubAllocatorPolicy<CpuVirtualBlock>;
+    using Allocation = Policy::Allocation;
+
+    struct SubAllocatorPolicyTest : testing::Test
+    {
+        Policy policy{ s_blockSize, s_alignment };
+        uint32_t createdBlockCount = 0;
+
+        Allocation allocate(uint32_t byteSize)
+        {
+            bool createdBlock = false;
+            const auto allocation = policy.allocate(byteSize, createdBlock);
+
+            EXPECT_NE(allocation.handle, 0u);
+            EXPECT_EQ(allocation.byteOffset % s_alignment, 0u);
+            EXPECT_LE(allocation.byteOffset + byteSize, s_blockSize);
+
+            if (createdBlock)
+                ++createdBlockCount;
+
+            return allocation;
+        }
+
+        std::vector<uint32_t> freeBlocks()
+        {
+            std::vector<uint32_t> blockIndices;
+            policy.freeBlocks([&](uint32_t blockIndex) { blockIndices.push_back(blockIndex); });
+            return blockIndices;
+        }
+    };
+}
+
+TEST(CpuVirtualBlock, AllocatesFirstFitAndMergesOnFree)
+{
+    CpuVirtualBlock block;
+    block.create(1024);
+
+    uint64_t handles[4]{};
+    uint32_t offsets[4]{};
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(block.allocate(256, 256, handles[i], offsets[i]));
+        EXPECT_EQ(offsets[i], i * 256);
+    }
+
+    uint64_t handle;
+    uint32_t offset;
+    EXPECT_FALSE(block.allocate(1, 1, handle, offset));
+
+    // Freeing two neighbors makes room for something twice as large.
+    block.free(handles[1]);
+    block.free(handles[2]);
+    ASSERT_TRUE(block.allocate(512, 256, handle, offset));
+    EXPECT_EQ(offset, 256u);
+
+    block.free(handle);
+    block.free(handles[0]);
+    block.free(handles[3]);
+    EXPECT_TRUE(block.isEmpty());
+
+    ASSERT_TRUE(block.allocate(1024, 256, handle, offset));
+    EXPECT_EQ(offset, 0u);
+}
+
+TEST(CpuVirtualBlock, KeepsAlignmentPaddingFree)
+{
+    CpuVirtualBlock block;
+    block.create(1024);
+
+    uint64_t handles[3];
+    uint32_t offsets[3];
+
+    ASSERT_TRUE(block.allocate(100, 1, handles[0], offsets[0]));
+    ASSERT_TRUE(block.allocate(100, 256, handles[1], offsets[1]));
+    EXPECT_EQ(offsets[1], 256u);
+
+    // Fits into the padding left by the aligned allocation.
+    ASSERT_TRUE(block.allocate(100, 4, handles[2], offsets[2]));
+    EXPECT_EQ(offsets[2], 100u);
+}
+
+TEST_F(SubAllocatorPolicyTest, LargeAllocationsAreDedicated)
+{
+    EXPECT_FALSE(policy.isDedicated(s_blockSize / 2 - 1));
+    EXPECT_TRUE(policy.isDedicated(s_blockSize / 2));
+}
+
+TEST_F(SubAllocatorPolicyTest, SegregatesSizeClasses)
+{
+    const auto small = allocate(256);
+    const auto medium = allocate(s_blockSize / 16);
+    const auto large = allocate(s_blockSize / 4);
+
+    EXPECT_EQ(createdBlockCount, 3u);
+    EXPECT_NE(small.blockIndex, medium.blockIndex);
+    EXPECT_NE(medium.blockIndex, large.blockIndex);
+
+    for (uint32_t sizeClass = 0; sizeClass < SIZE_CLASS_NUM; sizeClass++)
+        EXPECT_EQ(policy.getFreeBlockCount(sizeClass), 1u);
+
+    // More of the same size class share the block.
+    EXPECT_EQ(allocate(512).blockIndex, small.blockIndex);
+    EXPECT_EQ(createdBlockCount, 3u);
+}
+
+TEST_F(SubAllocatorPolicyTest, FullBlocksLeaveIndexUntilFreedFrom)
+{
+    const uint32_t byteSize = s_blockSize / 8;
+    std::vector<Allocation> allocations;
+
+    for (uint32_t i = 0; i < 8; i++)
+        allocations.push_back(allocate(byteSize));
+
+    EXPECT_EQ(createdBlockCount, 1u);
+
+    // The full block gets dropped from the index when it fails to fit the next one.
+    allocations.push_back(allocate(byteSize));
+    EXPECT_EQ(createdBlockCount, 2u);
+    EXPECT_EQ(policy.getFreeBlockCount(2), 1u);
+
+    policy.free(allocations[3]);
+    EXPECT_EQ(policy.getFreeBlockCount(2), 2u);
+
+    // Newest free block is tried first, it still has room.
+    EXPECT_EQ(allocate(byteSize).blockIndex, allocations[3].blockIndex);
+}
+
+TEST_F(SubAllocatorPolicyTest, FreesEmptyBlocksAndReusesTheirSlots)
+{
+    const auto first = allocate(256);
+    const auto second = allocate(s_blockSize / 16);
+    const auto third = allocate(s_blockSize / 4);
+
+    policy.free(second);
+    EXPECT_EQ(freeBlocks(), std::vector<uint32_t>({ second.blockIndex }));
+    EXPECT_FALSE(policy.isBlockCreated(second.blockIndex));
+    EXPECT_EQ(policy.getFreeBlockCount(1), 0u);
+
+    // The hole gets filled before growing.
+    EXPECT_EQ(allocate(s_blockSize / 16).blockIndex, second.blockIndex);
+    EXPECT_EQ(policy.getBlockCount(), 3u);
+
+    policy.free(third);
+    EXPECT_EQ(freeBlocks(), std::vector<uint32_t>({ third.blockIndex }));
+    EXPECT_EQ(policy.getBlockCount(), 2u);
+
+    policy.free(first);
+    EXPECT_EQ(freeBlocks(), std::vector<uint32_t>({ first.blockIndex }));
+}
+
+TEST_F(SubAllocatorPolicyTest, PicksSparseBlockForDefragmentation)
+{
+    const uint32_t byteSize = s_blockSize / 8;
+    std::vector<Allocation> allocations;
+
+    // Three large blocks, the middle one nearly empty afterwards.
+    for (uint32_t i = 0; i < 24; i++)
+        allocations.push_back(allocate(byteSize));
+
+    ASSERT_EQ(createdBlockCount, 3u);
+
+    for (auto& allocation : allocations)
+    {
+        if (allocation.blockIndex == 1 && allocation.byteOffset != 0)
+        {
+            policy.free(allocation);
+            allocation = {};
+        }
+    }
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        for (auto& allocation : allocations)
+        {
+            if (allocation.blockIndex != 1 && allocation.handle != 0)
+            {
+                policy.free(allocation);
+                allocation = {};
+                break;
+            }
+        }
+    }
+
+    EXPECT_EQ(policy.getDefragmentationBlockIndex(), 1u);
+
+    // No new allocations go to it while it is being emptied.
+    for (uint32_t i = 0; i < 4; i++)
+        EXPECT_NE(allocate(byteSize).blockIndex, 1u);
+
+    // Moving the last allocation out lets the block get freed.
+    for (auto& allocation : allocations)
+    {
+        if (allocation.blockIndex == 1 && allocation.handle != 0)
+            policy.free(allocation);
+    }
+
+    EXPECT_EQ(freeBlocks(), std::vector<uint32_t>({ 1u }));
+}
+
+TEST_F(SubAllocatorPolicyTest, GivesUpOnStuckDefragmentation)
+{
+    const uint32_t byteSize = s_blockSize / 8;
+    std::vector<Allocation> allocations;
+
+    for (uint32_t i = 0; i < 24; i++)
+        allocations.push_back(allocate(byteSize));
+
+    // Leave room for the remaining allocation of block 2 elsewhere, which then never gets moved.
+    for (const auto& allocation : allocations)
+    {
+        if ((allocation.blockIndex == 2 && allocation.byteOffset != 0) || (allocation.blockIndex == 0 && allocation.byteOffset < byteSize * 2))
+            policy.free(allocation);
+    }
+
+    ASSERT_EQ(policy.getDefragmentationBlockIndex(), 2u);
+
+    for (uint32_t i = 0; i < MAX_DEFRAGMENTATION_FRAMES; i++)
+        EXPECT_EQ(policy.getDefragmentationBlockIndex(), 2u);
+
+    // The attempt times out and a new one starts over.
+    EXPECT_EQ(policy.getDefragmentationBlockIndex(), 2u);
+    EXPECT_GE(policy.getFreeBlockCount(2), 1u);
+}
+
+TEST_F(SubAllocatorPolicyTest, DoesNotDefragmentWithoutRoomElsewhere)
+{
+    allocate(256);
+    EXPECT_EQ(policy.getDefragmentationBlockIndex(), ~0u);
+}
+
+TEST_F(SubAllocatorPolicyTest, RandomChurnKeepsBookkeepingConsistent)
+{
+    std::mt19937 random(0x5AB);
+    std::vector<Allocation> allocations;
+
+    for (uint32_t frame = 0; frame < 300; frame++)
+    {
+        for (uint32_t i = random() % 64; i != 0; i--)
+        {
+            if (!allocations.empty() && random() % 2 == 0)
+            {
+                const size_t index = random() % allocations.size();
+                policy.free(allocations[index]);
+                allocations[index] = allocations.back();
+                allocations.pop_back();
+            }
+            else
+            {
+                const uint32_t sizes[] = { 256, 1024, s_blockSize / 32, s_blockSize / 10, s_blockSize / 3 };
+                allocations.push_back(allocate(sizes[random() % std::size(sizes)] - random() % 200));
+            }
+        }
+
+        // Relocate everything out of the block being defragmented, like the device does.
+        const uint32_t defragmentationBlockIndex = policy.getDefragmentationBlockIndex();
+        if (defragmentationBlockIndex != ~0u)
+        {
+            for (auto& allocation : allocations)
+            {
+                if (allocation.blockIndex == defragmentationBlockIndex)
+                {
+                    const auto relocated = allocate(allocation.byteSize);
+                    ASSERT_NE(relocated.blockIndex, defragmentationBlockIndex);
+                    policy.free(allocation);
+                    allocation = relocated;
+                }
+            }
+        }
+
+        freeBlocks();
+
+        // Used sizes match the live allocations, which never overlap.
+        std::vector<uint32_t> usedSizes(policy.getBlockCount());
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> ranges;
+
+        for (const auto& allocation : allocations)
+        {
+            ASSERT_TRUE(policy.isBlockCreated(allocation.blockIndex));
+            usedSizes[allocation.blockIndex] += allocation.byteSize;
+
+            const auto it = ranges.emplace(std::make_pair(allocation.blockIndex, allocation.byteOffset), allocation.byteSize).first;
+            if (it != ranges.begin())
+            {
+                const auto prev = std::prev(it);
+                if (prev->first.first == allocation.blockIndex)
+                {
+                    ASSERT_LE(prev->first.second + prev->second, allocation.byteOffset);
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < policy.getBlockCount(); i++)
+        {
+            if (policy.isBlockCreated(i))
+            {
+                ASSERT_EQ(policy.getUsedSize(i), usedSizes[i]);
+                ASSERT_FALSE(policy.getVirtualBlock(i).isEmpty());
+            }
+        }
+    }
+}
\ No newline at end of file
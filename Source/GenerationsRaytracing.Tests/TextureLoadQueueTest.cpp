@@ -0,0 +1,287 @@
+#include "TextureLoadQueue.h"
+
+namespace
+{
+    struct MockTexture
+    {
+        bool parsed = false;
+        uint32_t format = 0;
+        uint32_t subresourceCount = 0;
+        uint8_t firstPixel = 0;
+        std::string name;
+    };
+
+    // Records what the layout looked like. Textures named "slow" wait until they get unblocked.
+    class MockTextureLoadBackend final : public TextureLoadBackend<MockTexture>
+    {
+    public:
+        std::atomic<bool> blocked = false;
+        std::atomic<uint32_t> slowCount = 0;
+
+        MockTexture loadTexture(const DdsLayout* layout, const uint8_t* data, size_t /*dataSize*/, const char* name) override
+        {
+            MockTexture texture;
+            texture.name = name;
+
+            if (texture.name == "slow")
+            {
+                ++slowCount;
+                while (blocked)
+                    std::this_thread::yield();
+            }
+
+            if (layout != nullptr)
+            {
+                texture.parsed = true;
+                texture.format = layout->getFormat();
+                texture.subresourceCount = static_cast<uint32_t>(layout->getSubresources().size());
+                texture.firstPixel = data[layout->getHeaderSize()];
+            }
+
+            return texture;
+        }
+    };
+
+    // RGBA8 texture with a DX10 header, every pixel byte set to the given value.
+    std::vector<uint8_t> makeDds(uint32_t width, uint32_t height, uint32_t mipLevels, uint8_t value, uint32_t depth = 0)
+    {
+        std::vector<uint8_t> data(DdsLayout::s_maxHeaderSize);
+
+        const auto write = [&](uint32_t offset, uint32_t fieldValue)
+        {
+            memcpy(data.data() + offset, &fieldValue, sizeof(fieldValue));
+        };
+
+        write(0, DDS_MAKE_FOURCC('D', 'D', 'S', ' '));
+        write(4, 124);
+        write(8, 0x1007 | 0x20000 | (depth > 1 ? 0x800000 : 0));
+        write(12, height);
+        write(16, width);
+        write(24, depth);
+        write(28, mipLevels);
+        write(76, 32);
+        write(80, 0x4);
+
+        if (depth > 1)
+        {
+            // Volume textures only come with legacy headers.
+            write(84, DDS_MAKE_FOURCC('D', 'X', 'T', '1'));
+            write(112, 0x200000);
+            data.resize(128);
+        }
+        else
+        {
+            write(84, DDS_MAKE_FOURCC('D', 'X', '1', '0'));
+            write(128, 28); // R8G8B8A8_UNORM
+            write(132, 3);
+            write(140, 1);
+        }
+
+        for (uint32_t i = 0; i < mipLevels; i++)
+            data.resize(data.size() + std::max(1u, width >> i) * std::max(1u, height >> i) * 4, value);
+
+        return data;
+    }
+
+    struct TextureLoadQueueTest : testing::Test
+    {
+        MockTextureLoadBackend backend;
+        std::vector<LoadedTexture<MockTexture>> loadedTextures;
+
+        // Polls like the render thread does every frame.
+        bool collectUntil(TextureLoadQueue<MockTexture>& queue, size_t count)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+            while (loadedTextures.size() < count)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                    return false;
+
+                queue.collectLoadedTextures(loadedTextures);
+                std::this_thread::yield();
+            }
+
+            return true;
+        }
+    };
+}
+
+TEST_F(TextureLoadQueueTest, LoadsOnCallingThreadWithoutWorkers)
+{
+    TextureLoadQueue<MockTexture> queue(backend, 0);
+
+    const uint32_t ticket = queue.loadTexture(7, makeDds(16, 8, 3, 0x42), "texture");
+    EXPECT_NE(ticket, 0u);
+    EXPECT_EQ(queue.getPendingCount(), 1u);
+
+    queue.collectLoadedTextures(loadedTextures);
+    EXPECT_TRUE(loadedTextures.empty());
+
+    EXPECT_TRUE(queue.loadNext());
+    EXPECT_FALSE(queue.loadNext());
+
+    queue.collectLoadedTextures(loadedTextures);
+    ASSERT_EQ(loadedTextures.size(), 1u);
+
+    const auto& loadedTexture = loadedTextures[0];
+    EXPECT_EQ(loadedTexture.textureId, 7u);
+    EXPECT_EQ(loadedTexture.ticket, ticket);
+    EXPECT_TRUE(loadedTexture.texture.parsed);
+    EXPECT_EQ(loadedTexture.texture.format, 28u);
+    EXPECT_EQ(loadedTexture.texture.subresourceCount, 3u);
+    EXPECT_EQ(loadedTexture.texture.firstPixel, 0x42);
+    EXPECT_EQ(loadedTexture.texture.name, "texture");
+
+    // Subresources point into the data, which has to stay around for the upload.
+    EXPECT_EQ(loadedTexture.data.size(), DdsLayout::s_maxHeaderSize + (16 * 8 + 8 * 4 + 4 * 2) * 4u);
+    EXPECT_EQ(queue.getPendingCount(), 0u);
+}
+
+TEST_F(TextureLoadQueueTest, FilesTheLayoutDoesNotHandleGetNoLayout)
+{
+    TextureLoadQueue<MockTexture> queue(backend, 0);
+
+    auto truncated = makeDds(64, 64, 1, 0);
+    truncated.resize(truncated.size() - 1);
+
+    queue.loadTexture(1, makeDds(4, 4, 1, 0, 4), "volume");
+    queue.loadTexture(2, std::move(truncated), "truncated");
+    queue.loadTexture(3, std::vector<uint8_t>(16), "garbage");
+
+    while (queue.loadNext())
+        ;
+
+    queue.collectLoadedTextures(loadedTextures);
+    ASSERT_EQ(loadedTextures.size(), 3u);
+
+    for (const auto& loadedTexture : loadedTextures)
+        EXPECT_FALSE(loadedTexture.texture.parsed) << loadedTexture.texture.name;
+}
+
+TEST_F(TextureLoadQueueTest, TicketsTellApartReusedIds)
+{
+    TextureLoadQueue<MockTexture> queue(backend, 0);
+
+    // Released before it finished loading, then the id got reused.
+    const uint32_t staleTicket = queue.loadTexture(5, makeDds(4, 4, 1, 1), "texture");
+    const uint32_t ticket = queue.loadTexture(5, makeDds(4, 4, 1, 2), "texture");
+    EXPECT_NE(staleTicket, ticket);
+
+    while (queue.loadNext())
+        ;
+
+    queue.collectLoadedTextures(loadedTextures);
+    ASSERT_EQ(loadedTextures.size(), 2u);
+
+    for (const auto& loadedTexture : loadedTextures)
+    {
+        EXPECT_EQ(loadedTexture.textureId, 5u);
+        EXPECT_EQ(loadedTexture.texture.firstPixel, loadedTexture.ticket == ticket ? 2 : 1);
+    }
+}
+
+TEST_F(TextureLoadQueueTest, CancelDropsQueuedLoad)
+{
+    TextureLoadQueue<MockTexture> queue(backend, 0);
+
+    const uint32_t first = queue.loadTexture(1, makeDds(4, 4, 1, 1), "first");
+    const uint32_t second = queue.loadTexture(2, makeDds(4, 4, 1, 2), "second");
+
+    EXPECT_TRUE(queue.cancel(first));
+    EXPECT_FALSE(queue.cancel(first));
+    EXPECT_EQ(queue.getPendingCount(), 1u);
+
+    EXPECT_TRUE(queue.loadNext());
+    EXPECT_FALSE(queue.loadNext());
+
+    // Too late once it's loaded, the caller throws the result away instead.
+    EXPECT_FALSE(queue.cancel(second));
+
+    queue.collectLoadedTextures(loadedTextures);
+    ASSERT_EQ(loadedTextures.size(), 1u);
+    EXPECT_EQ(loadedTextures[0].ticket, second);
+    EXPECT_EQ(queue.getPendingCount(), 0u);
+}
+
+TEST_F(TextureLoadQueueTest, CollectDoesNotWaitForSlowTextures)
+{
+    TextureLoadQueue<MockTexture> queue(backend, 2);
+
+    backend.blocked = true;
+    const uint32_t slowTicket = queue.loadTexture(1, makeDds(4, 4, 1, 0), "slow");
+
+    while (backend.slowCount == 0)
+        std::this_thread::yield();
+
+    for (uint32_t i = 2; i < 10; i++)
+        queue.loadTexture(i, makeDds(8, 8, 4, static_cast<uint8_t>(i)), "fast");
+
+    // The other worker publishes every fast texture while the slow one is still going.
+    ASSERT_TRUE(collectUntil(queue, 8));
+    EXPECT_EQ(queue.getPendingCount(), 1u);
+
+    for (const auto& loadedTexture : loadedTextures)
+    {
+        EXPECT_NE(loadedTexture.ticket, slowTicket);
+        EXPECT_EQ(loadedTexture.texture.firstPixel, loadedTexture.textureId);
+    }
+
+    // Cancelling can't stop a load that already started.
+    EXPECT_FALSE(queue.cancel(slowTicket));
+
+    backend.blocked = false;
+    ASSERT_TRUE(collectUntil(queue, 9));
+    EXPECT_EQ(loadedTextures.back().ticket, slowTicket);
+    EXPECT_EQ(queue.getPendingCount(), 0u);
+}
+
+TEST_F(TextureLoadQueueTest, ManyWorkersLoadEveryTextureOnce)
+{
+    constexpr uint32_t s_count = 500;
+    TextureLoadQueue<MockTexture> queue(backend, 4);
+
+    std::vector<uint32_t> tickets;
+    for (uint32_t i = 0; i < s_count; i++)
+        tickets.push_back(queue.loadTexture(i, makeDds(1 + i % 32, 1 + i % 16, 1, static_cast<uint8_t>(i)), "texture"));
+
+    ASSERT_TRUE(collectUntil(queue, s_count));
+    EXPECT_EQ(loadedTextures.size(), s_count);
+
+    std::vector<bool> seen(s_count);
+    for (const auto& loadedTexture : loadedTextures)
+    {
+        ASSERT_LT(loadedTexture.textureId, s_count);
+        EXPECT_FALSE(seen[loadedTexture.textureId]);
+        seen[loadedTexture.textureId] = true;
+
+        EXPECT_EQ(loadedTexture.ticket, tickets[loadedTexture.textureId]);
+        EXPECT_EQ(loadedTexture.texture.firstPixel, static_cast<uint8_t>(loadedTexture.textureId));
+    }
+}
+
+TEST_F(TextureLoadQueueTest, DestroyingDropsQueuedLoads)
+{
+    auto queue = std::make_unique<TextureLoadQueue<MockTexture>>(backend, 1);
+
+    backend.blocked = true;
+    queue->loadTexture(1, makeDds(4, 4, 1, 0), "slow");
+
+    while (backend.slowCount == 0)
+        std::this_thread::yield();
+
+    for (uint32_t i = 0; i < 10; i++)
+        queue->loadTexture(i + 2, makeDds(4, 4, 1, 0), "slow");
+
+    std::thread unblock([&]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        backend.blocked = false;
+    });
+
+    queue = nullptr;
+    unblock.join();
+
+    // Only the one that was running got loaded, the rest were dropped without starting.
+    EXPECT_EQ(backend.slowCount, 1u);
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "TypeClassifier.h"
+
+namespace
+{
+    enum class Kind
+    {
+        Unknown,
+        Bundle,
+        OptimalBundle,
+        Element,
+        Numbered
+    };
+
+    struct Renderable
+    {
+        virtual ~Renderable() = default;
+    };
+
+    struct Bundle : Renderable {};
+    struct OptimalBundle : Bundle {};
+    struct Element : Renderable {};
+    struct SkinnedElement : Element {};
+    struct Light : Renderable {};
+
+    template<size_t N>
+    struct Numbered : Renderable {};
+
+    template<size_t... Indices>
+    std::vector<std::unique_ptr<Renderable>> makeNumbered(std::index_sequence<Indices...>)
+    {
+        std::vector<std::unique_ptr<Renderable>> objects;
+        (objects.push_back(std::make_unique<Numbered<Indices>>()), ...);
+        return objects;
+    }
+
+    TypeClassifier<Renderable, Kind> makeClassifier()
+    {
+        return TypeClassifier<Renderable, Kind>(Kind::Unknown)
+            .add<OptimalBundle>(Kind::OptimalBundle)
+            .add<Bundle>(Kind::Bundle)
+            .add<Element>(Kind::Element);
+    }
+}
+
+TEST(TypeClassifierTest, ClassifiesRegisteredTypes)
+{
+    auto classifier = makeClassifier();
+
+    Bundle bundle;
+    OptimalBundle optimalBundle;
+    Element element;
+
+    EXPECT_EQ(classifier.classify(&bundle), Kind::Bundle);
+    EXPECT_EQ(classifier.classify(&optimalBundle), Kind::OptimalBundle);
+    EXPECT_EQ(classifier.classify(&element), Kind::Element);
+}
+
+TEST(TypeClassifierTest, DerivedTypesMatchTheirBase)
+{
+    auto classifier = makeClassifier();
+
+    SkinnedElement skinnedElement;
+    EXPECT_EQ(classifier.classify(&skinnedElement), Kind::Element);
+}
+
+TEST(TypeClassifierTest, RegistrationOrderDecides)
+{
+    auto classifier = TypeClassifier<Renderable, Kind>(Kind::Unknown)
+        .add<Bundle>(Kind::Bundle)
+        .add<OptimalBundle>(Kind::OptimalBundle);
+
+    OptimalBundle optimalBundle;
+    EXPECT_EQ(classifier.classify(&optimalBundle), Kind::Bundle);
+}
+
+TEST(TypeClassifierTest, UnknownTypesGetDefaultKind)
+{
+    auto classifier = makeClassifier();
+
+    Light light;
+    Renderable renderable;
+
+    EXPECT_EQ(classifier.classify(&light), Kind::Unknown);
+    EXPECT_EQ(classifier.classify(&renderable), Kind::Unknown);
+    EXPECT_EQ(classifier.classify(&light), Kind::Unknown);
+}
+
+// A vtable is resolved once, so a type registered afterwards doesn't change the result.
+TEST(TypeClassifierTest, MemoizesByVtable)
+{
+    auto classifier = TypeClassifier<Renderable, Kind>(Kind::Unknown);
+
+    Light light;
+    EXPECT_EQ(classifier.classify(&light), Kind::Unknown);
+
+    classifier.add<Light>(Kind::Element);
+
+    Light otherLight;
+    EXPECT_EQ(classifier.classify(&otherLight), Kind::Unknown);
+
+    Element element;
+    EXPECT_EQ(classifier.classify(&element), Kind::Unknown);
+}
+
+TEST(TypeClassifierTest, KeepsResultsWhileGrowing)
+{
+    auto classifier = makeClassifier();
+    classifier.add<Numbered<0>>(Kind::Numbered);
+
+    const auto objects = makeNumbered(std::make_index_sequence<300>());
+
+    Bundle bundle;
+    Element element;
+    EXPECT_EQ(classifier.classify(&bundle), Kind::Bundle);
+
+    for (const auto& object : objects)
+        classifier.classify(object.get());
+
+    EXPECT_EQ(classifier.classify(&bundle), Kind::Bundle);
+    EXPECT_EQ(classifier.classify(&element), Kind::Element);
+
+    for (size_t i = 0; i < objects.size(); i++)
+        EXPECT_EQ(classifier.classify(objects[i].get()), i == 0 ? Kind::Numbered : Kind::Unknown);
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "WorkerPool.h"
+#include "WorkLanes.h"
+
+namespace
+{
+    void append(WorkLanes& lanes, size_t laneIndex, uint32_t itemIndex, const std::string& value)
+    {
+        memcpy(lanes.append(laneIndex, itemIndex, static_cast<uint32_t>(value.size())), value.data(), value.size());
+    }
+
+    std::vector<std::pair<uint32_t, std::string>> readAll(const WorkLanes& lanes)
+    {
+        std::vector<std::pair<uint32_t, std::string>> records;
+        WorkLanes::Cursor cursor(lanes);
+        WorkLanes::Record record;
+
+        while (cursor.next(record))
+            records.emplace_back(record.itemIndex, std::string(reinterpret_cast<const char*>(record.data), record.byteSize));
+
+        return records;
+    }
+
+    // Every item writes a few records derived from its index, some write none.
+    void produce(WorkLanes& lanes, size_t laneIndex, uint32_t itemIndex)
+    {
+        std::mt19937 random(itemIndex);
+
+        const uint32_t recordCount = random() % 4;
+        for (uint32_t i = 0; i < recordCount; i++)
+            append(lanes, laneIndex, itemIndex, std::string(random() % 40, static_cast<char>('a' + i)) + std::to_string(itemIndex));
+    }
+}
+
+TEST(WorkLanesTest, MergesLanesInItemOrder)
+{
+    WorkLanes lanes;
+    lanes.reset(3);
+
+    append(lanes, 0, 0, "a");
+    append(lanes, 2, 1, "b");
+    append(lanes, 2, 1, "c");
+    append(lanes, 1, 2, "d");
+    append(lanes, 0, 3, "e");
+    append(lanes, 1, 5, "");
+    append(lanes, 2, 6, "f");
+
+    const std::vector<std::pair<uint32_t, std::string>> expected =
+    {
+        { 0, "a" }, { 1, "b" }, { 1, "c" }, { 2, "d" }, { 3, "e" }, { 5, "" }, { 6, "f" }
+    };
+
+    EXPECT_EQ(readAll(lanes), expected);
+}
+
+TEST(WorkLanesTest, SeekSkipsToItem)
+{
+    WorkLanes lanes;
+    lanes.reset(2);
+
+    append(lanes, 0, 1, "a");
+    append(lanes, 1, 2, "b");
+    append(lanes, 0, 4, "c");
+
+    WorkLanes::Cursor cursor(lanes);
+    WorkLanes::Record record;
+
+    EXPECT_FALSE(cursor.seek(0, record));
+    EXPECT_TRUE(cursor.seek(1, record));
+    EXPECT_EQ(record.itemIndex, 1u);
+    EXPECT_FALSE(cursor.seek(3, record)); // Skips item 2
+    EXPECT_TRUE(cursor.seek(4, record));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(record.data), record.byteSize), "c");
+    EXPECT_FALSE(cursor.seek(5, record));
+    EXPECT_FALSE(cursor.next(record));
+}
+
+TEST(WorkLanesTest, RecordsAreAligned)
+{
+    WorkLanes lanes;
+    lanes.reset(1);
+
+    for (uint32_t i = 0; i < 16; i++)
+        lanes.append(0, i, i);
+
+    WorkLanes::Cursor cursor(lanes);
+    WorkLanes::Record record;
+
+    while (cursor.next(record))
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(record.data) % alignof(uint32_t), 0u);
+}
+
+TEST(WorkLanesTest, ResetKeepsMemory)
+{
+    WorkLanes lanes;
+    lanes.reset(2);
+
+    append(lanes, 0, 0, std::string(1000, 'a'));
+    append(lanes, 1, 1, std::string(1000, 'b'));
+
+    const auto record = readAll(lanes);
+    EXPECT_EQ(record.size(), 2u);
+
+    lanes.reset(2);
+    EXPECT_EQ(lanes.getByteSize(0), 0u);
+    EXPECT_EQ(lanes.getByteSize(1), 0u);
+    EXPECT_TRUE(readAll(lanes).empty());
+
+    append(lanes, 1, 0, "x");
+    EXPECT_EQ(readAll(lanes), (std::vector<std::pair<uint32_t, std::string>>{ { 0, "x" } }));
+}
+
+// Whatever the thread count and chunk size, the merged records come out exactly as a serial loop writes them.
+TEST(WorkLanesTest, MergeMatchesSerialOrder)
+{
+    constexpr uint32_t s_itemCount = 3000;
+
+    WorkLanes serialLanes;
+    serialLanes.reset(1);
+
+    for (uint32_t i = 0; i < s_itemCount; i++)
+        produce(serialLanes, 0, i);
+
+    const auto expected = readAll(serialLanes);
+
+    WorkLanes lanes;
+
+    for (const uint32_t threadCount : { 0, 1, 3, 7 })
+    {
+        WorkerPool pool(threadCount);
+
+        for (const size_t chunkSize : { 1, 5, 64 })
+        {
+            for (uint32_t run = 0; run < 4; run++)
+            {
+                lanes.reset(pool.getWorkerCount());
+
+                pool.run(s_itemCount, chunkSize, [&](size_t itemIndex, size_t workerIndex)
+                {
+                    produce(lanes, workerIndex, static_cast<uint32_t>(itemIndex));
+                });
+
+                EXPECT_EQ(readAll(lanes), expected) << "threads " << threadCount << ", chunk size " << chunkSize;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "WorkerPool.h"
+
+TEST(WorkerPoolTest, RunsEveryItemOnce)
+{
+    WorkerPool pool(3);
+    EXPECT_EQ(pool.getWorkerCount(), 4u);
+
+    for (const size_t chunkSize : { 1, 7, 64, 1000 })
+    {
+        std::vector<std::atomic<uint32_t>> counts(517);
+
+        pool.run(counts.size(), chunkSize, [&](size_t itemIndex, size_t workerIndex)
+        {
+            EXPECT_LT(workerIndex, pool.getWorkerCount());
+            ++counts[itemIndex];
+        });
+
+        for (const auto& count : counts)
+            EXPECT_EQ(count, 1u);
+    }
+}
+
+TEST(WorkerPoolTest, WorkersSeeIncreasingItems)
+{
+    WorkerPool pool(4);
+
+    for (uint32_t run = 0; run < 50; run++)
+    {
+        std::vector<std::vector<size_t>> itemIndices(pool.getWorkerCount());
+
+        pool.run(2000, 3, [&](size_t itemIndex, size_t workerIndex)
+        {
+            itemIndices[workerIndex].push_back(itemIndex);
+        });
+
+        size_t itemCount = 0;
+        for (const auto& workerItemIndices : itemIndices)
+        {
+            EXPECT_TRUE(std::is_sorted(workerItemIndices.begin(), workerItemIndices.end()));
+            itemCount += workerItemIndices.size();
+        }
+
+        EXPECT_EQ(itemCount, 2000u);
+    }
+}
+
+TEST(WorkerPoolTest, RunsOnCallingThreadWithoutThreads)
+{
+    WorkerPool pool(0);
+    EXPECT_EQ(pool.getWorkerCount(), 1u);
+
+    const auto threadId = std::this_thread::get_id();
+    std::vector<size_t> itemIndices;
+
+    pool.run(100, 8, [&](size_t itemIndex, size_t workerIndex)
+    {
+        EXPECT_EQ(workerIndex, 0u);
+        EXPECT_EQ(std::this_thread::get_id(), threadId);
+        itemIndices.push_back(itemIndex);
+    });
+
+    ASSERT_EQ(itemIndices.size(), 100u);
+    for (size_t i = 0; i < itemIndices.size(); i++)
+        EXPECT_EQ(itemIndices[i], i);
+}
+
+TEST(WorkerPoolTest, SingleChunkStaysOnCallingThread)
+{
+    WorkerPool pool(2);
+    const auto threadId = std::this_thread::get_id();
+
+    pool.run(16, 16, [&](size_t, size_t workerIndex)
+    {
+        EXPECT_EQ(workerIndex, 0u);
+        EXPECT_EQ(std::this_thread::get_id(), threadId);
+    });
+
+    uint32_t count = 0;
+    pool.run(0, 16, [&](size_t, size_t) { ++count; });
+    EXPECT_EQ(count, 0u);
+}
+
+TEST(WorkerPoolTest, ReturnsAfterSlowItems)
+{
+    WorkerPool pool(3);
+    std::atomic<uint32_t> count = 0;
+
+    for (uint32_t run = 0; run < 10; run++)
+    {
+        pool.run(8, 1, [&](size_t itemIndex, size_t)
+        {
+            if (itemIndex % 3 == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+            ++count;
+        });
+
+        EXPECT_EQ(count, (run + 1) * 8);
+    }
+}
\ No newline at end of file
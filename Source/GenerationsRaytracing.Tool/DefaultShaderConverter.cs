@@ -112,31 +112,38 @@ public class DefaultShaderConverter
 
 	public void Save(string destinationDirectoryPath)
 	{
-        byte[] uncompressedBlock;
+        // Sorted hash index followed by individually compressed shaders, see ShaderCache.cpp.
+        var shaders = _shaders
+            .OrderBy(x => x.Key)
+            .Select(x =>
+            {
+                var compressedData = new byte[LZ4Codec.MaximumOutputSize(x.Value.Length)];
+                int compressedSize = LZ4Codec.Encode(x.Value, compressedData, LZ4Level.L12_MAX);
+                return (Hash: x.Key, UncompressedSize: x.Value.Length, CompressedData: compressedData, CompressedSize: compressedSize);
+            })
+            .ToList();
 
-        using (var stream = new MemoryStream())
+        using (var stream = File.Create(Path.Combine(destinationDirectoryPath, "pregenerated_shader_cache.bin")))
         using (var writer = new BinaryWriter(stream))
         {
-            foreach (var kvp in _shaders.OrderBy(x => x.Value.Length))
-            {
-                writer.Write(kvp.Key);
-                writer.Write(kvp.Value.Length);
-                writer.Write(kvp.Value);
-            }
+            writer.Write(0x43535247);
+            writer.Write(1);
+            writer.Write(shaders.Count);
 
-            uncompressedBlock = stream.ToArray();
-        }
+            int offset = 12 + shaders.Count * 20;
 
-        var compressedBlock = new byte[LZ4Codec.MaximumOutputSize(uncompressedBlock.Length)];
-        int compressedSize = LZ4Codec.Encode(uncompressedBlock, compressedBlock, LZ4Level.L12_MAX);
+            foreach (var shader in shaders)
+            {
+                writer.Write(shader.Hash);
+                writer.Write(offset);
+                writer.Write(shader.CompressedSize);
+                writer.Write(shader.UncompressedSize);
 
-        using (var stream = File.Create(Path.Combine(destinationDirectoryPath, "pregenerated_shader_cache.bin")))
-        using (var writer = new BinaryWriter(stream))
-        {
-            writer.Write(0);
-            writer.Write(uncompressedBlock.Length);
-            writer.Write(compressedSize);
-            writer.Write(compressedBlock, 0, compressedSize);
+                offset += shader.CompressedSize;
+            }
+
+            foreach (var shader in shaders)
+                writer.Write(shader.CompressedData, 0, shader.CompressedSize);
         }
     }
 }
\ No newline at end of file
@@ -9,7 +9,9 @@ struct BottomLevelAccelStruct
     uint32_t geometryCount = 0;
     D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC desc{};
     std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geometryDescs{};
+    uint32_t resultDataSize = 0;
     uint32_t scratchBufferSize = 0;
     uint32_t updateScratchBufferSize = 0;
     D3D12_RAYTRACING_INSTANCE_FLAGS instanceFlags{};
+    uint64_t buildIndex = 0;
 };
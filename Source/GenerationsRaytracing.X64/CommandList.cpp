@@ -2,6 +2,242 @@
 
 #include "CommandQueue.h"
 
+struct ResourceBarrierCommand
+{
+    static constexpr uint32_t s_id = 0;
+};
+
+struct SetGraphicsRootSignatureCommand
+{
+    static constexpr uint32_t s_id = 1;
+    ID3D12RootSignature* rootSignature;
+};
+
+struct SetPipelineStateCommand
+{
+    static constexpr uint32_t s_id = 2;
+    ID3D12PipelineState* pipelineState;
+};
+
+struct SetGraphicsRootConstantBufferViewCommand
+{
+    static constexpr uint32_t s_id = 3;
+    UINT rootParameterIndex;
+    D3D12_GPU_VIRTUAL_ADDRESS bufferLocation;
+};
+
+struct SetGraphicsRootDescriptorTableCommand
+{
+    static constexpr uint32_t s_id = 4;
+    UINT rootParameterIndex;
+    D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor;
+};
+
+struct OMSetRenderTargetsCommand
+{
+    static constexpr uint32_t s_id = 5;
+    D3D12_CPU_DESCRIPTOR_HANDLE depthStencilDescriptor;
+    bool hasDepthStencilDescriptor;
+};
+
+struct RSSetViewportsCommand
+{
+    static constexpr uint32_t s_id = 6;
+};
+
+struct RSSetScissorRectsCommand
+{
+    static constexpr uint32_t s_id = 7;
+};
+
+struct IASetVertexBuffersCommand
+{
+    static constexpr uint32_t s_id = 8;
+    UINT startSlot;
+};
+
+struct IASetIndexBufferCommand
+{
+    static constexpr uint32_t s_id = 9;
+    D3D12_INDEX_BUFFER_VIEW view;
+};
+
+struct IASetPrimitiveTopologyCommand
+{
+    static constexpr uint32_t s_id = 10;
+    D3D12_PRIMITIVE_TOPOLOGY primitiveTopology;
+};
+
+struct DrawInstancedCommand
+{
+    static constexpr uint32_t s_id = 11;
+    UINT vertexCountPerInstance;
+    UINT instanceCount;
+    UINT startVertexLocation;
+    UINT startInstanceLocation;
+};
+
+struct DrawIndexedInstancedCommand
+{
+    static constexpr uint32_t s_id = 12;
+    UINT indexCountPerInstance;
+    UINT instanceCount;
+    UINT startIndexLocation;
+    INT baseVertexLocation;
+    UINT startInstanceLocation;
+};
+
+struct ClearRenderTargetViewCommand
+{
+    static constexpr uint32_t s_id = 13;
+    D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView;
+    FLOAT color[4];
+};
+
+struct ClearDepthStencilViewCommand
+{
+    static constexpr uint32_t s_id = 14;
+    D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView;
+    D3D12_CLEAR_FLAGS clearFlags;
+    FLOAT depth;
+    UINT8 stencil;
+};
+
+template<typename T>
+static UINT getCount(const CommandStream::Record& record)
+{
+    return record.dataSize / sizeof(T);
+}
+
+void CommandList::playCommands()
+{
+    if (m_commands.isEmpty())
+        return;
+
+    const auto commandList = m_commandList.Get();
+
+    m_commands.play([&](const CommandStream::Record& record)
+        {
+            switch (record.id)
+            {
+            case ResourceBarrierCommand::s_id:
+                commandList->ResourceBarrier(getCount<D3D12_RESOURCE_BARRIER>(record),
+                    static_cast<const D3D12_RESOURCE_BARRIER*>(record.data));
+                break;
+
+            case SetGraphicsRootSignatureCommand::s_id:
+                commandList->SetGraphicsRootSignature(
+                    static_cast<const SetGraphicsRootSignatureCommand*>(record.command)->rootSignature);
+                break;
+
+            case SetPipelineStateCommand::s_id:
+                commandList->SetPipelineState(
+                    static_cast<const SetPipelineStateCommand*>(record.command)->pipelineState);
+                break;
+
+            case SetGraphicsRootConstantBufferViewCommand::s_id:
+            {
+                const auto command = static_cast<const SetGraphicsRootConstantBufferViewCommand*>(record.command);
+                commandList->SetGraphicsRootConstantBufferView(command->rootParameterIndex, command->bufferLocation);
+                break;
+            }
+
+            case SetGraphicsRootDescriptorTableCommand::s_id:
+            {
+                const auto command = static_cast<const SetGraphicsRootDescriptorTableCommand*>(record.command);
+                commandList->SetGraphicsRootDescriptorTable(command->rootParameterIndex, command->baseDescriptor);
+                break;
+            }
+
+            case OMSetRenderTargetsCommand::s_id:
+            {
+                const auto command = static_cast<const OMSetRenderTargetsCommand*>(record.command);
+                const UINT numRenderTargetDescriptors = getCount<D3D12_CPU_DESCRIPTOR_HANDLE>(record);
+
+                commandList->OMSetRenderTargets(
+                    numRenderTargetDescriptors,
+                    numRenderTargetDescriptors != 0 ? static_cast<const D3D12_CPU_DESCRIPTOR_HANDLE*>(record.data) : nullptr,
+                    FALSE,
+                    command->hasDepthStencilDescriptor ? &command->depthStencilDescriptor : nullptr);
+
+                break;
+            }
+
+            case RSSetViewportsCommand::s_id:
+                commandList->RSSetViewports(getCount<D3D12_VIEWPORT>(record), static_cast<const D3D12_VIEWPORT*>(record.data));
+                break;
+
+            case RSSetScissorRectsCommand::s_id:
+                commandList->RSSetScissorRects(getCount<D3D12_RECT>(record), static_cast<const D3D12_RECT*>(record.data));
+                break;
+
+            case IASetVertexBuffersCommand::s_id:
+                commandList->IASetVertexBuffers(
+                    static_cast<const IASetVertexBuffersCommand*>(record.command)->startSlot,
+                    getCount<D3D12_VERTEX_BUFFER_VIEW>(record),
+                    static_cast<const D3D12_VERTEX_BUFFER_VIEW*>(record.data));
+
+                break;
+
+            case IASetIndexBufferCommand::s_id:
+                commandList->IASetIndexBuffer(&static_cast<const IASetIndexBufferCommand*>(record.command)->view);
+                break;
+
+            case IASetPrimitiveTopologyCommand::s_id:
+                commandList->IASetPrimitiveTopology(
+                    static_cast<const IASetPrimitiveTopologyCommand*>(record.command)->primitiveTopology);
+                break;
+
+            case DrawInstancedCommand::s_id:
+            {
+                const auto command = static_cast<const DrawInstancedCommand*>(record.command);
+
+                commandList->DrawInstanced(
+                    command->vertexCountPerInstance,
+                    command->instanceCount,
+                    command->startVertexLocation,
+                    command->startInstanceLocation);
+
+                break;
+            }
+
+            case DrawIndexedInstancedCommand::s_id:
+            {
+                const auto command = static_cast<const DrawIndexedInstancedCommand*>(record.command);
+
+                commandList->DrawIndexedInstanced(
+                    command->indexCountPerInstance,
+                    command->instanceCount,
+                    command->startIndexLocation,
+                    command->baseVertexLocation,
+                    command->startInstanceLocation);
+
+                break;
+            }
+
+            case ClearRenderTargetViewCommand::s_id:
+            {
+                const auto command = static_cast<const ClearRenderTargetViewCommand*>(record.command);
+                commandList->ClearRenderTargetView(command->renderTargetView, command->color, 0, nullptr);
+                break;
+            }
+
+            case ClearDepthStencilViewCommand::s_id:
+            {
+                const auto command = static_cast<const ClearDepthStencilViewCommand*>(record.command);
+                commandList->ClearDepthStencilView(command->depthStencilView, command->clearFlags, command->depth, command->stencil, 0, nullptr);
+                break;
+            }
+
+            default:
+                assert(false);
+                break;
+            }
+        });
+
+    m_commands.clear();
+}
+
 void CommandList::init(ID3D12Device* device, const CommandQueue& commandQueue)
 {
     HRESULT hr = device->CreateCommandAllocator(commandQueue.getType(), IID_PPV_ARGS(m_commandAllocator.GetAddressOf()));
@@ -11,8 +247,9 @@ void CommandList::init(ID3D12Device* device, const CommandQueue& commandQueue)
     assert(SUCCEEDED(hr) && m_commandList != nullptr);
 }
 
-ID3D12GraphicsCommandList4* CommandList::getUnderlyingCommandList() const
+ID3D12GraphicsCommandList4* CommandList::getUnderlyingCommandList()
 {
+    playCommands();
     return m_commandList.Get();
 }
 
@@ -39,11 +276,10 @@ void CommandList::close()
 {
     if (m_isOpen)
     {
-        for (auto& [resource, states] : m_resourceStates)
-            states.stateAfter = states.stateInitial;
-
+        m_resourceStates.restoreInitialStates();
         commitBarriers();
         m_resourceStates.clear();
+        playCommands();
 
         const HRESULT hr = m_commandList->Close();
         assert(SUCCEEDED(hr));
@@ -52,20 +288,32 @@ void CommandList::close()
     }
 }
 
+void CommandList::split(CommandList& commandList)
+{
+    assert(m_isOpen && &commandList != this);
+
+    commitBarriers();
+
+    commandList.open();
+    m_resourceStates.moveTo(commandList.m_resourceStates);
+}
+
+void CommandList::record()
+{
+    assert(m_isOpen);
+
+    playCommands();
+
+    const HRESULT hr = m_commandList->Close();
+    assert(SUCCEEDED(hr));
+
+    m_isOpen = false;
+}
+
 void CommandList::transitionBarrier(ID3D12Resource* resource, 
     D3D12_RESOURCE_STATES stateInitial, D3D12_RESOURCE_STATES stateAfter)
 {
-    const auto result = m_resourceStates.find(resource);
-
-    if (result != m_resourceStates.end())
-    {
-        assert(result->second.stateInitial == stateInitial);
-        result->second.stateAfter = stateAfter;
-    }
-    else
-    {
-        m_resourceStates.emplace(resource, ResourceStates { stateInitial, stateInitial, stateAfter });
-    }
+    m_resourceStates.transition(resource, stateInitial, stateAfter);
 }
 
 void CommandList::transitionBarriers(std::initializer_list<ID3D12Resource*> resources,
@@ -92,18 +340,115 @@ void CommandList::uavBarrier(ID3D12Resource* resource)
 
 void CommandList::commitBarriers()
 {
-    for (auto& [resource, states] : m_resourceStates)
-    {
-        if (states.stateBefore != states.stateAfter)
+    m_resourceStates.commit([&](ID3D12Resource* resource, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
         {
-            m_resourceBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, states.stateBefore, states.stateAfter));
-            states.stateBefore = states.stateAfter;
-        }
-    }
+            m_resourceBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, stateBefore, stateAfter));
+        });
 
     if (!m_resourceBarriers.empty())
-        m_commandList->ResourceBarrier(static_cast<UINT>(m_resourceBarriers.size()), m_resourceBarriers.data());
+    {
+        const UINT numBarriers = static_cast<UINT>(m_resourceBarriers.size());
+
+        if (m_commands.isEmpty())
+            m_commandList->ResourceBarrier(numBarriers, m_resourceBarriers.data());
+        else
+            m_commands.append<ResourceBarrierCommand>(m_resourceBarriers.data(), numBarriers * sizeof(D3D12_RESOURCE_BARRIER));
+    }
 
     m_resourceBarriers.clear();
     m_uavResources.clear();
 }
+
+void CommandList::setGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+{
+    m_commands.append<SetGraphicsRootSignatureCommand>().rootSignature = rootSignature;
+}
+
+void CommandList::setPipelineState(ID3D12PipelineState* pipelineState)
+{
+    m_commands.append<SetPipelineStateCommand>().pipelineState = pipelineState;
+}
+
+void CommandList::setGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS bufferLocation)
+{
+    auto& command = m_commands.append<SetGraphicsRootConstantBufferViewCommand>();
+    command.rootParameterIndex = rootParameterIndex;
+    command.bufferLocation = bufferLocation;
+}
+
+void CommandList::setGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)
+{
+    auto& command = m_commands.append<SetGraphicsRootDescriptorTableCommand>();
+    command.rootParameterIndex = rootParameterIndex;
+    command.baseDescriptor = baseDescriptor;
+}
+
+void CommandList::omSetRenderTargets(UINT numRenderTargetDescriptors, const D3D12_CPU_DESCRIPTOR_HANDLE* renderTargetDescriptors,
+    const D3D12_CPU_DESCRIPTOR_HANDLE* depthStencilDescriptor)
+{
+    auto& command = m_commands.append<OMSetRenderTargetsCommand>(renderTargetDescriptors,
+        numRenderTargetDescriptors * sizeof(D3D12_CPU_DESCRIPTOR_HANDLE));
+
+    command.depthStencilDescriptor = depthStencilDescriptor != nullptr ? *depthStencilDescriptor : D3D12_CPU_DESCRIPTOR_HANDLE{};
+    command.hasDepthStencilDescriptor = depthStencilDescriptor != nullptr;
+}
+
+void CommandList::rsSetViewports(UINT numViewports, const D3D12_VIEWPORT* viewports)
+{
+    m_commands.append<RSSetViewportsCommand>(viewports, numViewports * sizeof(D3D12_VIEWPORT));
+}
+
+void CommandList::rsSetScissorRects(UINT numRects, const D3D12_RECT* rects)
+{
+    m_commands.append<RSSetScissorRectsCommand>(rects, numRects * sizeof(D3D12_RECT));
+}
+
+void CommandList::iaSetVertexBuffers(UINT startSlot, UINT numViews, const D3D12_VERTEX_BUFFER_VIEW* views)
+{
+    m_commands.append<IASetVertexBuffersCommand>(views, numViews * sizeof(D3D12_VERTEX_BUFFER_VIEW)).startSlot = startSlot;
+}
+
+void CommandList::iaSetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+    m_commands.append<IASetIndexBufferCommand>().view = view;
+}
+
+void CommandList::iaSetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY primitiveTopology)
+{
+    m_commands.append<IASetPrimitiveTopologyCommand>().primitiveTopology = primitiveTopology;
+}
+
+void CommandList::drawInstanced(UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation, UINT startInstanceLocation)
+{
+    auto& command = m_commands.append<DrawInstancedCommand>();
+    command.vertexCountPerInstance = vertexCountPerInstance;
+    command.instanceCount = instanceCount;
+    command.startVertexLocation = startVertexLocation;
+    command.startInstanceLocation = startInstanceLocation;
+}
+
+void CommandList::drawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation)
+{
+    auto& command = m_commands.append<DrawIndexedInstancedCommand>();
+    command.indexCountPerInstance = indexCountPerInstance;
+    command.instanceCount = instanceCount;
+    command.startIndexLocation = startIndexLocation;
+    command.baseVertexLocation = baseVertexLocation;
+    command.startInstanceLocation = startInstanceLocation;
+}
+
+void CommandList::clearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView, const FLOAT color[4])
+{
+    auto& command = m_commands.append<ClearRenderTargetViewCommand>();
+    command.renderTargetView = renderTargetView;
+    memcpy(command.color, color, sizeof(command.color));
+}
+
+void CommandList::clearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView, D3D12_CLEAR_FLAGS clearFlags, FLOAT depth, UINT8 stencil)
+{
+    auto& command = m_commands.append<ClearDepthStencilViewCommand>();
+    command.depthStencilView = depthStencilView;
+    command.clearFlags = clearFlags;
+    command.depth = depth;
+    command.stencil = stencil;
+}
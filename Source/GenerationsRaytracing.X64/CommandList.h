@@ -1,5 +1,8 @@
 #pragma once
 
+#include "CommandStream.h"
+#include "ResourceStateTracker.h"
+
 class DescriptorHeap;
 class CommandQueue;
 
@@ -10,27 +13,34 @@ protected:
     ComPtr<ID3D12GraphicsCommandList4> m_commandList;
     bool m_isOpen = true;
 
-    struct ResourceStates
-    {
-        D3D12_RESOURCE_STATES stateInitial = D3D12_RESOURCE_STATE_COMMON;
-        D3D12_RESOURCE_STATES stateBefore = D3D12_RESOURCE_STATE_COMMON;
-        D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_COMMON;
-    };
-
-    ankerl::unordered_dense::map<ID3D12Resource*, ResourceStates> m_resourceStates;
+    ResourceStateTracker<ankerl::unordered_dense::map<ID3D12Resource*, ResourceStates<D3D12_RESOURCE_STATES>>> m_resourceStates;
     std::vector<D3D12_RESOURCE_BARRIER> m_resourceBarriers;
     ankerl::unordered_dense::set<ID3D12Resource*> m_uavResources;
 
+    // Graphics state and draws of a split segment get recorded into the command list
+    // by whichever thread calls record(), see SegmentRecorder.
+    CommandStream m_commands;
+
+    void playCommands();
+
 public:
     void init(ID3D12Device* device, const CommandQueue& commandQueue);
 
-    ID3D12GraphicsCommandList4* getUnderlyingCommandList() const;
+    // Records pending commands first, so direct recording stays in order with them.
+    ID3D12GraphicsCommandList4* getUnderlyingCommandList();
 
     bool isOpen() const;
 
     void open();
     void close();
 
+    // Continues recording on the given command list, this one gets closed by record(). Resources keep
+    // their current states instead of returning to their initial states at the end of this list.
+    void split(CommandList& commandList);
+
+    // Records pending commands and closes the command list. Can be called from any thread after a split.
+    void record();
+
     void transitionBarrier(ID3D12Resource* resource, D3D12_RESOURCE_STATES stateInitial, D3D12_RESOURCE_STATES stateAfter);
     void transitionBarriers(std::initializer_list<ID3D12Resource*> resources, D3D12_RESOURCE_STATES stateInitial, D3D12_RESOURCE_STATES stateAfter);
 
@@ -38,4 +48,25 @@ public:
     void uavBarriers(std::initializer_list<ID3D12Resource*> resources);
 
     void commitBarriers();
+
+    void setGraphicsRootSignature(ID3D12RootSignature* rootSignature);
+    void setPipelineState(ID3D12PipelineState* pipelineState);
+    void setGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS bufferLocation);
+    void setGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor);
+
+    void omSetRenderTargets(UINT numRenderTargetDescriptors, const D3D12_CPU_DESCRIPTOR_HANDLE* renderTargetDescriptors,
+        const D3D12_CPU_DESCRIPTOR_HANDLE* depthStencilDescriptor);
+
+    void rsSetViewports(UINT numViewports, const D3D12_VIEWPORT* viewports);
+    void rsSetScissorRects(UINT numRects, const D3D12_RECT* rects);
+
+    void iaSetVertexBuffers(UINT startSlot, UINT numViews, const D3D12_VERTEX_BUFFER_VIEW* views);
+    void iaSetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view);
+    void iaSetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY primitiveTopology);
+
+    void drawInstanced(UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation, UINT startInstanceLocation);
+    void drawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation);
+
+    void clearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView, const FLOAT color[4]);
+    void clearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView, D3D12_CLEAR_FLAGS clearFlags, FLOAT depth, UINT8 stencil);
 };
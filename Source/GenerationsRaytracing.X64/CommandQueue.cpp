@@ -64,7 +64,7 @@ ID3D12Fence* CommandQueue::getFence() const
     return m_fence.Get();
 }
 
-void CommandQueue::executeCommandList(const CommandList& commandList) const
+void CommandQueue::executeCommandList(CommandList& commandList) const
 {
     ID3D12CommandList* commandLists[] = { commandList.getUnderlyingCommandList() };
     m_queue->ExecuteCommandLists(1, commandLists);
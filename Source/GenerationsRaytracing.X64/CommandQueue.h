@@ -16,7 +16,7 @@ public:
     ID3D12CommandQueue* getUnderlyingQueue() const;
     ID3D12Fence* getFence() const;
 
-    void executeCommandList(const CommandList& commandList) const;
+    void executeCommandList(CommandList& commandList) const;
     void signal(uint64_t fenceValue) const;
     void wait(uint64_t fenceValue, const CommandQueue& commandQueue) const;
 };
@@ -59,28 +59,24 @@ void Device::writeBuffer(
     }
     else
     {
-        const auto& uploadBuffers = m_uploadBuffers[m_frame];
-
-        if (m_uploadBufferOffset + dataSize <= UPLOAD_BUFFER_SIZE && uploadBuffers.size() > m_uploadBufferIndex &&
-            uploadBuffers[m_uploadBufferIndex].allocation != nullptr)
+        if (dataSize <= UPLOAD_BUFFER_SIZE)
         {
-            const auto& uploadBuffer = uploadBuffers[m_uploadBufferIndex];
-
-            memcpy(uploadBuffer.memory + m_uploadBufferOffset, memory, dataSize);
+            const auto uploadAllocation = allocateUploadBuffer(dataSize, 1);
+            memcpy(uploadAllocation.memory, memory, dataSize);
 
-            executeCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+            recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
                 {
                     underlyingCommandList->CopyBufferRegion(
                         dstResource,
                         offset,
-                        uploadBuffer.allocation->GetResource(),
-                        m_uploadBufferOffset,
+                        uploadAllocation.resource,
+                        uploadAllocation.offset,
                         dataSize);
                 });
         }
         else
         {
-            auto& uploadBuffer = m_tempBuffers[m_frame].emplace_back();
+            ComPtr<D3D12MA::Allocation> uploadBuffer;
             createBuffer(D3D12_HEAP_TYPE_UPLOAD, dataSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, uploadBuffer);
 
             constexpr D3D12_RANGE readRange{};
@@ -94,7 +90,7 @@ void Device::writeBuffer(
             const D3D12_RANGE writtenRange{ 0, dataSize };
             uploadBuffer->GetResource()->Unmap(0, &writtenRange);
 
-            executeCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+            recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
                 {
                     underlyingCommandList->CopyBufferRegion(
                         dstResource,
@@ -103,11 +99,13 @@ void Device::writeBuffer(
                         0,
                         dataSize);
                 });
+
+            m_copyScheduler.addStaging(std::move(uploadBuffer));
         }
     }
 }
 
-D3D12_GPU_VIRTUAL_ADDRESS Device::createBuffer(const void* memory, uint32_t dataSize, uint32_t dataAlignment)
+UploadAllocation Device::allocateUploadBuffer(uint32_t dataSize, uint32_t dataAlignment)
 {
     assert(dataSize <= UPLOAD_BUFFER_SIZE);
 
@@ -159,13 +157,230 @@ D3D12_GPU_VIRTUAL_ADDRESS Device::createBuffer(const void* memory, uint32_t data
         assert(SUCCEEDED(hr) && uploadBuffer.memory != nullptr);
     }
 
-    memcpy(uploadBuffer.memory + m_uploadBufferOffset, memory, dataSize);
-    const D3D12_GPU_VIRTUAL_ADDRESS result = uploadBuffer.allocation->GetResource()->GetGPUVirtualAddress() + m_uploadBufferOffset;
+    UploadAllocation result;
+    result.resource = uploadBuffer.allocation->GetResource();
+    result.memory = uploadBuffer.memory + m_uploadBufferOffset;
+    result.offset = m_uploadBufferOffset;
+
     m_uploadBufferOffset += dataSize;
 
     return result;
 }
 
+D3D12_GPU_VIRTUAL_ADDRESS Device::createBuffer(const void* memory, uint32_t dataSize, uint32_t dataAlignment)
+{
+    const auto uploadAllocation = allocateUploadBuffer(dataSize, dataAlignment);
+    memcpy(uploadAllocation.memory, memory, dataSize);
+
+    return uploadAllocation.resource->GetGPUVirtualAddress() + uploadAllocation.offset;
+}
+
+void Device::submitCopyCommandList()
+{
+    if (m_copyScheduler.isRecording())
+        m_copyScheduler.submit(++m_fenceValue);
+}
+
+void Device::submitGraphicsCommandLists()
+{
+    m_segmentRecorder.submit([&](CommandList& commandList)
+        {
+            m_graphicsQueue.executeCommandList(commandList);
+        });
+}
+
+void Device::splitGraphicsCommandList()
+{
+    if (!m_passSegmenter.shouldSplit())
+        return;
+
+    // Copies go first so the queue waits for them before any segment that might read the loaded textures.
+    collectLoadedTextures();
+    submitCopyCommandList();
+    submitGraphicsCommandLists();
+
+    auto& commandList = getGraphicsCommandList();
+    m_passSegmenter.split();
+    commandList.split(getGraphicsCommandList());
+
+    m_segmentRecorder.push(commandList);
+
+    m_curPipeline = nullptr;
+
+    m_vertexBufferViewsFirst = 0;
+    m_vertexBufferViewsLast = _countof(m_vertexBufferViews) - 1;
+
+    m_dirtyFlags = ~0;
+
+    m_samplerDescsFirst = 0;
+    m_samplerDescsLast = _countof(m_samplerDescs) - 1;
+
+    setDescriptorHeaps();
+    invalidateRaytracingState();
+}
+
+void Device::collectLoadedTextures()
+{
+    m_textureLoader->collectLoadedTextures(m_loadedTextures);
+
+    for (auto& loadedTexture : m_loadedTextures)
+    {
+        auto& texture = m_textures[loadedTexture.textureId];
+
+        // Released while loading, possibly with the id reused since.
+        if (texture.loadTicket != loadedTexture.ticket)
+        {
+            m_tempBuffers[m_frame].emplace_back(std::move(loadedTexture.texture.allocation));
+            continue;
+        }
+
+        texture.allocation = std::move(loadedTexture.texture.allocation);
+        texture.loadTicket = 0;
+
+        // Nothing has referenced the view yet, so it can be written without waiting for the GPU.
+        const auto srvHandle = m_descriptorHeap.getCpuHandle(texture.srvIndex);
+
+        for (size_t i = 0; i < _countof(m_textureIds); i++)
+        {
+            if (m_textureIds[i] == loadedTexture.textureId)
+            {
+                m_globalsPS.textureIndices[i] = texture.srvIndex;
+                m_dirtyFlags |= DIRTY_FLAG_GLOBALS_PS;
+            }
+        }
+
+        if (texture.allocation == nullptr)
+        {
+            TextureLoader::createNullShaderResourceView(m_device.Get(), srvHandle);
+            continue;
+        }
+
+        const auto resource = texture.allocation->GetResource();
+
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc;
+        const bool result = TextureLoader::makeShaderResourceViewDesc(resource->GetDesc(), loadedTexture.texture.isCubeMap, srvDesc);
+        assert(result);
+
+        m_device->CreateShaderResourceView(resource, &srvDesc, srvHandle);
+
+        const auto& subResources = loadedTexture.texture.subResources;
+        if (subResources.empty())
+            continue;
+
+        const uint32_t intermediateSize = static_cast<uint32_t>(GetRequiredIntermediateSize(resource, 0, static_cast<UINT>(subResources.size())));
+
+        if (intermediateSize <= UPLOAD_BUFFER_SIZE)
+        {
+            const auto uploadAllocation = allocateUploadBuffer(intermediateSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+            recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+                {
+                    UpdateSubresources(
+                        underlyingCommandList,
+                        resource,
+                        uploadAllocation.resource,
+                        uploadAllocation.offset,
+                        0,
+                        static_cast<UINT>(subResources.size()),
+                        subResources.data());
+                });
+        }
+        else
+        {
+            ComPtr<D3D12MA::Allocation> uploadBuffer;
+
+            createBuffer(
+                D3D12_HEAP_TYPE_UPLOAD,
+                intermediateSize,
+                D3D12_RESOURCE_FLAG_NONE,
+                D3D12_RESOURCE_STATE_GENERIC_READ,
+                uploadBuffer);
+
+            recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+                {
+                    UpdateSubresources(
+                        underlyingCommandList,
+                        resource,
+                        uploadBuffer->GetResource(),
+                        0,
+                        0,
+                        static_cast<UINT>(subResources.size()),
+                        subResources.data());
+                });
+
+            m_copyScheduler.addStaging(std::move(uploadBuffer));
+        }
+    }
+
+    m_loadedTextures.clear();
+}
+
+uint32_t Device::getTextureSrvIndex(const Texture& texture) const
+{
+    return texture.loadTicket != 0 ? m_placeholderSrvIndex : texture.srvIndex;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS Device::updatePersistentBuffer(PersistentBuffer& buffer, const void* memory, uint32_t dataSize)
+{
+    if (buffer.byteSize < dataSize)
+    {
+        if (buffer.allocation != nullptr)
+            m_tempBuffers[m_frame].emplace_back(std::move(buffer.allocation));
+
+        buffer.byteSize = std::max(dataSize, buffer.byteSize * 2);
+
+        createBuffer(
+            D3D12_HEAP_TYPE_DEFAULT,
+            buffer.byteSize,
+            D3D12_RESOURCE_FLAG_NONE,
+            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+            buffer.allocation);
+
+        buffer.dirtyRanges.markAll(dataSize);
+    }
+
+    if (buffer.allocation == nullptr)
+        return NULL;
+
+    auto& commandList = getGraphicsCommandList();
+    const auto resource = buffer.allocation->GetResource();
+
+    bool transitioned = false;
+
+    for (auto [begin, end] : buffer.dirtyRanges.coalesce(dataSize))
+    {
+        while (begin < end)
+        {
+            if (!transitioned)
+            {
+                commandList.transitionBarrier(resource, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+                commandList.commitBarriers();
+                transitioned = true;
+            }
+
+            const uint32_t copySize = std::min(end - begin, UPLOAD_BUFFER_SIZE);
+            const auto uploadAllocation = allocateUploadBuffer(copySize, 1);
+            memcpy(uploadAllocation.memory, static_cast<const uint8_t*>(memory) + begin, copySize);
+
+            commandList.getUnderlyingCommandList()->CopyBufferRegion(
+                resource,
+                begin,
+                uploadAllocation.resource,
+                uploadAllocation.offset,
+                copySize);
+
+            begin += copySize;
+        }
+    }
+
+    if (transitioned)
+        commandList.transitionBarrier(resource, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+
+    buffer.dirtyRanges.clear();
+
+    return resource->GetGPUVirtualAddress();
+}
+
 void Device::setPrimitiveType(D3DPRIMITIVETYPE primitiveType)
 {
     D3D12_PRIMITIVE_TOPOLOGY primitiveTopology;
@@ -230,13 +445,12 @@ void Device::setDescriptorHeaps()
     m_dirtyFlags |= DIRTY_FLAG_ROOT_SIGNATURE;
 }
 
-void Device::flushGraphicsState()
+bool Device::flushGraphicsState()
 {
     auto& commandList = getGraphicsCommandList();
-    const auto underlyingCommandList = commandList.getUnderlyingCommandList();
 
     if (m_dirtyFlags & DIRTY_FLAG_ROOT_SIGNATURE)
-        underlyingCommandList->SetGraphicsRootSignature(m_rootSignature.Get());
+        commandList.setGraphicsRootSignature(m_rootSignature.Get());
 
     if (m_dirtyFlags & DIRTY_FLAG_RENDER_TARGET_AND_DEPTH_STENCIL)
     {
@@ -247,10 +461,9 @@ void Device::flushGraphicsState()
                 D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_DEPTH_READ);
         }
 
-        underlyingCommandList->OMSetRenderTargets(
+        commandList.omSetRenderTargets(
             m_pipelineDesc.NumRenderTargets,
-            m_pipelineDesc.NumRenderTargets != 0 ? m_renderTargetViews : nullptr,
-            FALSE,
+            m_renderTargetViews,
             m_depthStencilView.ptr != NULL ? &m_depthStencilView : nullptr);
     }
 
@@ -276,6 +489,8 @@ void Device::flushGraphicsState()
         m_pipelineDesc.InputLayout.NumElements = inputElementsSize;
     }
 
+    bool skipDraw = false;
+
     if (m_dirtyFlags & DIRTY_FLAG_PIPELINE_DESC)
     {
         if (m_depthStencilTexture != nullptr)
@@ -290,9 +505,11 @@ void Device::flushGraphicsState()
 
         if (m_vertexShaderId != NULL && !isFVF)
         {
-            const auto& vertexShader = m_vertexShaders[m_vertexShaderId];
+            auto& vertexShader = m_vertexShaders[m_vertexShaderId];
+            if (vertexShader.byteCode == nullptr)
+                vertexShader.byteCode = m_shaderCache->getConvertedShader(vertexShader.hash, vertexShader.byteSize);
 
-            m_pipelineDesc.VS.pShaderBytecode = vertexShader.byteCode.get();
+            m_pipelineDesc.VS.pShaderBytecode = vertexShader.byteCode;
             m_pipelineDesc.VS.BytecodeLength = vertexShader.byteSize;
         }
         else
@@ -303,9 +520,11 @@ void Device::flushGraphicsState()
 
         if (m_pixelShaderId != NULL)
         {
-            const auto& pixelShader = m_pixelShaders[m_pixelShaderId];
+            auto& pixelShader = m_pixelShaders[m_pixelShaderId];
+            if (pixelShader.byteCode == nullptr)
+                pixelShader.byteCode = m_shaderCache->getConvertedShader(pixelShader.hash, pixelShader.byteSize);
 
-            m_pipelineDesc.PS.pShaderBytecode = pixelShader.byteCode.get();
+            m_pipelineDesc.PS.pShaderBytecode = pixelShader.byteCode;
             m_pipelineDesc.PS.BytecodeLength = pixelShader.byteSize;
         }
         else
@@ -314,18 +533,37 @@ void Device::flushGraphicsState()
             m_pipelineDesc.PS.BytecodeLength = sizeof(FVFPixelShader);
         }
 
-        const XXH64_hash_t pipelineHash = XXH3_64bits(&m_pipelineDesc, sizeof(m_pipelineDesc));
-        auto& pipeline = m_pipelines[pipelineHash];
-        if (!pipeline)
-            m_device->CreateGraphicsPipelineState(&m_pipelineDesc, IID_PPV_ARGS(pipeline.GetAddressOf()));
+        // Shaders still converting in the background.
+        if (m_pipelineDesc.VS.pShaderBytecode == nullptr || m_pipelineDesc.PS.pShaderBytecode == nullptr)
+        {
+            skipDraw = true;
+            m_curPipeline = nullptr;
+        }
+        else
+        {
+            const XXH64_hash_t pipelineHash = XXH3_64bits(&m_pipelineDesc, sizeof(m_pipelineDesc));
+            auto& pipeline = m_pipelines[pipelineHash];
+            if (pipeline.pipeline == nullptr)
+            {
+                // Keep the key so draw calls skipped while compiling don't serialize the desc again.
+                if (pipeline.key == 0)
+                    pipeline.key = m_pipelineCache->addPipeline(m_pipelineDesc);
 
-        underlyingCommandList->SetPipelineState(pipeline.Get());
-        m_curPipeline = pipeline.Get();
+                pipeline.pipeline = m_pipelineCache->getPipeline(pipeline.key, m_asyncPipelineCompilation);
+            }
+
+            if (pipeline.pipeline != nullptr)
+                commandList.setPipelineState(pipeline.pipeline.Get());
+            else
+                skipDraw = true;
+
+            m_curPipeline = pipeline.pipeline.Get();
+        }
     }
 
     if (m_dirtyFlags & DIRTY_FLAG_GLOBALS_VS)
     {
-        underlyingCommandList->SetGraphicsRootConstantBufferView(0,
+        commandList.setGraphicsRootConstantBufferView(0,
             createBuffer(&m_globalsVS, sizeof(m_globalsVS), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT));
     }
 
@@ -367,15 +605,15 @@ void Device::flushGraphicsState()
 
     if (m_dirtyFlags & DIRTY_FLAG_GLOBALS_PS)
     {
-        underlyingCommandList->SetGraphicsRootConstantBufferView(1,
+        commandList.setGraphicsRootConstantBufferView(1,
             createBuffer(&m_globalsPS, sizeof(m_globalsPS), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT));
     }
 
     if (m_dirtyFlags & DIRTY_FLAG_VIEWPORT)
-        underlyingCommandList->RSSetViewports(1, &m_viewport);
+        commandList.rsSetViewports(1, &m_viewport);
 
     if (m_dirtyFlags & DIRTY_FLAG_SCISSOR_RECT)
-        underlyingCommandList->RSSetScissorRects(1, &m_scissorRect);
+        commandList.rsSetScissorRects(1, &m_scissorRect);
 
     if (m_dirtyFlags & DIRTY_FLAG_VERTEX_BUFFER_VIEWS)
     {
@@ -393,14 +631,14 @@ void Device::flushGraphicsState()
             numViews = m_vertexBufferViewsLast - m_vertexBufferViewsFirst + 1;
         }
 
-        underlyingCommandList->IASetVertexBuffers(startSlot, numViews, m_vertexBufferViews);
+        commandList.iaSetVertexBuffers(startSlot, numViews, m_vertexBufferViews);
     }
 
     if (m_dirtyFlags & DIRTY_FLAG_INDEX_BUFFER_VIEW)
-        underlyingCommandList->IASetIndexBuffer(&m_indexBufferView);
+        commandList.iaSetIndexBuffer(m_indexBufferView);
 
     if (m_dirtyFlags & DIRTY_FLAG_PRIMITIVE_TOPOLOGY)
-        underlyingCommandList->IASetPrimitiveTopology(m_primitiveTopology);
+        commandList.iaSetPrimitiveTopology(m_primitiveTopology);
 
     commandList.commitBarriers();
 
@@ -411,6 +649,14 @@ void Device::flushGraphicsState()
 
     m_samplerDescsFirst = ~0;
     m_samplerDescsLast = 0;
+
+    // Keep trying until the pipeline finishes compiling in the background.
+    if (skipDraw)
+        m_dirtyFlags |= DIRTY_FLAG_PIPELINE_DESC;
+    else
+        m_passSegmenter.addDraw();
+
+    return !skipDraw;
 }
 
 void Device::procMsgPadding()
@@ -665,13 +911,13 @@ void Device::procMsgCreatePixelShader()
     // Look for tone map placeholder GUID and replace with actual shader if detected.
     if (message.dataSize == sizeof(s_toneMapPixelShaderGuid) && memcmp(message.data, s_toneMapPixelShaderGuid, message.dataSize) == 0)
     {
-        pixelShader.byteCode = std::make_unique<uint8_t[]>(sizeof(ToneMapPixelShader));
-        memcpy(pixelShader.byteCode.get(), ToneMapPixelShader, sizeof(ToneMapPixelShader));
+        pixelShader.byteCode = ToneMapPixelShader;
         pixelShader.byteSize = sizeof(ToneMapPixelShader);
     }
     else
     {
-        pixelShader.byteCode = m_shaderCache->getShader(message.data, message.dataSize, pixelShader.byteSize);
+        pixelShader.byteCode = m_shaderCache->getShader(message.data, message.dataSize,
+            pixelShader.hash, pixelShader.byteSize, m_asyncPipelineCompilation);
     }
 }
 
@@ -683,7 +929,8 @@ void Device::procMsgCreateVertexShader()
         m_vertexShaders.resize(message.vertexShaderId + 1);
 
     auto& vertexShader = m_vertexShaders[message.vertexShaderId];
-    vertexShader.byteCode = m_shaderCache->getShader(message.data, message.dataSize, vertexShader.byteSize);
+    vertexShader.byteCode = m_shaderCache->getShader(message.data, message.dataSize,
+        vertexShader.hash, vertexShader.byteSize, m_asyncPipelineCompilation);
 }
 
 static constexpr size_t GLOBALS_VS_UNUSED_CONSTANT = 196;
@@ -914,7 +1161,7 @@ void Device::procMsgSetTexture()
                 m_descriptorHeap.getCpuHandle(texture.srvIndex));
         }
 
-        assert(texture.allocation != nullptr);
+        assert(texture.allocation != nullptr || texture.loadTicket != 0);
         auto& commandList = getGraphicsCommandList();
 
         if (texture.rtvIndex != NULL)
@@ -928,10 +1175,12 @@ void Device::procMsgSetTexture()
                 D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
         }
 
-        if (m_globalsPS.textureIndices[message.stage] != texture.srvIndex)
+        const uint32_t srvIndex = getTextureSrvIndex(texture);
+
+        if (m_globalsPS.textureIndices[message.stage] != srvIndex)
             m_dirtyFlags |= DIRTY_FLAG_GLOBALS_PS;
 
-        m_globalsPS.textureIndices[message.stage] = texture.srvIndex;
+        m_globalsPS.textureIndices[message.stage] = srvIndex;
     }
     else
     {
@@ -941,6 +1190,8 @@ void Device::procMsgSetTexture()
         m_globalsPS.textureIndices[message.stage] = NULL;
     }
 
+    m_textureIds[message.stage] = message.textureId;
+
     auto& samplerDesc = m_samplerDescs[message.stage];
     const auto filter = (samplerDesc.Filter & ~0x80) | (isShadowMap ? 0x80 : 0x00); // comparison filter
     const auto comparisonFunc = isShadowMap ? D3D12_COMPARISON_FUNC_LESS_EQUAL : D3D12_COMPARISON_FUNC_NONE;
@@ -1010,7 +1261,6 @@ void Device::procMsgClear()
     const auto& message = m_messageReceiver.getMessage<MsgClear>();
 
     auto& commandList = getGraphicsCommandList();
-    const auto underlyingCommandList = commandList.getUnderlyingCommandList();
 
     if ((message.flags & (D3DCLEAR_ZBUFFER | D3DCLEAR_STENCIL)) && m_depthStencilTexture != nullptr)
     {
@@ -1031,7 +1281,7 @@ void Device::procMsgClear()
         for (const auto& renderTargetView : m_renderTargetViews)
         {
             if (renderTargetView.ptr != NULL)
-                underlyingCommandList->ClearRenderTargetView(renderTargetView, color, 0, nullptr);
+                commandList.clearRenderTargetView(renderTargetView, color);
         }
     }
 
@@ -1045,8 +1295,8 @@ void Device::procMsgClear()
         if (message.flags & D3DCLEAR_STENCIL)
             clearFlag |= D3D12_CLEAR_FLAG_STENCIL;
 
-        underlyingCommandList->ClearDepthStencilView(m_depthStencilView,
-            static_cast<D3D12_CLEAR_FLAGS>(clearFlag), message.z, message.stencil, 0, nullptr);
+        commandList.clearDepthStencilView(m_depthStencilView,
+            static_cast<D3D12_CLEAR_FLAGS>(clearFlag), message.z, message.stencil);
     }
 }
 
@@ -1255,9 +1505,10 @@ void Device::procMsgDrawPrimitiveUP()
     m_vertexBufferViewsFirst = 0;
 
     setPrimitiveType(static_cast<D3DPRIMITIVETYPE>(message.primitiveType));
-    flushGraphicsState();
+    if (!flushGraphicsState())
+        return;
 
-    getUnderlyingGraphicsCommandList()->DrawInstanced(message.vertexCount, m_instanceCount, 0, 0);
+    getGraphicsCommandList().drawInstanced(message.vertexCount, m_instanceCount, 0, 0);
 }
 
 void Device::procMsgSetStreamSource()
@@ -1360,6 +1611,11 @@ void Device::procMsgPresent()
     m_samplerDescsFirst = 0;
     m_samplerDescsLast = _countof(m_samplerDescs) - 1;
 
+    // Textures still loading keep their placeholder for another frame.
+    collectLoadedTextures();
+    submitCopyCommandList();
+    submitGraphicsCommandLists();
+
     m_fenceValues[m_frame] = ++m_fenceValue;
 
     auto& graphicsCommandList = getGraphicsCommandList();
@@ -1368,9 +1624,11 @@ void Device::procMsgPresent()
     m_graphicsQueue.executeCommandList(graphicsCommandList);
     m_graphicsQueue.signal(m_fenceValue);
     m_swapChain.present();
+    m_messageReceiver.signalFrame();
 
     m_frame = m_nextFrame;
     m_nextFrame = (m_frame + 1) % NUM_FRAMES;
+    m_passSegmenter.reset();
 
     if (m_fenceValues[m_frame] > 1)
     {
@@ -1393,6 +1651,7 @@ void Device::procMsgPresent()
 
     m_tempTextures[m_frame].clear();
     m_tempBuffers[m_frame].clear();
+    m_copyScheduler.retire();
 
     for (const auto id : m_tempDescriptorIds[m_frame])
         m_descriptorHeap.free(id);
@@ -1484,11 +1743,13 @@ void Device::procMsgWriteVertexBuffer()
     }
 
     writeBuffer(
-        message.data,
+        m_messageReceiver.getBulkData(message.bulkOffset),
         message.offset, 
-        message.dataSize,
+        message.bulkSize,
         vertexBuffer.allocation->GetResource(),
         m_gpuUploadHeapSupported);
+
+    m_messageReceiver.releaseBulkData(message.bulkOffset);
 }
 
 void Device::procMsgCreateIndexBuffer()
@@ -1565,11 +1826,13 @@ void Device::procMsgWriteIndexBuffer()
     }
 
     writeBuffer(
-        message.data,
+        m_messageReceiver.getBulkData(message.bulkOffset),
         message.offset,
-        message.dataSize,
+        message.bulkSize,
         indexBuffer.allocation->GetResource(),
         m_gpuUploadHeapSupported);
+
+    m_messageReceiver.releaseBulkData(message.bulkOffset);
 }
 
 void Device::procMsgWriteTexture()
@@ -1582,19 +1845,16 @@ void Device::procMsgWriteTexture()
     D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint{};
     footprint.Footprint = CD3DX12_SUBRESOURCE_FOOTPRINT(texture.format, message.width, message.height, 1, message.pitch);
 
-    const auto& uploadBuffers = m_uploadBuffers[m_frame];
-
-    if (m_uploadBufferOffset + message.dataSize <= UPLOAD_BUFFER_SIZE && uploadBuffers.size() > m_uploadBufferIndex &&
-        uploadBuffers[m_uploadBufferIndex].allocation != nullptr)
+    if (message.bulkSize <= UPLOAD_BUFFER_SIZE)
     {
-        const auto& uploadBuffer = uploadBuffers[m_uploadBufferIndex];
+        const auto uploadAllocation = allocateUploadBuffer(message.bulkSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
 
-        memcpy(uploadBuffer.memory + m_uploadBufferOffset, message.data, message.dataSize);
-        footprint.Offset = m_uploadBufferOffset;
+        memcpy(uploadAllocation.memory, m_messageReceiver.getBulkData(message.bulkOffset), message.bulkSize);
+        footprint.Offset = uploadAllocation.offset;
 
-        const CD3DX12_TEXTURE_COPY_LOCATION srcLocation(uploadBuffer.allocation->GetResource(), footprint);
+        const CD3DX12_TEXTURE_COPY_LOCATION srcLocation(uploadAllocation.resource, footprint);
 
-        executeCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+        recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
             {
                 underlyingCommandList->CopyTextureRegion(
                     &dstLocation,
@@ -1607,8 +1867,8 @@ void Device::procMsgWriteTexture()
     }
     else
     {
-        auto& uploadBuffer = m_tempBuffers[m_frame].emplace_back();
-        createBuffer(D3D12_HEAP_TYPE_UPLOAD, message.dataSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, uploadBuffer);
+        ComPtr<D3D12MA::Allocation> uploadBuffer;
+        createBuffer(D3D12_HEAP_TYPE_UPLOAD, message.bulkSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, uploadBuffer);
 
         constexpr D3D12_RANGE readRange{};
         void* mappedData = nullptr;
@@ -1616,13 +1876,13 @@ void Device::procMsgWriteTexture()
         const HRESULT hr = uploadBuffer->GetResource()->Map(0, &readRange, &mappedData);
         assert(SUCCEEDED(hr) && mappedData != nullptr);
 
-        memcpy(mappedData, message.data, message.dataSize);
+        memcpy(mappedData, m_messageReceiver.getBulkData(message.bulkOffset), message.bulkSize);
 
         uploadBuffer->GetResource()->Unmap(0, nullptr);
 
         const CD3DX12_TEXTURE_COPY_LOCATION srcLocation(uploadBuffer->GetResource(), footprint);
 
-        executeCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+        recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
             {
                 underlyingCommandList->CopyTextureRegion(
                     &dstLocation,
@@ -1632,209 +1892,182 @@ void Device::procMsgWriteTexture()
                     &srcLocation,
                     nullptr);
             });
+
+        m_copyScheduler.addStaging(std::move(uploadBuffer));
     }
+
+    m_messageReceiver.releaseBulkData(message.bulkOffset);
 }
 
-void Device::procMsgMakeTexture()
+void Device::procMsgBeginMakeTexture()
 {
-    const auto& message = m_messageReceiver.getMessage<MsgMakeTexture>();
+    const auto& message = m_messageReceiver.getMessage<MsgBeginMakeTexture>();
 
-    if (m_textures.size() <= message.textureId)
-        m_textures.resize(message.textureId + 1);
+    auto& streamedTexture = m_streamedTextures[message.textureId];
+    assert(streamedTexture.allocation == nullptr);
 
-    auto& texture = m_textures[message.textureId];
+    const bool result = streamedTexture.layout.parse(message.data, message.dataSize);
+    assert(result);
 
-    std::vector<D3D12_SUBRESOURCE_DATA> subResources;
-    bool isCubeMap = false;
+    const auto& layout = streamedTexture.layout;
 
-    assert(texture.allocation == nullptr);
+    const auto resourceDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+        static_cast<DXGI_FORMAT>(layout.getFormat()),
+        layout.getWidth(),
+        layout.getHeight(),
+        static_cast<UINT16>(layout.getArraySize()),
+        static_cast<UINT16>(layout.getMipLevels()));
 
-    HRESULT hr = DirectX::LoadDDSTextureFromMemory(
-        m_device.Get(),
-        m_allocator.Get(),
-        message.data,
-        message.dataSize,
-        m_gpuUploadHeapSupported ? D3D12_HEAP_TYPE_GPU_UPLOAD : D3D12_HEAP_TYPE_DEFAULT,
-        nullptr,
-        texture.allocation.GetAddressOf(),
-        subResources,
-        0,
+    // Chunks get written directly into the texture when the upload heap is available, otherwise copied into it.
+    D3D12MA::ALLOCATION_DESC allocDesc{};
+    allocDesc.HeapType = m_gpuUploadHeapSupported ? D3D12_HEAP_TYPE_GPU_UPLOAD : D3D12_HEAP_TYPE_DEFAULT;
+
+    const HRESULT hr = m_allocator->CreateResource(
+        &allocDesc,
+        &resourceDesc,
+        D3D12_RESOURCE_STATE_COMMON,
         nullptr,
-        &isCubeMap);
+        streamedTexture.allocation.GetAddressOf(),
+        IID_ID3D12Resource,
+        nullptr);
 
-    if (FAILED(hr) || texture.allocation == nullptr)
-        return;
+    assert(SUCCEEDED(hr) && streamedTexture.allocation != nullptr);
+}
+
+void Device::procMsgWriteMakeTextureChunk()
+{
+    const auto& message = m_messageReceiver.getMessage<MsgWriteMakeTextureChunk>();
+
+    const auto& streamedTexture = m_streamedTextures[message.textureId];
+    const auto& layout = streamedTexture.layout;
+    const auto& subresource = layout.getSubresources()[message.subresource];
+
+    const uint32_t rowCount = message.bulkSize / subresource.rowPitch;
+    assert(message.row + rowCount <= subresource.rowCount);
+
+    const uint32_t top = message.row * layout.getBlockSize();
+    const uint8_t* bulkData = m_messageReceiver.getBulkData(message.bulkOffset);
+    const auto resource = streamedTexture.allocation->GetResource();
 
     if (m_gpuUploadHeapSupported)
     {
-        for (uint32_t i = 0; i < subResources.size(); i++)
-        {
-            constexpr D3D12_RANGE readRange{};
-            hr = texture.allocation->GetResource()->Map(i, &readRange, nullptr);
-            assert(SUCCEEDED(hr));
-
-            auto& subResource = subResources[i];
-            hr = texture.allocation->GetResource()->WriteToSubresource(
-                i, 
-                nullptr,
-                subResource.pData, 
-                static_cast<uint32_t>(subResource.RowPitch), 
-                static_cast<uint32_t>(subResource.SlicePitch));
+        constexpr D3D12_RANGE readRange{};
+        HRESULT hr = resource->Map(message.subresource, &readRange, nullptr);
+        assert(SUCCEEDED(hr));
 
-            assert(SUCCEEDED(hr));
+        const D3D12_BOX box{ 0, top, 0, subresource.width, std::min(top + rowCount * layout.getBlockSize(), subresource.height), 1 };
+        hr = resource->WriteToSubresource(message.subresource, &box, bulkData, subresource.rowPitch, message.bulkSize);
+        assert(SUCCEEDED(hr));
 
-            texture.allocation->GetResource()->Unmap(i, nullptr);
-        }
+        resource->Unmap(message.subresource, nullptr);
     }
     else
     {
-        const auto& uploadBuffers = m_uploadBuffers[m_frame];
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint{};
+        footprint.Footprint = CD3DX12_SUBRESOURCE_FOOTPRINT(
+            static_cast<DXGI_FORMAT>(layout.getFormat()),
+            alignUp(subresource.width, layout.getBlockSize()),
+            rowCount * layout.getBlockSize(),
+            1,
+            alignUp<uint32_t>(subresource.rowPitch, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
 
-        uint32_t uploadBufferOffset = alignUp<uint32_t>(m_uploadBufferOffset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-        uint32_t intermediateSize = static_cast<uint32_t>(GetRequiredIntermediateSize(texture.allocation->GetResource(), 0, static_cast<UINT>(subResources.size())));
+        const uint32_t uploadSize = footprint.Footprint.RowPitch * rowCount;
+        ComPtr<D3D12MA::Allocation> uploadBuffer;
+        ID3D12Resource* uploadResource;
+        uint8_t* uploadMemory;
 
-        if (uploadBufferOffset + intermediateSize <= UPLOAD_BUFFER_SIZE && uploadBuffers.size() > m_uploadBufferIndex &&
-            uploadBuffers[m_uploadBufferIndex].allocation != nullptr)
+        if (uploadSize <= UPLOAD_BUFFER_SIZE)
         {
-            const auto& uploadBuffer = uploadBuffers[m_uploadBufferIndex];
-
-            executeCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
-                {
-                    UpdateSubresources(
-                        underlyingCommandList,
-                        texture.allocation->GetResource(),
-                        uploadBuffers[m_uploadBufferIndex].allocation->GetResource(),
-                        uploadBufferOffset,
-                        0,
-                        static_cast<UINT>(subResources.size()),
-                        subResources.data());
-                });
+            const auto uploadAllocation = allocateUploadBuffer(uploadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+            uploadResource = uploadAllocation.resource;
+            uploadMemory = static_cast<uint8_t*>(uploadAllocation.memory);
+            footprint.Offset = uploadAllocation.offset;
         }
         else
         {
-            auto& uploadBuffer = m_tempBuffers[m_frame].emplace_back();
+            createBuffer(D3D12_HEAP_TYPE_UPLOAD, uploadSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, uploadBuffer);
 
-            createBuffer(
-                D3D12_HEAP_TYPE_UPLOAD,
-                intermediateSize,
-                D3D12_RESOURCE_FLAG_NONE,
-                D3D12_RESOURCE_STATE_GENERIC_READ,
-                uploadBuffer);
+            constexpr D3D12_RANGE readRange{};
+            void* mappedData = nullptr;
 
-            executeCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
-                {
-                    UpdateSubresources(
-                        underlyingCommandList,
-                        texture.allocation->GetResource(),
-                        uploadBuffer->GetResource(),
-                        0,
-                        0,
-                        static_cast<UINT>(subResources.size()),
-                        subResources.data());
-                });
+            const HRESULT hr = uploadBuffer->GetResource()->Map(0, &readRange, &mappedData);
+            assert(SUCCEEDED(hr) && mappedData != nullptr);
+
+            uploadResource = uploadBuffer->GetResource();
+            uploadMemory = static_cast<uint8_t*>(mappedData);
         }
-    }
 
-    const auto resourceDesc = texture.allocation->GetResource()->GetDesc();
+        for (uint32_t i = 0; i < rowCount; i++)
+            memcpy(uploadMemory + i * footprint.Footprint.RowPitch, bulkData + i * subresource.rowPitch, subresource.rowPitch);
 
-    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc;
-    srvDesc.Format = resourceDesc.Format;
-    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        if (uploadSize > UPLOAD_BUFFER_SIZE)
+            uploadResource->Unmap(0, nullptr);
 
-    switch (resourceDesc.Dimension)
-    {
-    case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
-        assert(!isCubeMap);
+        const CD3DX12_TEXTURE_COPY_LOCATION srcLocation(uploadResource, footprint);
+        const CD3DX12_TEXTURE_COPY_LOCATION dstLocation(resource, message.subresource);
 
-        srvDesc.ViewDimension = resourceDesc.DepthOrArraySize > 1 ? D3D12_SRV_DIMENSION_TEXTURE1DARRAY : D3D12_SRV_DIMENSION_TEXTURE1D;
+        recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+            {
+                underlyingCommandList->CopyTextureRegion(
+                    &dstLocation,
+                    0,
+                    top,
+                    0,
+                    &srcLocation,
+                    nullptr);
+            });
 
-        if (srvDesc.ViewDimension == D3D12_SRV_DIMENSION_TEXTURE1DARRAY)
-        {
-            srvDesc.Texture1DArray.MostDetailedMip = 0;
-            srvDesc.Texture1DArray.MipLevels = resourceDesc.MipLevels;
-            srvDesc.Texture1DArray.FirstArraySlice = 0;
-            srvDesc.Texture1DArray.ArraySize = resourceDesc.DepthOrArraySize;
-            srvDesc.Texture1DArray.ResourceMinLODClamp = 0.0f;
-        }
-        else
-        {
-            srvDesc.Texture1D.MostDetailedMip = 0;
-            srvDesc.Texture1D.MipLevels = resourceDesc.MipLevels;
-            srvDesc.Texture1D.ResourceMinLODClamp = 0.0f;
-        }
+        if (uploadBuffer != nullptr)
+            m_copyScheduler.addStaging(std::move(uploadBuffer));
+    }
 
-        break;
+    m_messageReceiver.releaseBulkData(message.bulkOffset);
+}
 
-    case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
-        if (isCubeMap)
-        {
-            srvDesc.ViewDimension = resourceDesc.DepthOrArraySize > 6 ? D3D12_SRV_DIMENSION_TEXTURECUBEARRAY : D3D12_SRV_DIMENSION_TEXTURECUBE;
+void Device::procMsgMakeTexture()
+{
+    const auto& message = m_messageReceiver.getMessage<MsgMakeTexture>();
 
-            if (srvDesc.ViewDimension == D3D12_SRV_DIMENSION_TEXTURECUBEARRAY)
-            {
-                srvDesc.TextureCubeArray.MostDetailedMip = 0;
-                srvDesc.TextureCubeArray.MipLevels = resourceDesc.MipLevels;
-                srvDesc.TextureCubeArray.First2DArrayFace = 0;
-                srvDesc.TextureCubeArray.NumCubes = resourceDesc.DepthOrArraySize / 6;
-                srvDesc.TextureCubeArray.ResourceMinLODClamp = 0.0f;
-            }
-            else
-            {
-                srvDesc.TextureCube.MostDetailedMip = 0;
-                srvDesc.TextureCube.MipLevels = resourceDesc.MipLevels;
-                srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
-            }
-        }
-        else
-        {
-            srvDesc.ViewDimension = resourceDesc.DepthOrArraySize > 1 ? D3D12_SRV_DIMENSION_TEXTURE2DARRAY : D3D12_SRV_DIMENSION_TEXTURE2D;
+    if (m_textures.size() <= message.textureId)
+        m_textures.resize(message.textureId + 1);
 
-            if (srvDesc.ViewDimension == D3D12_SRV_DIMENSION_TEXTURE2DARRAY)
-            {
-                srvDesc.Texture2DArray.MostDetailedMip = 0;
-                srvDesc.Texture2DArray.MipLevels = resourceDesc.MipLevels;
-                srvDesc.Texture2DArray.FirstArraySlice = 0;
-                srvDesc.Texture2DArray.ArraySize = resourceDesc.DepthOrArraySize;
-                srvDesc.Texture2DArray.PlaneSlice = 0;
-                srvDesc.Texture2DArray.ResourceMinLODClamp = 0.0f;
-            }
-            else
-            {
-                srvDesc.Texture2D.MostDetailedMip = 0;
-                srvDesc.Texture2D.MipLevels = resourceDesc.MipLevels;
-                srvDesc.Texture2D.PlaneSlice = 0;
-                srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-            }
-        }
+    auto& texture = m_textures[message.textureId];
 
-        break;
+    assert(texture.allocation == nullptr && texture.loadTicket == 0);
 
-    case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
-        assert(!isCubeMap);
+    texture.srvIndex = m_descriptorHeap.allocate();
 
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
-        srvDesc.Texture3D.MostDetailedMip = 0;
-        srvDesc.Texture3D.MipLevels = resourceDesc.MipLevels;
-        srvDesc.Texture3D.ResourceMinLODClamp = 0.0f;
-        break;
+    // Every chunk has been recorded already, which the copy queue finishes before anything samples the texture.
+    if (message.bulkSize == 0)
+    {
+        const auto findResult = m_streamedTextures.find(message.textureId);
+        assert(findResult != m_streamedTextures.end());
 
-    default: 
-        assert(false);
-        break;
-    }
+        texture.allocation = std::move(findResult->second.allocation);
+        const auto resource = texture.allocation->GetResource();
 
-    texture.srvIndex = m_descriptorHeap.allocate();
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc;
+        const bool result = TextureLoader::makeShaderResourceViewDesc(resource->GetDesc(), findResult->second.layout.isCubeMap(), srvDesc);
+        assert(result);
 
-    m_device->CreateShaderResourceView(
-        texture.allocation->GetResource(),
-        &srvDesc,
-        m_descriptorHeap.getCpuHandle(texture.srvIndex));
+        m_device->CreateShaderResourceView(resource, &srvDesc, m_descriptorHeap.getCpuHandle(texture.srvIndex));
 
 #ifdef _DEBUG
-    wchar_t name[0x100];
-    MultiByteToWideChar(CP_UTF8, 0, message.textureName, -1, name, _countof(name));
-    texture.allocation->GetResource()->SetName(name);
+        wchar_t name[0x100];
+        MultiByteToWideChar(CP_UTF8, 0, message.textureName, -1, name, _countof(name));
+        resource->SetName(name);
 #endif
+        m_streamedTextures.erase(findResult);
+        return;
+    }
+
+    const uint8_t* bulkData = m_messageReceiver.getBulkData(message.bulkOffset);
+    std::vector<uint8_t> data(bulkData, bulkData + message.bulkSize);
+
+    m_messageReceiver.releaseBulkData(message.bulkOffset);
+
+    // The view gets written once the texture is collected, until then bindings use the placeholder.
+    texture.loadTicket = m_textureLoader->loadTexture(message.textureId, std::move(data), message.textureName);
 }
 
 void Device::procMsgDrawIndexedPrimitive()
@@ -1842,9 +2075,10 @@ void Device::procMsgDrawIndexedPrimitive()
     const auto& message = m_messageReceiver.getMessage<MsgDrawIndexedPrimitive>();
 
     setPrimitiveType(static_cast<D3DPRIMITIVETYPE>(message.primitiveType));
-    flushGraphicsState();
+    if (!flushGraphicsState())
+        return;
 
-    getUnderlyingGraphicsCommandList()->DrawIndexedInstanced(
+    getGraphicsCommandList().drawIndexedInstanced(
         message.indexCount,
         m_instanceCount,
         message.startIndex,
@@ -1874,6 +2108,9 @@ void Device::procMsgReleaseResource()
     switch (message.resourceType)
     {
     case MsgReleaseResource::ResourceType::Texture:
+        if (m_textures[message.resourceId].loadTicket != 0)
+            m_textureLoader->cancel(m_textures[message.resourceId].loadTicket);
+
         m_tempTextures[m_frame].push_back(m_textures[message.resourceId]);
         m_textures[message.resourceId] = {};
         break;
@@ -1919,9 +2156,10 @@ void Device::procMsgDrawPrimitive()
     const auto& message = m_messageReceiver.getMessage<MsgDrawPrimitive>();
 
     setPrimitiveType(static_cast<D3DPRIMITIVETYPE>(message.primitiveType));
-    flushGraphicsState();
+    if (!flushGraphicsState())
+        return;
 
-    getUnderlyingGraphicsCommandList()->DrawInstanced(
+    getGraphicsCommandList().drawInstanced(
         message.vertexCount,
         m_instanceCount,
         message.startVertex,
@@ -1932,7 +2170,7 @@ void Device::procMsgCopyVertexBuffer()
 {
     const auto& message = m_messageReceiver.getMessage<MsgCopyVertexBuffer>();
 
-    executeCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
+    recordCopyCommandList([&](ID3D12GraphicsCommandList4* underlyingCommandList)
         {
             underlyingCommandList->CopyBufferRegion(
                 m_vertexBuffers[message.dstVertexBufferId].allocation->GetResource(),
@@ -1961,11 +2199,10 @@ void Device::procMsgSaveShaderCache()
 {
     const auto& message = m_messageReceiver.getMessage<MsgSaveShaderCache>();
 
-    if (m_shaderCache != nullptr)
-    {
-        m_shaderCache->saveShaderCache();
-        m_shaderCache = nullptr;
-    }
+    m_shaderCache->saveShaderCache();
+
+    if (m_pipelineCache != nullptr)
+        m_pipelineCache->savePipelineCache();
 }
 
 void Device::procMsgDrawIndexedPrimitiveUP()
@@ -1987,9 +2224,10 @@ void Device::procMsgDrawIndexedPrimitiveUP()
     m_dirtyFlags |= DIRTY_FLAG_INDEX_BUFFER_VIEW;
 
     setPrimitiveType(static_cast<D3DPRIMITIVETYPE>(message.primitiveType));
-    flushGraphicsState();
+    if (!flushGraphicsState())
+        return;
 
-    getUnderlyingGraphicsCommandList()->DrawIndexedInstanced(message.indexCount, m_instanceCount, 0, 0, 0);
+    getGraphicsCommandList().drawIndexedInstanced(message.indexCount, m_instanceCount, 0, 0, 0);
 }
 
 void Device::procMsgShowCursor()
@@ -2003,20 +2241,19 @@ void Device::procMsgCopyHdrTexture()
     const auto& message = m_messageReceiver.getMessage<MsgCopyHdrTexture>();
 
     auto& commandList = getGraphicsCommandList();
-    const auto underlyingCommandList = commandList.getUnderlyingCommandList();
 
     commandList.commitBarriers();
 
     const D3D12_RECT scissorRect = { 0, 0, static_cast<LONG>(m_viewport.Width), static_cast<LONG>(m_viewport.Height) };
 
-    underlyingCommandList->OMSetRenderTargets(1, m_renderTargetViews, FALSE, nullptr);
-    underlyingCommandList->SetGraphicsRootSignature(m_copyHdrTextureRootSignature.Get());
-    underlyingCommandList->SetGraphicsRootDescriptorTable(0, m_descriptorHeap.getGpuHandle(m_globalsPS.textureIndices[0]));
-    underlyingCommandList->SetPipelineState(m_copyHdrTexturePipeline.Get());
-    underlyingCommandList->RSSetScissorRects(1, &scissorRect);
-    underlyingCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    commandList.omSetRenderTargets(1, m_renderTargetViews, nullptr);
+    commandList.setGraphicsRootSignature(m_copyHdrTextureRootSignature.Get());
+    commandList.setGraphicsRootDescriptorTable(0, m_descriptorHeap.getGpuHandle(m_globalsPS.textureIndices[0]));
+    commandList.setPipelineState(m_copyHdrTexturePipeline.Get());
+    commandList.rsSetScissorRects(1, &scissorRect);
+    commandList.iaSetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-    underlyingCommandList->DrawInstanced(3, 1, 0, 0);
+    commandList.drawInstanced(3, 1, 0, 0);
 }
 
 Device::Device(const IniFile& iniFile)
@@ -2110,7 +2347,8 @@ Device::Device(const IniFile& iniFile)
 
     D3D12MA::ALLOCATOR_DESC desc{};
 
-    desc.Flags = D3D12MA::ALLOCATOR_FLAG_SINGLETHREADED | D3D12MA::ALLOCATOR_FLAG_DEFAULT_POOLS_NOT_ZEROED | 
+    // Not single threaded, the texture loader threads create their resources through it too.
+    desc.Flags = D3D12MA::ALLOCATOR_FLAG_DEFAULT_POOLS_NOT_ZEROED | 
         D3D12MA::ALLOCATOR_FLAG_DONT_PREFER_SMALL_BUFFERS_COMMITTED | D3D12MA::ALLOCATOR_FLAG_MSAA_TEXTURES_ALWAYS_COMMITTED;
 
     // Disable tight alignment if GPU upload heap is not supported. This is a temporary workaround for several D3D12 functions not supporting explicit alignment.
@@ -2124,14 +2362,22 @@ Device::Device(const IniFile& iniFile)
 
     assert(SUCCEEDED(hr) && m_allocator != nullptr);
 
+    m_textureLoader = std::make_unique<TextureLoader>(m_device.Get(), m_allocator.Get(), m_gpuUploadHeapSupported);
+
     m_graphicsQueue.init(m_device.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT);
     m_copyQueue.init(m_device.Get(), D3D12_COMMAND_LIST_TYPE_COPY);
 
-    for (auto& graphicsCommandList : m_graphicsCommandLists)
-        graphicsCommandList.init(m_device.Get(), m_graphicsQueue);
+    for (auto& graphicsCommandLists : m_graphicsCommandLists)
+    {
+        for (auto& graphicsCommandList : graphicsCommandLists)
+            graphicsCommandList.init(m_device.Get(), m_graphicsQueue);
+    }
 
-    for (auto& copyCommandList : m_copyCommandLists)
-        copyCommandList.init(m_device.Get(), m_copyQueue);
+    for (auto& copyCommandLists : m_copyCommandLists)
+    {
+        for (auto& copyCommandList : copyCommandLists)
+            copyCommandList.init(m_device.Get(), m_copyQueue);
+    }
 
     for (auto& fenceValue : m_fenceValues)
         fenceValue = m_fenceValue;
@@ -2141,10 +2387,16 @@ Device::Device(const IniFile& iniFile)
     m_rtvDescriptorHeap.init(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
     m_dsvDescriptorHeap.init(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 
+    // Bound in place of textures that are still loading.
+    m_placeholderSrvIndex = m_descriptorHeap.allocate();
+    TextureLoader::createNullShaderResourceView(m_device.Get(), m_descriptorHeap.getCpuHandle(m_placeholderSrvIndex));
+
     CD3DX12_ROOT_PARAMETER1 rootParams[2];
     rootParams[0].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC, D3D12_SHADER_VISIBILITY_VERTEX);
     rootParams[1].InitAsConstantBufferView(1, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC, D3D12_SHADER_VISIBILITY_PIXEL);
 
+    XXH64_hash_t rootSignatureHash = 0;
+
     RootSignature::create(
         m_device.Get(),
         rootParams,
@@ -2154,7 +2406,7 @@ Device::Device(const IniFile& iniFile)
         D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |
         D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED |
         D3D12_ROOT_SIGNATURE_FLAG_SAMPLER_HEAP_DIRECTLY_INDEXED,
-        m_rootSignature, "main");
+        m_rootSignature, "main", &rootSignatureHash);
 
     m_pipelineDesc.pRootSignature = m_rootSignature.Get();
     m_pipelineDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
@@ -2166,6 +2418,9 @@ Device::Device(const IniFile& iniFile)
     m_pipelineDesc.NumRenderTargets = 1;
     m_pipelineDesc.SampleDesc.Count = 1;
 
+    m_pipelineCache = std::make_unique<PipelineCache>(m_device.Get(), m_rootSignature.Get(), rootSignatureHash);
+    m_asyncPipelineCompilation = iniFile.getBool("Mod", "AsyncPipelineCompilation", true);
+
     for (auto& samplerDesc : m_samplerDescs)
     {
         samplerDesc.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
@@ -2246,6 +2501,66 @@ void Device::beginCommandList()
     setDescriptorHeaps();
 }
 
+void Device::processMessage()
+{
+    if (PassSegmenter::isPassBoundary(m_messageReceiver.getId()))
+        splitGraphicsCommandList();
+
+    switch (m_messageReceiver.getId())
+    {
+    default:
+        if (!processRaytracingMessage())
+            assert(!"Unknown message type");
+        break;
+
+    case MsgPadding::s_id: procMsgPadding(); break;
+    case MsgCreateSwapChain::s_id: procMsgCreateSwapChain(); break;
+    case MsgSetRenderTarget::s_id: procMsgSetRenderTarget(); break;
+    case MsgCreateVertexDeclaration::s_id: procMsgCreateVertexDeclaration(); break;
+    case MsgCreatePixelShader::s_id: procMsgCreatePixelShader(); break;
+    case MsgCreateVertexShader::s_id: procMsgCreateVertexShader(); break;
+    case MsgSetRenderState::s_id: procMsgSetRenderState(); break;
+    case MsgCreateTexture::s_id: procMsgCreateTexture(); break;
+    case MsgSetTexture::s_id: procMsgSetTexture(); break;
+    case MsgSetDepthStencilSurface::s_id: procMsgSetDepthStencilSurface(); break;
+    case MsgClear::s_id: procMsgClear(); break;
+    case MsgSetVertexShader::s_id: procMsgSetVertexShader(); break;
+    case MsgSetPixelShader::s_id: procMsgSetPixelShader(); break;
+    case MsgSetPixelShaderConstantF::s_id: procMsgSetPixelShaderConstantF(); break;
+    case MsgSetVertexShaderConstantF::s_id: procMsgSetVertexShaderConstantF(); break;
+    case MsgSetVertexShaderConstantB::s_id: procMsgSetVertexShaderConstantB(); break;
+    case MsgSetSamplerState::s_id: procMsgSetSamplerState(); break;
+    case MsgSetViewport::s_id: procMsgSetViewport(); break;
+    case MsgSetScissorRect::s_id: procMsgSetScissorRect(); break;
+    case MsgSetVertexDeclaration::s_id: procMsgSetVertexDeclaration(); break;
+    case MsgDrawPrimitiveUP::s_id: procMsgDrawPrimitiveUP(); break;
+    case MsgSetStreamSource::s_id: procMsgSetStreamSource(); break;
+    case MsgSetIndices::s_id: procMsgSetIndices(); break;
+    case MsgPresent::s_id: procMsgPresent(); break;
+    case MsgProcessWindowMessages::s_id: procMsgProcessWindowMessages(); break;
+    case MsgWaitOnSwapChain::s_id: procMsgWaitOnSwapChain(); break;
+    case MsgCreateVertexBuffer::s_id: procMsgCreateVertexBuffer(); break;
+    case MsgWriteVertexBuffer::s_id: procMsgWriteVertexBuffer(); break;
+    case MsgCreateIndexBuffer::s_id: procMsgCreateIndexBuffer(); break;
+    case MsgWriteIndexBuffer::s_id: procMsgWriteIndexBuffer(); break;
+    case MsgWriteTexture::s_id: procMsgWriteTexture(); break;
+    case MsgBeginMakeTexture::s_id: procMsgBeginMakeTexture(); break;
+    case MsgWriteMakeTextureChunk::s_id: procMsgWriteMakeTextureChunk(); break;
+    case MsgMakeTexture::s_id: procMsgMakeTexture(); break;
+    case MsgDrawIndexedPrimitive::s_id: procMsgDrawIndexedPrimitive(); break;
+    case MsgSetStreamSourceFreq::s_id: procMsgSetStreamSourceFreq(); break;
+    case MsgReleaseResource::s_id: procMsgReleaseResource(); break;
+    case MsgDrawPrimitive::s_id: procMsgDrawPrimitive(); break;
+    case MsgCopyVertexBuffer::s_id: procMsgCopyVertexBuffer(); break;
+    case MsgSetPixelShaderConstantB::s_id: procMsgSetPixelShaderConstantB(); break;
+    case MsgSaveShaderCache::s_id: procMsgSaveShaderCache(); break;
+    case MsgDrawIndexedPrimitiveUP::s_id: procMsgDrawIndexedPrimitiveUP(); break;
+    case MsgShowCursor::s_id: procMsgShowCursor(); break;
+    case MsgCopyHdrTexture::s_id: procMsgCopyHdrTexture(); break;
+
+    }
+}
+
 void Device::runLoop()
 {
     beginCommandList();
@@ -2253,62 +2568,18 @@ void Device::runLoop()
     while (!m_swapChain.getWindow().m_shouldExit)
     {
         while (m_messageReceiver.hasNext())
-        {
-            switch (m_messageReceiver.getId())
-            {
-            default:
-                if (!processRaytracingMessage())
-                    assert(!"Unknown message type");
-                break;
+            processMessage();
 
-            case MsgPadding::s_id: procMsgPadding(); break;
-            case MsgCreateSwapChain::s_id: procMsgCreateSwapChain(); break;
-            case MsgSetRenderTarget::s_id: procMsgSetRenderTarget(); break;
-            case MsgCreateVertexDeclaration::s_id: procMsgCreateVertexDeclaration(); break;
-            case MsgCreatePixelShader::s_id: procMsgCreatePixelShader(); break;
-            case MsgCreateVertexShader::s_id: procMsgCreateVertexShader(); break;
-            case MsgSetRenderState::s_id: procMsgSetRenderState(); break;
-            case MsgCreateTexture::s_id: procMsgCreateTexture(); break;
-            case MsgSetTexture::s_id: procMsgSetTexture(); break;
-            case MsgSetDepthStencilSurface::s_id: procMsgSetDepthStencilSurface(); break;
-            case MsgClear::s_id: procMsgClear(); break;
-            case MsgSetVertexShader::s_id: procMsgSetVertexShader(); break;
-            case MsgSetPixelShader::s_id: procMsgSetPixelShader(); break;
-            case MsgSetPixelShaderConstantF::s_id: procMsgSetPixelShaderConstantF(); break;
-            case MsgSetVertexShaderConstantF::s_id: procMsgSetVertexShaderConstantF(); break;
-            case MsgSetVertexShaderConstantB::s_id: procMsgSetVertexShaderConstantB(); break;
-            case MsgSetSamplerState::s_id: procMsgSetSamplerState(); break;
-            case MsgSetViewport::s_id: procMsgSetViewport(); break;
-            case MsgSetScissorRect::s_id: procMsgSetScissorRect(); break;
-            case MsgSetVertexDeclaration::s_id: procMsgSetVertexDeclaration(); break;
-            case MsgDrawPrimitiveUP::s_id: procMsgDrawPrimitiveUP(); break;
-            case MsgSetStreamSource::s_id: procMsgSetStreamSource(); break;
-            case MsgSetIndices::s_id: procMsgSetIndices(); break;
-            case MsgPresent::s_id: procMsgPresent(); break;
-            case MsgProcessWindowMessages::s_id: procMsgProcessWindowMessages(); break;
-            case MsgWaitOnSwapChain::s_id: procMsgWaitOnSwapChain(); break;
-            case MsgCreateVertexBuffer::s_id: procMsgCreateVertexBuffer(); break;
-            case MsgWriteVertexBuffer::s_id: procMsgWriteVertexBuffer(); break;
-            case MsgCreateIndexBuffer::s_id: procMsgCreateIndexBuffer(); break;
-            case MsgWriteIndexBuffer::s_id: procMsgWriteIndexBuffer(); break;
-            case MsgWriteTexture::s_id: procMsgWriteTexture(); break;
-            case MsgMakeTexture::s_id: procMsgMakeTexture(); break;
-            case MsgDrawIndexedPrimitive::s_id: procMsgDrawIndexedPrimitive(); break;
-            case MsgSetStreamSourceFreq::s_id: procMsgSetStreamSourceFreq(); break;
-            case MsgReleaseResource::s_id: procMsgReleaseResource(); break;
-            case MsgDrawPrimitive::s_id: procMsgDrawPrimitive(); break;
-            case MsgCopyVertexBuffer::s_id: procMsgCopyVertexBuffer(); break;
-            case MsgSetPixelShaderConstantB::s_id: procMsgSetPixelShaderConstantB(); break;
-            case MsgSaveShaderCache::s_id: procMsgSaveShaderCache(); break;
-            case MsgDrawIndexedPrimitiveUP::s_id: procMsgDrawIndexedPrimitiveUP(); break;
-            case MsgShowCursor::s_id: procMsgShowCursor(); break;
-            case MsgCopyHdrTexture::s_id: procMsgCopyHdrTexture(); break;
+        m_messageReceiver.wait();
+    }
+}
 
-            }
-        }
+void Device::runReplay(MessageReplayer& replayer)
+{
+    beginCommandList();
 
-        m_messageReceiver.sync();
-    }
+    while (!m_swapChain.getWindow().m_shouldExit && replayer.replayFrame())
+        ;
 }
 
 ID3D12Device* Device::getUnderlyingDevice() const
@@ -2338,22 +2609,22 @@ CommandQueue& Device::getCopyQueue()
 
 CommandList& Device::getGraphicsCommandList()
 {
-    return m_graphicsCommandLists[m_frame];
+    return m_graphicsCommandLists[m_frame][m_passSegmenter.getSegmentIndex()];
 }
 
-ID3D12GraphicsCommandList4* Device::getUnderlyingGraphicsCommandList() const
+ID3D12GraphicsCommandList4* Device::getUnderlyingGraphicsCommandList()
 {
-    return m_graphicsCommandLists[m_frame].getUnderlyingCommandList();
+    return m_graphicsCommandLists[m_frame][m_passSegmenter.getSegmentIndex()].getUnderlyingCommandList();
 }
 
 CommandList& Device::getCopyCommandList()
 {
-    return m_copyCommandLists[m_frame];
+    return m_copyCommandLists[m_frame][m_passSegmenter.getSegmentIndex()];
 }
 
-ID3D12GraphicsCommandList4* Device::getUnderlyingCopyCommandList() const
+ID3D12GraphicsCommandList4* Device::getUnderlyingCopyCommandList()
 {
-    return m_copyCommandLists[m_frame].getUnderlyingCommandList();
+    return m_copyCommandLists[m_frame][m_passSegmenter.getSegmentIndex()].getUnderlyingCommandList();
 }
 
 DescriptorHeap& Device::getDescriptorHeap()
@@ -2391,6 +2662,11 @@ const GlobalsPS& Device::getGlobalsPS() const
     return m_globalsPS;
 }
 
+MessageReceiver& Device::getMessageReceiver()
+{
+    return m_messageReceiver;
+}
+
 SwapChain& Device::getSwapChain()
 {
     return m_swapChain;
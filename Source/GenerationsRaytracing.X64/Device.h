@@ -4,12 +4,19 @@
 #include "CommandList.h"
 #include "CommandQueue.h"
 #include "DescriptorHeap.h"
+#include "DeviceCopyQueue.h"
 #include "Event.h"
 #include "MessageReceiver.h"
+#include "MessageReplayer.h"
+#include "PassSegmenter.h"
+#include "PersistentBuffer.h"
+#include "PipelineCache.h"
 #include "PixelShader.h"
+#include "SegmentRecorder.h"
 #include "ShaderCache.h"
 #include "SwapChain.h"
 #include "Texture.h"
+#include "TextureLoader.h"
 #include "UploadBuffer.h"
 #include "VertexDeclaration.h"
 #include "VertexShader.h"
@@ -53,6 +60,8 @@ enum DirtyFlags
 };
 
 static constexpr size_t NUM_FRAMES = 2;
+static constexpr size_t NUM_COMMAND_LISTS_PER_FRAME = 4;
+static constexpr uint32_t MIN_DRAW_CALLS_PER_COMMAND_LIST = 256;
 
 class Device
 {
@@ -72,8 +81,14 @@ protected:
     CommandQueue m_graphicsQueue;
     CommandQueue m_copyQueue;
 
-    CommandList m_graphicsCommandLists[NUM_FRAMES];
-    CommandList m_copyCommandLists[NUM_FRAMES];
+    CommandList m_graphicsCommandLists[NUM_FRAMES][NUM_COMMAND_LISTS_PER_FRAME];
+    CommandList m_copyCommandLists[NUM_FRAMES][NUM_COMMAND_LISTS_PER_FRAME];
+    DeviceCopyQueue m_copyQueueBackend{ *this };
+    // Staging buffers too large for the upload buffers are released once the copy queue is done with them.
+    CopyScheduler<ComPtr<D3D12MA::Allocation>> m_copyScheduler{ m_copyQueueBackend };
+    PassSegmenter m_passSegmenter{ MIN_DRAW_CALLS_PER_COMMAND_LIST, NUM_COMMAND_LISTS_PER_FRAME };
+    // Split segments finish recording on worker threads. The last segment of a frame is recorded at present.
+    SegmentRecorder<CommandList> m_segmentRecorder{ NUM_COMMAND_LISTS_PER_FRAME - 1 };
 
     uint64_t m_fenceValue = 1;
     uint64_t m_fenceValues[NUM_FRAMES]{};
@@ -93,6 +108,10 @@ protected:
     xxHashMap<uint32_t> m_samplers;
     std::vector<Buffer> m_vertexBuffers;
     std::vector<Buffer> m_indexBuffers;
+    ankerl::unordered_dense::map<uint32_t, StreamedTexture> m_streamedTextures;
+    std::unique_ptr<TextureLoader> m_textureLoader;
+    std::vector<LoadedTexture<TextureResource>> m_loadedTextures;
+    uint32_t m_placeholderSrvIndex = 0;
 
     std::vector<UploadBuffer> m_uploadBuffers[NUM_FRAMES];
     uint32_t m_uploadBufferIndex = 0;
@@ -107,7 +126,15 @@ protected:
     D3D12_CPU_DESCRIPTOR_HANDLE m_depthStencilView{};
     ID3D12Resource* m_depthStencilTexture = nullptr;
 
-    xxHashMap<ComPtr<ID3D12PipelineState>> m_pipelines;
+    struct CachedPipeline
+    {
+        XXH64_hash_t key = 0;
+        ComPtr<ID3D12PipelineState> pipeline;
+    };
+
+    xxHashMap<CachedPipeline> m_pipelines;
+    std::unique_ptr<PipelineCache> m_pipelineCache;
+    bool m_asyncPipelineCompilation = true;
     ID3D12PipelineState* m_curPipeline = nullptr;
 
     uint32_t m_samplerDescsFirst = 0;
@@ -142,16 +169,11 @@ protected:
     // Place chonky variables at the end.
     GlobalsVS m_globalsVS{};
     GlobalsPS m_globalsPS{};
+    // Bound per stage, for pointing stages away from the placeholder once their texture finishes loading.
+    uint32_t m_textureIds[16]{};
     D3D12_SAMPLER_DESC m_samplerDescs[16]{};
     D3D12_GRAPHICS_PIPELINE_STATE_DESC m_pipelineDesc{};
 
-    void createBuffer(
-        D3D12_HEAP_TYPE type,
-        uint32_t dataSize,
-        D3D12_RESOURCE_FLAGS flags,
-        D3D12_RESOURCE_STATES initialState,
-        ComPtr<D3D12MA::Allocation>& allocation) const;
-
     void writeBuffer(
         const void* memory,
         uint32_t offset,
@@ -159,15 +181,35 @@ protected:
         ID3D12Resource* dstResource,
         bool mapWrite);
 
+    UploadAllocation allocateUploadBuffer(
+        uint32_t dataSize,
+        uint32_t dataAlignment);
+
     D3D12_GPU_VIRTUAL_ADDRESS createBuffer(
         const void* memory,
         uint32_t dataSize,
         uint32_t dataAlignment);
 
+    void submitCopyCommandList();
+    // Executes split segments in order once their recording is done.
+    void submitGraphicsCommandLists();
+    void collectLoadedTextures();
+    // Points to the placeholder view while the texture is loading.
+    uint32_t getTextureSrvIndex(const Texture& texture) const;
+    // Hands the work recorded so far at a pass boundary to a worker thread and submits it at the next
+    // boundary, so the GPU can start on it while the render thread records the rest of the frame.
+    void splitGraphicsCommandList();
+
+    D3D12_GPU_VIRTUAL_ADDRESS updatePersistentBuffer(
+        PersistentBuffer& buffer,
+        const void* memory,
+        uint32_t dataSize);
+
     void setPrimitiveType(D3DPRIMITIVETYPE primitiveType);
 
     void setDescriptorHeaps();
-    void flushGraphicsState();
+    // Returns false if the draw call should be skipped.
+    bool flushGraphicsState();
 
     void procMsgPadding();
     void procMsgCreateSwapChain();
@@ -200,6 +242,8 @@ protected:
     void procMsgCreateIndexBuffer();
     void procMsgWriteIndexBuffer();
     void procMsgWriteTexture();
+    void procMsgBeginMakeTexture();
+    void procMsgWriteMakeTextureChunk();
     void procMsgMakeTexture();
     void procMsgDrawIndexedPrimitive();
     void procMsgSetStreamSourceFreq();
@@ -216,28 +260,42 @@ protected:
 
     virtual bool processRaytracingMessage() { return false; }
     virtual void releaseRaytracingResources() {}
+    virtual void invalidateRaytracingState() {}
 
 public:
     Device(const IniFile& iniFile);
     virtual ~Device();
 
+    // Processes the message the receiver is pointing to.
+    void processMessage();
     void runLoop();
 
+    // Plays back a capture through the same dispatch as runLoop, see DeviceReplayBackend.
+    void runReplay(MessageReplayer& replayer);
+
     ID3D12Device* getUnderlyingDevice() const;
     D3D12MA::Allocator* getAllocator() const;
 
+    void createBuffer(
+        D3D12_HEAP_TYPE type,
+        uint32_t dataSize,
+        D3D12_RESOURCE_FLAGS flags,
+        D3D12_RESOURCE_STATES initialState,
+        ComPtr<D3D12MA::Allocation>& allocation) const;
+
     CommandQueue& getGraphicsQueue();
     const CommandQueue& getGraphicsQueue() const;
     CommandQueue& getCopyQueue();
 
     CommandList& getGraphicsCommandList();
-    ID3D12GraphicsCommandList4* getUnderlyingGraphicsCommandList() const;
+    ID3D12GraphicsCommandList4* getUnderlyingGraphicsCommandList();
 
     CommandList& getCopyCommandList();
-    ID3D12GraphicsCommandList4* getUnderlyingCopyCommandList() const;
+    ID3D12GraphicsCommandList4* getUnderlyingCopyCommandList();
 
+    // Copies get submitted in a single batch at the end of the frame or at a split, see CopyScheduler.
     template<typename T>
-    void executeCopyCommandList(const T& function);
+    void recordCopyCommandList(const T& function);
 
     DescriptorHeap& getDescriptorHeap();
     DescriptorHeap& getSamplerDescriptorHeap();
@@ -248,6 +306,8 @@ public:
     const GlobalsVS& getGlobalsVS() const;
     const GlobalsPS& getGlobalsPS() const;
 
+    MessageReceiver& getMessageReceiver();
+
     SwapChain& getSwapChain();
 };
 
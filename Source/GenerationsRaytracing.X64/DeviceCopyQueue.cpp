@@ -0,0 +1,31 @@
+#include "DeviceCopyQueue.h"
+
+#include "Device.h"
+
+DeviceCopyQueue::DeviceCopyQueue(Device& device) : m_device(device)
+{
+}
+
+void DeviceCopyQueue::openCopyCommandList()
+{
+    m_device.getCopyCommandList().open();
+}
+
+void DeviceCopyQueue::submitCopyCommandList(uint64_t fenceValue)
+{
+    auto& copyCommandList = m_device.getCopyCommandList();
+    copyCommandList.close();
+
+    m_device.getCopyQueue().executeCommandList(copyCommandList);
+    m_device.getCopyQueue().signal(fenceValue);
+}
+
+void DeviceCopyQueue::waitForCopies(uint64_t fenceValue)
+{
+    m_device.getGraphicsQueue().wait(fenceValue, m_device.getCopyQueue());
+}
+
+uint64_t DeviceCopyQueue::getCompletedCopyFenceValue() const
+{
+    return m_device.getCopyQueue().getFence()->GetCompletedValue();
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CopyScheduler.h"
+
+class Device;
+
+// Records into the copy command list of the device's current frame and command list index.
+class DeviceCopyQueue final : public CopyQueueBackend
+{
+protected:
+    Device& m_device;
+
+public:
+    explicit DeviceCopyQueue(Device& device);
+
+    void openCopyCommandList() override;
+    void submitCopyCommandList(uint64_t fenceValue) override;
+    void waitForCopies(uint64_t fenceValue) override;
+    uint64_t getCompletedCopyFenceValue() const override;
+};
\ No newline at end of file
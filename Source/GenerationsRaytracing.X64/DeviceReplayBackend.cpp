@@ -0,0 +1,26 @@
+#include "DeviceReplayBackend.h"
+
+#include "Device.h"
+#include "MessageSize.h"
+
+DeviceReplayBackend::DeviceReplayBackend(Device& device) : m_device(device)
+{
+}
+
+void DeviceReplayBackend::writeBulkData(uint32_t offset, const uint8_t* data, uint32_t dataSize)
+{
+    m_device.getMessageReceiver().writeReplayBulkData(offset, data, dataSize);
+}
+
+uint32_t DeviceReplayBackend::processMessage(const uint8_t* message)
+{
+    auto& messageReceiver = m_device.getMessageReceiver();
+    messageReceiver.setReplayMessage(message);
+
+    m_device.processMessage();
+
+    const uint32_t byteSize = messageReceiver.getReplayMessageSize();
+    assert(byteSize == getMessageByteSize(message));
+
+    return byteSize;
+}
\ No newline at end of file
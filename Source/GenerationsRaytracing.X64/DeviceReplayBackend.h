@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ReplayBackend.h"
+
+class Device;
+
+// Hands messages from a capture to the device's regular dispatch.
+class DeviceReplayBackend final : public ReplayBackend
+{
+protected:
+    Device& m_device;
+
+public:
+    explicit DeviceReplayBackend(Device& device);
+
+    void writeBulkData(uint32_t offset, const uint8_t* data, uint32_t dataSize) override;
+    uint32_t processMessage(const uint8_t* message) override;
+};
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "DeviceScratchBufferRecorder.h"
+
+DeviceScratchBufferRecorder::DeviceScratchBufferRecorder(Device& device) : m_device(device)
+{
+}
+
+uint64_t DeviceScratchBufferRecorder::createPoolBuffer(uint32_t frame, uint32_t byteSize)
+{
+    auto& poolBuffer = m_poolBuffers[frame];
+    poolBuffer = nullptr;
+
+    m_device.createBuffer(
+        D3D12_HEAP_TYPE_DEFAULT,
+        byteSize,
+        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+        D3D12_RESOURCE_STATE_COMMON,
+        poolBuffer);
+
+#ifdef _DEBUG
+    poolBuffer->GetResource()->SetName(L"Scratch Buffer");
+#endif
+
+    return poolBuffer->GetResource()->GetGPUVirtualAddress();
+}
+
+uint64_t DeviceScratchBufferRecorder::createTempBuffer(uint32_t frame, uint32_t byteSize)
+{
+    auto& tempBuffer = m_tempBuffers[frame].emplace_back();
+
+    m_device.createBuffer(
+        D3D12_HEAP_TYPE_DEFAULT,
+        byteSize,
+        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+        D3D12_RESOURCE_STATE_COMMON,
+        tempBuffer);
+
+    return tempBuffer->GetResource()->GetGPUVirtualAddress();
+}
+
+void DeviceScratchBufferRecorder::releaseTempBuffers(uint32_t frame)
+{
+    m_tempBuffers[frame].clear();
+}
+
+void DeviceScratchBufferRecorder::recordPoolBarrier(uint32_t frame)
+{
+    auto& commandList = m_device.getGraphicsCommandList();
+    commandList.uavBarrier(m_poolBuffers[frame]->GetResource());
+    commandList.commitBarriers();
+}
\ No newline at end of file
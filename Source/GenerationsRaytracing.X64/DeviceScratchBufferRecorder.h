@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Device.h"
+#include "ScratchBufferScheduler.h"
+
+// Owns the scratch buffers and records the pool barriers into the device's graphics command list.
+class DeviceScratchBufferRecorder final : public ScratchBufferRecorder
+{
+protected:
+    Device& m_device;
+    ComPtr<D3D12MA::Allocation> m_poolBuffers[NUM_FRAMES];
+    std::vector<ComPtr<D3D12MA::Allocation>> m_tempBuffers[NUM_FRAMES];
+
+public:
+    explicit DeviceScratchBufferRecorder(Device& device);
+
+    uint64_t createPoolBuffer(uint32_t frame, uint32_t byteSize) override;
+    uint64_t createTempBuffer(uint32_t frame, uint32_t byteSize) override;
+    void releaseTempBuffers(uint32_t frame) override;
+    void recordPoolBarrier(uint32_t frame) override;
+};
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include "DeviceReplayBackend.h"
 #include "ProcessUtil.h"
 #include "RaytracingDevice.h"
 
@@ -41,8 +42,73 @@ static void onProcessNotFound()
 #endif
 }
 
-int main()
+static std::unique_ptr<Device> createDevice()
 {
+    IniFile iniFile;
+    iniFile.read("GenerationsRaytracing.ini");
+
+    return iniFile.getBool("Mod", "EnableRaytracing", true) ?
+        std::make_unique<RaytracingDevice>(iniFile) :
+        std::make_unique<Device>(iniFile);
+}
+
+static HANDLE createFileMapping(LPCTSTR name, size_t size)
+{
+    return CreateFileMapping(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32),
+        static_cast<DWORD>(size),
+        name);
+}
+
+// Plays back a capture made through MessageCaptureFilePath without the game running.
+static int replay(const char* filePath)
+{
+    // Stand in for x86 by creating everything it would normally create.
+    const Event x86Event(Event::s_x86EventName, FALSE, FALSE);
+    const Event x64Event(Event::s_x64EventName, FALSE, FALSE);
+    const Event frameEvent(Event::s_frameEventName, FALSE, FALSE);
+    const Event swapChainEvent(Event::s_swapChainEventName, FALSE, FALSE);
+
+    const HANDLE memoryMappedFile = createFileMapping(MemoryMappedFile::s_name, MemoryMappedFile::s_size);
+    const HANDLE bulkDataMappedFile = createFileMapping(MemoryMappedFile::s_bulkDataName, MemoryMappedFile::s_bulkDataSize);
+
+    // Read it all up front so disk reads don't end up in the message timings.
+    const auto capture = MessageCaptureReader::readFile(filePath);
+
+    s_device = createDevice();
+
+    if (s_device->getUnderlyingDevice() != nullptr)
+    {
+        DeviceReplayBackend backend(*s_device);
+        MessageReplayer replayer(capture.data(), capture.size(), backend);
+
+        if (replayer.isValid())
+        {
+            s_device->runReplay(replayer);
+            replayer.printStatistics(stdout);
+        }
+        else
+        {
+            printf("Unable to replay %s, it is missing or was captured with a different version\n", filePath);
+        }
+    }
+
+    s_device.reset();
+
+    CloseHandle(bulkDataMappedFile);
+    CloseHandle(memoryMappedFile);
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+        return replay(argv[2]);
+
 #ifdef _DEBUG 
     if (GetConsoleWindow())
         freopen("CONOUT$", "w", stdout);
@@ -100,12 +166,7 @@ int main()
         return -1;
     }
     
-    IniFile iniFile;
-    iniFile.read("GenerationsRaytracing.ini");
-
-    s_device = iniFile.getBool("Mod", "EnableRaytracing", true) ?
-        std::make_unique<RaytracingDevice>(iniFile) : 
-        std::make_unique<Device>(iniFile);
+    s_device = createDevice();
 
     if (s_device->getUnderlyingDevice() != nullptr)
     {
@@ -1,32 +1,117 @@
 #include "MessageReceiver.h"
+
 #include "MessageQueue.h"
+#include "Message.h"
 
 MessageReceiver::MessageReceiver()
 {
-    m_memoryMap = static_cast<uint8_t*>(m_memoryMappedFile.map());
+    m_bulkDataMap = static_cast<uint8_t*>(m_bulkDataMappedFile.map());
+    m_messages = m_memoryMap;
 }
 
 MessageReceiver::~MessageReceiver()
 {
+    m_bulkDataMappedFile.unmap(m_bulkDataMap);
     m_memoryMappedFile.unmap(m_memoryMap);
 }
 
-bool MessageReceiver::hasNext() const
+void MessageReceiver::publishTail()
 {
-    return m_offset < MESSAGE_QUEUE->offset;
+    if (m_tail != m_offset)
+    {
+        m_tail = m_offset;
+        MESSAGE_QUEUE->tail = m_tail;
+
+        if (MESSAGE_QUEUE->tailWaiterCount > 0)
+            m_x64Event.set();
+    }
 }
 
-uint8_t MessageReceiver::getId() const
+void MessageReceiver::beginMessage()
 {
-    return m_memoryMap[m_offset];
+    m_messageId = m_messages[m_offset];
+    m_messageOffset = m_offset;
+
+    LARGE_INTEGER timestamp;
+    QueryPerformanceCounter(&timestamp);
+    m_messageBegin = timestamp.QuadPart;
 }
 
-void MessageReceiver::sync()
+void MessageReceiver::endMessage()
 {
-    if (m_offset <= MESSAGE_QUEUE->offset && MESSAGE_QUEUE->sync)
+    if (m_messageBegin != 0)
     {
-        m_x64Event.set();
-        m_offset = sizeof(MessageQueue);
-        m_x86Event.wait();
+        LARGE_INTEGER timestamp;
+        QueryPerformanceCounter(&timestamp);
+
+        m_statistics.add(m_messageId, m_offset - m_messageOffset, timestamp.QuadPart - m_messageBegin);
+        m_messageBegin = 0;
+    }
+}
+
+bool MessageReceiver::hasNext()
+{
+    endMessage();
+
+    // Only let x86 know of our progress when it's actually waiting for space, 
+    // writing to its cache line after every message is wasteful otherwise.
+    if (MESSAGE_QUEUE->tailWaiterCount > 0)
+        publishTail();
+
+    if (!m_ring.hasNext(MESSAGE_QUEUE->head, m_offset))
+    {
+        publishTail();
+        return false;
     }
+
+    beginMessage();
+    return true;
 }
+
+void MessageReceiver::wait()
+{
+    MessageWaiter::wait(MESSAGE_QUEUE->sleeping, m_x86Event, [&] { return m_offset != MESSAGE_QUEUE->head; });
+}
+
+uint8_t MessageReceiver::getId() const
+{
+    return m_messages[m_offset];
+}
+
+const uint8_t* MessageReceiver::getBulkData(uint32_t offset) const
+{
+    return m_bulkDataMap + offset;
+}
+
+void MessageReceiver::releaseBulkData(uint32_t offset)
+{
+    BULK_DATA_HEADER(offset)->released = true;
+
+    if (MESSAGE_QUEUE->bulkDataWaiterCount > 0)
+        m_x64Event.set();
+}
+
+void MessageReceiver::signalFrame()
+{
+    const uint32_t completedFrame = MESSAGE_QUEUE->completedFrame;
+    MESSAGE_QUEUE->statistics.publish(completedFrame, m_statistics);
+    m_statistics.reset();
+
+    FrameFence(MESSAGE_QUEUE->completedFrame, m_frameEvent).signal();
+}
+
+void MessageReceiver::setReplayMessage(const uint8_t* message)
+{
+    m_messages = message;
+    m_offset = 0;
+}
+
+uint32_t MessageReceiver::getReplayMessageSize() const
+{
+    return m_offset;
+}
+
+void MessageReceiver::writeReplayBulkData(uint32_t offset, const uint8_t* data, uint32_t dataSize)
+{
+    memcpy(m_bulkDataMap + offset, data, dataSize);
+}
\ No newline at end of file
@@ -1,31 +1,67 @@
 #pragma once
 
 #include "Event.h"
+#include "FrameFence.h"
 #include "MemoryMappedFile.h"
 #include "MessageQueue.h"
+#include "MessageRing.h"
+#include "MessageSize.h"
+#include "MessageWaiter.h"
 
 class MessageReceiver
 {
 protected:
     Event m_x86Event{ Event::s_x86EventName };
     Event m_x64Event{ Event::s_x64EventName };
+    Event m_frameEvent{ Event::s_frameEventName };
 
-    MemoryMappedFile m_memoryMappedFile;
-    uint8_t* m_memoryMap;
+    MemoryMappedFile m_memoryMappedFile{ MemoryMappedFile::s_name, MemoryMappedFile::s_size };
+    uint8_t* m_memoryMap = static_cast<uint8_t*>(m_memoryMappedFile.map());
+    MessageRingReader m_ring{ m_memoryMap };
 
+    MemoryMappedFile m_bulkDataMappedFile{ MemoryMappedFile::s_bulkDataName, MemoryMappedFile::s_bulkDataSize };
+    uint8_t* m_bulkDataMap;
+
+    // Points to the memory map, or to the current message when replaying.
+    const uint8_t* m_messages;
     uint32_t m_offset = sizeof(MessageQueue);
+    uint32_t m_tail = sizeof(MessageQueue);
+
+    void publishTail();
+
+    // Statistics of the frame in progress, the time between two calls 
+    // to hasNext gets attributed to the message returned by the first one.
+    MessageStatistics m_statistics{};
+    uint8_t m_messageId = 0;
+    uint32_t m_messageOffset = 0;
+    int64_t m_messageBegin = 0;
+
+    void beginMessage();
+    void endMessage();
 
 public:
     MessageReceiver();
     ~MessageReceiver();
 
-    bool hasNext() const;
+    bool hasNext();
+
+    // Spins for a short while before yielding, and eventually
+    // goes to sleep until x86 wakes us up with a new message.
+    void wait();
     uint8_t getId() const;
 
     template <typename T>
     const T& getMessage();
 
-    void sync();
+    const uint8_t* getBulkData(uint32_t offset) const;
+    void releaseBulkData(uint32_t offset);
+
+    void signalFrame();
+
+    // Points the receiver at a single message from a capture instead of the queue, see DeviceReplayBackend.
+    void setReplayMessage(const uint8_t* message);
+    uint32_t getReplayMessageSize() const;
+    void writeReplayBulkData(uint32_t offset, const uint8_t* data, uint32_t dataSize);
 };
 
 #include "MessageReceiver.inl"
@@ -12,8 +12,13 @@ using Microsoft::WRL::ComPtr;
 #include <cstddef>
 #include <cstdint>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <random>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "DirtyRangeTracker.h"
+
+struct PersistentBuffer
+{
+    ComPtr<D3D12MA::Allocation> allocation;
+    uint32_t byteSize = 0;
+    DirtyRangeTracker dirtyRanges;
+};
\ No newline at end of file
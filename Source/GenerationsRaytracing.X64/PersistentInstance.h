@@ -0,0 +1,24 @@
+#pragma once
+
+struct PersistentInstance
+{
+    float transform[3][4];
+    float prevTransform[3][4];
+    float headTransform[3][4];
+    uint32_t bottomLevelAccelStructId = 0;
+    bool isMirrored = false;
+    uint8_t instanceMask = 0;
+    uint8_t instanceType = 0;
+    float playableParam = 0.0f;
+    float chrPlayableMenuParam = 0.0f;
+    float forceAlphaColor = 0.0f;
+    float edgeEmissionParam = 0.0f;
+
+    // Material remap pairs. Instances with any get their own copy of the geometry descs,
+    // otherwise the ones of the bottom level acceleration structure are used. The copy is
+    // redone when the bottom level acceleration structure gets recreated with new geometry descs.
+    std::vector<uint32_t> materialIds;
+    uint32_t geometryId = 0;
+    uint32_t geometryCount = 0;
+    uint32_t srcGeometryId = 0;
+};
\ No newline at end of file
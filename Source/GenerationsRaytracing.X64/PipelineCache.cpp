@@ -0,0 +1,254 @@
+#include "PipelineCache.h"
+
+static constexpr uint32_t PIPELINE_CACHE_VERSION = 2;
+
+#pragma pack(push, 1)
+struct BlockHeader
+{
+    uint32_t version;
+    XXH64_hash_t rootSignatureHash;
+    uint32_t uncompressedSize;
+    uint32_t compressedSize;
+};
+#pragma pack(pop)
+
+// Records in the blocks are laid out by PipelineStore. Each desc is followed by input elements,
+// vertex shader, pixel shader and null terminated semantic names.
+struct PipelineDescHeader
+{
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc;
+    uint32_t inputElementCount;
+    uint32_t vertexShaderSize;
+    uint32_t pixelShaderSize;
+    uint32_t semanticNamesSize;
+};
+
+void PipelineCache::loadPipelineCache(const char* name)
+{
+    FILE* file = fopen(name, "rb");
+    if (file != nullptr)
+    {
+        fseek(file, 0, SEEK_END);
+        const long fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        std::vector<uint8_t> compressedBlock;
+        long filePosition;
+
+        while ((filePosition = ftell(file)) < fileSize)
+        {
+            BlockHeader blockHeader{};
+            bool isBlockValid = false;
+
+            if (fread(&blockHeader, sizeof(BlockHeader), 1, file) == 1 && blockHeader.version == PIPELINE_CACHE_VERSION &&
+                blockHeader.uncompressedSize > 0 && blockHeader.compressedSize > 0 && 
+                blockHeader.compressedSize <= static_cast<uint32_t>(fileSize - filePosition))
+            {
+                compressedBlock.resize(blockHeader.compressedSize);
+
+                if (fread(compressedBlock.data(), 1, compressedBlock.size(), file) == blockHeader.compressedSize)
+                {
+                    // Pipelines made for another root signature would fail to compile or bind the wrong resources.
+                    if (blockHeader.rootSignatureHash != m_rootSignatureHash)
+                    {
+                        m_shouldRewrite = true;
+                        continue;
+                    }
+
+                    std::unique_ptr<uint8_t[]> uncompressedBlock(new uint8_t[blockHeader.uncompressedSize]);
+
+                    const int decompressedSize = LZ4_decompress_safe(
+                        reinterpret_cast<const char*>(compressedBlock.data()),
+                        reinterpret_cast<char*>(uncompressedBlock.get()),
+                        static_cast<int>(blockHeader.compressedSize),
+                        static_cast<int>(blockHeader.uncompressedSize));
+
+                    isBlockValid = static_cast<uint32_t>(decompressedSize) == blockHeader.uncompressedSize &&
+                        m_store.loadBlock(std::move(uncompressedBlock), blockHeader.uncompressedSize);
+
+                    if (isBlockValid)
+                    {
+                        const auto blockHeaderBytes = reinterpret_cast<const uint8_t*>(&blockHeader);
+                        m_validBlocks.insert(m_validBlocks.end(), blockHeaderBytes, blockHeaderBytes + sizeof(BlockHeader));
+                        m_validBlocks.insert(m_validBlocks.end(), compressedBlock.begin(), compressedBlock.end());
+                    }
+                }
+            }
+
+            // Everything from here on is unreadable, so it gets cut off.
+            if (!isBlockValid)
+            {
+                m_shouldRewrite = true;
+                break;
+            }
+        }
+
+        fclose(file);
+    }
+}
+
+void PipelineCache::serializeDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    assert(desc.DS.BytecodeLength == 0 && desc.HS.BytecodeLength == 0 && desc.GS.BytecodeLength == 0 && desc.StreamOutput.NumEntries == 0);
+
+    PipelineDescHeader header{};
+    memcpy(&header.desc, &desc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
+    header.desc.pRootSignature = nullptr;
+    header.desc.VS = {};
+    header.desc.PS = {};
+    header.desc.DS = {};
+    header.desc.HS = {};
+    header.desc.GS = {};
+    header.desc.StreamOutput = {};
+    header.desc.InputLayout = {};
+    header.desc.CachedPSO = {};
+    header.inputElementCount = desc.InputLayout.NumElements;
+    header.vertexShaderSize = static_cast<uint32_t>(desc.VS.BytecodeLength);
+    header.pixelShaderSize = static_cast<uint32_t>(desc.PS.BytecodeLength);
+
+    for (uint32_t i = 0; i < desc.InputLayout.NumElements; i++)
+        header.semanticNamesSize += static_cast<uint32_t>(strlen(desc.InputLayout.pInputElementDescs[i].SemanticName) + 1);
+
+    m_serializedDesc.resize(sizeof(PipelineDescHeader) + header.inputElementCount * sizeof(D3D12_INPUT_ELEMENT_DESC) +
+        header.vertexShaderSize + header.pixelShaderSize + header.semanticNamesSize);
+
+    uint8_t* dataPtr = m_serializedDesc.data();
+
+    memcpy(dataPtr, &header, sizeof(PipelineDescHeader));
+    dataPtr += sizeof(PipelineDescHeader);
+
+    for (uint32_t i = 0; i < desc.InputLayout.NumElements; i++)
+    {
+        D3D12_INPUT_ELEMENT_DESC inputElement = desc.InputLayout.pInputElementDescs[i];
+        inputElement.SemanticName = nullptr;
+
+        memcpy(dataPtr, &inputElement, sizeof(D3D12_INPUT_ELEMENT_DESC));
+        dataPtr += sizeof(D3D12_INPUT_ELEMENT_DESC);
+    }
+
+    memcpy(dataPtr, desc.VS.pShaderBytecode, header.vertexShaderSize);
+    dataPtr += header.vertexShaderSize;
+
+    memcpy(dataPtr, desc.PS.pShaderBytecode, header.pixelShaderSize);
+    dataPtr += header.pixelShaderSize;
+
+    for (uint32_t i = 0; i < desc.InputLayout.NumElements; i++)
+    {
+        const size_t semanticNameSize = strlen(desc.InputLayout.pInputElementDescs[i].SemanticName) + 1;
+        memcpy(dataPtr, desc.InputLayout.pInputElementDescs[i].SemanticName, semanticNameSize);
+        dataPtr += semanticNameSize;
+    }
+}
+
+ComPtr<ID3D12PipelineState> PipelineCache::compilePipeline(const uint8_t* data, uint32_t dataSize)
+{
+    assert(dataSize >= sizeof(PipelineDescHeader));
+
+    PipelineDescHeader header;
+    memcpy(&header, data, sizeof(PipelineDescHeader));
+    data += sizeof(PipelineDescHeader);
+
+    std::vector<D3D12_INPUT_ELEMENT_DESC> inputElements(header.inputElementCount);
+    memcpy(inputElements.data(), data, header.inputElementCount * sizeof(D3D12_INPUT_ELEMENT_DESC));
+    data += header.inputElementCount * sizeof(D3D12_INPUT_ELEMENT_DESC);
+
+    auto& desc = header.desc;
+    desc.pRootSignature = m_rootSignature.Get();
+    desc.VS.pShaderBytecode = data;
+    desc.VS.BytecodeLength = header.vertexShaderSize;
+    data += header.vertexShaderSize;
+
+    desc.PS.pShaderBytecode = data;
+    desc.PS.BytecodeLength = header.pixelShaderSize;
+    data += header.pixelShaderSize;
+
+    const char* semanticName = reinterpret_cast<const char*>(data);
+    for (auto& inputElement : inputElements)
+    {
+        inputElement.SemanticName = semanticName;
+        semanticName += strlen(semanticName) + 1;
+    }
+
+    desc.InputLayout.pInputElementDescs = inputElements.data();
+    desc.InputLayout.NumElements = header.inputElementCount;
+
+    ComPtr<ID3D12PipelineState> pipeline;
+    const HRESULT hr = m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pipeline.GetAddressOf()));
+
+    // Can happen with a stale cache after a driver or shader converter change, the draw calls get skipped instead.
+    if (FAILED(hr))
+        pipeline = nullptr;
+
+    return pipeline;
+}
+
+PipelineCache::PipelineCache(ID3D12Device* device, ID3D12RootSignature* rootSignature, XXH64_hash_t rootSignatureHash)
+    : m_device(device)
+    , m_rootSignature(rootSignature)
+    , m_rootSignatureHash(rootSignatureHash)
+    , m_store(*this, std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u))
+{
+    loadPipelineCache("pipeline_cache.bin");
+}
+
+XXH64_hash_t PipelineCache::addPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    serializeDesc(desc);
+
+    const XXH64_hash_t key = XXH3_64bits(m_serializedDesc.data(), m_serializedDesc.size());
+    m_store.addPipeline(key, m_serializedDesc.data(), static_cast<uint32_t>(m_serializedDesc.size()));
+
+    return key;
+}
+
+ComPtr<ID3D12PipelineState> PipelineCache::getPipeline(XXH64_hash_t key, bool async)
+{
+    return m_store.getPipeline(key, async);
+}
+
+void PipelineCache::savePipelineCache()
+{
+    if (m_store.saveBlock(m_block))
+    {
+        BlockHeader blockHeader{};
+        blockHeader.version = PIPELINE_CACHE_VERSION;
+        blockHeader.rootSignatureHash = m_rootSignatureHash;
+        blockHeader.uncompressedSize = static_cast<uint32_t>(m_block.size());
+
+        const int compressBound = LZ4_compressBound(static_cast<int>(blockHeader.uncompressedSize));
+        const auto compressedBlock = std::make_unique<uint8_t[]>(compressBound);
+
+        blockHeader.compressedSize = static_cast<uint32_t>(LZ4_compress_default(
+            reinterpret_cast<const char*>(m_block.data()),
+            reinterpret_cast<char*>(compressedBlock.get()),
+            static_cast<int>(blockHeader.uncompressedSize),
+            compressBound));
+
+        const auto blockHeaderBytes = reinterpret_cast<const uint8_t*>(&blockHeader);
+        m_validBlocks.insert(m_validBlocks.end(), blockHeaderBytes, blockHeaderBytes + sizeof(BlockHeader));
+        m_validBlocks.insert(m_validBlocks.end(), compressedBlock.get(), compressedBlock.get() + blockHeader.compressedSize);
+
+        m_shouldRewrite = true;
+    }
+
+    if (!m_shouldRewrite)
+        return;
+
+    // The file is rewritten with only the valid blocks, stale ones would pile up with every shader change otherwise.
+    // If anything fails, the old file stays in place and the next save tries again.
+    FILE* file = fopen("pipeline_cache.bin.tmp", "wb");
+    if (file == nullptr)
+        return;
+
+    const bool written = fwrite(m_validBlocks.data(), 1, m_validBlocks.size(), file) == m_validBlocks.size();
+
+    if (fclose(file) == 0 && written &&
+        MoveFileExA("pipeline_cache.bin.tmp", "pipeline_cache.bin", MOVEFILE_REPLACE_EXISTING))
+    {
+        m_shouldRewrite = false;
+    }
+    else
+    {
+        DeleteFileA("pipeline_cache.bin.tmp");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "PipelineStore.h"
+
+// Graphics pipelines keyed by their contents rather than by pointers, so they can be stored on disk
+// and compiled on worker threads before they are needed in the next session.
+class PipelineCache : protected PipelineCompiler<ComPtr<ID3D12PipelineState>>
+{
+protected:
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12RootSignature> m_rootSignature;
+    XXH64_hash_t m_rootSignatureHash;
+    std::vector<uint8_t> m_serializedDesc;
+    std::vector<uint8_t> m_block;
+
+    // Blocks that are still valid, exactly as they are stored in the file.
+    std::vector<uint8_t> m_validBlocks;
+    bool m_shouldRewrite = false;
+
+    PipelineStore<ComPtr<ID3D12PipelineState>> m_store;
+
+    void loadPipelineCache(const char* name);
+
+    void serializeDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+    ComPtr<ID3D12PipelineState> compilePipeline(const uint8_t* data, uint32_t dataSize) override;
+
+public:
+    // Blocks stored with a different root signature hash are ignored, and dropped from the file on the next save.
+    PipelineCache(ID3D12Device* device, ID3D12RootSignature* rootSignature, XXH64_hash_t rootSignatureHash);
+
+    // Queues the pipeline for compilation if it isn't cached yet. The key can be passed to getPipeline
+    // on subsequent draw calls to avoid serializing the desc again.
+    XXH64_hash_t addPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+    // Returns null if the pipeline is still compiling in the background or failed to compile.
+    ComPtr<ID3D12PipelineState> getPipeline(XXH64_hash_t key, bool async);
+
+    void savePipelineCache();
+};
\ No newline at end of file
@@ -2,7 +2,7 @@
 
 struct PixelShader
 {
-    std::unique_ptr<uint8_t[]> byteCode;
+    const uint8_t* byteCode = nullptr;
     uint32_t byteSize = 0;
-    // 4 bytes wasted...
+    XXH64_hash_t hash = 0;
 };
@@ -35,78 +35,30 @@
 #include "CopyHdrTexturePixelShader.h"
 #include "GrassInstancerComputeShader.h"
 
-static constexpr uint32_t SCRATCH_BUFFER_SIZE = 32 * 1024 * 1024;
+static constexpr uint32_t MAX_DEFRAGMENTATION_SIZE = 4 * 1024 * 1024;
 static constexpr uint32_t CUBE_MAP_RESOLUTION = 1024;
 
 uint32_t RaytracingDevice::allocateGeometryDescs(uint32_t count)
 {
-    const auto it = m_freeCounts.lower_bound(count);
-    if (it != m_freeCounts.end())
-    {
-        const uint32_t remnant = it->first - count;
-        const uint32_t index = it->second + remnant;
-
-        const auto it2 = m_freeIndices.find(it->second);
-        assert(it2 != m_freeIndices.end());
-
-        if (remnant > 0)
-        {
-            auto node = m_freeCounts.extract(it);
-            node.key() = remnant;
-            it2->second = m_freeCounts.insert(std::move(node));
-        }
-        else
-        {
-            m_freeIndices.erase(it2);
-            m_freeCounts.erase(it);
-        }
+    const uint32_t index = m_geometryDescAllocator.allocate(count);
 
-        return index;
-    }
-    else
+    if (m_geometryDescs.size() < m_geometryDescAllocator.getCapacity())
     {
-        const uint32_t index = static_cast<uint32_t>(m_geometryDescs.size());
-        m_geometryDescs.resize(m_geometryDescs.size() + count);
+        m_geometryDescs.resize(m_geometryDescAllocator.getCapacity());
         m_hitGroupShaderTable.resize(m_geometryDescs.size() * D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES * HIT_GROUP_NUM);
-        return index;
     }
+
+    return index;
 }
 
 void RaytracingDevice::freeGeometryDescs(uint32_t id, uint32_t count)
 {
-    const auto next = m_freeIndices.lower_bound(id);
-    if (next != m_freeIndices.end())
-    {
-        if (next != m_freeIndices.begin())
-        {
-            const auto prev = std::prev(next);
-
-            // Merge previous range (prevId + prevCount) == id
-            if ((prev->first + prev->second->first) == id)
-            {
-                id = prev->first;
-                count += prev->second->first;
+    m_geometryDescAllocator.free(id, count);
 
-                m_freeCounts.erase(prev->second);
-                m_freeIndices.erase(prev->first);
-            }
-        }
-        // Merge next range (id + count) == nextId
-        if ((id + count) == next->first)
-        {
-            count += next->second->first;
-            m_freeCounts.erase(next->second);
-            m_freeIndices.erase(next->first);
-        }
-    }
-    if ((id + count) == m_geometryDescs.size())
-    {
-        m_geometryDescs.resize(id);
-        m_hitGroupShaderTable.resize(id * D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES * HIT_GROUP_NUM);
-    }
-    else
+    if (m_geometryDescs.size() > m_geometryDescAllocator.getCapacity())
     {
-        m_freeIndices.emplace(id, m_freeCounts.emplace(count, id));
+        m_geometryDescs.resize(m_geometryDescAllocator.getCapacity());
+        m_hitGroupShaderTable.resize(m_geometryDescs.size() * D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES * HIT_GROUP_NUM);
     }
 }
 
@@ -116,8 +68,12 @@ D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO RaytracingDevice::buildAcc
     D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO preBuildInfo{};
     m_device->GetRaytracingAccelerationStructurePrebuildInfo(&accelStructDesc.Inputs, &preBuildInfo);
 
+    const bool performUpdate = (accelStructDesc.Inputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE) != 0;
+
     if (allocation.blockAllocation == nullptr || allocation.byteSize < preBuildInfo.ResultDataMaxSizeInBytes)
     {
+        assert(!performUpdate);
+
         if (allocation.blockAllocation != nullptr)
             m_tempBottomLevelAccelStructs[m_frame].push_back(std::move(allocation));
 
@@ -127,30 +83,13 @@ D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO RaytracingDevice::buildAcc
 
     accelStructDesc.DestAccelerationStructureData = allocation.getGpuVA();
 
+    // Updates happen in place.
+    accelStructDesc.SourceAccelerationStructureData = performUpdate ? accelStructDesc.DestAccelerationStructureData : NULL;
+
     if (buildImmediate)
     {
-        // Create separate resource if it does not fit to the pool
-        if (m_scratchBufferOffset + preBuildInfo.ScratchDataSizeInBytes > SCRATCH_BUFFER_SIZE)
-        {
-            auto& scratchBuffer = m_tempBuffers[m_frame].emplace_back();
-
-            createBuffer(
-                D3D12_HEAP_TYPE_DEFAULT,
-                static_cast<uint32_t>(preBuildInfo.ScratchDataSizeInBytes),
-                D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
-                D3D12_RESOURCE_STATE_COMMON,
-                scratchBuffer);
-
-            accelStructDesc.ScratchAccelerationStructureData = scratchBuffer->GetResource()->GetGPUVirtualAddress();
-        }
-        else
-        {
-            accelStructDesc.ScratchAccelerationStructureData = 
-                m_scratchBuffers[m_frame]->GetResource()->GetGPUVirtualAddress() + m_scratchBufferOffset;
-
-            m_scratchBufferOffset = alignUp<uint32_t>(m_scratchBufferOffset +
-                static_cast<uint32_t>(preBuildInfo.ScratchDataSizeInBytes), D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
-        }
+        accelStructDesc.ScratchAccelerationStructureData = m_scratchBufferScheduler.allocate(static_cast<uint32_t>(performUpdate ?
+            preBuildInfo.UpdateScratchDataSizeInBytes : preBuildInfo.ScratchDataSizeInBytes));
 
         auto& commandList = getGraphicsCommandList();
 
@@ -161,8 +100,11 @@ D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO RaytracingDevice::buildAcc
     return preBuildInfo;
 }
 
-void RaytracingDevice::buildBottomLevelAccelStruct(BottomLevelAccelStruct& bottomLevelAccelStruct)
+void RaytracingDevice::buildBottomLevelAccelStruct(uint32_t bottomLevelAccelStructId)
 {
+    auto& bottomLevelAccelStruct = m_bottomLevelAccelStructs[bottomLevelAccelStructId];
+    bottomLevelAccelStruct.buildIndex = ++m_buildIndex;
+
     uint32_t scratchBufferSize;
 
     if (bottomLevelAccelStruct.desc.Inputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE)
@@ -176,35 +118,139 @@ void RaytracingDevice::buildBottomLevelAccelStruct(BottomLevelAccelStruct& botto
         scratchBufferSize = bottomLevelAccelStruct.scratchBufferSize;
     }
 
-    // Create separate resource if it does not fit to the pool
-    if (m_scratchBufferOffset + scratchBufferSize > SCRATCH_BUFFER_SIZE)
+    bottomLevelAccelStruct.desc.ScratchAccelerationStructureData = m_scratchBufferScheduler.allocate(scratchBufferSize);
+
+    // Compacted copies are smaller than what a full build needs.
+    if (bottomLevelAccelStruct.allocation.byteSize < bottomLevelAccelStruct.resultDataSize)
     {
-        auto& scratchBuffer = m_tempBuffers[m_frame].emplace_back();
+        m_tempBottomLevelAccelStructs[m_frame].push_back(std::move(bottomLevelAccelStruct.allocation));
+        bottomLevelAccelStruct.allocation = m_bottomLevelAccelStructAllocator.allocate(m_allocator.Get(), bottomLevelAccelStruct.resultDataSize);
+    }
 
-        createBuffer(
-            D3D12_HEAP_TYPE_DEFAULT,
-            scratchBufferSize,
-            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
-            D3D12_RESOURCE_STATE_COMMON,
-            scratchBuffer);
+    bottomLevelAccelStruct.desc.DestAccelerationStructureData = bottomLevelAccelStruct.allocation.getGpuVA();
 
-        bottomLevelAccelStruct.desc.ScratchAccelerationStructureData = scratchBuffer->GetResource()->GetGPUVirtualAddress();
-    }
-    else
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postBuildInfoDesc{};
+    uint32_t postBuildInfoDescCount = 0;
+
+    if (bottomLevelAccelStruct.desc.Inputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION)
     {
-        bottomLevelAccelStruct.desc.ScratchAccelerationStructureData =
-            m_scratchBuffers[m_frame]->GetResource()->GetGPUVirtualAddress() + m_scratchBufferOffset;
+        const uint32_t slot = m_accelStructCompactor.request(bottomLevelAccelStructId, bottomLevelAccelStruct.buildIndex);
+
+        if (slot != ~0u)
+        {
+            postBuildInfoDesc.DestBuffer = m_compactedSizeBuffers[m_frame]->GetResource()->GetGPUVirtualAddress() +
+                slot * sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC);
 
-        m_scratchBufferOffset = alignUp<uint32_t>(m_scratchBufferOffset + scratchBufferSize,
-            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+            postBuildInfoDesc.InfoType = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE;
+            postBuildInfoDescCount = 1;
+        }
     }
 
     auto& commandList = getGraphicsCommandList();
 
-    commandList.getUnderlyingCommandList()->BuildRaytracingAccelerationStructure(&bottomLevelAccelStruct.desc, 0, nullptr);
+    commandList.getUnderlyingCommandList()->BuildRaytracingAccelerationStructure(&bottomLevelAccelStruct.desc, postBuildInfoDescCount, &postBuildInfoDesc);
     commandList.uavBarrier(bottomLevelAccelStruct.allocation.blockAllocation->GetResource());
 }
 
+void RaytracingDevice::readCompactedSizes(uint32_t frame, uint32_t* compactedSizes, uint32_t count)
+{
+    const D3D12_RANGE readRange = { 0, count * sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC) };
+    void* data = nullptr;
+
+    const HRESULT hr = m_compactedSizeReadbackBuffers[frame]->GetResource()->Map(0, &readRange, &data);
+    assert(SUCCEEDED(hr) && data != nullptr);
+
+    const auto compactedSizeDescs = static_cast<const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC*>(data);
+
+    for (uint32_t i = 0; i < count; i++)
+        compactedSizes[i] = static_cast<uint32_t>(compactedSizeDescs[i].CompactedSizeInBytes);
+
+    const D3D12_RANGE writeRange = { 0, 0 };
+    m_compactedSizeReadbackBuffers[frame]->GetResource()->Unmap(0, &writeRange);
+}
+
+uint32_t RaytracingDevice::getByteSize(uint32_t id, uint64_t buildIndex)
+{
+    const auto& bottomLevelAccelStruct = m_bottomLevelAccelStructs[id];
+
+    if (bottomLevelAccelStruct.buildIndex != buildIndex || bottomLevelAccelStruct.allocation.blockAllocation == nullptr)
+        return 0;
+
+    return bottomLevelAccelStruct.allocation.byteSize;
+}
+
+void RaytracingDevice::copyCompacted(uint32_t frame, uint32_t id, uint32_t compactedSize)
+{
+    auto& bottomLevelAccelStruct = m_bottomLevelAccelStructs[id];
+    auto allocation = m_bottomLevelAccelStructAllocator.allocate(m_allocator.Get(), compactedSize);
+
+    auto& commandList = getGraphicsCommandList();
+
+    commandList.getUnderlyingCommandList()->CopyRaytracingAccelerationStructure(allocation.getGpuVA(),
+        bottomLevelAccelStruct.allocation.getGpuVA(), D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_COMPACT);
+
+    commandList.uavBarrier(allocation.blockAllocation->GetResource());
+
+    // Instances created this frame still point to the original.
+    m_compactedOriginals[frame].push_back(std::move(bottomLevelAccelStruct.allocation));
+    bottomLevelAccelStruct.allocation = std::move(allocation);
+}
+
+void RaytracingDevice::releaseOriginals(uint32_t frame)
+{
+    for (auto& subAllocation : m_compactedOriginals[frame])
+        m_bottomLevelAccelStructAllocator.free(subAllocation);
+
+    m_compactedOriginals[frame].clear();
+}
+
+void RaytracingDevice::handleAccelStructDefragmentation()
+{
+    if (m_defragmentationBlockIndex == ~0)
+        return;
+
+    const auto isInBlock = [&](const SubAllocation& allocation)
+    {
+        return allocation.virtualAllocation != 0 && allocation.blockIndex == m_defragmentationBlockIndex;
+    };
+
+    auto& commandList = getGraphicsCommandList();
+    uint32_t relocatedSize = 0;
+
+    // Move a limited amount of data every frame to avoid stalls.
+    for (auto& bottomLevelAccelStruct : m_bottomLevelAccelStructs)
+    {
+        if (relocatedSize >= MAX_DEFRAGMENTATION_SIZE)
+            break;
+
+        // Skip if it has not been built yet, there is nothing to copy.
+        if (!isInBlock(bottomLevelAccelStruct.allocation) || bottomLevelAccelStruct.buildIndex == 0)
+            continue;
+
+        auto allocation = m_bottomLevelAccelStructAllocator.allocate(m_allocator.Get(), bottomLevelAccelStruct.allocation.byteSize);
+
+        commandList.getUnderlyingCommandList()->CopyRaytracingAccelerationStructure(allocation.getGpuVA(),
+            bottomLevelAccelStruct.allocation.getGpuVA(), D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_CLONE);
+
+        commandList.uavBarrier(allocation.blockAllocation->GetResource());
+
+        relocatedSize += allocation.byteSize;
+
+        // Instances created this frame still point to the original.
+        m_tempBottomLevelAccelStructs[m_frame].push_back(std::move(bottomLevelAccelStruct.allocation));
+        bottomLevelAccelStruct.allocation = std::move(allocation);
+    }
+
+    // Top level accel structs get rebuilt every frame, dropping the allocation makes the next one build elsewhere.
+    for (auto& topLevelAccelStruct : m_topLevelAccelStructs)
+    {
+        if (isInBlock(topLevelAccelStruct.allocation))
+            m_tempBottomLevelAccelStructs[m_frame].push_back(std::move(topLevelAccelStruct.allocation));
+    }
+
+    m_defragmentationBlockIndex = ~0;
+}
+
 void RaytracingDevice::handlePendingBottomLevelAccelStructBuilds()
 {
     PIX_EVENT();
@@ -216,14 +262,32 @@ void RaytracingDevice::handlePendingBottomLevelAccelStructBuilds()
 
     commandList.commitBarriers();
 
+    m_accelStructCompactor.compact();
+    handleAccelStructDefragmentation();
+
+    const uint32_t compactionRequestOffset = m_accelStructCompactor.getRequestCount();
+
     for (const auto pendingBuild : m_pendingBuilds)
-    {
-        auto& bottomLevelAccelStruct = m_bottomLevelAccelStructs[pendingBuild];
-        buildBottomLevelAccelStruct(bottomLevelAccelStruct);
-    }
+        buildBottomLevelAccelStruct(pendingBuild);
 
     m_pendingPoses.clear();
     m_pendingBuilds.clear();
+
+    const uint32_t compactionRequestCount = m_accelStructCompactor.getRequestCount() - compactionRequestOffset;
+
+    if (compactionRequestCount != 0)
+    {
+        const auto compactedSizeBuffer = m_compactedSizeBuffers[m_frame]->GetResource();
+        const uint64_t offset = compactionRequestOffset * sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC);
+
+        commandList.transitionBarrier(compactedSizeBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        commandList.commitBarriers();
+
+        commandList.getUnderlyingCommandList()->CopyBufferRegion(m_compactedSizeReadbackBuffers[m_frame]->GetResource(), offset,
+            compactedSizeBuffer, offset, compactionRequestCount * sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC));
+
+        commandList.transitionBarrier(compactedSizeBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    }
 }
 
 void RaytracingDevice::handlePendingSmoothNormalCommands()
@@ -290,6 +354,9 @@ void RaytracingDevice::handlePendingSmoothNormalCommands()
 void RaytracingDevice::writeHitGroupShaderTable(size_t geometryIndex, size_t shaderType, bool constTexCoord)
 {
     uint8_t* hitGroupTable = &m_hitGroupShaderTable[geometryIndex * D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES * HIT_GROUP_NUM];
+    m_hitGroupShaderTableBuffer.dirtyRanges.markDirty(geometryIndex * D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES * HIT_GROUP_NUM, 
+        D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES * HIT_GROUP_NUM);
+
     void* const* hitGroups = &m_hitGroups[shaderType * (_countof(m_hitGroups) / SHADER_TYPE_MAX)];
 
     for (size_t i = 0; i < HIT_GROUP_NUM; i++)
@@ -402,7 +469,7 @@ D3D12_GPU_VIRTUAL_ADDRESS RaytracingDevice::createGlobalsRT(const MsgTraceRays&
     m_globalsRT.middleGray = message.middleGray;
     m_globalsRT.skyInRoughReflection = message.skyInRoughReflection;
     m_globalsRT.enableAccumulation = m_globalsRT.currentFrame > 0 && m_upscaler == nullptr;
-    m_globalsRT.envBrdfTextureId = m_textures[message.envBrdfTextureId].srvIndex;
+    m_globalsRT.envBrdfTextureId = getTextureSrvIndex(m_textures[message.envBrdfTextureId]);
 
     getGraphicsCommandList().transitionBarrier(m_textures[message.adaptionLuminanceTextureId].allocation->GetResource(),
         D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
@@ -415,10 +482,49 @@ D3D12_GPU_VIRTUAL_ADDRESS RaytracingDevice::createGlobalsRT(const MsgTraceRays&
     return globalsRT;
 }
 
+void RaytracingDevice::addPersistentInstances()
+{
+    for (auto& persistentInstance : m_persistentInstances)
+    {
+        if (persistentInstance.bottomLevelAccelStructId == NULL)
+            continue;
+
+        const auto& bottomLevelAccelStruct = m_bottomLevelAccelStructs[persistentInstance.bottomLevelAccelStructId];
+        if (bottomLevelAccelStruct.allocation.blockAllocation == nullptr)
+            continue;
+
+        if (!persistentInstance.materialIds.empty() && persistentInstance.srcGeometryId != bottomLevelAccelStruct.geometryId)
+            remapPersistentInstanceMaterials(persistentInstance);
+
+        auto& topLevelAccelStruct = m_topLevelAccelStructs[persistentInstance.instanceType];
+        auto& instanceDesc = topLevelAccelStruct.instanceDescs.emplace_back();
+        auto& alsoInstanceDesc = topLevelAccelStruct.alsoInstanceDescs.emplace_back();
+
+        memcpy(instanceDesc.Transform, persistentInstance.transform, sizeof(instanceDesc.Transform));
+        memcpy(alsoInstanceDesc.prevTransform, persistentInstance.prevTransform, sizeof(alsoInstanceDesc.prevTransform));
+        memcpy(alsoInstanceDesc.headTransform, persistentInstance.headTransform, sizeof(alsoInstanceDesc.headTransform));
+        alsoInstanceDesc.playableParam = persistentInstance.playableParam;
+        alsoInstanceDesc.chrPlayableMenuParam = persistentInstance.chrPlayableMenuParam;
+        alsoInstanceDesc.forceAlphaColor = persistentInstance.forceAlphaColor;
+        alsoInstanceDesc.edgeEmissionParam = persistentInstance.edgeEmissionParam;
+
+        instanceDesc.InstanceID = persistentInstance.geometryCount != 0 ? persistentInstance.geometryId : bottomLevelAccelStruct.geometryId;
+        instanceDesc.InstanceMask = persistentInstance.instanceMask;
+        instanceDesc.InstanceContributionToHitGroupIndex = instanceDesc.InstanceID * HIT_GROUP_NUM;
+        instanceDesc.Flags = bottomLevelAccelStruct.instanceFlags;
+
+        if (persistentInstance.isMirrored && !(instanceDesc.Flags & D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_CULL_DISABLE))
+            instanceDesc.Flags |= D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_FRONT_COUNTERCLOCKWISE;
+
+        instanceDesc.AccelerationStructure = bottomLevelAccelStruct.allocation.getGpuVA();
+    }
+}
+
 void RaytracingDevice::createTopLevelAccelStructs()
 {
     handlePendingBottomLevelAccelStructBuilds();
     handlePendingSmoothNormalCommands();
+    addPersistentInstances();
 
     getGraphicsCommandList().commitBarriers();
 
@@ -430,7 +536,13 @@ void RaytracingDevice::createTopLevelAccelStructs()
         {
             D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC accelStructDesc{};
             accelStructDesc.Inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
-            accelStructDesc.Inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+            accelStructDesc.Inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE |
+                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
+
+            // Refit when only transforms changed, which is most frames for static stages.
+            if (topLevelAccelStruct.getBuildType() == AccelStructBuildType::Update)
+                accelStructDesc.Inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
+
             accelStructDesc.Inputs.NumDescs = static_cast<UINT>(topLevelAccelStruct.instanceDescs.size());
             accelStructDesc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
             accelStructDesc.Inputs.InstanceDescs = createBuffer(topLevelAccelStruct.instanceDescs.data(),
@@ -629,6 +741,36 @@ void RaytracingDevice::createRaytracingTextures()
     }
 }
 
+void RaytracingDevice::removePlaceholderMaterialTextures(uint32_t materialId)
+{
+    m_placeholderMaterialTextures.erase(std::remove_if(m_placeholderMaterialTextures.begin(), m_placeholderMaterialTextures.end(),
+        [&](const PlaceholderMaterialTexture& placeholder) { return placeholder.materialId == materialId; }), m_placeholderMaterialTextures.end());
+}
+
+void RaytracingDevice::resolvePlaceholderMaterialTextures()
+{
+    for (size_t i = 0; i < m_placeholderMaterialTextures.size();)
+    {
+        const auto placeholder = m_placeholderMaterialTextures[i];
+        const auto& texture = m_textures[placeholder.textureId];
+
+        if (texture.loadTicket != 0)
+        {
+            ++i;
+            continue;
+        }
+
+        // Sampler and texture coordinate index stay in the upper bits.
+        auto& packedTexture = m_materials[placeholder.materialId].packedData[placeholder.textureIndex];
+        packedTexture = (packedTexture & ~0xFFFFFu) | texture.srvIndex;
+
+        m_materialBuffer.dirtyRanges.markDirty(placeholder.materialId * sizeof(Material), sizeof(Material));
+
+        m_placeholderMaterialTextures[i] = m_placeholderMaterialTextures.back();
+        m_placeholderMaterialTextures.pop_back();
+    }
+}
+
 void RaytracingDevice::dispatchResolver(const MsgTraceRays& message)
 {
     auto& commandList = getGraphicsCommandList();
@@ -807,6 +949,8 @@ void RaytracingDevice::procMsgCreateBottomLevelAccelStruct()
             dstGeometryDesc.texCoordOffset2 = geometryDesc.texCoordOffsets[2];
             dstGeometryDesc.texCoordOffset3 = geometryDesc.texCoordOffsets[3];
             dstGeometryDesc.materialId = geometryDesc.materialId;
+
+            m_geometryDescBuffer.dirtyRanges.markDirty((bottomLevelAccelStruct.geometryId + i) * sizeof(GeometryDesc), sizeof(GeometryDesc));
         }
 
         const auto& material = m_materials[geometryDesc.materialId];
@@ -826,11 +970,16 @@ void RaytracingDevice::procMsgCreateBottomLevelAccelStruct()
     else
         bottomLevelAccelStruct.desc.Inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
 
+    // Static geometry gets compacted a few frames after it's built.
+    if (!message.allowUpdate && !message.preferFastBuild)
+        bottomLevelAccelStruct.desc.Inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION;
+
     bottomLevelAccelStruct.desc.Inputs.NumDescs = static_cast<UINT>(bottomLevelAccelStruct.geometryDescs.size());
     bottomLevelAccelStruct.desc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
     bottomLevelAccelStruct.desc.Inputs.pGeometryDescs = bottomLevelAccelStruct.geometryDescs.data();
 
     auto preBuildInfo = buildAccelStruct(bottomLevelAccelStruct.allocation, bottomLevelAccelStruct.desc, false);
+    bottomLevelAccelStruct.resultDataSize = static_cast<uint32_t>(preBuildInfo.ResultDataMaxSizeInBytes);
     bottomLevelAccelStruct.scratchBufferSize = static_cast<uint32_t>(preBuildInfo.ScratchDataSizeInBytes);
     bottomLevelAccelStruct.updateScratchBufferSize = static_cast<uint32_t>(preBuildInfo.UpdateScratchDataSizeInBytes);
 
@@ -859,7 +1008,24 @@ void RaytracingDevice::procMsgReleaseRaytracingResource()
     case RaytracingResourceType::Material:
     {
         if (m_materials.size() > message.resourceId)
+        {
             memset(&m_materials[message.resourceId], 0, sizeof(Material));
+            m_materialBuffer.dirtyRanges.markDirty(message.resourceId * sizeof(Material), sizeof(Material));
+            removePlaceholderMaterialTextures(message.resourceId);
+        }
+        break;
+    }
+
+    case RaytracingResourceType::Instance:
+    {
+        if (m_persistentInstances.size() > message.resourceId)
+        {
+            auto& persistentInstance = m_persistentInstances[message.resourceId];
+            persistentInstance.bottomLevelAccelStructId = NULL;
+            persistentInstance.materialIds.clear();
+            remapPersistentInstanceMaterials(persistentInstance);
+        }
+
         break;
     }
 
@@ -888,32 +1054,8 @@ void RaytracingDevice::procMsgCreateInstance()
 
     if (message.dataSize > 0)
     {
-        auto& [geometryId, geometryCount] = m_tempGeometryRanges[m_frame].emplace_back();
-
-        geometryId = allocateGeometryDescs(bottomLevelAccelStruct.geometryCount);
-        geometryCount = bottomLevelAccelStruct.geometryCount;
-
-        auto& geometryDesc = m_geometryDescs[geometryId];
-
-        for (size_t i = 0; i < geometryCount; i++)
-        {
-            auto& geometry = m_geometryDescs[geometryId + i];
-            geometry = m_geometryDescs[bottomLevelAccelStruct.geometryId + i];
-
-            auto curId = reinterpret_cast<const uint32_t*>(message.data);
-            const auto lastId = reinterpret_cast<const uint32_t*>(message.data + message.dataSize);
-
-            while (curId < lastId)
-            {
-                if ((*curId) == geometry.materialId)
-                    geometry.materialId = *(curId + 1);
-
-                curId += 2;
-            }
-
-            const auto& material = m_materials[geometry.materialId];
-            writeHitGroupShaderTable(geometryId + i, material.shaderType - 1, (material.flags & MATERIAL_FLAG_CONST_TEX_COORD) != 0);
-        }
+        const uint32_t geometryId = createRemappedGeometryDescs(bottomLevelAccelStruct, message.data, message.dataSize);
+        m_tempGeometryRanges[m_frame].emplace_back(geometryId, bottomLevelAccelStruct.geometryCount);
 
         instanceDesc.InstanceID = geometryId;
     }
@@ -932,6 +1074,112 @@ void RaytracingDevice::procMsgCreateInstance()
     instanceDesc.AccelerationStructure = bottomLevelAccelStruct.allocation.getGpuVA();
 }
 
+uint32_t RaytracingDevice::createRemappedGeometryDescs(const BottomLevelAccelStruct& bottomLevelAccelStruct, const uint8_t* data, uint32_t dataSize)
+{
+    const uint32_t geometryId = allocateGeometryDescs(bottomLevelAccelStruct.geometryCount);
+
+    for (size_t i = 0; i < bottomLevelAccelStruct.geometryCount; i++)
+    {
+        auto& geometry = m_geometryDescs[geometryId + i];
+        geometry = m_geometryDescs[bottomLevelAccelStruct.geometryId + i];
+        m_geometryDescBuffer.dirtyRanges.markDirty((geometryId + i) * sizeof(GeometryDesc), sizeof(GeometryDesc));
+
+        auto curId = reinterpret_cast<const uint32_t*>(data);
+        const auto lastId = reinterpret_cast<const uint32_t*>(data + dataSize);
+
+        while (curId < lastId)
+        {
+            if ((*curId) == geometry.materialId)
+                geometry.materialId = *(curId + 1);
+
+            curId += 2;
+        }
+
+        const auto& material = m_materials[geometry.materialId];
+        writeHitGroupShaderTable(geometryId + i, material.shaderType - 1, (material.flags & MATERIAL_FLAG_CONST_TEX_COORD) != 0);
+    }
+
+    return geometryId;
+}
+
+void RaytracingDevice::remapPersistentInstanceMaterials(PersistentInstance& persistentInstance)
+{
+    // The GPU might still be reading the previous copy.
+    if (persistentInstance.geometryCount != 0)
+        m_tempGeometryRanges[m_frame].emplace_back(persistentInstance.geometryId, persistentInstance.geometryCount);
+
+    persistentInstance.geometryId = 0;
+    persistentInstance.geometryCount = 0;
+
+    if (persistentInstance.bottomLevelAccelStructId != NULL && !persistentInstance.materialIds.empty())
+    {
+        const auto& bottomLevelAccelStruct = m_bottomLevelAccelStructs[persistentInstance.bottomLevelAccelStructId];
+
+        persistentInstance.geometryId = createRemappedGeometryDescs(bottomLevelAccelStruct,
+            reinterpret_cast<const uint8_t*>(persistentInstance.materialIds.data()),
+            static_cast<uint32_t>(persistentInstance.materialIds.size() * sizeof(uint32_t)));
+
+        persistentInstance.geometryCount = bottomLevelAccelStruct.geometryCount;
+        persistentInstance.srcGeometryId = bottomLevelAccelStruct.geometryId;
+    }
+}
+
+void RaytracingDevice::procMsgCreatePersistentInstance()
+{
+    const auto& message = m_messageReceiver.getMessage<MsgCreatePersistentInstance>();
+
+    if (m_persistentInstances.size() <= message.instanceId)
+        m_persistentInstances.resize(message.instanceId + 1);
+
+    auto& persistentInstance = m_persistentInstances[message.instanceId];
+
+    memcpy(persistentInstance.transform, message.transform, sizeof(persistentInstance.transform));
+    memcpy(persistentInstance.prevTransform, message.transform, sizeof(persistentInstance.prevTransform));
+    memcpy(persistentInstance.headTransform, message.headTransform, sizeof(persistentInstance.headTransform));
+    persistentInstance.bottomLevelAccelStructId = message.bottomLevelAccelStructId;
+    persistentInstance.isMirrored = message.isMirrored;
+    persistentInstance.instanceMask = message.instanceMask;
+    persistentInstance.instanceType = message.instanceType;
+    persistentInstance.playableParam = message.playableParam;
+    persistentInstance.chrPlayableMenuParam = message.chrPlayableMenuParam;
+    persistentInstance.forceAlphaColor = message.forceAlphaColor;
+    persistentInstance.edgeEmissionParam = message.edgeEmissionParam;
+
+    persistentInstance.materialIds.assign(reinterpret_cast<const uint32_t*>(message.data),
+        reinterpret_cast<const uint32_t*>(message.data + message.dataSize));
+
+    remapPersistentInstanceMaterials(persistentInstance);
+}
+
+void RaytracingDevice::procMsgUpdatePersistentInstance()
+{
+    const auto& message = m_messageReceiver.getMessage<MsgUpdatePersistentInstance>();
+    auto& persistentInstance = m_persistentInstances[message.instanceId];
+
+    // Previous transform only differs for the frame the instance moved in.
+    memcpy(persistentInstance.prevTransform, persistentInstance.transform, sizeof(persistentInstance.prevTransform));
+    memcpy(persistentInstance.transform, message.transform, sizeof(persistentInstance.transform));
+    memcpy(persistentInstance.headTransform, message.headTransform, sizeof(persistentInstance.headTransform));
+    persistentInstance.isMirrored = message.isMirrored;
+    persistentInstance.playableParam = message.playableParam;
+    persistentInstance.chrPlayableMenuParam = message.chrPlayableMenuParam;
+    persistentInstance.forceAlphaColor = message.forceAlphaColor;
+    persistentInstance.edgeEmissionParam = message.edgeEmissionParam;
+
+    m_updatedPersistentInstances.push_back(message.instanceId);
+}
+
+void RaytracingDevice::procMsgUpdatePersistentInstanceMaterials()
+{
+    const auto& message = m_messageReceiver.getMessage<MsgUpdatePersistentInstanceMaterials>();
+    auto& persistentInstance = m_persistentInstances[message.instanceId];
+
+    persistentInstance.materialIds.assign(reinterpret_cast<const uint32_t*>(message.data),
+        reinterpret_cast<const uint32_t*>(message.data + message.dataSize));
+
+    remapPersistentInstanceMaterials(persistentInstance);
+}
+
 void RaytracingDevice::procMsgTraceRays()
 {
     const auto& message = m_messageReceiver.getMessage<MsgTraceRays>();
@@ -1012,11 +1260,16 @@ void RaytracingDevice::procMsgTraceRays()
     const auto topLevelAccelStructTransparent = !m_topLevelAccelStructs[INSTANCE_TYPE_TRANSPARENT].instanceDescs.empty() ?
         m_topLevelAccelStructs[INSTANCE_TYPE_TRANSPARENT].allocation.getGpuVA() : NULL;
 
-    const auto geometryDescs = createBuffer(m_geometryDescs.data(), 
-        static_cast<uint32_t>(m_geometryDescs.size() * sizeof(GeometryDesc)), 0x10);
+    const auto geometryDescs = updatePersistentBuffer(m_geometryDescBuffer, m_geometryDescs.data(), 
+        static_cast<uint32_t>(m_geometryDescs.size() * sizeof(GeometryDesc)));
 
-    const auto materials = createBuffer(m_materials.data(),
-        static_cast<uint32_t>(m_materials.size() * sizeof(Material)), 0x10);
+    resolvePlaceholderMaterialTextures();
+
+    const auto materials = updatePersistentBuffer(m_materialBuffer, m_materials.data(),
+        static_cast<uint32_t>(m_materials.size() * sizeof(Material)));
+
+    const auto hitGroupShaderTable = updatePersistentBuffer(m_hitGroupShaderTableBuffer, 
+        m_hitGroupShaderTable.data(), static_cast<uint32_t>(m_hitGroupShaderTable.size()));
 
     const auto instanceDescs = createBuffer(m_topLevelAccelStructs[INSTANCE_TYPE_OPAQUE].alsoInstanceDescs.data(),
         static_cast<uint32_t>(m_topLevelAccelStructs[INSTANCE_TYPE_OPAQUE].alsoInstanceDescs.size() * sizeof(InstanceDesc)), 0x10);
@@ -1061,9 +1314,6 @@ void RaytracingDevice::procMsgTraceRays()
     const auto missShaderTable = createBuffer(
         m_missShaderTable.data(), static_cast<uint32_t>(m_missShaderTable.size()), D3D12_RAYTRACING_SHADER_TABLE_BYTE_ALIGNMENT);
 
-    const auto hitGroupShaderTable = createBuffer(
-        m_hitGroupShaderTable.data(), static_cast<uint32_t>(m_hitGroupShaderTable.size()), D3D12_RAYTRACING_SHADER_TABLE_BYTE_ALIGNMENT);
-
     D3D12_DISPATCH_RAYS_DESC dispatchRaysDesc{};
     dispatchRaysDesc.RayGenerationShaderRecord.StartAddress = rayGenShaderTable;
     dispatchRaysDesc.RayGenerationShaderRecord.SizeInBytes = D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES;
@@ -1377,6 +1627,8 @@ void RaytracingDevice::procMsgCreateMaterial()
         m_materials.resize(message.materialId + 1);
 
     auto& material = m_materials[message.materialId];
+    m_materialBuffer.dirtyRanges.markDirty(message.materialId * sizeof(Material), sizeof(Material));
+    removePlaceholderMaterialTextures(message.materialId);
 
     material.shaderType = message.shaderType + 1;
     material.flags = message.flags;
@@ -1420,7 +1672,11 @@ void RaytracingDevice::procMsgCreateMaterial()
                     m_samplerDescriptorHeap.getCpuHandle(sampler));
             }
 
-            dstTexture = m_textures[srcTexture.id].srvIndex;
+            const auto& texture = m_textures[srcTexture.id];
+            if (texture.loadTicket != 0)
+                m_placeholderMaterialTextures.push_back({ message.materialId, static_cast<uint32_t>(i), srcTexture.id });
+
+            dstTexture = getTextureSrvIndex(texture);
             dstTexture |= sampler << 20;
             dstTexture |= srcTexture.texCoordIndex << 30;
         }
@@ -1609,7 +1865,7 @@ void RaytracingDevice::procMsgRenderSky()
         {
             if (srcTexture.id != NULL)
             {
-                dstTexture = m_textures[srcTexture.id].srvIndex;
+                dstTexture = getTextureSrvIndex(m_textures[srcTexture.id]);
 
                 if (samplerDesc.AddressU != srcTexture.addressModeU ||
                     samplerDesc.AddressV != srcTexture.addressModeV)
@@ -1654,7 +1910,7 @@ void RaytracingDevice::procMsgRenderSky()
             pipelineDesc.BlendState.RenderTarget[0].BlendEnable = blendEnable;
             pipelineDesc.BlendState.RenderTarget[0].DestBlend = destBlend;
 
-            auto& pipeline = m_pipelines[XXH3_64bits(&pipelineDesc, sizeof(pipelineDesc))];
+            auto& pipeline = m_pipelines[XXH3_64bits(&pipelineDesc, sizeof(pipelineDesc))].pipeline;
             if (!pipeline)
                 m_device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(pipeline.GetAddressOf()));
 
@@ -1909,25 +2165,38 @@ bool RaytracingDevice::processRaytracingMessage()
     case MsgDispatchUpscaler::s_id: procMsgDispatchUpscaler(); break;
     case MsgDrawIm3d::s_id: procMsgDrawIm3d(); break;
     case MsgComputeGrassInstancer::s_id: procMsgComputeGrassInstancer(); break;
+    case MsgCreatePersistentInstance::s_id: procMsgCreatePersistentInstance(); break;
+    case MsgUpdatePersistentInstance::s_id: procMsgUpdatePersistentInstance(); break;
+    case MsgUpdatePersistentInstanceMaterials::s_id: procMsgUpdatePersistentInstanceMaterials(); break;
     default: return false;
     }
 
     return true;
 }
 
+void RaytracingDevice::invalidateRaytracingState()
+{
+    m_curRootSignature = nullptr;
+}
+
 void RaytracingDevice::releaseRaytracingResources()
 {
     m_curRootSignature = nullptr;
     m_curPipeline = nullptr;
-    m_scratchBufferOffset = 0;
     m_globalsPS.exposureTextureId = NULL;
 
+    m_scratchBufferScheduler.beginFrame(m_frame);
+
+    m_accelStructCompactor.beginFrame(m_frame);
+
     for (auto& subAllocation : m_tempBottomLevelAccelStructs[m_frame])
         m_bottomLevelAccelStructAllocator.free(subAllocation);
 
     m_bottomLevelAccelStructAllocator.freeBlocks(m_tempBuffers[m_frame]);
     m_tempBottomLevelAccelStructs[m_frame].clear();
 
+    m_defragmentationBlockIndex = m_bottomLevelAccelStructAllocator.getDefragmentationBlockIndex();
+
     while (!m_materials.empty() && m_materials.back().shaderType == NULL)
         m_materials.pop_back();
 
@@ -1937,6 +2206,14 @@ void RaytracingDevice::releaseRaytracingResources()
         topLevelAccelStruct.alsoInstanceDescs.clear();
     }
 
+    for (const auto instanceId : m_updatedPersistentInstances)
+    {
+        auto& persistentInstance = m_persistentInstances[instanceId];
+        memcpy(persistentInstance.prevTransform, persistentInstance.transform, sizeof(persistentInstance.prevTransform));
+    }
+
+    m_updatedPersistentInstances.clear();
+
     for (auto& [geometryId, geometryCount] : m_tempGeometryRanges[m_frame])
         freeGeometryDescs(geometryId, geometryCount);
 
@@ -2159,18 +2436,26 @@ RaytracingDevice::RaytracingDevice(const IniFile& iniFile) : Device(iniFile)
     for (size_t i = 0; i < _countof(m_hitGroups); i++)
         m_hitGroups[i] = m_properties->GetShaderIdentifier(s_shaderHitGroups[i]);
 
-    for (auto& scratchBuffer : m_scratchBuffers)
+    // Other frames create their scratch pool once they begin.
+    m_scratchBufferScheduler.beginFrame(m_frame);
+
+    for (size_t i = 0; i < NUM_FRAMES; i++)
     {
+        const uint32_t compactedSizeBufferSize = m_accelStructCompactor.getMaxRequestCount() * sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC);
+
         createBuffer(
             D3D12_HEAP_TYPE_DEFAULT,
-            SCRATCH_BUFFER_SIZE,
+            compactedSizeBufferSize,
             D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
-            D3D12_RESOURCE_STATE_COMMON,
-            scratchBuffer);
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            m_compactedSizeBuffers[i]);
 
-#ifdef _DEBUG
-        scratchBuffer->GetResource()->SetName(L"Scratch Buffer");
-#endif
+        createBuffer(
+            D3D12_HEAP_TYPE_READBACK,
+            compactedSizeBufferSize,
+            D3D12_RESOURCE_FLAG_NONE,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            m_compactedSizeReadbackBuffers[i]);
     }
 
     m_uavId = m_descriptorHeap.allocateMany(s_textureCount);
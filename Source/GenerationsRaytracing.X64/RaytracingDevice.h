@@ -1,13 +1,17 @@
 #pragma once
 
+#include "AccelStructCompactor.h"
 #include "BottomLevelAccelStruct.h"
 #include "DebugView.h"
+#include "DeviceScratchBufferRecorder.h"
 #include "Device.h"
 #include "GeometryDesc.h"
 #include "InstanceDesc.h"
 #include "LocalLight.h"
 #include "Material.h"
 #include "NGX.h"
+#include "PersistentInstance.h"
+#include "RangeAllocator.h"
 #include "HitGroups.h"
 #include "SubAllocator.h"
 #include "Upscaler.h"
@@ -71,7 +75,7 @@ struct SmoothNormalCmd
     bool isMirrored;
 };
 
-class RaytracingDevice final : public Device
+class RaytracingDevice final : public Device, protected AccelStructCompactionDevice
 {
 protected:
     // Global
@@ -85,14 +89,20 @@ protected:
     std::vector<uint8_t> m_rayGenShaderTable;
     std::vector<uint8_t> m_missShaderTable;
     std::vector<uint8_t> m_hitGroupShaderTable;
+    PersistentBuffer m_hitGroupShaderTableBuffer;
     GlobalsRT m_globalsRT;
 
     bool m_serSupported = false;
     uint32_t m_serUavId = 0;
 
     // Accel Struct
-    ComPtr<D3D12MA::Allocation> m_scratchBuffers[NUM_FRAMES];
-    uint32_t m_scratchBufferOffset = 0;
+    DeviceScratchBufferRecorder m_scratchBufferRecorder{ *this };
+    ScratchBufferScheduler<NUM_FRAMES> m_scratchBufferScheduler{
+        m_scratchBufferRecorder,
+        32 * 1024 * 1024,
+        256 * 1024 * 1024,
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT,
+        1024 * 1024 };
 
     // Bottom Level Accel Struct
     SubAllocator m_bottomLevelAccelStructAllocator{
@@ -103,16 +113,39 @@ protected:
 
     std::vector<BottomLevelAccelStruct> m_bottomLevelAccelStructs;
     std::vector<GeometryDesc> m_geometryDescs;
-    std::multimap<uint32_t, uint32_t> m_freeCounts;
-    std::map<uint32_t, std::multimap<uint32_t, uint32_t>::iterator> m_freeIndices;
+    PersistentBuffer m_geometryDescBuffer;
+    RangeAllocator m_geometryDescAllocator;
     std::vector<uint32_t> m_pendingBuilds;
     std::vector<SubAllocation> m_tempBottomLevelAccelStructs[NUM_FRAMES];
+
+    // Compaction, sizes are read back once the frame that built them completes.
+    uint64_t m_buildIndex = 0;
+
+    ComPtr<D3D12MA::Allocation> m_compactedSizeBuffers[NUM_FRAMES];
+    ComPtr<D3D12MA::Allocation> m_compactedSizeReadbackBuffers[NUM_FRAMES];
+    std::vector<SubAllocation> m_compactedOriginals[NUM_FRAMES];
+    AccelStructCompactor<NUM_FRAMES> m_accelStructCompactor{ *this, 4096 };
+
+    uint32_t m_defragmentationBlockIndex = ~0;
     
     // Material
     std::vector<Material> m_materials;
+    PersistentBuffer m_materialBuffer;
+
+    // Material textures that point to the placeholder view until their texture is loaded.
+    struct PlaceholderMaterialTexture
+    {
+        uint32_t materialId;
+        uint32_t textureIndex;
+        uint32_t textureId;
+    };
+
+    std::vector<PlaceholderMaterialTexture> m_placeholderMaterialTextures;
 
     // Top Level Accel Struct
     TopLevelAccelStruct m_topLevelAccelStructs[INSTANCE_TYPE_NUM];
+    std::vector<PersistentInstance> m_persistentInstances;
+    std::vector<uint32_t> m_updatedPersistentInstances;
     std::vector<std::pair<uint32_t, uint32_t>> m_tempGeometryRanges[NUM_FRAMES];
 
     // Upscaler
@@ -220,18 +253,31 @@ protected:
     D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO buildAccelStruct(SubAllocation& allocation,
         D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC& accelStructDesc, bool buildImmediate);
 
-    void buildBottomLevelAccelStruct(BottomLevelAccelStruct& bottomLevelAccelStruct);
+    void buildBottomLevelAccelStruct(uint32_t bottomLevelAccelStructId);
 
+    void readCompactedSizes(uint32_t frame, uint32_t* compactedSizes, uint32_t count) override;
+    uint32_t getByteSize(uint32_t id, uint64_t buildIndex) override;
+    void copyCompacted(uint32_t frame, uint32_t id, uint32_t compactedSize) override;
+    void releaseOriginals(uint32_t frame) override;
+
+    void handleAccelStructDefragmentation();
     void handlePendingBottomLevelAccelStructBuilds();
 
     void handlePendingSmoothNormalCommands();
 
     void writeHitGroupShaderTable(size_t geometryIndex, size_t shaderType, bool constTexCoord);
 
+    // Copies the geometry descs of the bottom level acceleration structure and replaces their materials.
+    uint32_t createRemappedGeometryDescs(const BottomLevelAccelStruct& bottomLevelAccelStruct, const uint8_t* data, uint32_t dataSize);
+    void remapPersistentInstanceMaterials(PersistentInstance& persistentInstance);
+
     D3D12_GPU_VIRTUAL_ADDRESS createGlobalsRT(const MsgTraceRays& message);
+    void addPersistentInstances();
     void createTopLevelAccelStructs();
 
     void createRaytracingTextures();
+    void removePlaceholderMaterialTextures(uint32_t materialId);
+    void resolvePlaceholderMaterialTextures();
     void dispatchResolver(const MsgTraceRays& message);
     void copyToRenderTargetAndDepthStencil(const MsgDispatchUpscaler& message);
     void prepareForDispatchUpscaler(const MsgTraceRays& message);
@@ -252,9 +298,13 @@ protected:
     void procMsgDispatchUpscaler();
     void procMsgDrawIm3d();
     void procMsgComputeGrassInstancer();
+    void procMsgCreatePersistentInstance();
+    void procMsgUpdatePersistentInstance();
+    void procMsgUpdatePersistentInstanceMaterials();
 
     bool processRaytracingMessage() override;
     void releaseRaytracingResources() override;
+    void invalidateRaytracingState() override;
 
 public:
     RaytracingDevice(const IniFile& iniFile);
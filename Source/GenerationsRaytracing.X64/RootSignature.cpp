@@ -7,7 +7,8 @@ void RootSignature::create(ID3D12Device* device,
     uint32_t staticSamplerCount,
     D3D12_ROOT_SIGNATURE_FLAGS flags,
     ComPtr<ID3D12RootSignature>& rootSignature,
-    const char* rootSignatureName)
+    const char* rootSignatureName,
+    XXH64_hash_t* blobHash)
 {
     assert(rootSignature == nullptr);
 
@@ -50,6 +51,9 @@ void RootSignature::create(ID3D12Device* device,
     fclose(file);
 #endif
 
+    if (blobHash != nullptr)
+        *blobHash = XXH3_64bits(blob->GetBufferPointer(), blob->GetBufferSize());
+
     hr = device->CreateRootSignature(
         0,
         blob->GetBufferPointer(),
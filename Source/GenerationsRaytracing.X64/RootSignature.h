@@ -9,5 +9,6 @@ struct RootSignature
         uint32_t staticSamplerCount,
         D3D12_ROOT_SIGNATURE_FLAGS flags,
         ComPtr<ID3D12RootSignature>& rootSignature,
-        const char* rootSignatureName);
+        const char* rootSignatureName,
+        XXH64_hash_t* blobHash = nullptr);
 };
\ No newline at end of file
@@ -2,99 +2,253 @@
 
 #include "ShaderConverter.h"
 
-#pragma pack(push, 1)
-struct BlockHeader
+static void compressShader(XXH64_hash_t hash, const void* data, uint32_t dataSize, 
+    std::vector<CompressedShader>& shaders, std::vector<std::unique_ptr<uint8_t[]>>& compressedBlocks)
 {
-    uint32_t version;
-    uint32_t uncompressedSize;
-    uint32_t compressedSize;
-};
+    const int compressBound = LZ4_compressBound(static_cast<int>(dataSize));
+    auto& compressedBlock = compressedBlocks.emplace_back(new uint8_t[compressBound]);
 
-struct ShaderHeader
+    const int compressedSize = LZ4_compress_default(
+        reinterpret_cast<const char*>(data),
+        reinterpret_cast<char*>(compressedBlock.get()),
+        static_cast<int>(dataSize),
+        compressBound);
+
+    shaders.push_back({ hash, compressedBlock.get(), static_cast<uint32_t>(compressedSize), dataSize });
+}
+
+static bool writeShaderCache(const char* name, std::vector<CompressedShader>& shaders)
 {
-    XXH64_hash_t hash;
-    uint32_t dataSize;
-};
-#pragma pack(pop)
+    FILE* file = fopen(name, "wb");
+    if (file == nullptr)
+        return false;
+
+    const bool result = ShaderCacheIndex::write(file, shaders);
+
+    if (fclose(file) != 0 || !result)
+    {
+        DeleteFileA(name);
+        return false;
+    }
 
-bool ShaderCache::loadShaderCache(const char* name)
+    return true;
+}
+
+bool ShaderCache::mapFile(const char* name, MappedFile& mappedFile)
 {
-    FILE* file = fopen(name, "rb");
-    if (file != nullptr)
+    mappedFile.fileHandle = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mappedFile.fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize{};
+    if (GetFileSizeEx(mappedFile.fileHandle, &fileSize) && fileSize.QuadPart > 0)
     {
-        fseek(file, 0, SEEK_END);
-        const long fileSize = ftell(file);
-        fseek(file, 0, SEEK_SET);
+        mappedFile.mappingHandle = CreateFileMappingA(mappedFile.fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappedFile.mappingHandle != nullptr)
+        {
+            mappedFile.data = static_cast<const uint8_t*>(MapViewOfFile(mappedFile.mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            mappedFile.dataSize = static_cast<size_t>(fileSize.QuadPart);
+        }
+    }
+
+    if (mappedFile.data == nullptr)
+    {
+        unmapFile(mappedFile);
+        return false;
+    }
+
+    return true;
+}
+
+void ShaderCache::unmapFile(MappedFile& mappedFile)
+{
+    mappedFile.index.close();
+
+    if (mappedFile.data != nullptr)
+        UnmapViewOfFile(mappedFile.data);
+
+    if (mappedFile.mappingHandle != nullptr)
+        CloseHandle(mappedFile.mappingHandle);
+
+    if (mappedFile.fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(mappedFile.fileHandle);
+
+    mappedFile = {};
+}
+
+bool ShaderCache::mapShaderCache(const char* name, MappedFile& mappedFile)
+{
+    if (!mapFile(name, mappedFile))
+        return false;
 
-        std::vector<uint8_t> compressedBlock;
-        long filePosition;
+    if (mappedFile.index.open(mappedFile.data, mappedFile.dataSize))
+        return true;
+
+    unmapFile(mappedFile);
+    return false;
+}
 
-        while ((filePosition = ftell(file)) < fileSize)
+bool ShaderCache::convertLegacyShaderCache(const char* name, const char* convertedName)
+{
+    FILE* file = fopen(name, "rb");
+    if (file == nullptr)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    const long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    std::vector<uint8_t> compressedBlock;
+    std::vector<uint8_t> uncompressedBlock;
+    std::vector<CompressedShader> shaders;
+    std::vector<std::unique_ptr<uint8_t[]>> compressedBlocks;
+    long filePosition;
+
+    while ((filePosition = ftell(file)) < fileSize)
+    {
+        ShaderCacheBlockHeader blockHeader{};
+        bool isBlockValid = false;
+
+        if (fread(&blockHeader, sizeof(ShaderCacheBlockHeader), 1, file) == 1 && blockHeader.uncompressedSize > 0 &&
+            blockHeader.compressedSize > 0 && blockHeader.compressedSize <= static_cast<uint32_t>(fileSize - filePosition))
         {
-            BlockHeader blockHeader{};
-            bool isBlockValid = false;
+            compressedBlock.resize(blockHeader.compressedSize);
 
-            if (fread(&blockHeader, sizeof(BlockHeader), 1, file) == 1 && blockHeader.uncompressedSize > 0 &&
-                blockHeader.compressedSize > 0 && blockHeader.compressedSize <= static_cast<uint32_t>(fileSize - filePosition))
+            if (fread(compressedBlock.data(), 1, compressedBlock.size(), file) == blockHeader.compressedSize)
             {
-                compressedBlock.resize(blockHeader.compressedSize);
-
-                if (fread(compressedBlock.data(), 1, compressedBlock.size(), file) == blockHeader.compressedSize)
-                {
-                    auto& uncompressedBlock = m_blocks.emplace_back(new uint8_t[blockHeader.uncompressedSize]);
-
-                    const int decompressedSize = LZ4_decompress_safe(
-                        reinterpret_cast<const char*>(compressedBlock.data()), 
-                        reinterpret_cast<char*>(uncompressedBlock.get()), 
-                        static_cast<int>(blockHeader.compressedSize), 
-                        static_cast<int>(blockHeader.uncompressedSize));
-
-                   if (static_cast<uint32_t>(decompressedSize) == blockHeader.uncompressedSize)
-                   {
-                       const uint8_t* blockPtr = uncompressedBlock.get();
-
-                       while (blockPtr < (uncompressedBlock.get() + blockHeader.uncompressedSize))
-                       {
-                           const ShaderHeader* shaderHeader = reinterpret_cast<const ShaderHeader*>(blockPtr);
-                           blockPtr += sizeof(ShaderHeader);
-
-                           m_shaders.emplace(shaderHeader->hash, Shader{ blockPtr, shaderHeader->dataSize });
-                           blockPtr += shaderHeader->dataSize;
-                       }
-
-                       isBlockValid = true;
-                   }
-                }
+                uncompressedBlock.resize(blockHeader.uncompressedSize);
+
+                const int decompressedSize = LZ4_decompress_safe(
+                    reinterpret_cast<const char*>(compressedBlock.data()), 
+                    reinterpret_cast<char*>(uncompressedBlock.data()), 
+                    static_cast<int>(blockHeader.compressedSize), 
+                    static_cast<int>(blockHeader.uncompressedSize));
+
+                isBlockValid = static_cast<uint32_t>(decompressedSize) == blockHeader.uncompressedSize &&
+                    ShaderCacheIndex::forEachBlockShader(uncompressedBlock.data(), blockHeader.uncompressedSize,
+                        [&](uint64_t hash, const uint8_t* data, uint32_t dataSize)
+                        {
+                            compressShader(hash, data, dataSize, shaders, compressedBlocks);
+                        });
             }
-
-            if (!isBlockValid)
-                break;
         }
 
-        fclose(file);
+        if (!isBlockValid)
+            break;
+    }
+
+    fclose(file);
+
+    const std::string tempName = std::string(convertedName) + ".tmp";
+
+    if (!writeShaderCache(tempName.c_str(), shaders))
+        return false;
+
+    if (!MoveFileExA(tempName.c_str(), convertedName, MOVEFILE_REPLACE_EXISTING))
+    {
+        DeleteFileA(tempName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+static bool isNewerOrSame(const char* name, const char* otherName)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes{};
+    WIN32_FILE_ATTRIBUTE_DATA otherAttributes{};
+
+    return GetFileAttributesExA(name, GetFileExInfoStandard, &attributes) &&
+        GetFileAttributesExA(otherName, GetFileExInfoStandard, &otherAttributes) &&
+        CompareFileTime(&attributes.ftLastWriteTime, &otherAttributes.ftLastWriteTime) >= 0;
+}
+
+bool ShaderCache::loadShaderCache(const char* name, const char* convertedName, MappedFile& mappedFile)
+{
+    if (mapShaderCache(name, mappedFile))
+        return true;
+
+    if (convertedName == nullptr)
+        return convertLegacyShaderCache(name, name) && mapShaderCache(name, mappedFile);
 
+    // Converted only once, and again after the file gets replaced by a newer version.
+    if (isNewerOrSame(convertedName, name) && mapShaderCache(convertedName, mappedFile))
         return true;
+
+    return convertLegacyShaderCache(name, convertedName) && mapShaderCache(convertedName, mappedFile);
+}
+
+const uint8_t* ShaderCache::decompressShader(const MappedFile& mappedFile, XXH64_hash_t hash, uint32_t& dataSize)
+{
+    const ShaderCacheEntry* entry = mappedFile.index.find(hash);
+    if (entry == nullptr)
+        return nullptr;
+
+    auto& decompressedShader = m_decompressedShaders.emplace_back(new uint8_t[entry->uncompressedSize]);
+
+    const int decompressedSize = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(mappedFile.index.getCompressedData(*entry)),
+        reinterpret_cast<char*>(decompressedShader.get()),
+        static_cast<int>(entry->compressedSize),
+        static_cast<int>(entry->uncompressedSize));
+
+    if (static_cast<uint32_t>(decompressedSize) != entry->uncompressedSize)
+    {
+        m_decompressedShaders.pop_back();
+        return nullptr;
     }
 
-    return false;
+    dataSize = entry->uncompressedSize;
+    return decompressedShader.get();
+}
+
+const uint8_t* ShaderCache::findCachedShader(uint64_t hash, uint32_t& dataSize)
+{
+    const uint8_t* data = decompressShader(m_pregeneratedFile, hash, dataSize);
+    if (data == nullptr)
+        data = decompressShader(m_runtimeFile, hash, dataSize);
+
+    return data;
+}
+
+void ShaderCache::loadConverter()
+{
+    m_shaderConverter.loadUnmanagedLibrary();
+}
+
+void* ShaderCache::convertShader(const void* data, uint32_t dataSize, uint32_t& convertedSize)
+{
+    return m_shaderConverter.convertShader(data, dataSize, convertedSize);
+}
+
+const uint8_t* ShaderCache::getConvertedData(void* handle)
+{
+    return static_cast<const uint8_t*>(m_shaderConverter.getPointerFromHandle(handle));
+}
+
+void ShaderCache::freeConvertedShader(void* handle)
+{
+    m_shaderConverter.freeHandle(handle);
 }
 
 ShaderCache::ShaderCache()
+    : m_conversionService(*this, std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u))
 {
-    if (!loadShaderCache("pregenerated_shader_cache.bin"))
+    // The pregenerated cache ships with the mod, so its conversion goes to a file of its own.
+    if (!loadShaderCache("pregenerated_shader_cache.bin", "pregenerated_shader_cache_converted.bin", m_pregeneratedFile))
     {
         MessageBox(nullptr,
             TEXT("Unable to open \"pregenerated_shader_cache.bin\" in mod directory."),
             TEXT("Generations Raytracing"),
             MB_ICONERROR);
     }
-    loadShaderCache("runtime_generated_shader_cache.bin");
+    loadShaderCache("runtime_generated_shader_cache.bin", nullptr, m_runtimeFile);
 }
 
 ShaderCache::~ShaderCache()
 {
-    for (const auto& handle : m_handles)
-        m_shaderConverter.freeHandle(handle.handlePtr);
+    unmapFile(m_pregeneratedFile);
+    unmapFile(m_runtimeFile);
 }
 
 static XXH64_hash_t getHash(const uint8_t* data, uint32_t dataSize)
@@ -115,75 +269,60 @@ static XXH64_hash_t getHash(const uint8_t* data, uint32_t dataSize)
     return XXH3_64bits(data, dataSize);
 }
 
-std::unique_ptr<uint8_t[]> ShaderCache::getShader(const void* data, uint32_t dataSize, uint32_t& convertedSize)
+const uint8_t* ShaderCache::getShader(const void* data, uint32_t dataSize, XXH64_hash_t& hash, uint32_t& convertedSize, bool async)
 {
-    const XXH64_hash_t hash = getHash(reinterpret_cast<const uint8_t*>(data), dataSize);
-    auto& shader = m_shaders[hash];
-
-    if (shader.data == nullptr)
-    {
-        m_shaderConverter.loadUnmanagedLibrary();
-
-        auto& handle = m_handles.emplace_back();
-        handle.hash = hash;
-        handle.handlePtr = m_shaderConverter.convertShader(data, dataSize, handle.dataSize);
-
-        shader.data = m_shaderConverter.getPointerFromHandle(handle.handlePtr);
-        shader.dataSize = handle.dataSize;
-    }
-
-    auto convertedShader = std::make_unique<uint8_t[]>(shader.dataSize);
-    memcpy(convertedShader.get(), shader.data, shader.dataSize);
-    convertedSize = shader.dataSize;
+    hash = getHash(reinterpret_cast<const uint8_t*>(data), dataSize);
+    return m_conversionService.getShader(hash, data, dataSize, convertedSize, async);
+}
 
-    return convertedShader;
+const uint8_t* ShaderCache::getConvertedShader(XXH64_hash_t hash, uint32_t& convertedSize)
+{
+    return m_conversionService.getConvertedShader(hash, convertedSize);
 }
 
-void ShaderCache::saveShaderCache() const
+void ShaderCache::saveShaderCache()
 {
-    if (!m_handles.empty())
+    const auto& convertedShaders = m_conversionService.getConvertedShaders();
+
+    if (m_savedShaderCount < convertedShaders.size())
     {
-        FILE* file = fopen("runtime_generated_shader_cache.bin", "ab");
-        if (file != nullptr)
-        {
-            BlockHeader blockHeader{};
+        std::vector<CompressedShader> shaders;
+        std::vector<std::unique_ptr<uint8_t[]>> compressedBlocks;
 
-            for (const auto& handle : m_handles)
-                blockHeader.uncompressedSize += sizeof(ShaderHeader) + handle.dataSize;
+        // Entries already on disk are copied without recompressing them.
+        m_runtimeFile.index.getShaders(shaders);
 
-            const auto uncompressedBlock = std::make_unique<uint8_t[]>(blockHeader.uncompressedSize);
-            uint8_t* blockPtr = uncompressedBlock.get();
+        for (size_t i = m_savedShaderCount; i < convertedShaders.size(); i++)
+        {
+            const auto& convertedShader = convertedShaders[i];
+            compressShader(convertedShader.hash, getConvertedData(convertedShader.handle), convertedShader.dataSize, shaders, compressedBlocks);
+        }
 
-            for (const auto& handle : m_handles)
-            {
-                const auto shaderHeader = reinterpret_cast<ShaderHeader*>(blockPtr);
-                shaderHeader->hash = handle.hash;
-                shaderHeader->dataSize = handle.dataSize;
-                blockPtr += sizeof(ShaderHeader);
+        bool saved = false;
 
-                memcpy(blockPtr, m_shaderConverter.getPointerFromHandle(handle.handlePtr), handle.dataSize);
-                blockPtr += handle.dataSize;
-            }
+        if (writeShaderCache("runtime_generated_shader_cache.bin.tmp", shaders))
+        {
+            // The file can't be replaced while it's mapped. If moving fails, the old one is still there to map again,
+            // and the new shaders stay unsaved so the next save tries again.
+            unmapFile(m_runtimeFile);
 
-            const int compressBound = LZ4_compressBound(static_cast<int>(blockHeader.uncompressedSize));
-            const auto compressedBlock = std::make_unique<uint8_t[]>(compressBound);
+            saved = MoveFileExA("runtime_generated_shader_cache.bin.tmp", "runtime_generated_shader_cache.bin", MOVEFILE_REPLACE_EXISTING) != FALSE;
+            if (!saved)
+                DeleteFileA("runtime_generated_shader_cache.bin.tmp");
 
-            blockHeader.compressedSize = static_cast<uint32_t>(LZ4_compress_default(
-                reinterpret_cast<const char*>(uncompressedBlock.get()),
-                reinterpret_cast<char*>(compressedBlock.get()),
-                static_cast<int>(blockHeader.uncompressedSize),
-                compressBound));
+            mapShaderCache("runtime_generated_shader_cache.bin", m_runtimeFile);
+        }
 
-            fwrite(&blockHeader, sizeof(BlockHeader), 1, file);
-            fwrite(compressedBlock.get(), 1, blockHeader.compressedSize, file);
-            fclose(file);
+        if (saved)
+        {
+            m_savedShaderCount = convertedShaders.size();
         }
         else
         {
             MessageBox(nullptr,
-                TEXT("Unable to open \"runtime_generated_shader_cache.bin\" in mod directory."),
+                TEXT("Unable to save \"runtime_generated_shader_cache.bin\" in mod directory."),
                 TEXT("Generations Raytracing"),
                 MB_ICONERROR);
         }
     }
-}
+}
\ No newline at end of file
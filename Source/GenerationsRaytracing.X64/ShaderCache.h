@@ -1,34 +1,52 @@
 #pragma once
+#include "ShaderCacheIndex.h"
+#include "ShaderConversionService.h"
 #include "ShaderConverter.h"
 #include "xxHashMap.h"
 
-class ShaderCache
+class ShaderCache : protected ShaderConversionBackend
 {
 protected:
-    struct Shader
+    // Sorted index of individually compressed shaders, mapped into memory.
+    struct MappedFile
     {
-        const void* data;
-        uint32_t dataSize;
-    };
-
-    struct ShaderHandle
-    {
-        XXH64_hash_t hash;
-        void* handlePtr;
-        uint32_t dataSize;
+        HANDLE fileHandle = INVALID_HANDLE_VALUE;
+        HANDLE mappingHandle = nullptr;
+        const uint8_t* data = nullptr;
+        size_t dataSize = 0;
+        ShaderCacheIndex index;
     };
 
     ShaderConverter m_shaderConverter;
-    std::vector<std::unique_ptr<uint8_t[]>> m_blocks;
-    xxHashMap<Shader> m_shaders;
-    std::vector<ShaderHandle> m_handles;
+    MappedFile m_pregeneratedFile;
+    MappedFile m_runtimeFile;
+    std::vector<std::unique_ptr<uint8_t[]>> m_decompressedShaders;
+    size_t m_savedShaderCount = 0;
+
+    ShaderConversionService m_conversionService;
+
+    static bool mapFile(const char* name, MappedFile& mappedFile);
+    static void unmapFile(MappedFile& mappedFile);
+    static bool mapShaderCache(const char* name, MappedFile& mappedFile);
+
+    static bool convertLegacyShaderCache(const char* name, const char* convertedName);
+    // Files of the previous format are converted into the converted file if there is one, or in place otherwise.
+    static bool loadShaderCache(const char* name, const char* convertedName, MappedFile& mappedFile);
+    const uint8_t* decompressShader(const MappedFile& mappedFile, XXH64_hash_t hash, uint32_t& dataSize);
 
-    bool loadShaderCache(const char* name);
+    const uint8_t* findCachedShader(uint64_t hash, uint32_t& dataSize) override;
+    void loadConverter() override;
+    void* convertShader(const void* data, uint32_t dataSize, uint32_t& convertedSize) override;
+    const uint8_t* getConvertedData(void* handle) override;
+    void freeConvertedShader(void* handle) override;
 
 public:
     ShaderCache();
     ~ShaderCache();
 
-    std::unique_ptr<uint8_t[]> getShader(const void* data, uint32_t dataSize, uint32_t& convertedSize);
-    void saveShaderCache() const;
-};
+    // Owned by the cache, valid until it gets destroyed. Returns null when converting
+    // asynchronously, in which case the result can be polled with the returned hash.
+    const uint8_t* getShader(const void* data, uint32_t dataSize, XXH64_hash_t& hash, uint32_t& convertedSize, bool async);
+    const uint8_t* getConvertedShader(XXH64_hash_t hash, uint32_t& convertedSize);
+    void saveShaderCache();
+};
\ No newline at end of file
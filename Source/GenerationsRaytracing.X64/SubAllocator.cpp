@@ -5,12 +5,49 @@ D3D12_GPU_VIRTUAL_ADDRESS SubAllocation::getGpuVA() const
     return blockAllocation->GetResource()->GetGPUVirtualAddress() + byteOffset;
 }
 
+void D3D12MAVirtualBlock::create(uint32_t byteSize)
+{
+    D3D12MA::VIRTUAL_BLOCK_DESC virtualBlockDesc{};
+    virtualBlockDesc.Size = byteSize;
+
+    const HRESULT hr = D3D12MA::CreateVirtualBlock(&virtualBlockDesc, m_virtualBlock.ReleaseAndGetAddressOf());
+    assert(SUCCEEDED(hr) && m_virtualBlock != nullptr);
+}
+
+bool D3D12MAVirtualBlock::allocate(uint32_t byteSize, uint32_t alignment, uint64_t& handle, uint32_t& byteOffset)
+{
+    D3D12MA::VIRTUAL_ALLOCATION_DESC virtualAllocDesc{};
+    virtualAllocDesc.Size = byteSize;
+    virtualAllocDesc.Alignment = alignment;
+
+    D3D12MA::VirtualAllocation virtualAllocation{};
+    UINT64 offset = 0;
+
+    const HRESULT hr = m_virtualBlock->Allocate(&virtualAllocDesc, &virtualAllocation, &offset);
+    if (FAILED(hr))
+        return false;
+
+    handle = virtualAllocation.AllocHandle;
+    byteOffset = static_cast<uint32_t>(offset);
+    return true;
+}
+
+void D3D12MAVirtualBlock::free(uint64_t handle)
+{
+    m_virtualBlock->FreeAllocation({ handle });
+}
+
+bool D3D12MAVirtualBlock::isEmpty() const
+{
+    return m_virtualBlock->IsEmpty();
+}
+
 SubAllocator::SubAllocator(
     uint32_t blockSize,
     D3D12_RESOURCE_FLAGS flags,
     uint32_t alignment,
     D3D12_RESOURCE_STATES initialState)
-    : m_blockSize(blockSize), m_flags(flags), m_alignment(alignment), m_initialState(initialState)
+    : m_policy(blockSize, alignment), m_blockSize(blockSize), m_flags(flags), m_initialState(initialState)
 {
 }
 
@@ -19,12 +56,12 @@ SubAllocation SubAllocator::allocate(D3D12MA::Allocator* allocator, uint32_t byt
     SubAllocation subAllocation{};
     subAllocation.byteSize = byteSize;
 
+    D3D12MA::ALLOCATION_DESC allocDesc{};
+    allocDesc.HeapType = D3D12_HEAP_TYPE_DEFAULT;
+
     // If requested resource is larger than half the block size, allocate it separately
-    if (byteSize >= m_blockSize / 2)
+    if (m_policy.isDedicated(byteSize))
     {
-        D3D12MA::ALLOCATION_DESC allocDesc{};
-        allocDesc.HeapType = D3D12_HEAP_TYPE_DEFAULT;
-
         const auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize, m_flags);
 
         HRESULT hr = allocator->CreateResource(
@@ -40,108 +77,61 @@ SubAllocation SubAllocator::allocate(D3D12MA::Allocator* allocator, uint32_t byt
         return subAllocation;
     }
 
-    D3D12MA::VIRTUAL_ALLOCATION_DESC virtualAllocDesc{};
-    virtualAllocDesc.Size = byteSize;
-    virtualAllocDesc.Alignment = m_alignment;
+    bool createdBlock = false;
+    const auto allocation = m_policy.allocate(byteSize, createdBlock);
 
-    UINT64 offset = 0;
-    for (size_t i = 0; i < m_blocks.size(); i++)
-    {
-        const auto& block = m_blocks[i];
-        if (block.blockAllocation != nullptr)
-        {
-            HRESULT hr = block.virtualBlock->Allocate(&virtualAllocDesc, &subAllocation.virtualAllocation, &offset);
-            if (SUCCEEDED(hr))
-            {
-                subAllocation.blockAllocation = block.blockAllocation;
-                subAllocation.blockIndex = static_cast<uint32_t>(i);
-                subAllocation.byteOffset = static_cast<uint32_t>(offset);
-
-                return subAllocation;
-            }
-        }
-    }
+    if (allocation.blockIndex >= m_blockAllocations.size())
+        m_blockAllocations.resize(allocation.blockIndex + 1);
 
-    // Reuse or create new block if the resource couldn't fit to any of them
+    auto& blockAllocation = m_blockAllocations[allocation.blockIndex];
 
-    bool foundBlock = false;
-    for (uint32_t i = 0; i < m_blocks.size(); i++)
+    if (createdBlock)
     {
-        if (m_blocks[i].blockAllocation == nullptr)
-        {
-            subAllocation.blockIndex = i;
-            foundBlock = true;
-            break;
-        }
-    }
-
-    if (!foundBlock)
-        subAllocation.blockIndex = static_cast<uint32_t>(m_blocks.size());
-
-    D3D12MA::ALLOCATION_DESC allocDesc{};
-    allocDesc.HeapType = D3D12_HEAP_TYPE_DEFAULT;
-
-    const auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(m_blockSize, m_flags);
+        const auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(m_blockSize, m_flags);
 
-    auto& block = !foundBlock ? 
-        m_blocks.emplace_back() : m_blocks[subAllocation.blockIndex];
-
-    if (!block.virtualBlock)
-    {
-        D3D12MA::VIRTUAL_BLOCK_DESC virtualBlockDesc{};
-        virtualBlockDesc.Size = m_blockSize;
-
-        const HRESULT hr = D3D12MA::CreateVirtualBlock(&virtualBlockDesc, block.virtualBlock.GetAddressOf());
-        assert(SUCCEEDED(hr) && block.virtualBlock != nullptr);
-    }
-
-    HRESULT hr = allocator->CreateResource(
-        &allocDesc,
-        &resourceDesc,
-        m_initialState,
-        nullptr,
-        block.blockAllocation.GetAddressOf(),
-        IID_ID3D12Resource,
-        nullptr);
+        HRESULT hr = allocator->CreateResource(
+            &allocDesc,
+            &resourceDesc,
+            m_initialState,
+            nullptr,
+            blockAllocation.GetAddressOf(),
+            IID_ID3D12Resource,
+            nullptr);
 
-    assert(SUCCEEDED(hr) && block.blockAllocation != nullptr);
+        assert(SUCCEEDED(hr) && blockAllocation != nullptr);
 
 #ifdef _DEBUG
-    wchar_t name[0x100];
-    swprintf_s(name, L"Sub Allocation Buffer %d", static_cast<uint32_t>(m_blocks.size()));
-    block.blockAllocation->GetResource()->SetName(name);
+        wchar_t name[0x100];
+        swprintf_s(name, L"Sub Allocation Buffer %d", allocation.blockIndex);
+        blockAllocation->GetResource()->SetName(name);
 #endif
+    }
 
-    hr = block.virtualBlock->Allocate(&virtualAllocDesc, &subAllocation.virtualAllocation, &offset);
-    assert(SUCCEEDED(hr));
-
-    subAllocation.blockAllocation = block.blockAllocation;
-    subAllocation.byteOffset = static_cast<uint32_t>(offset);
+    subAllocation.virtualAllocation = allocation.handle;
+    subAllocation.blockAllocation = blockAllocation;
+    subAllocation.blockIndex = allocation.blockIndex;
+    subAllocation.byteOffset = allocation.byteOffset;
 
     return subAllocation;
 }
 
-void SubAllocator::free(SubAllocation& allocation) const
+void SubAllocator::free(SubAllocation& allocation)
 {
-    if (allocation.virtualAllocation.AllocHandle != NULL)
-        m_blocks[allocation.blockIndex].virtualBlock->FreeAllocation(allocation.virtualAllocation);
-
+    m_policy.free({ allocation.virtualAllocation, allocation.blockIndex, allocation.byteOffset, allocation.byteSize });
     allocation = {};
 }
 
 void SubAllocator::freeBlocks(std::vector<ComPtr<D3D12MA::Allocation>>& blocksToFree)
 {
-    size_t count = 0;
-
-    for (auto& block : m_blocks)
+    m_policy.freeBlocks([&](uint32_t blockIndex)
     {
-        if (block.blockAllocation != nullptr && block.virtualBlock->IsEmpty())
-            blocksToFree.emplace_back(std::move(block.blockAllocation));
+        blocksToFree.emplace_back(std::move(m_blockAllocations[blockIndex]));
+    });
 
-        if (block.blockAllocation != nullptr)
-            ++count;
-    }
+    m_blockAllocations.resize(m_policy.getBlockCount());
+}
 
-    while (!m_blocks.empty() && m_blocks.back().blockAllocation == nullptr)
-        m_blocks.pop_back();
+uint32_t SubAllocator::getDefragmentationBlockIndex()
+{
+    return m_policy.getDefragmentationBlockIndex();
 }
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "SubAllocatorPolicy.h"
+
 #define DEFAULT_BLOCK_SIZE (8 * 1024 * 1024)
 
 struct SubAllocation
 {
-    D3D12MA::VirtualAllocation virtualAllocation{};
+    // Zero for dedicated allocations.
+    uint64_t virtualAllocation = 0;
     ComPtr<D3D12MA::Allocation> blockAllocation;
     uint32_t blockIndex = 0;
     uint32_t byteOffset = 0;
@@ -13,19 +16,28 @@ struct SubAllocation
     D3D12_GPU_VIRTUAL_ADDRESS getGpuVA() const;
 };
 
-class SubAllocator
+// Adapts D3D12MA virtual blocks to SubAllocatorPolicy.
+class D3D12MAVirtualBlock
 {
 protected:
-    struct Block
-    {
-        ComPtr<D3D12MA::VirtualBlock> virtualBlock;
-        ComPtr<D3D12MA::Allocation> blockAllocation;
-    };
+    ComPtr<D3D12MA::VirtualBlock> m_virtualBlock;
+
+public:
+    void create(uint32_t byteSize);
+
+    bool allocate(uint32_t byteSize, uint32_t alignment, uint64_t& handle, uint32_t& byteOffset);
+    void free(uint64_t handle);
 
-    std::vector<Block> m_blocks;
+    bool isEmpty() const;
+};
+
+class SubAllocator
+{
+protected:
+    SubAllocatorPolicy<D3D12MAVirtualBlock> m_policy;
+    std::vector<ComPtr<D3D12MA::Allocation>> m_blockAllocations;
     uint32_t m_blockSize;
     D3D12_RESOURCE_FLAGS m_flags;
-    uint32_t m_alignment = 0;
     D3D12_RESOURCE_STATES m_initialState;
 
 public:
@@ -36,7 +48,10 @@ public:
         D3D12_RESOURCE_STATES initialState);
 
     SubAllocation allocate(D3D12MA::Allocator* allocator, uint32_t byteSize);
-    void free(SubAllocation& allocation) const;
+    void free(SubAllocation& allocation);
 
     void freeBlocks(std::vector<ComPtr<D3D12MA::Allocation>>& blocksToFree);
+
+    // See SubAllocatorPolicy::getDefragmentationBlockIndex.
+    uint32_t getDefragmentationBlockIndex();
 };
\ No newline at end of file
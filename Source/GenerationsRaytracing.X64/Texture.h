@@ -1,11 +1,22 @@
 #pragma once
 
+#include "DdsLayout.h"
+
 struct Texture
 {
     ComPtr<D3D12MA::Allocation> allocation;
     DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
     bool isShadowMap = false;
+    // Non-zero while the texture loader works on it, the placeholder view gets bound in the meantime.
+    uint32_t loadTicket = 0;
     uint32_t srvIndex = 0;
     uint32_t rtvIndex = 0;
     uint32_t dsvIndex = 0;
+};
+
+// Created from the DDS header and written one chunk at a time, becomes a regular texture once every chunk arrived.
+struct StreamedTexture
+{
+    ComPtr<D3D12MA::Allocation> allocation;
+    DdsLayout layout;
 };
\ No newline at end of file
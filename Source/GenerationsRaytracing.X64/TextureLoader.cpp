@@ -0,0 +1,230 @@
+#include "TextureLoader.h"
+
+bool TextureLoader::makeShaderResourceViewDesc(const D3D12_RESOURCE_DESC& resourceDesc, bool isCubeMap, D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc)
+{
+    srvDesc.Format = resourceDesc.Format;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+
+    switch (resourceDesc.Dimension)
+    {
+    case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
+        assert(!isCubeMap);
+
+        srvDesc.ViewDimension = resourceDesc.DepthOrArraySize > 1 ? D3D12_SRV_DIMENSION_TEXTURE1DARRAY : D3D12_SRV_DIMENSION_TEXTURE1D;
+
+        if (srvDesc.ViewDimension == D3D12_SRV_DIMENSION_TEXTURE1DARRAY)
+        {
+            srvDesc.Texture1DArray.MostDetailedMip = 0;
+            srvDesc.Texture1DArray.MipLevels = resourceDesc.MipLevels;
+            srvDesc.Texture1DArray.FirstArraySlice = 0;
+            srvDesc.Texture1DArray.ArraySize = resourceDesc.DepthOrArraySize;
+            srvDesc.Texture1DArray.ResourceMinLODClamp = 0.0f;
+        }
+        else
+        {
+            srvDesc.Texture1D.MostDetailedMip = 0;
+            srvDesc.Texture1D.MipLevels = resourceDesc.MipLevels;
+            srvDesc.Texture1D.ResourceMinLODClamp = 0.0f;
+        }
+
+        return true;
+
+    case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
+        if (isCubeMap)
+        {
+            srvDesc.ViewDimension = resourceDesc.DepthOrArraySize > 6 ? D3D12_SRV_DIMENSION_TEXTURECUBEARRAY : D3D12_SRV_DIMENSION_TEXTURECUBE;
+
+            if (srvDesc.ViewDimension == D3D12_SRV_DIMENSION_TEXTURECUBEARRAY)
+            {
+                srvDesc.TextureCubeArray.MostDetailedMip = 0;
+                srvDesc.TextureCubeArray.MipLevels = resourceDesc.MipLevels;
+                srvDesc.TextureCubeArray.First2DArrayFace = 0;
+                srvDesc.TextureCubeArray.NumCubes = resourceDesc.DepthOrArraySize / 6;
+                srvDesc.TextureCubeArray.ResourceMinLODClamp = 0.0f;
+            }
+            else
+            {
+                srvDesc.TextureCube.MostDetailedMip = 0;
+                srvDesc.TextureCube.MipLevels = resourceDesc.MipLevels;
+                srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+            }
+        }
+        else
+        {
+            srvDesc.ViewDimension = resourceDesc.DepthOrArraySize > 1 ? D3D12_SRV_DIMENSION_TEXTURE2DARRAY : D3D12_SRV_DIMENSION_TEXTURE2D;
+
+            if (srvDesc.ViewDimension == D3D12_SRV_DIMENSION_TEXTURE2DARRAY)
+            {
+                srvDesc.Texture2DArray.MostDetailedMip = 0;
+                srvDesc.Texture2DArray.MipLevels = resourceDesc.MipLevels;
+                srvDesc.Texture2DArray.FirstArraySlice = 0;
+                srvDesc.Texture2DArray.ArraySize = resourceDesc.DepthOrArraySize;
+                srvDesc.Texture2DArray.PlaneSlice = 0;
+                srvDesc.Texture2DArray.ResourceMinLODClamp = 0.0f;
+            }
+            else
+            {
+                srvDesc.Texture2D.MostDetailedMip = 0;
+                srvDesc.Texture2D.MipLevels = resourceDesc.MipLevels;
+                srvDesc.Texture2D.PlaneSlice = 0;
+                srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+            }
+        }
+
+        return true;
+
+    case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
+        assert(!isCubeMap);
+
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
+        srvDesc.Texture3D.MostDetailedMip = 0;
+        srvDesc.Texture3D.MipLevels = resourceDesc.MipLevels;
+        srvDesc.Texture3D.ResourceMinLODClamp = 0.0f;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void TextureLoader::createNullShaderResourceView(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE srvHandle)
+{
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+
+    device->CreateShaderResourceView(nullptr, &srvDesc, srvHandle);
+}
+
+bool TextureLoader::createTexture(const DdsLayout& layout, const uint8_t* data, TextureResource& texture) const
+{
+    const auto resourceDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+        static_cast<DXGI_FORMAT>(layout.getFormat()),
+        layout.getWidth(),
+        layout.getHeight(),
+        static_cast<UINT16>(layout.getArraySize()),
+        static_cast<UINT16>(layout.getMipLevels()));
+
+    D3D12MA::ALLOCATION_DESC allocDesc{};
+    allocDesc.HeapType = m_gpuUploadHeapSupported ? D3D12_HEAP_TYPE_GPU_UPLOAD : D3D12_HEAP_TYPE_DEFAULT;
+
+    const HRESULT hr = m_allocator->CreateResource(
+        &allocDesc,
+        &resourceDesc,
+        D3D12_RESOURCE_STATE_COMMON,
+        nullptr,
+        texture.allocation.GetAddressOf(),
+        IID_ID3D12Resource,
+        nullptr);
+
+    if (FAILED(hr) || texture.allocation == nullptr)
+        return false;
+
+    const uint8_t* pixelData = data + layout.getHeaderSize();
+    texture.subResources.reserve(layout.getSubresources().size());
+
+    for (const auto& subresource : layout.getSubresources())
+    {
+        auto& subResource = texture.subResources.emplace_back();
+        subResource.pData = pixelData + subresource.offset;
+        subResource.RowPitch = subresource.rowPitch;
+        subResource.SlicePitch = static_cast<LONG_PTR>(subresource.rowPitch) * subresource.rowCount;
+    }
+
+    texture.isCubeMap = layout.isCubeMap();
+    return true;
+}
+
+TextureResource TextureLoader::loadTexture(const DdsLayout* layout, const uint8_t* data, size_t dataSize, const char* name)
+{
+    TextureResource texture;
+
+    // Volume textures and formats the layout doesn't know about go through the full loader.
+    if (layout == nullptr || !createTexture(*layout, data, texture))
+    {
+        texture.allocation = nullptr;
+        texture.subResources.clear();
+
+        const HRESULT hr = DirectX::LoadDDSTextureFromMemory(
+            m_device,
+            m_allocator,
+            data,
+            dataSize,
+            m_gpuUploadHeapSupported ? D3D12_HEAP_TYPE_GPU_UPLOAD : D3D12_HEAP_TYPE_DEFAULT,
+            nullptr,
+            texture.allocation.GetAddressOf(),
+            texture.subResources,
+            0,
+            nullptr,
+            &texture.isCubeMap);
+
+        if (FAILED(hr) || texture.allocation == nullptr)
+            return {};
+    }
+
+    const auto resource = texture.allocation->GetResource();
+
+#ifdef _DEBUG
+    wchar_t wideName[0x100];
+    MultiByteToWideChar(CP_UTF8, 0, name, -1, wideName, _countof(wideName));
+    resource->SetName(wideName);
+#endif
+
+    if (m_gpuUploadHeapSupported)
+    {
+
+        for (uint32_t i = 0; i < texture.subResources.size(); i++)
+        {
+            constexpr D3D12_RANGE readRange{};
+            HRESULT hr = resource->Map(i, &readRange, nullptr);
+            assert(SUCCEEDED(hr));
+
+            auto& subResource = texture.subResources[i];
+            hr = resource->WriteToSubresource(
+                i,
+                nullptr,
+                subResource.pData,
+                static_cast<uint32_t>(subResource.RowPitch),
+                static_cast<uint32_t>(subResource.SlicePitch));
+
+            assert(SUCCEEDED(hr));
+
+            resource->Unmap(i, nullptr);
+        }
+
+        // Nothing left for the copy queue to do.
+        texture.subResources.clear();
+    }
+
+    return texture;
+}
+
+TextureLoader::TextureLoader(ID3D12Device* device, D3D12MA::Allocator* allocator, bool gpuUploadHeapSupported)
+    : m_device(device)
+    , m_allocator(allocator)
+    , m_gpuUploadHeapSupported(gpuUploadHeapSupported)
+    , m_queue(*this, std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u))
+{
+}
+
+uint32_t TextureLoader::loadTexture(uint32_t textureId, std::vector<uint8_t>&& data, const char* name)
+{
+    return m_queue.loadTexture(textureId, std::move(data), name);
+}
+
+void TextureLoader::cancel(uint32_t ticket)
+{
+    m_queue.cancel(ticket);
+}
+
+void TextureLoader::collectLoadedTextures(std::vector<LoadedTexture<TextureResource>>& loadedTextures)
+{
+    m_queue.collectLoadedTextures(loadedTextures);
+}
+
+size_t TextureLoader::getPendingCount()
+{
+    return m_queue.getPendingCount();
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "TextureLoadQueue.h"
+
+struct TextureResource
+{
+    ComPtr<D3D12MA::Allocation> allocation;
+    // Empty if the texture was written through the GPU upload heap already.
+    std::vector<D3D12_SUBRESOURCE_DATA> subResources;
+    bool isCubeMap = false;
+};
+
+// Creates DDS textures through the device allocator on worker threads. Results are handed back to
+// the render thread, which creates the views and records the uploads that still need the copy queue.
+class TextureLoader : protected TextureLoadBackend<TextureResource>
+{
+protected:
+    ID3D12Device* m_device;
+    D3D12MA::Allocator* m_allocator;
+    bool m_gpuUploadHeapSupported;
+    TextureLoadQueue<TextureResource> m_queue;
+
+    bool createTexture(const DdsLayout& layout, const uint8_t* data, TextureResource& texture) const;
+    TextureResource loadTexture(const DdsLayout* layout, const uint8_t* data, size_t dataSize, const char* name) override;
+
+public:
+    TextureLoader(ID3D12Device* device, D3D12MA::Allocator* allocator, bool gpuUploadHeapSupported);
+
+    static bool makeShaderResourceViewDesc(const D3D12_RESOURCE_DESC& resourceDesc, bool isCubeMap, D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc);
+    // Reads as zero.
+    static void createNullShaderResourceView(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE srvHandle);
+
+    // Returns the ticket the texture is collected with.
+    uint32_t loadTexture(uint32_t textureId, std::vector<uint8_t>&& data, const char* name);
+    void cancel(uint32_t ticket);
+
+    void collectLoadedTextures(std::vector<LoadedTexture<TextureResource>>& loadedTextures);
+    size_t getPendingCount();
+};
\ No newline at end of file
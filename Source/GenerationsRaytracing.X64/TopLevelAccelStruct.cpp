@@ -0,0 +1,13 @@
+#include "TopLevelAccelStruct.h"
+
+static_assert(sizeof(D3D12_RAYTRACING_INSTANCE_DESC) == sizeof(AccelStructInstance));
+static_assert(offsetof(D3D12_RAYTRACING_INSTANCE_DESC, AccelerationStructure) == offsetof(AccelStructInstance, accelStruct));
+
+AccelStructBuildType TopLevelAccelStruct::getBuildType()
+{
+    // Refitting needs the result of the previous build.
+    if (allocation.blockAllocation == nullptr)
+        buildPolicy.reset();
+
+    return buildPolicy.getBuildType(reinterpret_cast<const AccelStructInstance*>(instanceDescs.data()), instanceDescs.size());
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AccelStructBuildPolicy.h"
 #include "InstanceDesc.h"
 #include "SubAllocator.h"
 
@@ -8,4 +9,7 @@ struct TopLevelAccelStruct
     std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instanceDescs;
     std::vector<InstanceDesc> alsoInstanceDescs;
     SubAllocation allocation;
+    RefitAccelStructPolicy buildPolicy;
+
+    AccelStructBuildType getBuildType();
 };
\ No newline at end of file
@@ -6,4 +6,11 @@ struct UploadBuffer
 {
     ComPtr<D3D12MA::Allocation> allocation;
     uint8_t* memory = nullptr;
-};
\ No newline at end of file
+};
+
+struct UploadAllocation
+{
+    ID3D12Resource* resource = nullptr;
+    uint8_t* memory = nullptr;
+    uint32_t offset = 0;
+};
@@ -19,5 +19,7 @@ void Configuration::init()
         s_toneMap = iniFile.getBool("Mod", "ToneMap", true);
         s_furStyle = static_cast<FurStyle>(iniFile.get<uint32_t>("Mod", "FurStyle", static_cast<uint32_t>(FurStyle::Frontiers)));
         s_hdr = iniFile.getBool("Mod", "HDR", false);
+        s_maxFramesAhead = iniFile.get<uint32_t>("Mod", "MaxFramesAhead", 0);
+        s_messageCaptureFilePath = iniFile.getString("Mod", "MessageCaptureFilePath", std::string());
     }
 }
@@ -37,5 +37,11 @@ public:
 
     static inline bool s_enableImgui;
 
+    // Zero keeps both processes in lockstep. Otherwise, x64 gets paced by the swap chain 
+    // and x86 by the frame fence, which adds this many frames of input latency.
+    static inline uint32_t s_maxFramesAhead = 0;
+
+    static inline std::string s_messageCaptureFilePath;
+
     static void init();
 };
\ No newline at end of file
@@ -450,7 +450,7 @@ HRESULT Device::Present(const RECT* pSourceRect, const RECT* pDestRect, HWND hDe
     }
 
     s_messageSender.oneShotMessage<MsgPresent>();
-    s_messageSender.sync();
+    s_messageSender.endFrame(Configuration::s_maxFramesAhead);
 
     return S_OK;
 }
@@ -727,12 +727,12 @@ HRESULT Device::SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
         case D3DRS_DESTBLENDALPHA:
         case D3DRS_BLENDOPALPHA:
         {
-            auto& message = s_messageSender.makeMessage<MsgSetRenderState>();
+            auto& message = s_messageSender.reserveMessage<MsgSetRenderState>();
 
             message.state = State;
             message.value = Value;
 
-            s_messageSender.endMessage();
+            s_messageSender.commitMessage();
 
             break;
         }
@@ -762,12 +762,12 @@ HRESULT Device::SetTexture(DWORD Stage, BaseTexture* pTexture)
 {
     if (m_textures[Stage].Get() != pTexture)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetTexture>();
+        auto& message = s_messageSender.reserveMessage<MsgSetTexture>();
 
         message.stage = static_cast<uint8_t>(Stage);
         message.textureId = pTexture != nullptr ? pTexture->getId() : NULL;
 
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_textures[Stage] = pTexture;
     }
@@ -790,13 +790,13 @@ HRESULT Device::SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD V
 
     if (m_samplerStates[Sampler][Type] != Value)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetSamplerState>();
+        auto& message = s_messageSender.reserveMessage<MsgSetSamplerState>();
 
         message.sampler = static_cast<uint8_t>(Sampler);
         message.type = static_cast<uint8_t>(Type);
         message.value = Value;
 
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_samplerStates[Sampler][Type] = Value;
     }
@@ -817,14 +817,14 @@ HRESULT Device::SetScissorRect(const RECT* pRect)
 {
     if (memcmp(&m_scissorRect, pRect, sizeof(RECT)) != 0)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetScissorRect>();
+        auto& message = s_messageSender.reserveMessage<MsgSetScissorRect>();
 
         message.left = static_cast<uint16_t>(pRect->left);
         message.top = static_cast<uint16_t>(pRect->top);
         message.right = static_cast<uint16_t>(pRect->right);
         message.bottom = static_cast<uint16_t>(pRect->bottom);
 
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_scissorRect = *pRect;
     }
@@ -870,27 +870,27 @@ UINT calculatePrimitiveElements(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCo
 
 HRESULT Device::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgDrawPrimitive>();
+    auto& message = s_messageSender.reserveMessage<MsgDrawPrimitive>();
 
     message.primitiveType = PrimitiveType;
     message.startVertex = StartVertex;
     message.vertexCount = calculatePrimitiveElements(PrimitiveType, PrimitiveCount);
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
 
 HRESULT Device::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgDrawIndexedPrimitive>();
+    auto& message = s_messageSender.reserveMessage<MsgDrawIndexedPrimitive>();
 
     message.primitiveType = PrimitiveType;
     message.baseVertexIndex = BaseVertexIndex;
     message.startIndex = startIndex;
     message.indexCount = calculatePrimitiveElements(PrimitiveType, primCount);
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
@@ -899,14 +899,14 @@ HRESULT Device::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCo
 {
     const uint32_t vertexCount = calculatePrimitiveElements(PrimitiveType, PrimitiveCount);
 
-    auto& message = s_messageSender.makeMessage<MsgDrawPrimitiveUP>(vertexCount * VertexStreamZeroStride);
+    auto& message = s_messageSender.reserveMessage<MsgDrawPrimitiveUP>(vertexCount * VertexStreamZeroStride);
 
     message.primitiveType = PrimitiveType;
     message.vertexCount = vertexCount;
     message.vertexStreamZeroStride = VertexStreamZeroStride;
     memcpy(message.data, pVertexStreamZeroData, vertexCount * VertexStreamZeroStride);
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
@@ -918,7 +918,7 @@ HRESULT Device::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT MinV
     const uint32_t verticesSize = VertexStreamZeroStride * NumVertices;
     const uint32_t indicesSize = (IndexDataFormat == D3DFMT_INDEX32 ? 4 : 2) * indexCount;
 
-    auto& message = s_messageSender.makeMessage<MsgDrawIndexedPrimitiveUP>(verticesSize + indicesSize);
+    auto& message = s_messageSender.reserveMessage<MsgDrawIndexedPrimitiveUP>(verticesSize + indicesSize);
 
     message.primitiveType = static_cast<uint8_t>(PrimitiveType);
     message.vertexCount = NumVertices;
@@ -929,7 +929,7 @@ HRESULT Device::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT MinV
     memcpy(message.data, pVertexStreamZeroData, verticesSize);
     memcpy(message.data + verticesSize, pIndexData, indicesSize);
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
@@ -946,9 +946,9 @@ HRESULT Device::SetVertexDeclaration(VertexDeclaration* pDecl)
 {
     if (m_vertexDeclaration.Get() != pDecl)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetVertexDeclaration>();
+        auto& message = s_messageSender.reserveMessage<MsgSetVertexDeclaration>();
         message.vertexDeclarationId = pDecl != nullptr ? pDecl->getId() : NULL;
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_vertexDeclaration = pDecl;
     }
@@ -1016,9 +1016,9 @@ HRESULT Device::SetVertexShader(VertexShader* pShader)
 {
     if (m_vertexShader.Get() != pShader)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetVertexShader>();
+        auto& message = s_messageSender.reserveMessage<MsgSetVertexShader>();
         message.vertexShaderId = pShader != nullptr ? pShader->getId() : NULL;
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_vertexShader = pShader;
     }
@@ -1029,12 +1029,12 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetVertexShader, VertexShader** ppShad
 
 HRESULT Device::SetVertexShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetVertexShaderConstantF>(Vector4fCount * sizeof(float[4]));
+    auto& message = s_messageSender.reserveMessage<MsgSetVertexShaderConstantF>(Vector4fCount * sizeof(float[4]));
 
     message.startRegister = StartRegister;
     memcpy(message.data, pConstantData, Vector4fCount * sizeof(float[4]));
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
@@ -1047,12 +1047,12 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetVertexShaderConstantI, UINT StartRe
 
 HRESULT Device::SetVertexShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetVertexShaderConstantB>(BoolCount * sizeof(BOOL));
+    auto& message = s_messageSender.reserveMessage<MsgSetVertexShaderConstantB>(BoolCount * sizeof(BOOL));
 
     message.startRegister = StartRegister;
     memcpy(message.data, pConstantData, BoolCount * sizeof(BOOL));
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
@@ -1065,14 +1065,14 @@ HRESULT Device::SetStreamSource(UINT StreamNumber, VertexBuffer* pStreamData, UI
         m_offsetsInBytes[StreamNumber] != OffsetInBytes ||
         m_strides[StreamNumber] != Stride)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetStreamSource>();
+        auto& message = s_messageSender.reserveMessage<MsgSetStreamSource>();
 
         message.streamNumber = StreamNumber;
         message.streamDataId = pStreamData != nullptr ? pStreamData->getId() : NULL;
         message.offsetInBytes = OffsetInBytes;
         message.stride = Stride;
 
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_streamData[StreamNumber] = pStreamData;
         m_offsetsInBytes[StreamNumber] = OffsetInBytes;
@@ -1089,12 +1089,12 @@ HRESULT Device::SetStreamSourceFreq(UINT StreamNumber, UINT Setting)
     {
         if (StreamNumber == 0)
         {
-            auto& message = s_messageSender.makeMessage<MsgSetStreamSourceFreq>();
+            auto& message = s_messageSender.reserveMessage<MsgSetStreamSourceFreq>();
 
             message.streamNumber = StreamNumber;
             message.setting = Setting;
 
-            s_messageSender.endMessage();
+            s_messageSender.commitMessage();
         }
 
         m_settings[StreamNumber] = Setting;
@@ -1108,9 +1108,9 @@ HRESULT Device::SetIndices(IndexBuffer* pIndexData)
 {
     if (m_indexData.Get() != pIndexData)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetIndices>();
+        auto& message = s_messageSender.reserveMessage<MsgSetIndices>();
         message.indexDataId = pIndexData != nullptr ? pIndexData->getId() : NULL;
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_indexData = pIndexData;
     }
@@ -1143,9 +1143,9 @@ HRESULT Device::SetPixelShader(PixelShader* pShader)
 {
     if (m_pixelShader.Get() != pShader)
     {
-        auto& message = s_messageSender.makeMessage<MsgSetPixelShader>();
+        auto& message = s_messageSender.reserveMessage<MsgSetPixelShader>();
         message.pixelShaderId = pShader != nullptr ? pShader->getId() : NULL;
-        s_messageSender.endMessage();
+        s_messageSender.commitMessage();
 
         m_pixelShader = pShader;
     }
@@ -1156,12 +1156,12 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetPixelShader, PixelShader** ppShader
 
 HRESULT Device::SetPixelShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetPixelShaderConstantF>(Vector4fCount * sizeof(float[4]));
+    auto& message = s_messageSender.reserveMessage<MsgSetPixelShaderConstantF>(Vector4fCount * sizeof(float[4]));
 
     message.startRegister = StartRegister;
     memcpy(message.data, pConstantData, Vector4fCount * sizeof(float[4]));
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
@@ -1174,12 +1174,12 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetPixelShaderConstantI, UINT StartReg
 
 HRESULT Device::SetPixelShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetPixelShaderConstantB>(BoolCount * sizeof(BOOL));
+    auto& message = s_messageSender.reserveMessage<MsgSetPixelShaderConstantB>(BoolCount * sizeof(BOOL));
 
     message.startRegister = StartRegister;
     memcpy(message.data, pConstantData, BoolCount * sizeof(BOOL));
 
-    s_messageSender.endMessage();
+    s_messageSender.commitMessage();
 
     return S_OK;
 }
@@ -10,6 +10,12 @@ protected:
     uint32_t m_byteSize;
     bool m_pendingWrite = true;
 
+    // Locks too large for the bulk data memory get staged here and sent in chunks on unlock.
+    std::unique_ptr<uint8_t[]> m_stagingData;
+    uint32_t m_stagingOffset = 0;
+    uint32_t m_stagingSize = 0;
+    bool m_stagingInitialWrite = false;
+
 public:
     static inline alignas(0x4) std::atomic<uint32_t> s_wastedMemory;
 
@@ -10,8 +10,70 @@
 
 static std::unordered_set<TerrainInstanceInfoDataEx*> s_instances;
 static std::unordered_multimap<uint32_t, TerrainInstanceInfoDataEx*> s_instanceSubsets;
+static std::unordered_set<TerrainInstanceInfoDataEx*> s_persistentInstances;
 static Mutex s_terrainInstanceMutex;
 
+// Turns persistent instance changes into messages. Releases are sent right away instead of at the
+// end of the frame so hidden instances don't linger for a frame, the terrain instance mutex keeps this in order.
+class TerrainInstanceSink final : public PersistentInstanceSink
+{
+public:
+    const float (*transform)[4] = nullptr;
+    bool isMirrored = false;
+    float playableParam = 0.0f;
+
+    uint32_t allocateInstanceId() override
+    {
+        return InstanceData::s_idAllocator.allocate();
+    }
+
+    void createInstance(uint32_t instanceId, size_t instanceType, uint32_t bottomLevelAccelStructId) override
+    {
+        auto& message = s_messageSender.makeMessage<MsgCreatePersistentInstance>(0);
+        message.instanceId = instanceId;
+        memcpy(message.transform, transform, sizeof(message.transform));
+        memcpy(message.headTransform, transform, sizeof(message.headTransform));
+        message.bottomLevelAccelStructId = bottomLevelAccelStructId;
+        message.isMirrored = isMirrored;
+        message.instanceMask = INSTANCE_MASK_TERRAIN;
+        message.instanceType = s_instanceTypes[instanceType].instanceType;
+        message.playableParam = playableParam;
+        message.chrPlayableMenuParam = 10000.0f;
+        message.forceAlphaColor = 1.0f;
+        message.edgeEmissionParam = 0.0f;
+        s_messageSender.endMessage();
+    }
+
+    void updateInstance(uint32_t instanceId) override
+    {
+        auto& message = s_messageSender.makeMessage<MsgUpdatePersistentInstance>();
+        message.instanceId = instanceId;
+        memcpy(message.transform, transform, sizeof(message.transform));
+        memcpy(message.headTransform, transform, sizeof(message.headTransform));
+        message.isMirrored = isMirrored;
+        message.playableParam = playableParam;
+        message.chrPlayableMenuParam = 10000.0f;
+        message.forceAlphaColor = 1.0f;
+        message.edgeEmissionParam = 0.0f;
+        s_messageSender.endMessage();
+    }
+
+    void updateMaterials(uint32_t instanceId) override
+    {
+        // Terrain never remaps materials.
+    }
+
+    void releaseInstance(uint32_t instanceId) override
+    {
+        auto& message = s_messageSender.makeMessage<MsgReleaseRaytracingResource>();
+        message.resourceType = RaytracingResourceType::Instance;
+        message.resourceId = instanceId;
+        s_messageSender.endMessage();
+
+        InstanceData::s_idAllocator.free(instanceId);
+    }
+};
+
 HOOK(TerrainInstanceInfoDataEx*, __fastcall, TerrainInstanceInfoDataConstructor, 0x717350, TerrainInstanceInfoDataEx* This)
 {
     const auto result = originalTerrainInstanceInfoDataConstructor(This);
@@ -19,6 +81,7 @@ HOOK(TerrainInstanceInfoDataEx*, __fastcall, TerrainInstanceInfoDataConstructor,
     This->m_instanceFrame = 0;
     new (&This->m_subsetIterator) decltype(This->m_subsetIterator) ();
     This->m_hasValidIterator = false;
+    This->m_persistentState.reset();
 
     return result;
 }
@@ -31,6 +94,10 @@ HOOK(void, __fastcall, TerrainInstanceInfoDataDestructor, 0x717090, TerrainInsta
     if (This->m_hasValidIterator)
         s_instanceSubsets.erase(This->m_subsetIterator);
 
+    TerrainInstanceSink sink;
+    This->m_persistentState.release(sink);
+    s_persistentInstances.erase(This);
+
     originalTerrainInstanceInfoDataDestructor(This);
 }
 
@@ -52,12 +119,15 @@ HOOK(InstanceInfoEx*, __fastcall, InstanceInfoConstructor, 0x7036A0, InstanceInf
     This->m_enableForceAlphaColor = false;
     This->m_forceAlphaColor = 1.0f;
     This->m_edgeEmissionParam = 0.0f;
+    This->m_persistentState.reset();
 
     return result;
 }
 
 HOOK(void, __fastcall, InstanceInfoDestructor, 0x7030B0, InstanceInfoEx* This)
 {
+    ModelData::releaseInstances(*This);
+
     This->m_effectMap.~unordered_map();
     This->m_poseVertexBuffer.~ComPtr();
 
@@ -98,33 +168,40 @@ void InstanceData::createInstances(Hedgehog::Mirage::CRenderingDevice* rendering
                 }
             }
 
-            const bool copyPrevTransform = instance->m_instanceFrame == (RaytracingRendering::s_frame - 1);
             const bool isMirrored = instance->m_scpTransform->determinant() < 0.0f;
             const float playableParam = PlayableParam::getPlayableParam(instance, renderingDevice);
 
-            for (size_t i = 0; i < _countof(s_instanceTypes); i++)
-            {
-                const auto bottomLevelAccelStructId = terrainModelEx->m_bottomLevelAccelStructIds[i];
+            // Only send what changed since the last time, most terrain never moves.
+            TerrainInstanceSink sink;
+            sink.transform = transform;
+            sink.isMirrored = isMirrored;
+            sink.playableParam = playableParam;
 
-                if (bottomLevelAccelStructId != NULL)
-                {
-                    auto& message = s_messageSender.makeMessage<MsgCreateInstance>(0);
-                    memcpy(message.transform, transform, sizeof(message.transform));
-                    memcpy(message.prevTransform, copyPrevTransform ? instance->m_prevTransform : transform, sizeof(message.prevTransform));
-                    message.bottomLevelAccelStructId = bottomLevelAccelStructId;
-                    message.isMirrored = isMirrored;
-                    message.instanceMask = INSTANCE_MASK_TERRAIN;
-                    message.instanceType = s_instanceTypes[i].instanceType;
-                    message.playableParam = playableParam;
-                    message.chrPlayableMenuParam = 10000.0f;
-                    message.forceAlphaColor = 1.0f;
-                    message.edgeEmissionParam = 0.0f;
-                    s_messageSender.endMessage();
-                }
-            }
+            uint32_t parameterHash;
+            static_assert(sizeof(parameterHash) == sizeof(playableParam));
+            memcpy(&parameterHash, &playableParam, sizeof(parameterHash));
+
+            instance->m_persistentState.update(terrainModelEx->m_bottomLevelAccelStructIds, transform, parameterHash, 0, 0, sink);
 
             instance->m_instanceFrame = RaytracingRendering::s_frame;
-            memcpy(instance->m_prevTransform, transform, sizeof(instance->m_prevTransform));
+
+            s_persistentInstances.insert(instance);
+        }
+    }
+
+    // Instances that got hidden or unloaded since the last frame.
+    TerrainInstanceSink sink;
+
+    for (auto it = s_persistentInstances.begin(); it != s_persistentInstances.end();)
+    {
+        if ((*it)->m_instanceFrame != RaytracingRendering::s_frame)
+        {
+            (*it)->m_persistentState.release(sink);
+            it = s_persistentInstances.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
 }
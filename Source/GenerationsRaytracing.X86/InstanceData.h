@@ -2,22 +2,22 @@
 
 #include "FreeListAllocator.h"
 #include "InstanceType.h"
+#include "PersistentInstanceState.h"
 #include "VertexBuffer.h"
 
 class TerrainInstanceInfoDataEx : public Hedgehog::Mirage::CTerrainInstanceInfoData
 {
 public:
     uint32_t m_instanceFrame;
-    float m_prevTransform[3][4];
     std::unordered_multimap<uint32_t, TerrainInstanceInfoDataEx*>::iterator m_subsetIterator;
     bool m_hasValidIterator;
+    PersistentInstanceState<_countof(s_instanceTypes)> m_persistentState;
 };
 
 class InstanceInfoEx : public Hedgehog::Mirage::CInstanceInfo
 {
 public:
     uint32_t m_instanceFrame;
-    float m_prevTransform[3][4];
     std::unordered_map<XXH32_hash_t, std::array<uint32_t, _countof(s_instanceTypes)>> m_bottomLevelAccelStructIds;
     ComPtr<VertexBuffer> m_poseVertexBuffer;
     uint32_t m_headNodeIndex;
@@ -31,10 +31,13 @@ public:
     bool m_enableForceAlphaColor;
     float m_forceAlphaColor;
     float m_edgeEmissionParam;
+    PersistentInstanceState<_countof(s_instanceTypes)> m_persistentState;
 };
 
 struct InstanceData
 {
+    static inline FreeListAllocator s_idAllocator;
+
     static void createInstances(Hedgehog::Mirage::CRenderingDevice* renderingDevice);
 
     static void init();
@@ -19,8 +19,7 @@ HOOK(MaterialDataEx*, __fastcall, MaterialDataConstructor, 0x704CA0, MaterialDat
     const auto result = originalMaterialDataConstructor(This);
 
     This->m_materialId = NULL;
-    This->m_materialHash = 0;
-    This->m_hashFrame = 0;
+    This->m_version.reset();
     new (&This->m_fhlMaterials) decltype(This->m_fhlMaterials) ();
 
     return result;
@@ -243,44 +242,95 @@ HOOK(void, __fastcall, MaterialAnimationEnv, 0x57C1C0, uintptr_t This, uintptr_t
     originalMaterialAnimationEnv(This, Edx, deltaTime);
 }
 
+static boost::shared_ptr<Hedgehog::Mirage::CParameterFloat4Element>* findTexcoordOffsetParam(Hedgehog::Mirage::CMaterialData& materialData)
+{
+    static Hedgehog::Base::CStringSymbol s_texcoordOffsetSymbol("mrgTexcoordOffset");
+
+    for (auto& float4Param : materialData.m_Float4Params)
+    {
+        if (float4Param->m_Name == s_texcoordOffsetSymbol)
+            return &float4Param;
+    }
+
+    return nullptr;
+}
+
 HOOK(void, __cdecl, SampleTexcoordAnim, 0x757E50, MaterialDataEx* materialData, uintptr_t a2, uintptr_t a3, uintptr_t a4)
 {
-    s_matCreateMutex.lock();
-    s_materialsToCreate.emplace(materialData);
-    s_matCreateMutex.unlock();
+    // Most samples write the same offsets as last time, only changes need the material sent again.
+    const auto prevParam = findTexcoordOffsetParam(*materialData);
+    const auto prevParamData = prevParam != nullptr ? prevParam->get() : nullptr;
+    float prevValues[8]{};
+
+    const size_t valueSize = prevParamData != nullptr ?
+        std::min(prevParamData->m_ValueNum * sizeof(float[4]), sizeof(prevValues)) : 0;
+
+    if (valueSize != 0)
+        memcpy(prevValues, prevParamData->m_spValue.get(), valueSize);
+
+    originalSampleTexcoordAnim(materialData, a2, a3, a4);
+
+    const auto sourceParam = findTexcoordOffsetParam(*materialData);
+    if (sourceParam == nullptr)
+        return;
+
+    const bool changed = sourceParam->get() != prevParamData ||
+        memcmp(prevValues, (*sourceParam)->m_spValue.get(), valueSize) != 0;
+
+    if (changed)
+    {
+        s_matCreateMutex.lock();
+        s_materialsToCreate.emplace(materialData);
+        s_matCreateMutex.unlock();
+    }
 
+    // FHL materials share the parameter, so they change along with the source material.
     for (auto& fhlMaterial : materialData->m_fhlMaterials)
     {
         if (fhlMaterial->IsMadeOne())
         {
-            static Hedgehog::Base::CStringSymbol s_texcoordOffsetSymbol("mrgTexcoordOffset");
+            const auto destParam = findTexcoordOffsetParam(*fhlMaterial);
 
-            for (auto& sourceParam : materialData->m_Float4Params)
+            if (destParam == nullptr)
             {
-                if (sourceParam->m_Name == s_texcoordOffsetSymbol)
-                {
-                    bool found = false;
+                fhlMaterial->m_Float4Params.push_back(*sourceParam);
+                MaterialData::markDirty(*fhlMaterial);
+            }
+            else if (!MaterialData::setFloat4Param(*fhlMaterial, *destParam, *sourceParam) && changed)
+            {
+                MaterialData::markDirty(*fhlMaterial);
+            }
+        }
+    }
+}
 
-                    for (auto& destParam : fhlMaterial->m_Float4Params)
-                    {
-                        if (destParam->m_Name == s_texcoordOffsetSymbol)
-                        {
-                            destParam = sourceParam;
-                            found = true;
-                            break;
-                        }
-                    }
+static XXH32_hash_t computeMaterialHash(const MaterialDataEx& materialDataEx, bool& hasPendingTextures)
+{
+    XXH32_state_t state;
+    XXH32_reset(&state, 0);
 
-                    if (!found)
-                        fhlMaterial->m_Float4Params.push_back(sourceParam);
+    if (materialDataEx.m_spShaderListData != nullptr)
+        XXH32_update(&state, &materialDataEx.m_spShaderListData, sizeof(materialDataEx.m_spShaderListData));
 
-                    break;
-                }
+    for (const auto& float4Param : materialDataEx.m_Float4Params)
+        XXH32_update(&state, float4Param->m_spValue.get(), float4Param->m_ValueNum * sizeof(float[4]));
+
+    if (materialDataEx.m_spTexsetData != nullptr)
+    {
+        for (const auto& textureData : materialDataEx.m_spTexsetData->m_TextureList)
+        {
+            if (textureData->m_spPictureData != nullptr)
+            {
+                XXH32_update(&state, &textureData->m_spPictureData->m_pD3DTexture, sizeof(textureData->m_spPictureData->m_pD3DTexture));
+
+                // The material got made before the picture, the texture shows up once it is loaded.
+                if (textureData->m_spPictureData->m_pD3DTexture == nullptr && !textureData->m_spPictureData->IsMadeAll())
+                    hasPendingTextures = true;
             }
         }
     }
 
-    originalSampleTexcoordAnim(materialData, a2, a3, a4);
+    return XXH32_digest(&state);
 }
 
 bool MaterialData::create(Hedgehog::Mirage::CMaterialData& materialData, bool checkForHash)
@@ -289,53 +339,70 @@ bool MaterialData::create(Hedgehog::Mirage::CMaterialData& materialData, bool ch
     {
         auto& materialDataEx = reinterpret_cast<MaterialDataEx&>(materialData);
 
-        bool shouldCreate = true;
+        bool isNew = false;
 
         if (materialDataEx.m_materialId == NULL)
         {
             materialDataEx.m_materialId = s_idAllocator.allocate();
+            isNew = true;
         }
-        else if (checkForHash)
-        {
-            if (materialDataEx.m_hashFrame != RaytracingRendering::s_frame)
-            {
-                XXH32_state_t state;
-                XXH32_reset(&state, 0);
 
-                if (materialDataEx.m_spShaderListData != nullptr)
-                    XXH32_update(&state, &materialDataEx.m_spShaderListData, sizeof(materialDataEx.m_spShaderListData));
+        // Validate a slice of the materials every frame to catch modifications nobody marked.
+        const bool shouldCreate = materialDataEx.m_version.update(isNew || !checkForHash,
+            MaterialVersion::shouldValidate(materialDataEx.m_materialId, RaytracingRendering::s_frame),
+            [&](bool& hasPendingTextures) { return computeMaterialHash(materialDataEx, hasPendingTextures); });
 
-                for (const auto& float4Param : materialData.m_Float4Params)
-                    XXH32_update(&state, float4Param->m_spValue.get(), float4Param->m_ValueNum * sizeof(float[4]));
+        if (shouldCreate)
+            createMaterial(materialDataEx);
 
-                if (materialData.m_spTexsetData != nullptr)
-                {
-                    for (const auto& textureData : materialData.m_spTexsetData->m_TextureList)
-                    {
-                        if (textureData->m_spPictureData != nullptr)
-                            XXH32_update(&state, &textureData->m_spPictureData->m_pD3DTexture, sizeof(textureData->m_spPictureData->m_pD3DTexture));
-                    }
-                }
+        return true;
+    }
+    return false;
+}
+
+bool MaterialData::setValue(Hedgehog::Mirage::CMaterialData& materialData, void* dst, const void* src, size_t byteSize)
+{
+    return reinterpret_cast<MaterialDataEx&>(materialData).m_version.set(dst, src, byteSize);
+}
+
+bool MaterialData::setFloat4Param(Hedgehog::Mirage::CMaterialData& materialData,
+    boost::shared_ptr<Hedgehog::Mirage::CParameterFloat4Element>& dst, const boost::shared_ptr<Hedgehog::Mirage::CParameterFloat4Element>& src)
+{
+    return reinterpret_cast<MaterialDataEx&>(materialData).m_version.set(dst, src);
+}
 
-                const XXH32_hash_t materialHash = XXH32_digest(&state);
+bool MaterialData::setTexture(Hedgehog::Mirage::CMaterialData& materialData,
+    Hedgehog::Mirage::CPictureData& pictureData, DX_PATCH::IDirect3DBaseTexture9* texture)
+{
+    if (pictureData.m_pD3DTexture == texture)
+        return false;
 
-                shouldCreate = materialDataEx.m_materialHash != materialHash;
+    if (pictureData.m_pD3DTexture != nullptr)
+        pictureData.m_pD3DTexture->Release();
 
-                materialDataEx.m_materialHash = materialHash;
-                materialDataEx.m_hashFrame = RaytracingRendering::s_frame;
-            }
-            else
-            {
-                shouldCreate = false;
-            }
-        }
+    pictureData.m_pD3DTexture = texture;
 
-        if (shouldCreate)
-            createMaterial(materialDataEx);
+    if (pictureData.m_pD3DTexture != nullptr)
+        pictureData.m_pD3DTexture->AddRef();
 
-        return true;
+    markDirty(materialData);
+    return true;
+}
+
+void MaterialData::markDirty(Hedgehog::Mirage::CMaterialData& materialData)
+{
+    reinterpret_cast<MaterialDataEx&>(materialData).m_version.markDirty();
+}
+
+void MaterialData::markDirtyIfChanged(Hedgehog::Mirage::CMaterialData& materialData)
+{
+    auto& materialDataEx = reinterpret_cast<MaterialDataEx&>(materialData);
+
+    if (materialDataEx.m_materialId != NULL)
+    {
+        materialDataEx.m_version.markDirtyIfChanged(
+            [&](bool& hasPendingTextures) { return computeMaterialHash(materialDataEx, hasPendingTextures); });
     }
-    return false;
 }
 
 void MaterialData::createPendingMaterials()
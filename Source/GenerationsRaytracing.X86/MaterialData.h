@@ -1,12 +1,12 @@
 #pragma once
 #include "FreeListAllocator.h"
+#include "MaterialVersion.h"
 
 class MaterialDataEx : public Hedgehog::Mirage::CMaterialData
 {
 public:
     uint32_t m_materialId;
-    XXH32_hash_t m_materialHash;
-    uint32_t m_hashFrame;
+    MaterialVersion m_version;
     std::vector<boost::shared_ptr<CMaterialData>> m_fhlMaterials;
 };
 
@@ -17,6 +17,19 @@ struct MaterialData
     static bool create(Hedgehog::Mirage::CMaterialData& materialData, bool checkForHash);
     static void createPendingMaterials();
 
+    // Code modifying a material in place needs to go through these, they mark it dirty only if the value
+    // changed. Anything else only gets picked up once the material's turn for hash validation comes around.
+    static bool setValue(Hedgehog::Mirage::CMaterialData& materialData, void* dst, const void* src, size_t byteSize);
+    static bool setFloat4Param(Hedgehog::Mirage::CMaterialData& materialData,
+        boost::shared_ptr<Hedgehog::Mirage::CParameterFloat4Element>& dst, const boost::shared_ptr<Hedgehog::Mirage::CParameterFloat4Element>& src);
+    static bool setTexture(Hedgehog::Mirage::CMaterialData& materialData,
+        Hedgehog::Mirage::CPictureData& pictureData, DX_PATCH::IDirect3DBaseTexture9* texture);
+
+    // For changes that have no single value to compare, like adding a parameter.
+    static void markDirty(Hedgehog::Mirage::CMaterialData& materialData);
+    // For materials sharing parameters with other materials, where modifications can't be observed.
+    static void markDirtyIfChanged(Hedgehog::Mirage::CMaterialData& materialData);
+
     static void init();
     static void postInit();
 };
\ No newline at end of file
@@ -343,11 +343,11 @@ static IndexBuffer* createIndexBuffer()
     createMsg.indexBufferId = indexBuffer->getId();
     s_messageSender.endMessage();
 
-    auto& copyMsg = s_messageSender.makeMessage<MsgWriteIndexBuffer>(byteSize);
+    auto& copyMsg = s_messageSender.makeBulkMessage<MsgWriteIndexBuffer>(byteSize);
     copyMsg.indexBufferId = indexBuffer->getId();
     copyMsg.offset = 0;
     copyMsg.initialWrite = true;
-    memcpy(copyMsg.data, s_indices.data(), byteSize);
+    memcpy(s_messageSender.getBulkData(copyMsg.bulkOffset), s_indices.data(), byteSize);
     s_messageSender.endMessage();
 
     s_indices.clear();
@@ -429,12 +429,12 @@ static void generateAdjacencyData(MeshDataEx& meshData, MeshResource* meshResour
         createMsg.indexBufferId = meshData.m_adjacency->getId();
         s_messageSender.endMessage();
 
-        auto& copyMsg = s_messageSender.makeMessage<MsgWriteIndexBuffer>(byteSize);
+        auto& copyMsg = s_messageSender.makeBulkMessage<MsgWriteIndexBuffer>(byteSize);
         copyMsg.indexBufferId = meshData.m_adjacency->getId();
         copyMsg.offset = 0;
         copyMsg.initialWrite = true;
 
-        auto metaCursor = reinterpret_cast<uint32_t*>(copyMsg.data);
+        auto metaCursor = reinterpret_cast<uint32_t*>(s_messageSender.getBulkData(copyMsg.bulkOffset));
         auto indexCursor = metaCursor + adjacentTriangles.size() * 2;
 
         size_t curIndex = 0;
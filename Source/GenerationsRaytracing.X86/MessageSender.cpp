@@ -1,20 +1,31 @@
 #include "MessageSender.h"
 
+#include "AlignmentUtil.h"
 #include "LockGuard.h"
 #include "Message.h"
 
 bool MessageSender::canMakeMessage(uint32_t byteSize, uint32_t alignment)
 {
-    return ((sizeof(MessageQueue) + alignment - 1) & ~(alignment - 1)) + byteSize <= MemoryMappedFile::s_size;
+    return MessageRingWriter::canAllocate(MemoryMappedFile::s_size, byteSize, alignment);
+}
+
+bool MessageSender::canMakeBulkData(uint32_t byteSize)
+{
+    return BulkDataAllocator::canAllocate(MemoryMappedFile::s_bulkDataSize, byteSize);
 }
 
 MessageSender::MessageSender()
 {
-    m_memoryMap = static_cast<uint8_t*>(m_memoryMappedFile.map());
+    MESSAGE_QUEUE->head = m_ring.getOffset();
+    MESSAGE_QUEUE->tail = m_ring.getOffset();
 }
 
 MessageSender::~MessageSender()
 {
+    if (m_captureFile != nullptr)
+        fclose(m_captureFile);
+
+    m_bulkDataMappedFile.unmap(m_bulkDataMap);
     m_memoryMappedFile.unmap(m_memoryMap);
 }
 
@@ -22,6 +33,7 @@ struct MessageHolder
 {
     uint32_t alignment = 0;
     std::vector<uint8_t> data;
+    std::vector<std::pair<uint32_t, uint32_t>> bulkData;
 };
 
 struct MessageHolderStack : std::vector<MessageHolder>
@@ -50,53 +62,230 @@ void* MessageSender::makeMessage(uint32_t byteSize, uint32_t alignment)
     return &holder.data[0];
 }
 
+static std::vector<uint32_t>& getReservationStack()
+{
+    thread_local std::vector<uint32_t> stack;
+    return stack;
+}
+
+template<typename T>
+void MessageSender::waitForTail(const T& condition)
+{
+    // Head can't get past our own reservation, so tail would never move.
+    assert(getReservationStack().empty());
+
+    // Counted before checking tail, x64 would stop publishing it otherwise as soon as any other waiter is done.
+    ++MESSAGE_QUEUE->tailWaiterCount;
+
+    while (!condition(MESSAGE_QUEUE->tail) && !(*s_shouldExit))
+    {
+        // Waiting with the lock held would keep every other thread from sending anything.
+        m_mutex.unlock();
+        m_x64Event.waitImm();
+        m_mutex.lock();
+    }
+
+    --MESSAGE_QUEUE->tailWaiterCount;
+}
+
+uint32_t MessageSender::allocateMessage(uint32_t byteSize, uint32_t alignment, uint32_t& offset)
+{
+    while (true)
+    {
+        // Only committers free up reservations, and they don't need the lock.
+        while (!m_reservations.canReserve())
+        {
+            // Our own reservation might be the one keeping the others from being published.
+            assert(getReservationStack().empty());
+
+            m_mutex.unlock();
+            std::this_thread::yield();
+            m_mutex.lock();
+        }
+
+        const uint32_t tail = MESSAGE_QUEUE->tail;
+        if (m_ring.tryAllocate(byteSize, alignment, tail, offset))
+            break;
+
+        // Nothing gets read anymore, the message only needs somewhere to go.
+        if (*s_shouldExit)
+        {
+            offset = alignUp<uint32_t>(sizeof(MessageQueue), alignment);
+            return m_reservations.reserve(offset, 0, m_ring.getOffset());
+        }
+
+        // Publish a possible wrap on its own so the consumer can catch up to it even when it's idle.
+        publishHead();
+        waitForTail([&](uint32_t nextTail) { return nextTail != tail; });
+    }
+
+    return m_reservations.reserve(offset, byteSize, m_ring.getOffset());
+}
+
+void MessageSender::onPublish(Reservation& reservation)
+{
+    // Empty reservations only move head past a wrap.
+    if (reservation.byteSize == 0)
+        return;
+
+    m_statistics.add(m_memoryMap[reservation.offset], reservation.byteSize, reservation.data.duration);
+
+    if (m_captureFile != nullptr)
+    {
+        // Bulk data needs to be in place before the message referring to it gets replayed.
+        for (const auto& [bulkOffset, bulkSize] : reservation.data.bulkData)
+            writeCaptureRecord(MessageCaptureRecordType::BulkData, getBulkData(bulkOffset), bulkSize, &bulkOffset, sizeof(bulkOffset));
+
+        writeCaptureRecord(MessageCaptureRecordType::Message, m_memoryMap + reservation.offset, reservation.byteSize);
+    }
+
+    reservation.data.bulkData.clear();
+}
+
+void MessageSender::commit(uint32_t index)
+{
+    if (m_reservations.commit(index, [this](Reservation& reservation) { onPublish(reservation); }))
+        MessageWaiter::notify(MESSAGE_QUEUE->sleeping, m_x86Event);
+}
+
+template<typename T>
+void MessageSender::runExclusive(const T& function)
+{
+    if (m_reservations.runExclusive(function, [this](Reservation& reservation) { onPublish(reservation); }))
+        MessageWaiter::notify(MESSAGE_QUEUE->sleeping, m_x86Event);
+}
+
+void MessageSender::publishHead()
+{
+    commit(m_reservations.reserve(m_ring.getOffset(), 0, m_ring.getOffset()));
+}
+
 void MessageSender::endMessage()
 {
     auto& stack = getMessageHolderStack();
     auto& holder = stack[stack.peekIndex];
 
-    LockGuard lock(m_mutex);
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
 
-    uint32_t alignedOffset = m_offset;
-    if ((alignedOffset & (holder.alignment - 1)) != 0)
+    uint32_t index;
+    uint32_t offset;
     {
-        alignedOffset += offsetof(MsgPadding, data);
-        alignedOffset += holder.alignment - 1;
-        alignedOffset &= ~(holder.alignment - 1);
+        LockGuard lock(m_mutex);
+        index = allocateMessage(holder.data.size(), holder.alignment, offset);
     }
-    if (alignedOffset + holder.data.size() > MemoryMappedFile::s_size)
+
+    // Copied without the lock, head can't get past the reservation until it's committed.
+    memcpy(m_memoryMap + offset, &holder.data[0], holder.data.size());
+
+    auto& data = m_reservations.getData(index);
+    std::swap(data.bulkData, holder.bulkData);
+
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+    data.duration = end.QuadPart - begin.QuadPart;
+
+    commit(index);
+
+    --stack.peekIndex;
+}
+
+void* MessageSender::reserveMessage(uint32_t byteSize, uint32_t alignment)
+{
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+
+    uint32_t index;
+    uint32_t offset;
     {
-        sync();
-        alignedOffset = std::max(sizeof(MessageQueue), holder.alignment);
+        LockGuard lock(m_mutex);
+        index = allocateMessage(byteSize, alignment, offset);
     }
 
-    if (m_offset != alignedOffset)
+    // The ID isn't written yet, so the statistics get updated once the message is published.
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+    m_reservations.getData(index).duration = end.QuadPart - begin.QuadPart;
+
+    getReservationStack().push_back(index);
+
+    return m_memoryMap + offset;
+}
+
+void MessageSender::commitMessage()
+{
+    auto& stack = getReservationStack();
+    const uint32_t index = stack.back();
+    stack.pop_back();
+
+    commit(index);
+}
+
+uint32_t MessageSender::makeBulkData(uint32_t byteSize)
+{
+    assert(canMakeBulkData(byteSize));
+
+    // Left pointing at the first block when exiting.
+    uint32_t offset = sizeof(BulkDataHeader);
+
+    LockGuard lock(m_bulkDataMutex);
+
+    if (!m_bulkDataAllocator.tryAllocate(byteSize, offset))
     {
-        const auto padding = reinterpret_cast<MsgPadding*>(&m_memoryMap[m_offset]);
-        padding->id = MsgPadding::s_id;
-        padding->dataSize = alignedOffset - (m_offset + offsetof(MsgPadding, data));
+        // Counted for as long as we wait, another waiter being done shouldn't stop x64 from signalling.
+        ++MESSAGE_QUEUE->bulkDataWaiterCount;
+
+        // Other threads can keep sending messages, which x64 might need to get to before releasing anything.
+        do
+        {
+            m_bulkDataMutex.unlock();
+            m_x64Event.waitImm();
+            m_bulkDataMutex.lock();
+
+        } while (!m_bulkDataAllocator.tryAllocate(byteSize, offset) && !(*s_shouldExit));
+
+        --MESSAGE_QUEUE->bulkDataWaiterCount;
     }
 
-    memcpy(m_memoryMap + alignedOffset, &holder.data[0], holder.data.size());
+    // Capture the block along with the message that is being made.
+    if (m_captureFile != nullptr)
+    {
+        auto& stack = getMessageHolderStack();
+        stack[stack.peekIndex].bulkData.emplace_back(offset, byteSize);
+    }
 
-    m_offset = alignedOffset + holder.data.size();
-    MESSAGE_QUEUE->offset = m_offset;
+    return offset;
+}
 
-    --stack.peekIndex;
+uint8_t* MessageSender::getBulkData(uint32_t offset) const
+{
+    return m_bulkDataMap + offset;
 }
 
 void MessageSender::sync()
 {
     LockGuard lock(m_mutex);
-    m_offset = sizeof(MessageQueue);
+    waitForTail([&](uint32_t tail) { return tail == m_ring.getOffset(); });
+}
+
+void MessageSender::endFrame(uint32_t maxFramesAhead)
+{
+    {
+        LockGuard lock(m_mutex);
+
+        runExclusive([&]
+        {
+            m_frameStatistics[m_frame % MessageStatistics::s_frameNum] = m_statistics;
+            m_statistics.reset();
+
+            ++m_frame;
 
-    MESSAGE_QUEUE->sync = true;
-    if (!(*s_shouldExit))
-        m_x64Event.wait();
+            if (m_captureFile != nullptr)
+                writeCaptureRecord(MessageCaptureRecordType::Frame, &m_frame, sizeof(m_frame));
+        });
+    }
 
-    MESSAGE_QUEUE->sync = false;
-    MESSAGE_QUEUE->offset = m_offset;
-    m_x86Event.set();
+    FrameFence(MESSAGE_QUEUE->completedFrame, m_frameEvent).wait(m_frame, maxFramesAhead, s_shouldExit);
 }
 
 void MessageSender::notifyShouldExit()
@@ -106,5 +295,71 @@ void MessageSender::notifyShouldExit()
     while (!m_mutex.tryLock()) 
         m_x64Event.set();
 
+    m_frameEvent.set();
+
     m_mutex.unlock();
 }
+
+const MessageStatistics& MessageSender::getStatistics() const
+{
+    return m_frameStatistics[(m_frame - 1) % MessageStatistics::s_frameNum];
+}
+
+const MessageStatistics& MessageSender::getX64Statistics()
+{
+    // Keep showing the previous copy if x64 is already overwriting the frame.
+    const uint32_t completedFrame = MESSAGE_QUEUE->completedFrame;
+    if (completedFrame != 0)
+        MESSAGE_QUEUE->statistics.tryRead(completedFrame - 1, m_x64Statistics);
+
+    return m_x64Statistics;
+}
+
+void MessageSender::writeCaptureRecord(MessageCaptureRecordType type, 
+    const void* data, uint32_t dataSize, const void* prefix, uint32_t prefixSize)
+{
+    MessageCaptureRecord record{};
+    record.type = type;
+    record.byteSize = prefixSize + dataSize;
+
+    LARGE_INTEGER timestamp;
+    QueryPerformanceCounter(&timestamp);
+    record.timestamp = timestamp.QuadPart;
+
+    fwrite(&record, sizeof(record), 1, m_captureFile);
+
+    if (prefixSize != 0)
+        fwrite(prefix, 1, prefixSize, m_captureFile);
+
+    fwrite(data, 1, dataSize, m_captureFile);
+
+    constexpr uint8_t padding[alignof(MessageCaptureRecord)]{};
+    const uint32_t paddingSize = alignUp<uint32_t>(record.byteSize, alignof(MessageCaptureRecord)) - record.byteSize;
+
+    if (paddingSize != 0)
+        fwrite(padding, 1, paddingSize, m_captureFile);
+}
+
+void MessageSender::beginCapture(const char* filePath)
+{
+    LockGuard lock(m_mutex);
+
+    runExclusive([&]
+    {
+        assert(m_captureFile == nullptr);
+        m_captureFile = fopen(filePath, "wb");
+
+        if (m_captureFile != nullptr)
+        {
+            MessageCaptureHeader header{};
+            header.magic = MessageCaptureHeader::s_magic;
+            header.lastMessageId = MsgWrap::s_id;
+
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            header.frequency = frequency.QuadPart;
+
+            fwrite(&header, sizeof(header), 1, m_captureFile);
+        }
+    });
+}
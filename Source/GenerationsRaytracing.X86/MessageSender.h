@@ -1,8 +1,15 @@
 #pragma once
 
+#include "BulkDataAllocator.h"
 #include "Event.h"
+#include "FrameFence.h"
 #include "MemoryMappedFile.h"
+#include "MessageCapture.h"
 #include "MessageQueue.h"
+#include "MessageReservationQueue.h"
+#include "MessageRing.h"
+#include "MessageStatistics.h"
+#include "MessageWaiter.h"
 #include "Mutex.h"
 
 static size_t* s_shouldExit = reinterpret_cast<size_t*>(0x1E5E2E8);
@@ -12,12 +19,61 @@ class MessageSender
 protected:
     Event m_x86Event{ Event::s_x86EventName, FALSE, FALSE };
     Event m_x64Event{ Event::s_x64EventName, FALSE, FALSE };
+    Event m_frameEvent{ Event::s_frameEventName, FALSE, FALSE };
 
     Mutex m_mutex;
 
-    MemoryMappedFile m_memoryMappedFile;
-    uint8_t* m_memoryMap;
-    uint32_t m_offset = sizeof(MessageQueue);
+    MemoryMappedFile m_memoryMappedFile{ MemoryMappedFile::s_name, MemoryMappedFile::s_size };
+    uint8_t* m_memoryMap = static_cast<uint8_t*>(m_memoryMappedFile.map());
+    MessageRingWriter m_ring{ m_memoryMap, MemoryMappedFile::s_size };
+    uint32_t m_frame = 0;
+
+    struct ReservationData
+    {
+        int64_t duration;
+        // Bulk data blocks to capture before the message.
+        std::vector<std::pair<uint32_t, uint32_t>> bulkData;
+    };
+
+    using Reservation = MessageReservationQueue<ReservationData>::Reservation;
+
+    // Every message goes through a reservation, head cannot go past the first uncommitted one.
+    MessageReservationQueue<ReservationData> m_reservations{ MESSAGE_QUEUE->head, 1024 };
+
+    // Needs to be called with the mutex locked, which gets released while waiting.
+    template<typename T>
+    void waitForTail(const T& condition);
+
+    // Needs to be called with the mutex locked. Returns the reservation index to commit.
+    uint32_t allocateMessage(uint32_t byteSize, uint32_t alignment, uint32_t& offset);
+
+    // Called by whichever thread ends up publishing, without the mutex locked.
+    void onPublish(Reservation& reservation);
+    void commit(uint32_t index);
+
+    // Keeps other threads from publishing while the function runs.
+    template<typename T>
+    void runExclusive(const T& function);
+
+    void publishHead();
+
+    // Statistics of the frame in progress and the last few completed frames, indexed by frame.
+    MessageStatistics m_statistics{};
+    MessageStatistics m_frameStatistics[MessageStatistics::s_frameNum]{};
+    // Copied out of shared memory, x64 keeps writing to it.
+    MessageStatistics m_x64Statistics{};
+
+    Mutex m_bulkDataMutex;
+
+    MemoryMappedFile m_bulkDataMappedFile{ MemoryMappedFile::s_bulkDataName, MemoryMappedFile::s_bulkDataSize };
+    uint8_t* m_bulkDataMap = static_cast<uint8_t*>(m_bulkDataMappedFile.map());
+    BulkDataAllocator m_bulkDataAllocator{ m_bulkDataMap, MemoryMappedFile::s_bulkDataSize };
+
+    // Only written to by the publisher, or while nothing gets published.
+    FILE* m_captureFile = nullptr;
+
+    void writeCaptureRecord(MessageCaptureRecordType type, 
+        const void* data, uint32_t dataSize, const void* prefix = nullptr, uint32_t prefixSize = 0);
 
 public:
     static bool canMakeMessage(uint32_t byteSize, uint32_t alignment);
@@ -40,9 +96,42 @@ public:
     template<typename T>
     void oneShotMessage();
 
+    // Returns memory directly inside the queue. Messages become visible to x64
+    // in the order they were reserved, so only use this for messages that don't
+    // depend on anything sent between reserving and committing them.
+    void* reserveMessage(uint32_t byteSize, uint32_t alignment);
+    void commitMessage();
+
+    template<typename T>
+    T& reserveMessage();
+
+    template<typename T>
+    T& reserveMessage(uint32_t dataSize);
+
+    // Callers need to check this and split or reject the payload otherwise.
+    static bool canMakeBulkData(uint32_t byteSize);
+
+    // Returns the offset of a block in the bulk data memory, which x64 releases once 
+    // it processes the message referring to it. Blocks are reclaimed in any order.
+    uint32_t makeBulkData(uint32_t byteSize);
+    uint8_t* getBulkData(uint32_t offset) const;
+
+    template<typename T>
+    T& makeBulkMessage(uint32_t bulkSize);
+
     void sync();
 
+    // Waits until x64 is at most the specified amount of frames behind.
+    void endFrame(uint32_t maxFramesAhead);
+
     void notifyShouldExit();
+
+    // Statistics of the last frame completed by each side.
+    const MessageStatistics& getStatistics() const;
+    const MessageStatistics& getX64Statistics();
+
+    // Writes every message and bulk data block sent from now on to the specified file.
+    void beginCapture(const char* filePath);
 };
 
 inline MessageSender s_messageSender;
@@ -28,3 +28,29 @@ inline void MessageSender::oneShotMessage()
     makeMessage<T>();
     endMessage();
 }
+
+template <typename T>
+T& MessageSender::reserveMessage()
+{
+    T* message = static_cast<T*>(reserveMessage(sizeof(T), alignof(T)));
+    message->id = T::s_id;
+    return *message;
+}
+
+template <typename T>
+T& MessageSender::reserveMessage(uint32_t dataSize)
+{
+    T* message = static_cast<T*>(reserveMessage(offsetof(T, data) + dataSize, alignof(T)));
+    message->id = T::s_id;
+    message->dataSize = static_cast<decltype(T::dataSize)>(dataSize);
+    return *message;
+}
+
+template <typename T>
+T& MessageSender::makeBulkMessage(uint32_t bulkSize)
+{
+    T& message = makeMessage<T>();
+    message.bulkOffset = makeBulkData(bulkSize);
+    message.bulkSize = bulkSize;
+    return message;
+}
\ No newline at end of file
@@ -70,6 +70,10 @@ extern "C" void __declspec(dllexport) PreInit()
 extern "C" void __declspec(dllexport) Init(ModInfo_t* modInfo)
 {
     Configuration::init();
+
+    if (!Configuration::s_messageCaptureFilePath.empty())
+        s_messageSender.beginCapture(Configuration::s_messageCaptureFilePath.c_str());
+
     D3D9::init();
     PictureData::init();
     FillTexture::init();
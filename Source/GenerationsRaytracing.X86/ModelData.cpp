@@ -1,5 +1,6 @@
 #include "ModelData.h"
 
+#include "AlignmentUtil.h"
 #include "GeometryFlags.h"
 #include "IndexBuffer.h"
 #include "InstanceData.h"
@@ -67,16 +68,17 @@ static void traverseModelData(const TModelData& modelData, uint32_t geometryMask
     }
 }
 
-static std::vector<uint8_t> s_matrixZeroScaledStates;
+static const uint8_t* s_matrixZeroScaledStates;
+static size_t s_matrixZeroScaledStateNum;
 
 static bool checkAllZeroScaled(const MeshDataEx& meshDataEx)
 {
-    if (!s_matrixZeroScaledStates.empty())
+    if (s_matrixZeroScaledStateNum != 0)
     {
         for (size_t i = 0; i < meshDataEx.m_NodeNum; i++)
         {
             const uint8_t nodeIndex = meshDataEx.m_pNodeIndices[i];
-            if (nodeIndex >= s_matrixZeroScaledStates.size() || !s_matrixZeroScaledStates[nodeIndex])
+            if (nodeIndex >= s_matrixZeroScaledStateNum || !s_matrixZeroScaledStates[nodeIndex])
                 return false;
         }
         return true;
@@ -382,7 +384,7 @@ static boost::shared_ptr<Hedgehog::Mirage::CParameterFloat4Element> createFloat4
         if (float4Param->m_Name == name && float4Param->m_ValueNum == valueNum)
         {
             if (value != nullptr)
-                memcpy(float4Param->m_spValue.get(), value, valueNum * sizeof(float[4]));
+                MaterialData::setValue(material, float4Param->m_spValue.get(), value, valueNum * sizeof(float[4]));
 
             return float4Param;
         }
@@ -397,10 +399,31 @@ static boost::shared_ptr<Hedgehog::Mirage::CParameterFloat4Element> createFloat4
         memcpy(float4Param->m_spValue.get(), value, valueNum * sizeof(float[4]));
     
     material.m_Float4Params.push_back(float4Param);
+    MaterialData::markDirty(material);
+
     return float4Param;
 }
 
-static std::unordered_map<Hedgehog::Mirage::CMaterialData*, float*> s_texcoordOffsets;
+struct TexcoordOffsets
+{
+    Hedgehog::Mirage::CMaterialData* material;
+    float* values;
+    float prevValues[8];
+};
+
+static std::unordered_map<Hedgehog::Mirage::CMaterialData*, TexcoordOffsets> s_texcoordOffsets;
+
+// Offsets are accumulated from scratch, so they can only be compared once every motion is applied.
+static void flushTexcoordOffsets()
+{
+    for (const auto& [_, offsets] : s_texcoordOffsets)
+    {
+        if (memcmp(offsets.values, offsets.prevValues, sizeof(offsets.prevValues)) != 0)
+            MaterialData::markDirty(*offsets.material);
+    }
+
+    s_texcoordOffsets.clear();
+}
 
 static void processTexcoordMotion(InstanceInfoEx& instanceInfoEx, const Hedgehog::Motion::CTexcoordMotion& texcoordMotion)
 {
@@ -413,16 +436,18 @@ static void processTexcoordMotion(InstanceInfoEx& instanceInfoEx, const Hedgehog
             materialClone = cloneMaterial(*texcoordMotion.m_pMaterialData);
 
         auto& offsets = s_texcoordOffsets[texcoordMotion.m_pMaterialData];
-        if (offsets == nullptr)
+        if (offsets.values == nullptr)
         {
-            offsets = createFloat4Param(*materialClone, s_texCoordOffsetSymbol, 2, nullptr)->m_spValue.get();
-            std::fill_n(offsets, 8, 0.0f);
+            offsets.material = materialClone.get();
+            offsets.values = createFloat4Param(*materialClone, s_texCoordOffsetSymbol, 2, nullptr)->m_spValue.get();
+            memcpy(offsets.prevValues, offsets.values, sizeof(offsets.prevValues));
+            std::fill_n(offsets.values, 8, 0.0f);
         }
 
         if ((texcoordMotion.m_Field4 & 0x2) == 0)
         {
             for (size_t i = 0; i < 8; i++)
-                offsets[i] += texcoordMotion.m_TexcoordOffset[i];
+                offsets.values[i] += texcoordMotion.m_TexcoordOffset[i];
         }
     }
 }
@@ -450,23 +475,28 @@ static void processMaterialMotion(InstanceInfoEx& instanceInfoEx, const Hedgehog
 
         for (const auto& float4Param : material->m_Float4Params)
         {
+            const float* value = nullptr;
+
             if (float4Param->m_Name == s_diffuseSymbol)
-                memcpy(float4Param->m_spValue.get(), matMotionData.Diffuse, sizeof(float[4]));
+                value = matMotionData.Diffuse;
 
             else if (float4Param->m_Name == s_ambientSymbol)
-                memcpy(float4Param->m_spValue.get(), matMotionData.Ambient, sizeof(float[4]));
+                value = matMotionData.Ambient;
             
             else if (float4Param->m_Name == s_specularSymbol)
-                memcpy(float4Param->m_spValue.get(), matMotionData.Specular, sizeof(float[4]));
+                value = matMotionData.Specular;
             
             else if (float4Param->m_Name == s_emissiveSymbol)
-                memcpy(float4Param->m_spValue.get(), matMotionData.Emissive, sizeof(float[4]));
+                value = matMotionData.Emissive;
             
             else if (float4Param->m_Name == s_powerGlossLevelSymbol)
-                memcpy(float4Param->m_spValue.get(), matMotionData.PowerGlossLevel, sizeof(float[4]));
+                value = matMotionData.PowerGlossLevel;
             
             else if (float4Param->m_Name == s_opacityReflectionRefractionSpectypeSymbol)
-                memcpy(float4Param->m_spValue.get(), matMotionData.OpacityReflectionRefractionSpectype, sizeof(float[4]));
+                value = matMotionData.OpacityReflectionRefractionSpectype;
+
+            if (value != nullptr)
+                MaterialData::setValue(*material, float4Param->m_spValue.get(), value, sizeof(float[4]));
         }
 
         if ((materialMotion.m_Field4 & 0x2) == 0)
@@ -492,13 +522,8 @@ static void processTexpatternMotion(InstanceInfoEx& instanceInfoEx, const Hedgeh
                 if (texture->m_Type == s_diffuseSymbol)
                 {
                     if (texture->m_spPictureData != nullptr)
-                    {
-                        if (texture->m_spPictureData->m_pD3DTexture != nullptr)
-                            texture->m_spPictureData->m_pD3DTexture->Release();
+                        MaterialData::setTexture(*material, *texture->m_spPictureData, texpatternMotion.m_pPictureData->m_pD3DTexture);
 
-                        texture->m_spPictureData->m_pD3DTexture = texpatternMotion.m_pPictureData->m_pD3DTexture;
-                        texture->m_spPictureData->m_pD3DTexture->AddRef();
-                    }
                     break;
                 }
             }
@@ -531,7 +556,7 @@ void ModelData::processSingleElementEffect(InstanceInfoEx& instanceInfoEx, Hedge
                 instanceInfoEx.m_chrPlayableMenuParam = npcSingleElementEffectMotionAll->m_ChrPlayableMenuParam.x();
         }
 
-        s_texcoordOffsets.clear();
+        flushTexcoordOffsets();
         s_matMotionProcessedMats.clear();
     }
     else if (const auto singleElementEffectUvMotion = dynamic_cast<Hedgehog::Motion::CSingleElementEffectUvMotion*>(singleElementEffect))
@@ -539,7 +564,7 @@ void ModelData::processSingleElementEffect(InstanceInfoEx& instanceInfoEx, Hedge
         for (const auto& texcoordMotion : singleElementEffectUvMotion->m_TexcoordMotionList)
             processTexcoordMotion(instanceInfoEx, texcoordMotion);
 
-        s_texcoordOffsets.clear();
+        flushTexcoordOffsets();
     }
     else if (const auto singleElementEffectMatMotion = dynamic_cast<Hedgehog::Motion::CSingleElementEffectMatMotion*>(singleElementEffect))
     {
@@ -556,7 +581,156 @@ void ModelData::processSingleElementEffect(InstanceInfoEx& instanceInfoEx, Hedge
 
 static std::vector<Hedgehog::Mirage::CMaterialData*> s_materialsToClone;
 
-void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, InstanceInfoEx& instanceInfoEx, const MaterialMap& materialMap)
+static WorkLanes s_localPoseLanes;
+
+void ModelData::computePoseInfo(ModelDataEx& modelDataEx, InstanceInfoEx& instanceInfoEx, WorkLanes& lanes, size_t laneIndex, uint32_t itemIndex)
+{
+    const auto matrixList = instanceInfoEx.m_spPose->GetMatrixList();
+    const size_t matrixNum = instanceInfoEx.m_spPose->GetMatrixNum();
+
+    PoseInfo poseInfo;
+    poseInfo.modelDataEx = &modelDataEx;
+    poseInfo.nodeNum = static_cast<uint32_t>(std::min(matrixNum, modelDataEx.m_NodeNum));
+
+    for (uint32_t i = 0; i < poseInfo.nodeNum; i++)
+    {
+        if (modelDataEx.m_spNodes[i].m_Name == "Head")
+        {
+            poseInfo.headNodeIndex = i;
+            break;
+        }
+    }
+
+    poseInfo.matrixHash = XXH32(matrixList, matrixNum * sizeof(Hedgehog::Math::CMatrix), 0);
+
+    // Same check as on the render thread, which computes the matrices itself if the guess was wrong.
+    if (instanceInfoEx.m_matrixHash != poseInfo.matrixHash || instanceInfoEx.m_prevMatrixHash != poseInfo.matrixHash ||
+        RaytracingParams::s_prevComputeSmoothNormals != RaytracingParams::s_computeSmoothNormals)
+    {
+        poseInfo.matrixNum = static_cast<uint32_t>(matrixNum);
+    }
+
+    const uint32_t zeroScaledStatesSize = alignUp<uint32_t>(poseInfo.nodeNum, alignof(uint32_t));
+    const uint32_t matricesSize = poseInfo.matrixNum * sizeof(Hedgehog::Math::CMatrix);
+
+    uint8_t* data = lanes.append(laneIndex, itemIndex, sizeof(PoseInfo) + zeroScaledStatesSize + matricesSize);
+    memcpy(data, &poseInfo, sizeof(PoseInfo));
+
+    uint8_t* zeroScaledStates = data + sizeof(PoseInfo);
+
+    for (uint32_t i = 0; i < poseInfo.nodeNum; i++)
+    {
+        const auto& matrix = matrixList[i].matrix();
+
+        const bool x = matrix.col(0).squaredNorm() < 0.0001f;
+        const bool y = matrix.col(1).squaredNorm() < 0.0001f;
+        const bool z = matrix.col(2).squaredNorm() < 0.0001f;
+
+        zeroScaledStates[i] = (x && y) || (y && z) || (x && z);
+    }
+
+    uint8_t* matrices = zeroScaledStates + zeroScaledStatesSize;
+
+    if (poseInfo.matrixNum != 0 && poseInfo.headNodeIndex < matrixNum)
+    {
+        const Hedgehog::Math::CMatrix headTransformInverse = matrixList[poseInfo.headNodeIndex].inverse();
+
+        for (size_t i = 0; i < matrixNum; i++)
+        {
+            const Hedgehog::Math::CMatrix matrix = headTransformInverse * matrixList[i];
+            memcpy(matrices, &matrix, sizeof(matrix));
+            matrices += sizeof(matrix);
+        }
+    }
+    else
+    {
+        memcpy(matrices, matrixList, matricesSize);
+    }
+}
+
+void ModelData::readPoseInfo(const WorkLanes::Record& record, PoseInfo& poseInfo)
+{
+    memcpy(&poseInfo, record.data, sizeof(PoseInfo));
+
+    poseInfo.zeroScaledStates = record.data + sizeof(PoseInfo);
+    poseInfo.matrices = poseInfo.zeroScaledStates + alignUp<uint32_t>(poseInfo.nodeNum, alignof(uint32_t));
+}
+
+static std::unordered_set<InstanceInfoEx*> s_persistentInstances;
+static Mutex s_persistentInstanceMutex;
+
+// Turns persistent model instance changes into messages, same as terrain instances.
+class ModelInstanceSink final : public PersistentInstanceSink
+{
+public:
+    const float (*transform)[4] = nullptr;
+    const float (*headTransform)[4] = nullptr;
+    const InstanceInfoEx* instanceInfoEx = nullptr;
+    const std::vector<uint32_t>* materialIds = nullptr;
+
+    uint32_t allocateInstanceId() override
+    {
+        return InstanceData::s_idAllocator.allocate();
+    }
+
+    void createInstance(uint32_t instanceId, size_t instanceType, uint32_t bottomLevelAccelStructId) override
+    {
+        auto& message = s_messageSender.makeMessage<MsgCreatePersistentInstance>(
+            static_cast<uint32_t>(materialIds->size() * sizeof(uint32_t)));
+
+        message.instanceId = instanceId;
+        memcpy(message.transform, transform, sizeof(message.transform));
+        memcpy(message.headTransform, headTransform, sizeof(message.headTransform));
+        message.bottomLevelAccelStructId = bottomLevelAccelStructId;
+        message.isMirrored = false;
+        message.instanceMask = INSTANCE_MASK_OBJECT;
+        message.instanceType = instanceInfoEx->m_enableForceAlphaColor ? INSTANCE_TYPE_TRANSPARENT : s_instanceTypes[instanceType].instanceType;
+        message.playableParam = -10001.0f;
+        message.chrPlayableMenuParam = instanceInfoEx->m_chrPlayableMenuParam + RaytracingRendering::s_worldShift.y();
+        message.forceAlphaColor = instanceInfoEx->m_forceAlphaColor;
+        message.edgeEmissionParam = instanceInfoEx->m_edgeEmissionParam;
+        memcpy(message.data, materialIds->data(), message.dataSize);
+
+        s_messageSender.endMessage();
+    }
+
+    void updateInstance(uint32_t instanceId) override
+    {
+        auto& message = s_messageSender.makeMessage<MsgUpdatePersistentInstance>();
+        message.instanceId = instanceId;
+        memcpy(message.transform, transform, sizeof(message.transform));
+        memcpy(message.headTransform, headTransform, sizeof(message.headTransform));
+        message.isMirrored = false;
+        message.playableParam = -10001.0f;
+        message.chrPlayableMenuParam = instanceInfoEx->m_chrPlayableMenuParam + RaytracingRendering::s_worldShift.y();
+        message.forceAlphaColor = instanceInfoEx->m_forceAlphaColor;
+        message.edgeEmissionParam = instanceInfoEx->m_edgeEmissionParam;
+        s_messageSender.endMessage();
+    }
+
+    void updateMaterials(uint32_t instanceId) override
+    {
+        auto& message = s_messageSender.makeMessage<MsgUpdatePersistentInstanceMaterials>(
+            static_cast<uint32_t>(materialIds->size() * sizeof(uint32_t)));
+
+        message.instanceId = instanceId;
+        memcpy(message.data, materialIds->data(), message.dataSize);
+
+        s_messageSender.endMessage();
+    }
+
+    void releaseInstance(uint32_t instanceId) override
+    {
+        auto& message = s_messageSender.makeMessage<MsgReleaseRaytracingResource>();
+        message.resourceType = RaytracingResourceType::Instance;
+        message.resourceId = instanceId;
+        s_messageSender.endMessage();
+
+        InstanceData::s_idAllocator.free(instanceId);
+    }
+};
+
+void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, InstanceInfoEx& instanceInfoEx, const MaterialMap& materialMap, PoseInfo* poseInfo)
 {
     static Hedgehog::Base::CStringSymbol s_texCoordOffsetSymbol("mrgTexcoordOffset");
 
@@ -659,27 +833,36 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
             });
         }
 
+        PoseInfo localPoseInfo;
+        if (poseInfo == nullptr || poseInfo->modelDataEx != &modelDataEx)
+        {
+            s_localPoseLanes.reset(1);
+            computePoseInfo(modelDataEx, instanceInfoEx, s_localPoseLanes, 0, 0);
+
+            WorkLanes::Cursor cursor(s_localPoseLanes);
+            WorkLanes::Record record;
+            cursor.next(record);
+
+            readPoseInfo(record, localPoseInfo);
+            poseInfo = &localPoseInfo;
+        }
+
         Hedgehog::Math::CMatrix headTransformInverse;
         bool foundHeadTransform = false;
 
         const auto matrixList = instanceInfoEx.m_spPose->GetMatrixList();
         const size_t matrixNum = instanceInfoEx.m_spPose->GetMatrixNum();
 
-        for (size_t i = 0; i < std::min(matrixNum, modelDataEx.m_NodeNum); i++)
+        if (poseInfo->headNodeIndex < matrixNum)
         {
-            if (modelDataEx.m_spNodes[i].m_Name == "Head")
-            {
-                const auto& matrix = matrixList[i];
-                headTransform = headTransform * matrix;
-                transform = transform * matrix;
-                headTransformInverse = matrix.inverse();
-                foundHeadTransform = true;
-                break;
-            }
+            const auto& matrix = matrixList[poseInfo->headNodeIndex];
+            headTransform = headTransform * matrix;
+            transform = transform * matrix;
+            headTransformInverse = matrix.inverse();
+            foundHeadTransform = true;
         }
 
-        const XXH32_hash_t matrixHash = XXH32(
-            matrixList, matrixNum * sizeof(Hedgehog::Math::CMatrix), 0);
+        const XXH32_hash_t matrixHash = poseInfo->matrixHash;
 
         const bool shouldComputePose = instanceInfoEx.m_matrixHash != matrixHash || instanceInfoEx.m_prevMatrixHash != matrixHash ||
             RaytracingParams::s_prevComputeSmoothNormals != RaytracingParams::s_computeSmoothNormals;
@@ -709,7 +892,11 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
             message.nodeCount = static_cast<uint8_t>(matrixNum);
             message.geometryCount = geometryCount;
             
-            if (foundHeadTransform)
+            if (poseInfo->matrixNum == matrixNum)
+            {
+                memcpy(message.data, poseInfo->matrices, matrixNum * sizeof(Hedgehog::Math::CMatrix));
+            }
+            else if (foundHeadTransform)
             {
                 auto dstMatrixList = reinterpret_cast<Hedgehog::Math::CMatrix*>(message.data);
 
@@ -822,21 +1009,11 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
             s_messageSender.endMessage();
         }
 
-        s_matrixZeroScaledStates.resize(std::min(matrixNum, modelDataEx.m_NodeNum));
-
-        for (size_t i = 0; i < s_matrixZeroScaledStates.size(); i++)
-        {
-            const auto& matrix = matrixList[i].matrix();
-
-            const bool x = matrix.col(0).squaredNorm() < 0.0001f;
-            const bool y = matrix.col(1).squaredNorm() < 0.0001f;
-            const bool z = matrix.col(2).squaredNorm() < 0.0001f;
-
-            s_matrixZeroScaledStates[i] = (x && y) || (y && z) || (x && z);
-        }
+        s_matrixZeroScaledStates = poseInfo->zeroScaledStates;
+        s_matrixZeroScaledStateNum = poseInfo->nodeNum;
 
         const XXH32_hash_t bottomLevelAccelStructHash = XXH32(
-            s_matrixZeroScaledStates.data(), s_matrixZeroScaledStates.size(), modelDataEx.m_visibilityFlags);
+            s_matrixZeroScaledStates, s_matrixZeroScaledStateNum, modelDataEx.m_visibilityFlags);
 
         bottomLevelAccelStructIds = instanceInfoEx.m_bottomLevelAccelStructIds[bottomLevelAccelStructHash].data();
 
@@ -862,7 +1039,8 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
             }
         }
 
-        s_matrixZeroScaledStates.clear();
+        s_matrixZeroScaledStates = nullptr;
+        s_matrixZeroScaledStateNum = 0;
     }
     else
     {
@@ -906,55 +1084,87 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
         }
     }
 
-    const bool copyPrevTransform = instanceInfoEx.m_instanceFrame == (RaytracingRendering::s_frame - 1);
+    static std::vector<uint32_t> s_materialIds;
+    s_materialIds.clear();
 
-    for (size_t i = 0; i < _countof(s_instanceTypes); i++)
+    for (auto& [key, value] : materialMap)
     {
-        const auto& bottomLevelAccelStructId = bottomLevelAccelStructIds[i];
-        if (bottomLevelAccelStructId != NULL)
-        {
-            auto& message = s_messageSender.makeMessage<MsgCreateInstance>(
-                (materialMap.size() + instanceInfoEx.m_effectMap.size()) * sizeof(uint32_t) * 2);
+        s_materialIds.push_back(reinterpret_cast<MaterialDataEx*>(key)->m_materialId);
+        s_materialIds.push_back(reinterpret_cast<MaterialDataEx*>(value.get())->m_materialId);
+    }
 
-            memcpy(message.transform, transformTransposed, sizeof(message.transform));
-            memcpy(message.prevTransform, copyPrevTransform ? instanceInfoEx.m_prevTransform : transformTransposed, sizeof(message.prevTransform));
-            memcpy(message.headTransform, headTransformTransposed, sizeof(message.headTransform));
+    for (auto& [key, value] : instanceInfoEx.m_effectMap)
+    {
+        s_materialIds.push_back(reinterpret_cast<MaterialDataEx*>(key)->m_materialId);
+        s_materialIds.push_back(reinterpret_cast<MaterialDataEx*>(value.get())->m_materialId);
+    }
 
-            message.bottomLevelAccelStructId = bottomLevelAccelStructId;
-            message.isMirrored = false;
-            message.instanceMask = INSTANCE_MASK_OBJECT;
-            message.instanceType = instanceInfoEx.m_enableForceAlphaColor ? INSTANCE_TYPE_TRANSPARENT : s_instanceTypes[i].instanceType;
-            message.playableParam = -10001.0f;
-            message.chrPlayableMenuParam = instanceInfoEx.m_chrPlayableMenuParam + RaytracingRendering::s_worldShift.y();
-            message.forceAlphaColor = instanceInfoEx.m_forceAlphaColor;
-            message.edgeEmissionParam = instanceInfoEx.m_edgeEmissionParam;
+    struct
+    {
+        float headTransform[3][4];
+        float chrPlayableMenuParam;
+        float forceAlphaColor;
+        float edgeEmissionParam;
+    } parameters;
+
+    memcpy(parameters.headTransform, headTransformTransposed, sizeof(parameters.headTransform));
+    parameters.chrPlayableMenuParam = instanceInfoEx.m_chrPlayableMenuParam + RaytracingRendering::s_worldShift.y();
+    parameters.forceAlphaColor = instanceInfoEx.m_forceAlphaColor;
+    parameters.edgeEmissionParam = instanceInfoEx.m_edgeEmissionParam;
+
+    // The instance type only gets read on creation. BLAS IDs can get reused once the model hash changes,
+    // so that recreates the instances too, as the BLAS ID alone might not tell them apart.
+    const uint32_t layout[] = { instanceInfoEx.m_modelHash, instanceInfoEx.m_enableForceAlphaColor };
+
+    ModelInstanceSink sink;
+    sink.transform = transformTransposed;
+    sink.headTransform = headTransformTransposed;
+    sink.instanceInfoEx = &instanceInfoEx;
+    sink.materialIds = &s_materialIds;
+
+    uint32_t newBottomLevelAccelStructIds[_countof(s_instanceTypes)];
+    memcpy(newBottomLevelAccelStructIds, bottomLevelAccelStructIds, sizeof(newBottomLevelAccelStructIds));
+
+    LockGuard lock(s_persistentInstanceMutex);
+
+    instanceInfoEx.m_persistentState.update(newBottomLevelAccelStructIds, transformTransposed,
+        XXH32(&parameters, sizeof(parameters), 0),
+        XXH32(s_materialIds.data(), s_materialIds.size() * sizeof(uint32_t), 0),
+        XXH32(layout, sizeof(layout), 0),
+        sink);
 
-            auto materialIds = reinterpret_cast<uint32_t*>(message.data);
+    instanceInfoEx.m_instanceFrame = RaytracingRendering::s_frame;
 
-            for (auto& [key, value] : materialMap)
-            {
-                *materialIds = reinterpret_cast<MaterialDataEx*>(key)->m_materialId;
-                ++materialIds;
+    s_persistentInstances.insert(&instanceInfoEx);
+}
 
-                *materialIds = reinterpret_cast<MaterialDataEx*>(value.get())->m_materialId;
-                ++materialIds;
-            }
+void ModelData::releaseInstances(InstanceInfoEx& instanceInfoEx)
+{
+    LockGuard lock(s_persistentInstanceMutex);
 
-            for (auto& [key, value] : instanceInfoEx.m_effectMap)
-            {
-                *materialIds = reinterpret_cast<MaterialDataEx*>(key)->m_materialId;
-                ++materialIds;
+    ModelInstanceSink sink;
+    instanceInfoEx.m_persistentState.release(sink);
+    s_persistentInstances.erase(&instanceInfoEx);
+}
 
-                *materialIds = reinterpret_cast<MaterialDataEx*>(value.get())->m_materialId;
-                ++materialIds;
-            }
+void ModelData::releaseHiddenInstances()
+{
+    LockGuard lock(s_persistentInstanceMutex);
 
-            s_messageSender.endMessage();
+    ModelInstanceSink sink;
+
+    for (auto it = s_persistentInstances.begin(); it != s_persistentInstances.end();)
+    {
+        if ((*it)->m_instanceFrame != RaytracingRendering::s_frame)
+        {
+            (*it)->m_persistentState.release(sink);
+            it = s_persistentInstances.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
-
-    instanceInfoEx.m_instanceFrame = RaytracingRendering::s_frame;
-    memcpy(instanceInfoEx.m_prevTransform, transformTransposed, sizeof(instanceInfoEx.m_prevTransform));
 }
 
 void ModelData::renderSky(Hedgehog::Mirage::CModelData& modelData)
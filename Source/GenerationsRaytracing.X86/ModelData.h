@@ -2,6 +2,7 @@
 
 #include "FreeListAllocator.h"
 #include "InstanceType.h"
+#include "WorkLanes.h"
 
 class InstanceInfoEx;
 
@@ -23,6 +24,19 @@ public:
     bool m_checkForEdgeEmission;
 };
 
+// Data that only depends on the pose and the model. Worker threads write it to a WorkLanes record
+// before any messages are sent, the render thread then reads the records back in traversal order.
+struct PoseInfo
+{
+    const ModelDataEx* modelDataEx = nullptr;
+    XXH32_hash_t matrixHash = 0;
+    uint32_t headNodeIndex = ~0u;
+    uint32_t nodeNum = 0;
+    uint32_t matrixNum = 0; // Zero if the pose wasn't expected to change, the matrices are left out then
+    const uint8_t* zeroScaledStates = nullptr;
+    const uint8_t* matrices = nullptr; // Relative to the head node, ready for MsgComputePose
+};
+
 using MaterialMap = hh::map<Hedgehog::Mirage::CMaterialData*, boost::shared_ptr<Hedgehog::Mirage::CMaterialData>>;
 
 struct ModelData
@@ -34,8 +48,19 @@ struct ModelData
     static void processSingleElementEffect(InstanceInfoEx& instanceInfoEx,
         Hedgehog::Mirage::CSingleElementEffect* singleElementEffect);
 
+    // Only reads game state, so it is safe to call from worker threads.
+    static void computePoseInfo(ModelDataEx& modelDataEx, InstanceInfoEx& instanceInfoEx,
+        WorkLanes& lanes, size_t laneIndex, uint32_t itemIndex);
+
+    static void readPoseInfo(const WorkLanes::Record& record, PoseInfo& poseInfo);
+
     static void createBottomLevelAccelStructs(ModelDataEx& modelDataEx, InstanceInfoEx& instanceInfoEx, 
-        const MaterialMap& materialMap);
+        const MaterialMap& materialMap, PoseInfo* poseInfo = nullptr);
+
+    static void releaseInstances(InstanceInfoEx& instanceInfoEx);
+
+    // Releases the instances of models that didn't get drawn this frame.
+    static void releaseHiddenInstances();
 
     static void renderSky(Hedgehog::Mirage::CModelData& modelData);
 
@@ -311,6 +311,9 @@ void ModelReplacer::processFhlMaterials(InstanceInfoEx& instanceInfoEx, const Ma
                 break;
             }
         }
+
+        // The offsets are shared with the source material, so changes to them go unnoticed otherwise.
+        MaterialData::markDirtyIfChanged(*materialClone);
     }
 
     s_fhlMaterials.clear();
@@ -1,9 +1,12 @@
 #include "PictureData.h"
 
+#include "DdsLayout.h"
 #include "Message.h"
 #include "MessageSender.h"
 #include "Texture.h"
 
+static constexpr uint32_t s_textureChunkSize = 4 * 1024 * 1024;
+
 HOOK(void, __cdecl, PictureDataMake, Hedgehog::Mirage::fpCPictureDataMake0,
      Hedgehog::Mirage::CPictureData* pictureData,
      uint8_t* data,
@@ -14,7 +17,15 @@ HOOK(void, __cdecl, PictureDataMake, Hedgehog::Mirage::fpCPictureDataMake0,
     {
         assert(pictureData->m_pD3DTexture == nullptr);
 
-        if (*reinterpret_cast<uint32_t*>(data) == MAKEFOURCC('D', 'D', 'S', ' ') && MessageSender::canMakeMessage<MsgMakeTexture>(dataSize))
+        DdsLayout layout;
+
+        // Large textures are streamed in chunks of whole rows so they neither exhaust the bulk data heap
+        // nor hold up other messages for too long. Anything the layout can't describe is sent in one piece.
+        const bool streamed = dataSize > s_textureChunkSize && layout.parse(data, dataSize) &&
+            layout.getHeaderSize() + layout.getDataSize() <= dataSize;
+
+        if (*reinterpret_cast<uint32_t*>(data) == MAKEFOURCC('D', 'D', 'S', ' ') && 
+            (streamed || s_messageSender.canMakeBulkData(dataSize)))
         {
             const auto texture = new Texture(
                 *reinterpret_cast<uint32_t*>(data + 16),
@@ -24,13 +35,42 @@ HOOK(void, __cdecl, PictureDataMake, Hedgehog::Mirage::fpCPictureDataMake0,
             pictureData->m_pD3DTexture = reinterpret_cast<DX_PATCH::IDirect3DBaseTexture9*>(texture);
             pictureData->m_Type = Hedgehog::Mirage::ePictureType_Texture;
 
-            auto& message = s_messageSender.makeMessage<MsgMakeTexture>(dataSize);
+            if (streamed)
+            {
+                auto& beginMessage = s_messageSender.makeMessage<MsgBeginMakeTexture>(layout.getHeaderSize());
+                beginMessage.textureId = texture->getId();
+                memcpy(beginMessage.data, data, layout.getHeaderSize());
+                s_messageSender.endMessage();
+
+                const uint8_t* pixels = data + layout.getHeaderSize();
+
+                layout.forEachChunk(s_textureChunkSize, [&](const DdsChunk& chunk)
+                {
+                    auto& chunkMessage = s_messageSender.makeBulkMessage<MsgWriteMakeTextureChunk>(chunk.byteSize);
+                    chunkMessage.textureId = texture->getId();
+                    chunkMessage.subresource = chunk.subresource;
+                    chunkMessage.row = chunk.row;
+                    memcpy(s_messageSender.getBulkData(chunkMessage.bulkOffset), pixels + chunk.offset, chunk.byteSize);
+                    s_messageSender.endMessage();
+                });
+            }
+
+            auto& message = streamed ? s_messageSender.makeMessage<MsgMakeTexture>() : 
+                s_messageSender.makeBulkMessage<MsgMakeTexture>(dataSize);
 
             message.textureId = texture->getId();
 #if _DEBUG
             strcpy(message.textureName, pictureData->m_TypeAndName.c_str() + 15);
 #endif
-            memcpy(message.data, data, dataSize);
+            if (streamed)
+            {
+                message.bulkOffset = 0;
+                message.bulkSize = 0;
+            }
+            else
+            {
+                memcpy(s_messageSender.getBulkData(message.bulkOffset), data, dataSize);
+            }
 
             s_messageSender.endMessage();
         }
@@ -5,6 +5,7 @@
 #include "Configuration.h"
 #include "EnvironmentMode.h"
 #include "LightData.h"
+#include "Message.h"
 #include "MessageSender.h"
 #include "QuickBoot.h"
 #include "StageSelection.h"
@@ -227,6 +228,7 @@ bool RaytracingParams::update()
 constexpr size_t s_durationNum = 120;
 static double s_appDurations[s_durationNum];
 static double s_sceneTraverseDurations[s_durationNum];
+static double s_poseDurations[s_durationNum];
 static size_t s_durationIndex = 0;
 
 void RaytracingParams::imguiWindow()
@@ -583,6 +585,7 @@ void RaytracingParams::imguiWindow()
                 {
                     s_appDurations[s_durationIndex] = double(ImGui::GetIO().DeltaTime) * 1000.0;
                     s_sceneTraverseDurations[s_durationIndex] = RaytracingRendering::s_duration;
+                    s_poseDurations[s_durationIndex] = RaytracingRendering::s_poseDuration;
 
                     if (ImPlot::BeginPlot("Frametimes"))
                     {
@@ -591,7 +594,10 @@ void RaytracingParams::imguiWindow()
                         ImPlot::PlotLine<double>("Application", s_appDurations, s_durationNum, 1.0, 0.0, ImPlotLineFlags_None, s_durationIndex);
 
                         if (Configuration::s_enableRaytracing && RaytracingParams::s_enable)
+                        {
                             ImPlot::PlotLine<double>("Scene Traverse", s_sceneTraverseDurations, s_durationNum, 1.0, 0.0, ImPlotLineFlags_None, s_durationIndex);
+                            ImPlot::PlotLine<double>("Pose Preparation", s_poseDurations, s_durationNum, 1.0, 0.0, ImPlotLineFlags_None, s_durationIndex);
+                        }
 
                         ImPlot::EndPlot();
                     }
@@ -606,10 +612,66 @@ void RaytracingParams::imguiWindow()
                     {
                         const double sceneTraverseDurationAvg = std::accumulate(s_sceneTraverseDurations, s_sceneTraverseDurations + s_durationNum, 0.0) / s_durationNum;
                         ImGui::Text("Average Scene Traverse: %g ms (%g FPS)", sceneTraverseDurationAvg, 1000.0 / sceneTraverseDurationAvg);
+
+                        const double poseDurationAvg = std::accumulate(s_poseDurations, s_poseDurations + s_durationNum, 0.0) / s_durationNum;
+                        ImGui::Text("Average Pose Preparation: %g ms", poseDurationAvg);
                     }
 
                     ImGui::Text("Vertex Buffer Wasted Memory: %g MB", static_cast<double>(VertexBuffer::s_wastedMemory) / (1024.0 * 1024.0));
                     ImGui::Text("Index Buffer Wasted Memory: %g MB", static_cast<double>(IndexBuffer::s_wastedMemory) / (1024.0 * 1024.0));
+
+                    const auto& x86Statistics = s_messageSender.getStatistics();
+                    const auto& x64Statistics = s_messageSender.getX64Statistics();
+
+                    uint8_t ids[_countof(s_messageNames)];
+                    size_t idCount = 0;
+
+                    for (size_t i = 0; i < _countof(s_messageNames); i++)
+                    {
+                        if (x86Statistics.counts[i] != 0 || x64Statistics.counts[i] != 0)
+                            ids[idCount++] = static_cast<uint8_t>(i);
+                    }
+
+                    std::sort(ids, ids + idCount, [&](uint8_t lhs, uint8_t rhs)
+                    {
+                        return x86Statistics.durations[lhs] + x64Statistics.durations[lhs] > 
+                            x86Statistics.durations[rhs] + x64Statistics.durations[rhs];
+                    });
+
+                    LARGE_INTEGER frequency;
+                    QueryPerformanceFrequency(&frequency);
+                    const double milliseconds = 1000.0 / static_cast<double>(frequency.QuadPart);
+
+                    if (ImGui::BeginTable("Messages", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+                    {
+                        ImGui::TableSetupColumn("Message");
+                        ImGui::TableSetupColumn("x86 Count");
+                        ImGui::TableSetupColumn("x86 Bytes");
+                        ImGui::TableSetupColumn("x86 Time (ms)");
+                        ImGui::TableSetupColumn("x64 Count");
+                        ImGui::TableSetupColumn("x64 Time (ms)");
+                        ImGui::TableHeadersRow();
+
+                        for (size_t i = 0; i < idCount; i++)
+                        {
+                            const uint8_t id = ids[i];
+
+                            ImGui::TableNextColumn();
+                            ImGui::TextUnformatted(s_messageNames[id]);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%u", x86Statistics.counts[id]);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%llu", x86Statistics.byteSizes[id]);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%.3f", x86Statistics.durations[id] * milliseconds);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%u", x64Statistics.counts[id]);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%.3f", x64Statistics.durations[id] * milliseconds);
+                        }
+
+                        ImGui::EndTable();
+                    }
                 }
 
                 ImGui::EndChild();
@@ -18,14 +18,109 @@
 #include "Logger.h"
 #include "WallJumpBlock.h"
 #include "Frustum.h"
+#include "TypeClassifier.h"
+#include "WorkerPool.h"
+#include "WorkLanes.h"
 
-static void createInstancesAndBottomLevelAccelStructs(Hedgehog::Mirage::CRenderable* renderable)
+enum class RenderableType
+{
+    Unknown,
+    SingleElement,
+    Bundle,
+    OptimalBundle,
+    ReelRenderer,
+    RopeRenderable,
+    InstanceRenderObj,
+    WallJumpBlockRender
+};
+
+static TypeClassifier<Hedgehog::Mirage::CRenderable, RenderableType> s_renderableClassifier = 
+    TypeClassifier<Hedgehog::Mirage::CRenderable, RenderableType>(RenderableType::Unknown)
+    .add<Hedgehog::Mirage::CSingleElement>(RenderableType::SingleElement)
+    .add<Hedgehog::Mirage::CBundle>(RenderableType::Bundle)
+    .add<Hedgehog::Mirage::COptimalBundle>(RenderableType::OptimalBundle)
+    .add<Sonic::CObjUpReel::CReelRenderer>(RenderableType::ReelRenderer)
+    .add<Sonic::CRopeRenderable>(RenderableType::RopeRenderable)
+    .add<Sonic::CInstanceRenderObjDX9>(RenderableType::InstanceRenderObj)
+    .add<Sonic::CObjWallJumpBlock::CRender>(RenderableType::WallJumpBlockRender);
+
+struct RenderableEntry
+{
+    Hedgehog::Mirage::CRenderable* renderable;
+    RenderableType type;
+};
+
+static std::vector<RenderableEntry> s_renderableEntries;
+static std::unique_ptr<WorkerPool> s_workerPool;
+static WorkLanes s_poseLanes;
+
+static void collectRenderables(Hedgehog::Mirage::CRenderable* renderable)
 {
     if (!renderable->m_Enabled)
         return;
 
-    if (auto element = dynamic_cast<Hedgehog::Mirage::CSingleElement*>(renderable))
+    const RenderableType type = s_renderableClassifier.classify(renderable);
+
+    switch (type)
+    {
+    case RenderableType::Unknown:
+        break;
+
+    case RenderableType::Bundle:
+        for (const auto& it : static_cast<Hedgehog::Mirage::CBundle*>(renderable)->m_RenderableList)
+            collectRenderables(it.get());
+
+        break;
+
+    case RenderableType::OptimalBundle:
+        for (const auto it : static_cast<Hedgehog::Mirage::COptimalBundle*>(renderable)->m_RenderableList)
+            collectRenderables(it);
+
+        break;
+
+    default:
+        s_renderableEntries.push_back({ renderable, type });
+        break;
+    }
+}
+
+static void computePoseInfo(const RenderableEntry& entry, size_t laneIndex, uint32_t itemIndex)
+{
+    if (entry.type != RenderableType::SingleElement)
+        return;
+
+    const auto element = static_cast<Hedgehog::Mirage::CSingleElement*>(entry.renderable);
+
+    if (element->m_spModel == nullptr || !element->m_spModel->IsMadeOne() ||
+        (element->m_spInstanceInfo->m_Flags & Hedgehog::Mirage::eInstanceInfoFlags_Invisible) != 0)
+    {
+        return;
+    }
+
+    const auto instanceInfoEx = reinterpret_cast<InstanceInfoEx*>(element->m_spInstanceInfo.get());
+
+    if (instanceInfoEx->m_hashFrame == RaytracingRendering::s_frame ||
+        instanceInfoEx->m_spPose == nullptr || instanceInfoEx->m_spPose->GetMatrixNum() <= 1)
     {
+        return;
+    }
+
+    auto modelDataEx = reinterpret_cast<ModelDataEx*>(element->m_spModel.get());
+
+    if (modelDataEx->m_noAoModel != nullptr && RaytracingParams::s_enableNoAoModels)
+        modelDataEx = reinterpret_cast<ModelDataEx*>(modelDataEx->m_noAoModel.get());
+
+    if (modelDataEx->IsMadeAll() && modelDataEx->m_NodeNum != 0)
+        ModelData::computePoseInfo(*modelDataEx, *instanceInfoEx, s_poseLanes, laneIndex, itemIndex);
+}
+
+static void createInstanceAndBottomLevelAccelStructs(const RenderableEntry& entry, WorkLanes::Cursor& poseCursor, uint32_t itemIndex)
+{
+    switch (entry.type)
+    {
+    case RenderableType::SingleElement:
+    {
+        const auto element = static_cast<Hedgehog::Mirage::CSingleElement*>(entry.renderable);
         const auto instanceInfoEx = reinterpret_cast<InstanceInfoEx*>(element->m_spInstanceInfo.get());
 
         instanceInfoEx->m_chrPlayableMenuParam = 10000.0f;
@@ -79,40 +174,70 @@ static void createInstancesAndBottomLevelAccelStructs(Hedgehog::Mirage::CRendera
                     *instanceInfoEx,
                     element->m_MaterialMap);
 
+                PoseInfo poseInfo;
+                WorkLanes::Record poseRecord;
+                const bool hasPoseInfo = poseCursor.seek(itemIndex, poseRecord);
+
+                if (hasPoseInfo)
+                    ModelData::readPoseInfo(poseRecord, poseInfo);
+
                 ModelData::createBottomLevelAccelStructs(
                     *modelDataEx,
                     *instanceInfoEx,
-                    element->m_MaterialMap);
+                    element->m_MaterialMap,
+                    hasPoseInfo ? &poseInfo : nullptr);
             }
 
         }
+
+        break;
     }
-    else if (const auto bundle = dynamic_cast<const Hedgehog::Mirage::CBundle*>(renderable))
-    {
-        for (const auto& it : bundle->m_RenderableList)
-            createInstancesAndBottomLevelAccelStructs(it.get());
-    }
-    else if (const auto optimalBundle = dynamic_cast<const Hedgehog::Mirage::COptimalBundle*>(renderable))
-    {
-        for (const auto it : optimalBundle->m_RenderableList)
-            createInstancesAndBottomLevelAccelStructs(it);
-    }
-    else if (const auto reelRenderer = dynamic_cast<Sonic::CObjUpReel::CReelRenderer*>(renderable))
-    {
-        UpReelRenderable::createInstanceAndBottomLevelAccelStruct(reelRenderer);
-    }
-    else if (const auto ropeRenderable = dynamic_cast<Sonic::CRopeRenderable*>(renderable))
-    {
-        RopeRenderable::createInstanceAndBottomLevelAccelStruct(ropeRenderable);
-    }
-    else if (const auto instanceRenderObjDX9 = dynamic_cast<Sonic::CInstanceRenderObjDX9*>(renderable))
-    {
-        MetaInstancer::createInstanceAndBottomLevelAccelStruct(instanceRenderObjDX9);
+
+    case RenderableType::ReelRenderer:
+        UpReelRenderable::createInstanceAndBottomLevelAccelStruct(static_cast<Sonic::CObjUpReel::CReelRenderer*>(entry.renderable));
+        break;
+
+    case RenderableType::RopeRenderable:
+        RopeRenderable::createInstanceAndBottomLevelAccelStruct(static_cast<Sonic::CRopeRenderable*>(entry.renderable));
+        break;
+
+    case RenderableType::InstanceRenderObj:
+        MetaInstancer::createInstanceAndBottomLevelAccelStruct(static_cast<Sonic::CInstanceRenderObjDX9*>(entry.renderable));
+        break;
+
+    case RenderableType::WallJumpBlockRender:
+        WallJumpBlock::createInstanceAndBottomLevelAccelStruct(static_cast<Sonic::CObjWallJumpBlock::CRender*>(entry.renderable));
+        break;
     }
-    else if (const auto wallJumpBlockRender = dynamic_cast<Sonic::CObjWallJumpBlock::CRender*>(renderable))
+}
+
+static constexpr size_t s_renderableChunkSize = 16;
+
+static void createInstancesAndBottomLevelAccelStructs()
+{
+    // Only pose preparation runs on the workers, as it is the only part that just reads game state.
+    // Instance, material and BLAS messages are still built and sent here in traversal order, since
+    // building them mutates shared state (hash frames, materials, ids, resource releases).
+    const auto time = std::chrono::high_resolution_clock::now();
+
+    s_poseLanes.reset(s_workerPool->getWorkerCount());
+
+    s_workerPool->run(s_renderableEntries.size(), s_renderableChunkSize, [](size_t itemIndex, size_t workerIndex)
     {
-        WallJumpBlock::createInstanceAndBottomLevelAccelStruct(wallJumpBlockRender);
-    }
+        computePoseInfo(s_renderableEntries[itemIndex], workerIndex, static_cast<uint32_t>(itemIndex));
+    });
+
+    RaytracingRendering::s_poseDuration = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+        std::chrono::high_resolution_clock::now() - time).count();
+
+    WorkLanes::Cursor poseCursor(s_poseLanes);
+
+    for (size_t i = 0; i < s_renderableEntries.size(); i++)
+        createInstanceAndBottomLevelAccelStructs(s_renderableEntries[i], poseCursor, static_cast<uint32_t>(i));
+
+    s_renderableEntries.clear();
+
+    ModelData::releaseHiddenInstances();
 }
 
 static boost::shared_ptr<Hedgehog::Mirage::CModelData> findSky(Hedgehog::Mirage::CRenderable* renderable)
@@ -120,31 +245,40 @@ static boost::shared_ptr<Hedgehog::Mirage::CModelData> findSky(Hedgehog::Mirage:
     if (!renderable->m_Enabled)
         return nullptr;
 
-    if (auto element = dynamic_cast<const Hedgehog::Mirage::CSingleElement*>(renderable))
+    switch (s_renderableClassifier.classify(renderable))
+    {
+    case RenderableType::SingleElement:
     {
+        const auto element = static_cast<Hedgehog::Mirage::CSingleElement*>(renderable);
+
         if (element->m_spModel->IsMadeAll() && 
             (element->m_spInstanceInfo->m_Flags & Hedgehog::Mirage::eInstanceInfoFlags_Invisible) == 0)
         {
             return element->m_spModel;
         }
+
+        break;
     }
-    else if (const auto bundle = dynamic_cast<const Hedgehog::Mirage::CBundle*>(renderable))
-    {
-        for (const auto& it : bundle->m_RenderableList)
+
+    case RenderableType::Bundle:
+        for (const auto& it : static_cast<Hedgehog::Mirage::CBundle*>(renderable)->m_RenderableList)
         {
             const auto model = findSky(it.get());
             if (model != nullptr)
                 return model;
         }
-    }
-    else if (const auto optimalBundle = dynamic_cast<const Hedgehog::Mirage::COptimalBundle*>(renderable))
-    {
-        for (const auto it : optimalBundle->m_RenderableList)
+
+        break;
+
+    case RenderableType::OptimalBundle:
+        for (const auto it : static_cast<Hedgehog::Mirage::COptimalBundle*>(renderable)->m_RenderableList)
         {
             const auto model = findSky(it);
             if (model != nullptr)
                 return model;
         }
+
+        break;
     }
 
     return nullptr;
@@ -335,9 +469,11 @@ static void __cdecl implOfTraceRays(void* a1)
             {
                 const auto categoryFindResult = renderScene->m_BundleMap.find(symbol);
                 if (categoryFindResult != renderScene->m_BundleMap.end())
-                    createInstancesAndBottomLevelAccelStructs(categoryFindResult->second.get());
+                    collectRenderables(categoryFindResult->second.get());
             }
 
+            createInstancesAndBottomLevelAccelStructs();
+
             s_frustum.set(camera->m_MyCamera.m_Projection * camera->m_MyCamera.m_View.matrix());
 
             if (const auto gameDocument = Sonic::CGameDocument::GetInstance())
@@ -514,6 +650,8 @@ void RaytracingRendering::postInit()
     if (!Configuration::s_enableRaytracing)
         return;
 
+    s_workerPool = std::make_unique<WorkerPool>(std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u));
+
     s_particleChildCount = *reinterpret_cast<uint32_t*>(0x13DD790);
     s_renderBeforeParticleChildren = *reinterpret_cast<uint32_t*>(0x13DDDDC);
     s_renderBeforeParticleChildCount = *reinterpret_cast<uint32_t*>(0x13DDDE0);
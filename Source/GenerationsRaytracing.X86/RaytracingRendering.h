@@ -6,6 +6,8 @@ struct RaytracingRendering
     static inline uint32_t s_frame;
 
     static inline double s_duration;
+    // Part of the scene traversal spent preparing poses on the worker pool.
+    static inline double s_poseDuration;
 
     static void init();
     static void postInit();
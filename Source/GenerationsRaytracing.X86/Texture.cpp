@@ -66,7 +66,11 @@ HRESULT Texture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, const RECT* p
     const uint32_t height = m_height >> Level;
     const uint32_t pitch = std::max(width * 4u, 256u);
 
-    auto& message = s_messageSender.makeMessage<MsgWriteTexture>(pitch * height);
+    // The copy on x64 expects the whole level in one block, so there's nothing to split this into.
+    if (!s_messageSender.canMakeBulkData(pitch * height))
+        return E_OUTOFMEMORY;
+
+    auto& message = s_messageSender.makeBulkMessage<MsgWriteTexture>(pitch * height);
 
     message.textureId = m_id;
     message.width = width;
@@ -74,15 +78,21 @@ HRESULT Texture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, const RECT* p
     message.level = Level;
     message.pitch = pitch;
 
-    pLockedRect->pBits = message.data;
+    pLockedRect->pBits = s_messageSender.getBulkData(message.bulkOffset);
     pLockedRect->Pitch = pitch;
 
+    m_lockedLevels |= 1u << Level;
+
     return S_OK;
 }
 
 HRESULT Texture::UnlockRect(UINT Level)
 {
-    s_messageSender.endMessage();
+    if (m_lockedLevels & (1u << Level))
+    {
+        m_lockedLevels &= ~(1u << Level);
+        s_messageSender.endMessage();
+    }
 
     return S_OK;
 }
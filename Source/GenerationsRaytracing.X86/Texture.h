@@ -10,6 +10,8 @@ protected:
     uint32_t m_width;
     uint32_t m_height;
     ComPtr<Surface> m_surfaces[15];
+    // Levels with a write message in progress, a failed lock has nothing to end.
+    uint32_t m_lockedLevels = 0;
 
 public:
     explicit Texture(uint32_t width, uint32_t height, uint32_t levelCount);
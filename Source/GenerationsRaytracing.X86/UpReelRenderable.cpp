@@ -84,12 +84,12 @@ void UpReelRenderable::createInstanceAndBottomLevelAccelStruct(Sonic::CObjUpReel
             s_messageSender.endMessage();
         }
 
-        auto& writeMsg = s_messageSender.makeMessage<MsgWriteVertexBuffer>(vertexByteSize);
+        auto& writeMsg = s_messageSender.makeBulkMessage<MsgWriteVertexBuffer>(vertexByteSize);
         writeMsg.vertexBufferId = reelRendererEx->m_vertexBuffer->getId();
         writeMsg.offset = 0;
         writeMsg.initialWrite = initialWrite;
 
-        OptimizedVertexData* vertex = reinterpret_cast<OptimizedVertexData*>(writeMsg.data);
+        OptimizedVertexData* vertex = reinterpret_cast<OptimizedVertexData*>(s_messageSender.getBulkData(writeMsg.bulkOffset));
         for (const auto index : s_indices)
         {
             const auto& vertexData = reelRenderer->m_aVertexData[index];
@@ -7,6 +7,8 @@
 
 static FreeListAllocator s_idAllocator;
 
+static constexpr uint32_t s_stagingChunkSize = 4 * 1024 * 1024;
+
 VertexBuffer::VertexBuffer(uint32_t byteSize)
 {
     m_id = s_idAllocator.allocate();
@@ -44,12 +46,25 @@ HRESULT VertexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, D
     if (SizeToLock == 0)
         SizeToLock = m_byteSize - OffsetToLock;
 
-    auto& message = s_messageSender.makeMessage<MsgWriteVertexBuffer>(SizeToLock);
+    if (!s_messageSender.canMakeBulkData(SizeToLock))
+    {
+        m_stagingData = std::make_unique<uint8_t[]>(SizeToLock);
+        m_stagingOffset = OffsetToLock;
+        m_stagingSize = SizeToLock;
+        m_stagingInitialWrite = m_pendingWrite;
+        *ppbData = m_stagingData.get();
+
+        m_pendingWrite = false;
+
+        return S_OK;
+    }
+
+    auto& message = s_messageSender.makeBulkMessage<MsgWriteVertexBuffer>(SizeToLock);
 
     message.vertexBufferId = m_id;
     message.offset = OffsetToLock;
     message.initialWrite = m_pendingWrite;
-    *ppbData = message.data;
+    *ppbData = s_messageSender.getBulkData(message.bulkOffset);
 
     m_pendingWrite = false;
 
@@ -58,6 +73,27 @@ HRESULT VertexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, D
 
 HRESULT VertexBuffer::Unlock()
 {
+    if (m_stagingData != nullptr)
+    {
+        for (uint32_t offset = 0; offset < m_stagingSize; offset += s_stagingChunkSize)
+        {
+            const uint32_t chunkSize = std::min(m_stagingSize - offset, s_stagingChunkSize);
+
+            auto& message = s_messageSender.makeBulkMessage<MsgWriteVertexBuffer>(chunkSize);
+
+            // Only the first chunk can swap to the next allocation, the rest needs to land in the same one.
+            message.vertexBufferId = m_id;
+            message.offset = m_stagingOffset + offset;
+            message.initialWrite = offset != 0 || m_stagingInitialWrite;
+            memcpy(s_messageSender.getBulkData(message.bulkOffset), m_stagingData.get() + offset, chunkSize);
+
+            s_messageSender.endMessage();
+        }
+
+        m_stagingData = nullptr;
+        return S_OK;
+    }
+
     s_messageSender.endMessage();
 
     return S_OK;
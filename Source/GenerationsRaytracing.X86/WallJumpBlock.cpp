@@ -89,7 +89,9 @@ void WallJumpBlock::createInstanceAndBottomLevelAccelStruct(Sonic::CObjWallJumpB
     {
         if (float4Param->m_Name == s_ambientSymbol)
         {
-            memcpy(float4Param->m_spValue.get(), wallJumpBlockRender->m_pObjWallJumpBlock->m_spArrowMaterialMotion->m_MaterialMotionData.Ambient, sizeof(float[4]));
+            MaterialData::setValue(*wallJumpBlockRender->m_pObjWallJumpBlock->m_spArrowMaterial, float4Param->m_spValue.get(),
+                wallJumpBlockRender->m_pObjWallJumpBlock->m_spArrowMaterialMotion->m_MaterialMotionData.Ambient, sizeof(float[4]));
+
             break;
         }
     }
@@ -122,12 +124,12 @@ void WallJumpBlock::createInstanceAndBottomLevelAccelStruct(Sonic::CObjWallJumpB
     {
         wallJumpBlockRenderEx->m_vertexHash = vertexHash;
 
-        auto& writeMsg = s_messageSender.makeMessage<MsgWriteVertexBuffer>(vertexByteSize);
+        auto& writeMsg = s_messageSender.makeBulkMessage<MsgWriteVertexBuffer>(vertexByteSize);
         writeMsg.vertexBufferId = wallJumpBlockRenderEx->m_vertexBuffer->getId();
         writeMsg.offset = 0;
         writeMsg.initialWrite = initialWrite;
 
-        auto dest = reinterpret_cast<OptimizedVertexData*>(writeMsg.data);
+        auto dest = reinterpret_cast<OptimizedVertexData*>(s_messageSender.getBulkData(writeMsg.bulkOffset));
 
         copyVertexData(dest, wallJumpBlockRender->m_aPanelVertexData, nullptr, 0);
         dest += 6;
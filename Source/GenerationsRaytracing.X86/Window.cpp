@@ -104,7 +104,10 @@ static void __declspec(naked) createWindowTrampoline()
 HOOK(void*, __fastcall, ProcessWindowMessages, 0xE7BED0, void* This, void* _, void* a2, void* a3) 
 {
     s_messageSender.oneShotMessage<MsgProcessWindowMessages>();
-    s_messageSender.sync();
+
+    // Window messages get forwarded by x64 on its own time when it's allowed to run behind.
+    if (Configuration::s_maxFramesAhead == 0)
+        s_messageSender.sync();
 
     return originalProcessWindowMessages(This, _, a2, a3);
 }
@@ -116,7 +119,11 @@ HOOK(void*, __stdcall, SampleInput, 0xD683C0, float a1)
     if (!(*s_shouldExit))
     {
         s_messageSender.oneShotMessage<MsgWaitOnSwapChain>();
-        s_swapChainEvent.wait();
+
+        // x64 still waits on the swap chain before getting to the next frame,
+        // so the frame fence in Present paces us the same way, just with latency.
+        if (Configuration::s_maxFramesAhead == 0)
+            s_swapChainEvent.wait();
     }
 
     return originalSampleInput(a1);